@@ -41,6 +41,15 @@ benchmarks = [
     "test_face_ptr_creation.cpp",
     "test_font_registration.cpp",
     "test_rendering.cpp",
+    "test_label_collision.cpp",
+    "test_text_itemizer.cpp",
+    "test_compositing.cpp",
+    "test_image_filters.cpp",
+    "test_image_scaling.cpp",
+    "test_raster_colorizer.cpp",
+    "test_png_encoding3.cpp",
+    "test_png_encoding4.cpp",
+    "test_solid_encoding.cpp",
 ]
 for cpp_test in benchmarks:
     test_program = test_env_local.Program('out/'+cpp_test.replace('.cpp',''), source=[cpp_test])
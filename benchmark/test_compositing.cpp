@@ -0,0 +1,91 @@
+#include "bench_framework.hpp"
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_compositing.hpp>
+#include <mapnik/simd.hpp>
+#include <cstring>
+
+void fill(mapnik::image_data_32 & im, unsigned seed)
+{
+    // premultiplied, mostly translucent pixels
+    for (unsigned y = 0; y < im.height(); ++y)
+    {
+        unsigned char * row = reinterpret_cast<unsigned char*>(im.getRow(y));
+        for (unsigned x = 0; x < im.width(); ++x)
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned a = (seed >> 16) & 0xff;
+            row[x * 4 + 0] = static_cast<unsigned char>(((seed >> 8) & 0xff) * a / 255);
+            row[x * 4 + 1] = static_cast<unsigned char>(((seed >> 4) & 0xff) * a / 255);
+            row[x * 4 + 2] = static_cast<unsigned char>((seed & 0xff) * a / 255);
+            row[x * 4 + 3] = static_cast<unsigned char>(a);
+        }
+    }
+}
+
+class test : public benchmark::test_case
+{
+    mapnik::image_data_32 src_;
+    mapnik::image_data_32 dst_;
+    mapnik::composite_mode_e mode_;
+    float opacity_;
+    mapnik::simd::level_e level_;
+public:
+    test(mapnik::parameters const& params,
+         mapnik::composite_mode_e mode,
+         float opacity,
+         mapnik::simd::level_e level)
+     : test_case(params),
+       src_(1024, 1024),
+       dst_(1024, 1024),
+       mode_(mode),
+       opacity_(opacity),
+       level_(level)
+    {
+        fill(src_, 1);
+        fill(dst_, 2);
+    }
+    bool validate() const
+    {
+        mapnik::image_data_32 expected(dst_.width(), dst_.height());
+        mapnik::image_data_32 actual(dst_.width(), dst_.height());
+        std::size_t bytes = dst_.width() * dst_.height() * 4;
+        std::memcpy(expected.getBytes(), dst_.getBytes(), bytes);
+        std::memcpy(actual.getBytes(), dst_.getBytes(), bytes);
+        mapnik::simd::level_e previous = mapnik::simd::set_level(mapnik::simd::SCALAR);
+        mapnik::composite(expected, const_cast<mapnik::image_data_32&>(src_), mode_, opacity_, 0, 0, false);
+        mapnik::simd::set_level(level_);
+        mapnik::composite(actual, const_cast<mapnik::image_data_32&>(src_), mode_, opacity_, 0, 0, false);
+        mapnik::simd::set_level(previous);
+        return std::memcmp(expected.getBytes(), actual.getBytes(), bytes) == 0;
+    }
+    void operator()() const
+    {
+        mapnik::simd::set_level(level_);
+        mapnik::image_data_32 dst(dst_.width(), dst_.height());
+        mapnik::image_data_32 & src = const_cast<mapnik::image_data_32&>(src_);
+        for (std::size_t i=0;i<iterations_;++i) {
+            std::memcpy(dst.getBytes(), dst_.getBytes(), dst_.width() * dst_.height() * 4);
+            mapnik::composite(dst, src, mode_, opacity_, 0, 0, false);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    int return_value = 0;
+    for (mapnik::composite_mode_e mode : { mapnik::src_over, mapnik::multiply })
+    {
+        for (int level = mapnik::simd::SCALAR; level <= detected; ++level)
+        {
+            test test_runner(params, mode, 0.5f, static_cast<mapnik::simd::level_e>(level));
+            std::string name = *mapnik::comp_op_to_string(mode) +
+                (level == mapnik::simd::SCALAR ? " agg" : level == mapnik::simd::SSE2 ? " sse2" : " avx2");
+            return_value = return_value | run(test_runner, name);
+        }
+    }
+    mapnik::simd::set_level(detected);
+    return return_value;
+}
@@ -52,6 +52,48 @@ public:
     }
 };
 
+// faces as looked up by renderers: each renderer gets a new face_manager,
+// faces of globally registered fonts are reused from the thread's cache
+class test2 : public benchmark::test_case
+{
+public:
+    test2(mapnik::parameters const& params)
+     : test_case(params) {}
+    bool validate() const
+    {
+        std::size_t count = 0;
+        std::size_t expected_count = mapnik::freetype_engine::face_names().size();
+        mapnik::freetype_engine::font_file_mapping_type font_file_mapping;
+        mapnik::freetype_engine::font_memory_cache_type font_cache;
+        mapnik::font_library library;
+        mapnik::face_manager manager(library, font_file_mapping, font_cache);
+        for (std::string const& name : mapnik::freetype_engine::face_names())
+        {
+            if (manager.get_face(name)) ++count;
+        }
+        return count == expected_count;
+    }
+    void operator()() const
+    {
+        std::size_t expected_count = mapnik::freetype_engine::face_names().size();
+        for (unsigned i=0;i<iterations_;++i)
+        {
+            std::size_t count = 0;
+            mapnik::freetype_engine::font_file_mapping_type font_file_mapping;
+            mapnik::freetype_engine::font_memory_cache_type font_cache;
+            mapnik::font_library library;
+            mapnik::face_manager manager(library, font_file_mapping, font_cache);
+            for (std::string const& name : mapnik::freetype_engine::face_names())
+            {
+                if (manager.get_face(name)) ++count;
+            }
+            if (count != expected_count) {
+                std::clog << "warning: face creation not working as expected\n";
+            }
+        }
+    }
+};
+
 int main(int argc, char** argv)
 {
     mapnik::parameters params;
@@ -63,6 +105,8 @@ int main(int argc, char** argv)
     } 
     std::size_t face_count = mapnik::freetype_engine::face_names().size();
     test test_runner(params);
-    return run(test_runner,(boost::format("font_engine: creating %ld faces") % (face_count)).str());
+    run(test_runner,(boost::format("font_engine: creating %ld faces") % (face_count)).str());
+    test2 test_runner2(params);
+    return run(test_runner2,(boost::format("face_manager: looking up %ld faces") % (face_count)).str());
 }
 
@@ -0,0 +1,104 @@
+#include "bench_framework.hpp"
+#include <mapnik/graphics.hpp>
+#include <mapnik/image_filter.hpp>
+#include <mapnik/image_filter_types.hpp>
+#include <mapnik/simd.hpp>
+#include <cstring>
+
+class test : public benchmark::test_case
+{
+    mapnik::image_32 im_;
+    mapnik::filter::filter_type filter_;
+    mapnik::simd::level_e level_;
+    std::size_t parallel_threshold_;
+public:
+    test(mapnik::parameters const& params,
+         mapnik::filter::filter_type const& filter,
+         mapnik::simd::level_e level,
+         std::size_t parallel_threshold)
+     : test_case(params),
+       im_(2048, 2048),
+       filter_(filter),
+       level_(level),
+       parallel_threshold_(parallel_threshold)
+    {
+        // a metatile of translucent noise
+        unsigned seed = 1;
+        unsigned char * bytes = im_.raw_data();
+        for (std::size_t i = 0; i < std::size_t(im_.width()) * im_.height(); ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned a = (seed >> 16) & 0xff;
+            bytes[i * 4] = static_cast<unsigned char>(((seed >> 8) & 0xff) * a / 255);
+            bytes[i * 4 + 1] = static_cast<unsigned char>(((seed >> 4) & 0xff) * a / 255);
+            bytes[i * 4 + 2] = static_cast<unsigned char>((seed & 0xff) * a / 255);
+            bytes[i * 4 + 3] = static_cast<unsigned char>(a);
+        }
+    }
+    void apply(mapnik::image_32 & im) const
+    {
+        mapnik::filter::filter_visitor<mapnik::image_32> visitor(im);
+        mapnik::util::apply_visitor(visitor, filter_);
+    }
+    bool validate() const
+    {
+        mapnik::image_32 expected(im_);
+        mapnik::image_32 actual(im_);
+        mapnik::simd::level_e level = mapnik::simd::set_level(mapnik::simd::SCALAR);
+        std::size_t threshold = mapnik::filter::parallel_threshold();
+        mapnik::filter::set_parallel_threshold(0);
+        apply(expected);
+        mapnik::simd::set_level(level_);
+        mapnik::filter::set_parallel_threshold(parallel_threshold_);
+        apply(actual);
+        mapnik::simd::set_level(level);
+        mapnik::filter::set_parallel_threshold(threshold);
+        return std::memcmp(expected.raw_data(), actual.raw_data(), std::size_t(im_.width()) * im_.height() * 4) == 0;
+    }
+    void operator()() const
+    {
+        mapnik::simd::set_level(level_);
+        mapnik::filter::set_parallel_threshold(parallel_threshold_);
+        mapnik::image_32 im(im_);
+        for (std::size_t i=0;i<iterations_;++i) {
+            std::memcpy(im.raw_data(), im_.raw_data(), std::size_t(im_.width()) * im_.height() * 4);
+            apply(im);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    std::size_t threshold = mapnik::filter::parallel_threshold();
+    int return_value = 0;
+    mapnik::filter::colorize_alpha colorize;
+    colorize.emplace_back(mapnik::color(0, 0, 255));
+    colorize.emplace_back(mapnik::color(255, 0, 0));
+    std::vector<std::pair<std::string, mapnik::filter::filter_type> > filters = {
+        { "agg-stack-blur(8,8)", mapnik::filter::agg_stack_blur(8, 8) },
+        { "blur", mapnik::filter::blur() },
+        { "sobel", mapnik::filter::sobel() },
+        { "colorize-alpha", colorize }
+    };
+    for (auto const& filter : filters)
+    {
+        {
+            test test_runner(params, filter.second, mapnik::simd::SCALAR, 0);
+            return_value = return_value | run(test_runner, filter.first + " scalar");
+        }
+        {
+            test test_runner(params, filter.second, detected, 0);
+            return_value = return_value | run(test_runner, filter.first + " simd");
+        }
+        {
+            test test_runner(params, filter.second, detected, threshold);
+            return_value = return_value | run(test_runner, filter.first + " simd rows");
+        }
+    }
+    mapnik::simd::set_level(detected);
+    mapnik::filter::set_parallel_threshold(threshold);
+    return return_value;
+}
@@ -0,0 +1,82 @@
+#include "bench_framework.hpp"
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_scaling.hpp>
+#include <mapnik/simd.hpp>
+
+void fill(mapnik::image_data_32 & im)
+{
+    // opaque gradients, like a raster basemap tile
+    for (unsigned y = 0; y < im.height(); ++y)
+    {
+        unsigned char * row = reinterpret_cast<unsigned char*>(im.getRow(y));
+        for (unsigned x = 0; x < im.width(); ++x)
+        {
+            row[x * 4 + 0] = static_cast<unsigned char>(x * 3 + y);
+            row[x * 4 + 1] = static_cast<unsigned char>(y * 5);
+            row[x * 4 + 2] = static_cast<unsigned char>(x ^ y);
+            row[x * 4 + 3] = 255;
+        }
+    }
+}
+
+class test : public benchmark::test_case
+{
+    mapnik::image_data_32 src_;
+    unsigned width_;
+    unsigned height_;
+    mapnik::scaling_method_e method_;
+    mapnik::simd::level_e level_;
+public:
+    test(mapnik::parameters const& params,
+         unsigned width,
+         unsigned height,
+         mapnik::scaling_method_e method,
+         mapnik::simd::level_e level)
+     : test_case(params),
+       src_(1024, 1024),
+       width_(width),
+       height_(height),
+       method_(method),
+       level_(level)
+    {
+        fill(src_);
+    }
+    bool validate() const
+    {
+        mapnik::image_data_32 dst(width_, height_);
+        mapnik::simd::level_e previous = mapnik::simd::set_level(level_);
+        mapnik::scale_image_agg(dst, src_, method_, double(width_) / src_.width(),
+                                double(height_) / src_.height(), 0.0, 0.0, 3.0);
+        mapnik::simd::set_level(previous);
+        return dst(width_ / 2, height_ / 2) != 0;
+    }
+    void operator()() const
+    {
+        mapnik::simd::set_level(level_);
+        for (std::size_t i=0;i<iterations_;++i) {
+            mapnik::image_data_32 dst(width_, height_);
+            mapnik::scale_image_agg(dst, src_, method_, double(width_) / src_.width(),
+                                    double(height_) / src_.height(), 0.0, 0.0, 3.0);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    int return_value = 0;
+    for (mapnik::scaling_method_e method : { mapnik::SCALING_NEAR, mapnik::SCALING_BILINEAR,
+                                             mapnik::SCALING_BICUBIC, mapnik::SCALING_LANCZOS })
+    {
+        for (unsigned size : { 1536u, 400u })
+        {
+            test test_runner(params, size, size, method, detected);
+            std::string name = *mapnik::scaling_method_to_string(method) + " 1024 -> " + std::to_string(size);
+            return_value = return_value | run(test_runner, name);
+        }
+    }
+    mapnik::simd::set_level(detected);
+    return return_value;
+}
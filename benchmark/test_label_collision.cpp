@@ -0,0 +1,88 @@
+#include "bench_framework.hpp"
+#include <mapnik/label_collision_detector.hpp>
+#include <mapnik/unicode.hpp>
+#include <random>
+
+struct candidate
+{
+    mapnik::box2d<double> box;
+    mapnik::value_unicode_string text;
+};
+
+// dense labelling: many more candidates than fit on the canvas, as produced
+// by the displacement sweep of text and markers placement
+std::vector<candidate> make_candidates(std::size_t count, double width, double height)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> x(0, width);
+    std::uniform_real_distribution<double> y(0, height);
+    std::uniform_real_distribution<double> w(20, 120);
+    std::uniform_int_distribution<int> name(0, 200);
+    mapnik::transcoder tr("utf-8");
+    std::vector<candidate> candidates;
+    candidates.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        double x0 = x(gen);
+        double y0 = y(gen);
+        candidates.push_back(candidate{mapnik::box2d<double>(x0, y0, x0 + w(gen), y0 + 12),
+                                       tr.transcode(("road " + std::to_string(name(gen))).c_str())});
+    }
+    return candidates;
+}
+
+std::size_t place(mapnik::label_collision_detector4 & detector, std::vector<candidate> const& candidates)
+{
+    std::size_t placed = 0;
+    for (auto const& c : candidates)
+    {
+        if (detector.has_placement(c.box, 2.0, c.text, 100.0))
+        {
+            detector.insert(c.box, c.text);
+            ++placed;
+        }
+    }
+    return placed;
+}
+
+class test : public benchmark::test_case
+{
+    mapnik::box2d<double> extent_;
+    std::vector<candidate> candidates_;
+    bool grid_;
+public:
+    test(mapnik::parameters const& params, bool grid)
+     : test_case(params),
+       extent_(-128, -128, 1024 + 128, 1024 + 128),
+       candidates_(make_candidates(50000, 1024, 1024)),
+       grid_(grid) {}
+    double cell_size() const
+    {
+        return grid_ ? mapnik::label_collision_detector4::default_cell_size(extent_) : 0.0;
+    }
+    bool validate() const
+    {
+        mapnik::label_collision_detector4 quad_tree(extent_);
+        mapnik::label_collision_detector4 detector(extent_, cell_size());
+        std::size_t placed = place(detector, candidates_);
+        return placed > 0 && placed == place(quad_tree, candidates_);
+    }
+    void operator()() const
+    {
+        mapnik::label_collision_detector4 detector(extent_, cell_size());
+        for (std::size_t i=0;i<iterations_;++i) {
+            detector.clear();
+            place(detector, candidates_);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    test test_runner(params, false);
+    run(test_runner,"label collision quad tree");
+    test test_runner2(params, true);
+    return run(test_runner2,"label collision grid");
+}
@@ -0,0 +1,58 @@
+#include "bench_framework.hpp"
+#include <mapnik/image_util.hpp>
+#include <mapnik/image_data.hpp>
+
+void fill(mapnik::image_data_32 & im)
+{
+    // gradients with a little noise, roughly as compressible as a rendered map
+    unsigned seed = 17;
+    for (unsigned y = 0; y < im.height(); ++y)
+    {
+        for (unsigned x = 0; x < im.width(); ++x)
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned noise = (seed >> 16) & 0x7;
+            im(x, y) = 0xff000000 | ((((x ^ y) + noise) & 0xff) << 16) | ((y & 0xff) << 8) | ((x + noise) & 0xff);
+        }
+    }
+}
+
+class test : public benchmark::test_case
+{
+    mapnik::image_data_32 im_;
+    std::string format_;
+public:
+    test(mapnik::parameters const& params, std::string const& format)
+     : test_case(params),
+       im_(2048,2048),
+       format_(format)
+    {
+        fill(im_);
+    }
+    bool validate() const
+    {
+        return !mapnik::save_to_string(im_, format_).empty();
+    }
+    void operator()() const
+    {
+        std::string out;
+        for (std::size_t i=0;i<iterations_;++i) {
+            out.clear();
+            out = mapnik::save_to_string(im_, format_);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    for (std::string const& format : { "png32", "png32:p=2", "png32:p=4", "png32:p=0",
+                                        "png32:z=1", "png32:z=1:p=2", "png32:z=1:p=4", "png32:z=1:p=0" })
+    {
+        test test_runner(params, format);
+        return_value = return_value | run(test_runner, "encoding 2048x2048 " + format);
+    }
+    return return_value;
+}
@@ -0,0 +1,64 @@
+#include "bench_framework.hpp"
+#include "compare_images.hpp"
+#include <mapnik/palette.hpp>
+
+class test : public benchmark::test_case
+{
+    std::shared_ptr<image_32> im_;
+    std::shared_ptr<mapnik::rgba_palette> pal_;
+public:
+    test(mapnik::parameters const& params,
+         std::shared_ptr<mapnik::rgba_palette> const& pal)
+     : test_case(params),
+       pal_(pal)
+    {
+        std::string filename("./benchmark/data/multicolor.png");
+        std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(filename,"png"));
+        if (!reader.get())
+        {
+            throw mapnik::image_reader_exception("Failed to load: " + filename);
+        }
+        im_ = std::make_shared<image_32>(reader->width(),reader->height());
+        reader->read(0,0,im_->data());
+    }
+    bool validate() const
+    {
+        if (pal_) return !mapnik::save_to_string(im_->data(), "png8:z=1", *pal_).empty();
+        return !mapnik::save_to_string(im_->data(), "png8:m=h:z=1").empty();
+    }
+    void operator()() const
+    {
+        std::string out;
+        for (std::size_t i=0;i<iterations_;++i) {
+            out.clear();
+            if (pal_) out = mapnik::save_to_string(im_->data(), "png8:z=1", *pal_);
+            else out = mapnik::save_to_string(im_->data(), "png8:m=h:z=1");
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    // 6x6x6 color cube, grays and a few translucent entries
+    std::string colors;
+    for (unsigned i = 0; i < 216; ++i)
+    {
+        colors += std::string() + char(i % 6 * 51) + char(i / 6 % 6 * 51) + char(i / 36 * 51) + char(255);
+    }
+    for (unsigned i = 0; i < 40; ++i)
+    {
+        colors += std::string() + char(i * 6) + char(i * 6) + char(i * 6) + char(i < 20 ? 255 : i * 6);
+    }
+    int return_value = 0;
+    {
+        test test_runner(params, std::shared_ptr<mapnik::rgba_palette>());
+        return_value = return_value | run(test_runner, "encoding multicolor png8 hextree");
+    }
+    {
+        test test_runner(params, std::make_shared<mapnik::rgba_palette>(colors));
+        return_value = return_value | run(test_runner, "encoding multicolor png8 fixed palette");
+    }
+    return return_value;
+}
@@ -0,0 +1,73 @@
+#include "bench_framework.hpp"
+#include <mapnik/raster.hpp>
+#include <mapnik/raster_colorizer.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <cstring>
+
+class test : public benchmark::test_case
+{
+    std::vector<float> values_;
+    mapnik::raster_colorizer colorizer_;
+    mapnik::feature_ptr feature_;
+    void colorize(unsigned & first) const
+    {
+        auto r = std::make_shared<mapnik::raster>(mapnik::box2d<double>(0, 0, 256, 256), 256, 256, 1.0);
+        std::memcpy(r->data_.getData(), values_.data(), values_.size() * sizeof(float));
+        r->set_nodata(-32768);
+        colorizer_.colorize(r, *feature_);
+        first = r->data_(128, 128);
+    }
+public:
+    // a 256x256 tile of integer elevations in [lo, lo + span)
+    test(mapnik::parameters const& params, int lo, int span, float step)
+     : test_case(params),
+       values_(256 * 256),
+       colorizer_(mapnik::COLORIZER_LINEAR, mapnik::color(0,0,0,0)),
+       feature_(mapnik::feature_factory::create(std::make_shared<mapnik::context_type>(), 1))
+    {
+        for (std::size_t i = 0; i < values_.size(); ++i)
+        {
+            values_[i] = lo + static_cast<int>(i * 7919 % span) * step;
+        }
+        colorizer_.add_stop(mapnik::colorizer_stop(-100, mapnik::COLORIZER_LINEAR, mapnik::color(0,0,128)));
+        colorizer_.add_stop(mapnik::colorizer_stop(0, mapnik::COLORIZER_LINEAR, mapnik::color(0,128,0)));
+        colorizer_.add_stop(mapnik::colorizer_stop(100, mapnik::COLORIZER_LINEAR, mapnik::color(255,255,0)));
+        colorizer_.add_stop(mapnik::colorizer_stop(500, mapnik::COLORIZER_LINEAR, mapnik::color(128,64,0)));
+        colorizer_.add_stop(mapnik::colorizer_stop(1500, mapnik::COLORIZER_DISCRETE, mapnik::color(200,200,200)));
+        colorizer_.add_stop(mapnik::colorizer_stop(3000, mapnik::COLORIZER_LINEAR, mapnik::color(255,255,255)));
+    }
+    bool validate() const
+    {
+        unsigned color = 0;
+        colorize(color);
+        return color != 0;
+    }
+    void operator()() const
+    {
+        unsigned color = 0;
+        for (std::size_t i=0;i<iterations_;++i) {
+            colorize(color);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    {
+        test test_runner(params, 0, 256, 1.0f);
+        return_value = return_value | run(test_runner, "8 bit classes");
+    }
+    {
+        test test_runner(params, -200, 4000, 1.0f);
+        return_value = return_value | run(test_runner, "16 bit elevation");
+    }
+    {
+        test test_runner(params, -200, 4000, 1.25f);
+        return_value = return_value | run(test_runner, "float elevation");
+    }
+    return return_value;
+}
@@ -0,0 +1,91 @@
+#include "bench_framework.hpp"
+#include <mapnik/image_util.hpp>
+#include <mapnik/image_data.hpp>
+#include <mapnik/encoded_image_cache.hpp>
+
+class test : public benchmark::test_case
+{
+    mapnik::image_data_32 im_;
+    std::string format_;
+    bool cached_;
+public:
+    test(mapnik::parameters const& params, std::uint32_t color, std::string const& format, bool cached)
+     : test_case(params),
+       im_(256,256),
+       format_(format),
+       cached_(cached)
+    {
+        im_.set(color);
+    }
+    bool validate() const
+    {
+        return !mapnik::save_to_string(im_, format_).empty();
+    }
+    void operator()() const
+    {
+        mapnik::encoded_image_cache & cache = mapnik::encoded_image_cache::instance();
+        std::size_t max_size = cache.max_size();
+        cache.set_max_size(cached_ ? 1024 : 0);
+        std::string out;
+        for (std::size_t i=0;i<iterations_;++i) {
+            out.clear();
+            out = mapnik::save_to_string(im_, format_);
+        }
+        cache.set_max_size(max_size);
+    }
+};
+
+class hash_test : public benchmark::test_case
+{
+    mapnik::image_data_32 im_;
+public:
+    hash_test(mapnik::parameters const& params)
+     : test_case(params),
+       im_(256,256)
+    {
+        for (unsigned y = 0; y < im_.height(); ++y)
+        {
+            for (unsigned x = 0; x < im_.width(); ++x)
+            {
+                im_(x, y) = x * y;
+            }
+        }
+    }
+    bool validate() const
+    {
+        return mapnik::image_hash(im_) != 0;
+    }
+    void operator()() const
+    {
+        std::uint64_t hash = 0;
+        for (std::size_t i=0;i<iterations_;++i) {
+            hash ^= mapnik::image_hash(im_);
+        }
+        if (hash == 1) std::clog << hash;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    for (std::string const& format : { "png8:m=h", "png32" })
+    {
+        for (std::uint32_t color : { 0x00000000u, 0xffe0c8a0u })
+        {
+            for (bool cached : { false, true })
+            {
+                test test_runner(params, color, format, cached);
+                std::string name = "encoding " + std::string(color ? "solid " : "empty ") + format +
+                    (cached ? " (cached)" : "");
+                return_value = return_value | run(test_runner, name);
+            }
+        }
+    }
+    {
+        hash_test test_runner(params);
+        return_value = return_value | run(test_runner, "hashing 256x256");
+    }
+    return return_value;
+}
@@ -0,0 +1,63 @@
+#include "bench_framework.hpp"
+#include <mapnik/text/itemizer.hpp>
+#include <mapnik/text/text_properties.hpp>
+#include <mapnik/unicode.hpp>
+
+class test : public benchmark::test_case
+{
+    std::vector<mapnik::value_unicode_string> labels_;
+    mapnik::evaluated_format_properties_ptr format_;
+public:
+    test(mapnik::parameters const& params, std::vector<std::string> const& labels)
+     : test_case(params),
+       labels_(),
+       format_(std::make_shared<mapnik::detail::evaluated_format_properties>())
+    {
+        mapnik::transcoder tr("utf-8");
+        for (auto const& label : labels)
+        {
+            labels_.push_back(tr.transcode(label.c_str()));
+        }
+    }
+    std::size_t itemize() const
+    {
+        std::size_t count = 0;
+        mapnik::text_itemizer itemizer;
+        for (auto const& label : labels_)
+        {
+            itemizer.clear();
+            itemizer.add_text(label, format_);
+            for (unsigned i = 0; i < itemizer.num_lines(); ++i)
+            {
+                auto line = itemizer.line(i);
+                count += itemizer.itemize(line.first, line.second).size();
+            }
+        }
+        return count;
+    }
+    bool validate() const
+    {
+        return itemize() >= labels_.size();
+    }
+    void operator()() const
+    {
+        for (std::size_t i=0;i<iterations_;++i) {
+            itemize();
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    std::vector<std::string> latin = {
+        "Main Street", "Rue de l'Église", "Straße des 17. Juni", "A1", "Park Avenue\nSouth",
+        "Via Appia Antica", "Plaça de Catalunya", "Łódź", "1600 Pennsylvania Ave NW" };
+    std::vector<std::string> mixed = {
+        "Москва", "東京", "القاهرة", "ירושלים", "Αθήνα", "Main Street (Москва)" };
+    test test_runner(params, latin);
+    run(test_runner,"text itemizer latin");
+    test test_runner2(params, mixed);
+    return run(test_runner2,"text itemizer other scripts");
+}
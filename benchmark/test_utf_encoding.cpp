@@ -90,6 +90,55 @@ public:
     }
 };
 
+class test4 : public benchmark::test_case
+{
+    std::string utf8_;
+public:
+    test4(mapnik::parameters const& params)
+     : test_case(params),
+       utf8_("Main Street") {}
+    bool validate() const
+    {
+        mapnik::transcoder tr_("utf-8");
+        mapnik::value_unicode_string ustr = tr_.transcode(utf8_.data(),utf8_.size());
+        if (ustr.length() != 11) return false;
+        std::string roundtrip;
+        mapnik::to_utf8(ustr,roundtrip);
+        return roundtrip == utf8_;
+    }
+    void operator()() const
+    {
+        mapnik::transcoder tr_("utf-8");
+        mapnik::value_unicode_string ustr;
+        for (std::size_t i=0;i<iterations_;++i) {
+            ustr = tr_.transcode(utf8_.data(),utf8_.size());
+        }
+    }
+};
+
+class test5 : public benchmark::test_case
+{
+    std::string utf8_;
+public:
+    test5(mapnik::parameters const& params)
+     : test_case(params),
+       utf8_(u8"שלום") {}
+    bool validate() const
+    {
+        mapnik::transcoder tr_("utf-8");
+        mapnik::value val(tr_.transcode_utf8(utf8_.data(),utf8_.size()));
+        return val.to_string() == utf8_ && val == mapnik::value(tr_.transcode(utf8_.data(),utf8_.size()));
+    }
+    void operator()() const
+    {
+        mapnik::transcoder tr_("utf-8");
+        std::string utf8;
+        for (std::size_t i=0;i<iterations_;++i) {
+            utf8 = tr_.transcode_utf8(utf8_.data(),utf8_.size());
+        }
+    }
+};
+
 int main(int argc, char** argv)
 {
     mapnik::parameters params;
@@ -103,5 +152,9 @@ int main(int argc, char** argv)
     test2 test_runner2(params);
     run(test_runner2,"utf encode boost::locale");
     test3 test_runner3(params);
-    return run(test_runner3,"utf encode ICU");
+    run(test_runner3,"utf encode ICU");
+    test4 test_runner4(params);
+    run(test_runner4,"utf encode ICU ascii");
+    test5 test_runner5(params);
+    return run(test_runner5,"utf encode utf-8 value");
 }
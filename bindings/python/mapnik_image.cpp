@@ -113,24 +113,12 @@ bool painted(mapnik::image_32 const& im)
 
 bool is_solid(mapnik::image_32 const& im)
 {
-    if (im.width() > 0 && im.height() > 0)
-    {
-        mapnik::image_data_32 const & data = im.data();
-        mapnik::image_data_32::pixel_type const* first_row = data.getRow(0);
-        mapnik::image_data_32::pixel_type const first_pixel = first_row[0];
-        for (unsigned y = 0; y < im.height(); ++y)
-        {
-            mapnik::image_data_32::pixel_type const * row = data.getRow(y);
-            for (unsigned x = 0; x < im.width(); ++x)
-            {
-                if (first_pixel != row[x])
-                {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+    return mapnik::is_solid(im);
+}
+
+std::uint64_t content_hash(mapnik::image_32 const& im)
+{
+    return mapnik::image_hash(im);
 }
 
 unsigned get_pixel(mapnik::image_32 const& im, int x, int y)
@@ -266,6 +254,9 @@ void export_image()
         .def("view",&image_32::get_view)
         .def("painted",&painted)
         .def("is_solid",&is_solid)
+        .def("content_hash",&content_hash,
+             "Returns a 64 bit hash of the size and pixels of the Image,\n"
+             "for finding duplicate tiles without encoding them.\n")
         .add_property("background",make_function
                       (&image_32::get_background,return_value_policy<copy_const_reference>()),
                       &image_32::set_background, "The background color of the image.")
@@ -150,6 +150,12 @@ void export_map()
         .value("RESPECT", mapnik::Map::RESPECT)
         ;
 
+    // label collision detectors
+    mapnik::enumeration_<mapnik::collision_detector_e>("collision_detector")
+        .value("QUAD_TREE", mapnik::Map::QUAD_TREE_DETECTOR)
+        .value("GRID", mapnik::Map::GRID_DETECTOR)
+        ;
+
     class_<std::vector<layer> >("Layers")
         .def(vector_indexing_suite<std::vector<layer> >())
         ;
@@ -396,6 +402,25 @@ void export_map()
                       ">>> m.aspect_fix_mode = aspect_fix_mode.GROW_BBOX\n"
             )
 
+        .add_property("collision_detector",
+                      &Map::get_collision_detector,
+                      &Map::set_collision_detector,
+                      "Get/Set the index used for label collision detection.\n"
+                      "Usage:\n"
+                      "\n"
+                      ">>> m.collision_detector = collision_detector.GRID\n"
+            )
+
+        .add_property("deferred_labels",
+                      &Map::deferred_labels,
+                      &Map::set_deferred_labels,
+                      "Get/Set whether labels of all layers are collected and\n"
+                      "placed in a final pass by descending label-priority.\n"
+                      "Usage:\n"
+                      "\n"
+                      ">>> m.deferred_labels = True\n"
+            )
+
         .add_property("background",make_function
                       (&Map::background,return_value_policy<copy_const_reference>()),
                       &Map::set_background,
@@ -108,6 +108,7 @@ void export_logger();
 #include "mapnik_threads.hpp"
 #include "python_optional.hpp"
 #include <mapnik/marker_cache.hpp>
+#include <mapnik/raster_tile_cache.hpp>
 #if defined(SHAPE_MEMORY_MAPPED_FILE)
 #include <mapnik/mapped_memory_cache.hpp>
 #endif
@@ -125,6 +126,7 @@ namespace mapnik {
 void clear_cache()
 {
     mapnik::marker_cache::instance().clear();
+    mapnik::raster_tile_cache::instance().clear();
 #if defined(SHAPE_MEMORY_MAPPED_FILE)
     mapnik::mapped_memory_cache::instance().clear();
 #endif
@@ -645,7 +647,7 @@ BOOST_PYTHON_MODULE(_mapnik)
 
     def("clear_cache", &clear_cache,
         "\n"
-        "Clear all global caches of markers and mapped memory regions.\n"
+        "Clear all global caches of markers, decoded raster tiles and mapped memory regions.\n"
         "\n"
         "Usage:\n"
         ">>> from mapnik import clear_cache\n"
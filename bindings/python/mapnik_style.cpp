@@ -104,6 +104,11 @@ void export_style()
                       &feature_type_style::image_filters_inflate,
                       &feature_type_style::image_filters_inflate,
                       "Set/get the image_filters_inflate property of the style")
+        .add_property("filter_batch_size",
+                      &feature_type_style::filter_batch_size,
+                      &feature_type_style::set_filter_batch_size,
+                      "Set/get the number of features whose filters are evaluated\n"
+                      "together (0 disables batched evaluation)")
         .add_property("image_filters",
                       get_image_filters,
                       set_image_filters,
@@ -159,6 +159,8 @@ protected:
 private:
     buffer_type & pixmap_;
     std::shared_ptr<buffer_type> internal_buffer_;
+    // box of internal_buffer_ that may hold painted pixels
+    box2d<int> internal_buffer_dirty_;
     mutable buffer_type * current_buffer_;
     mutable bool style_level_compositing_;
     const std::unique_ptr<rasterizer> ras_ptr;
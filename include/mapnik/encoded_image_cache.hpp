@@ -0,0 +1,94 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_ENCODED_IMAGE_CACHE_HPP
+#define MAPNIK_ENCODED_IMAGE_CACHE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/utils.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/lru_cache.hpp>
+#include <mapnik/util/hash_combine.hpp>
+
+// stl
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace mapnik
+{
+
+using encoded_image_ptr = std::shared_ptr<std::string const>;
+
+// a single colored image of a given size, as encoded in one format
+struct encoded_image_key
+{
+    std::string format;
+    std::uint32_t color;
+    unsigned width;
+    unsigned height;
+
+    bool operator==(encoded_image_key const& rhs) const
+    {
+        return color == rhs.color && width == rhs.width &&
+            height == rhs.height && format == rhs.format;
+    }
+};
+
+struct encoded_image_key_hash
+{
+    std::size_t operator()(encoded_image_key const& key) const
+    {
+        std::size_t seed = std::hash<std::string>()(key.format);
+        util::hash_combine(seed, key.color);
+        util::hash_combine(seed, key.width);
+        util::hash_combine(seed, key.height);
+        return seed;
+    }
+};
+
+// Process wide LRU cache of the encodings of solid images, see save_to_stream.
+// Empty tiles and tiles of plain land or water come out of the renderer over
+// and over again and always encode to the same bytes.
+class MAPNIK_DECL encoded_image_cache :
+        public singleton<encoded_image_cache, CreateUsingNew>,
+        private mapnik::noncopyable
+{
+    friend class CreateUsingNew<encoded_image_cache>;
+public:
+    encoded_image_ptr find(encoded_image_key const& key);
+    void insert(encoded_image_key const& key, encoded_image_ptr data);
+    void clear();
+    // 0 disables the cache
+    void set_max_size(std::size_t max_size);
+    std::size_t max_size() const;
+    std::size_t size() const;
+private:
+    encoded_image_cache();
+    ~encoded_image_cache();
+    lru_cache<encoded_image_key, encoded_image_ptr, encoded_image_key_hash> cache_;
+};
+
+}
+
+#endif // MAPNIK_ENCODED_IMAGE_CACHE_HPP
@@ -28,10 +28,12 @@
 #include <mapnik/featureset.hpp>
 #include <mapnik/config.hpp>
 #include <mapnik/feature_style_processor_context.hpp>
+#include <mapnik/symbolizer_base.hpp>
 
 // stl
 #include <set>
 #include <string>
+#include <vector>
 
 namespace mapnik
 {
@@ -44,6 +46,15 @@ class feature_type_style;
 class rule_cache;
 struct layer_rendering_material;
 
+// label symbolizer queued for the final placement pass, see Map::deferred_labels()
+struct deferred_label
+{
+    feature_ptr feature;
+    symbolizer const* sym;
+    layer_rendering_material const* mat;
+    double priority;
+};
+
 enum eAttributeCollectionPolicy
 {
     DEFAULT = 0,
@@ -91,7 +102,7 @@ private:
                       feature_type_style const* style,
                       rule_cache const& rules,
                       featureset_ptr features,
-                      proj_transform const& prj_trans);
+                      layer_rendering_material const& mat);
 
     /*!
      * \brief prepare features for rendering asynchronously.
@@ -112,7 +123,13 @@ private:
      */
     void render_material(layer_rendering_material & mat, Processor & p );
 
+    /*!
+     * \brief place and render queued labels by descending priority.
+     */
+    void render_deferred_labels(Processor & p);
+
     Map const& m_;
+    std::vector<deferred_label> deferred_labels_;
 };
 }
 
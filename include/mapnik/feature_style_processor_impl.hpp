@@ -39,6 +39,7 @@
 #include <mapnik/rule_cache.hpp>
 #include <mapnik/attribute_collector.hpp>
 #include <mapnik/expression_evaluator.hpp>
+#include <mapnik/filter_batch.hpp>
 #include <mapnik/scale_denominator.hpp>
 #include <mapnik/projection.hpp>
 #include <mapnik/proj_transform.hpp>
@@ -48,6 +49,8 @@
 
 // stl
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <stdexcept>
 
 namespace mapnik
@@ -59,6 +62,7 @@ struct layer_rendering_material
     layer const& lay_;
     projection const& proj0_;
     projection proj1_;
+    proj_transform prj_trans_;
     box2d<double> layer_ext2_;
     std::vector<feature_type_style const*> active_styles_;
     std::vector<featureset_ptr> featureset_ptr_list_;
@@ -68,7 +72,50 @@ struct layer_rendering_material
         :
         lay_(lay),
         proj0_(dest),
-        proj1_(lay.srs(),true) {}
+        proj1_(lay.srs(),true),
+        prj_trans_(proj0_,proj1_) {}
+};
+
+// Evaluates label-priority of the symbolizers deferred to the final
+// placement pass; returns false for all others.
+struct deferred_label_priority : public util::static_visitor<bool>
+{
+    deferred_label_priority(feature_impl const& feature, attributes const& vars, double & priority)
+        : feature_(feature),
+          vars_(vars),
+          priority_(priority) {}
+
+    bool operator() (text_symbolizer const& sym) const
+    {
+        return evaluate(sym);
+    }
+
+    bool operator() (shield_symbolizer const& sym) const
+    {
+        return evaluate(sym);
+    }
+
+    bool operator() (point_symbolizer const& sym) const
+    {
+        return evaluate(sym);
+    }
+
+    template <typename T>
+    bool operator() (T const&) const
+    {
+        return false;
+    }
+
+private:
+    bool evaluate(symbolizer_base const& sym) const
+    {
+        priority_ = get<value_double>(sym, keys::label_priority, feature_, vars_, 0.0);
+        return true;
+    }
+
+    feature_impl const& feature_;
+    attributes const& vars_;
+    double & priority_;
 };
 
 using layer_rendering_material_ptr = std::shared_ptr<layer_rendering_material>;
@@ -142,6 +189,7 @@ void feature_style_processor<Processor>::apply(double scale_denom)
         }
     }
 
+    render_deferred_labels(p);
     p.end_map_processing(m_);
 }
 
@@ -206,6 +254,8 @@ void feature_style_processor<Processor>::apply_to_layer(layer const& lay,
     {
         render_material(mat,p);
     }
+    // mat owns the projections of queued labels
+    render_deferred_labels(p);
 }
 
 template <typename Processor>
@@ -241,7 +291,7 @@ void feature_style_processor<Processor>::prepare_layer(layer_rendering_material
     }
 
     processor_context_ptr current_ctx = ds->get_context(ctx_map);
-    proj_transform prj_trans(mat.proj0_,mat.proj1_);
+    proj_transform const& prj_trans = mat.prj_trans_;
 
     box2d<double> query_ext = extent; // unbuffered
     box2d<double> buffered_query_ext(query_ext);  // buffered
@@ -460,13 +510,17 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
         return;
     }
 
-    p.start_layer_processing(mat.lay_, mat.layer_ext2_);
-
     layer const& lay = mat.lay_;
 
-    std::vector<rule_cache> & rule_caches = mat.rule_caches_;
+    if (m_.deferred_labels() && lay.clear_label_cache())
+    {
+        // labels queued so far must not see this layer's labels or vice versa
+        render_deferred_labels(p);
+    }
 
-    proj_transform prj_trans(mat.proj0_,mat.proj1_);
+    p.start_layer_processing(lay, mat.layer_ext2_);
+
+    std::vector<rule_cache> & rule_caches = mat.rule_caches_;
 
     bool cache_features = lay.cache_features() && active_styles.size() > 1;
 
@@ -497,7 +551,7 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
                         render_style(p, style,
                                      rule_caches[i],
                                      cache,
-                                     prj_trans);
+                                     mat);
                         ++i;
                     }
                     cache->clear();
@@ -510,7 +564,7 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
             for (feature_type_style const* style : active_styles)
             {
                 cache->prepare();
-                render_style(p, style, rule_caches[i], cache, prj_trans);
+                render_style(p, style, rule_caches[i], cache, mat);
                 ++i;
             }
             cache->clear();
@@ -536,7 +590,7 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
             cache->prepare();
             render_style(p, style,
                          rule_caches[i],
-                         cache, prj_trans);
+                         cache, mat);
             ++i;
         }
     }
@@ -551,7 +605,7 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
             render_style(p, style,
                          rule_caches[i],
                          features,
-                         prj_trans);
+                         mat);
             ++i;
         }
     }
@@ -564,7 +618,7 @@ void feature_style_processor<Processor>::render_style(
     feature_type_style const* style,
     rule_cache const& rc,
     featureset_ptr features,
-    proj_transform const& prj_trans)
+    layer_rendering_material const& mat)
 {
     p.start_style_processing(*style);
     if (!features)
@@ -572,71 +626,161 @@ void feature_style_processor<Processor>::render_style(
         p.end_style_processing(*style);
         return;
     }
+    proj_transform const& prj_trans = mat.prj_trans_;
+    bool deferred = m_.deferred_labels();
     mapnik::attributes vars = p.variables();
     feature_ptr feature;
     bool was_painted = false;
-    while ((feature = features->next()))
+    auto process_rule = [&](rule const* r, feature_ptr const& f)
     {
-        bool do_else = true;
-        bool do_also = false;
-        for (rule const* r : rc.get_if_rules() )
+        was_painted = true;
+        rule::symbolizers const& symbols = r->get_symbolizers();
+        if(!p.process(symbols,*f,prj_trans))
         {
-            expression_ptr const& expr = r->get_filter();
-            value_type result = util::apply_visitor(evaluate<feature_impl,value_type,attributes>(*feature,vars),*expr);
-            if (result.to_bool())
+            for (symbolizer const& sym : symbols)
             {
-                was_painted = true;
-                do_else=false;
-                do_also=true;
-                rule::symbolizers const& symbols = r->get_symbolizers();
-                if(!p.process(symbols,*feature,prj_trans))
+                double priority = 0.0;
+                if (deferred && util::apply_visitor(deferred_label_priority(*f,vars,priority),sym))
                 {
-                    for (symbolizer const& sym : symbols)
-                    {
-                        util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
-                    }
-                }
-                if (style->get_filter_mode() == FILTER_FIRST)
-                {
-                    // Stop iterating over rules and proceed with next feature.
-                    do_also=false;
-                    break;
+                    deferred_labels_.push_back(deferred_label{f, &sym, &mat, priority});
+                    continue;
                 }
+                util::apply_visitor(symbolizer_dispatch<Processor>(p,*f,prj_trans),sym);
             }
         }
+    };
+    auto process_else_also = [&](feature_ptr const& f, bool do_else, bool do_also)
+    {
         if (do_else)
         {
             for( rule const* r : rc.get_else_rules() )
             {
-                was_painted = true;
-                rule::symbolizers const& symbols = r->get_symbolizers();
-                if(!p.process(symbols,*feature,prj_trans))
-                {
-                    for (symbolizer const& sym : symbols)
-                    {
-                        util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
-                    }
-                }
+                process_rule(r, f);
             }
         }
         if (do_also)
         {
             for( rule const* r : rc.get_also_rules() )
             {
-                was_painted = true;
-                rule::symbolizers const& symbols = r->get_symbolizers();
-                if(!p.process(symbols,*feature,prj_trans))
+                process_rule(r, f);
+            }
+        }
+    };
+    unsigned batch_size = style->filter_batch_size();
+    if (batch_size > 0)
+    {
+        // pull features in chunks and evaluate each rule filter across the whole
+        // chunk, then symbolize in the original feature order
+        filter_batch batch(vars);
+        std::vector<filter_batch::selection> selections(rc.get_if_rules().size());
+        std::vector<feature_ptr> & chunk = batch.features();
+        chunk.reserve(batch_size);
+        bool done = false;
+        while (!done)
+        {
+            chunk.clear();
+            while (chunk.size() < batch_size)
+            {
+                if (!(feature = features->next()))
                 {
-                    for (symbolizer const& sym : symbols)
+                    done = true;
+                    break;
+                }
+                chunk.push_back(feature);
+            }
+            if (chunk.empty()) break;
+            batch.reset();
+            std::size_t index = 0;
+            for (rule const* r : rc.get_if_rules())
+            {
+                batch.evaluate(r->get_filter(), selections[index++]);
+            }
+            for (std::size_t row = 0; row < chunk.size(); ++row)
+            {
+                feature_ptr const& f = chunk[row];
+                bool do_else = true;
+                bool do_also = false;
+                index = 0;
+                for (rule const* r : rc.get_if_rules())
+                {
+                    if (selections[index++][row])
                     {
-                        util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        do_else=false;
+                        do_also=true;
+                        process_rule(r, f);
+                        if (style->get_filter_mode() == FILTER_FIRST)
+                        {
+                            // Stop iterating over rules and proceed with next feature.
+                            do_also=false;
+                            break;
+                        }
                     }
                 }
+                process_else_also(f, do_else, do_also);
+            }
+        }
+        p.painted(p.painted() | was_painted);
+        p.end_style_processing(*style);
+        return;
+    }
+    while ((feature = features->next()))
+    {
+        bool do_else = true;
+        bool do_also = false;
+        for (rule const* r : rc.get_if_rules() )
+        {
+            expression_ptr const& expr = r->get_filter();
+            value_type result = util::apply_visitor(evaluate<feature_impl,value_type,attributes>(*feature,vars),*expr);
+            if (result.to_bool())
+            {
+                do_else=false;
+                do_also=true;
+                process_rule(r, feature);
+                if (style->get_filter_mode() == FILTER_FIRST)
+                {
+                    // Stop iterating over rules and proceed with next feature.
+                    do_also=false;
+                    break;
+                }
             }
         }
+        process_else_also(feature, do_else, do_also);
     }
     p.painted(p.painted() | was_painted);
     p.end_style_processing(*style);
 }
 
+template <typename Processor>
+void feature_style_processor<Processor>::render_deferred_labels(Processor & p)
+{
+    if (deferred_labels_.empty()) return;
+    // stable: equal priorities keep layer and feature order
+    std::stable_sort(deferred_labels_.begin(), deferred_labels_.end(),
+                     [](deferred_label const& a, deferred_label const& b) { return a.priority > b.priority; });
+    // layers are entered again only to restore their query extent, the
+    // collision detector has to keep everything placed in this pass
+    std::map<layer_rendering_material const*, layer> layers;
+    layer_rendering_material const* current = nullptr;
+    layer const* current_lay = nullptr;
+    for (deferred_label const& label : deferred_labels_)
+    {
+        if (label.mat != current)
+        {
+            if (current_lay) p.end_layer_processing(*current_lay);
+            auto itr = layers.find(label.mat);
+            if (itr == layers.end())
+            {
+                itr = layers.emplace(label.mat, label.mat->lay_).first;
+                itr->second.set_clear_label_cache(false);
+            }
+            current = label.mat;
+            current_lay = &itr->second;
+            p.start_layer_processing(*current_lay, current->layer_ext2_);
+        }
+        util::apply_visitor(symbolizer_dispatch<Processor>(p,*label.feature,current->prj_trans_),*label.sym);
+    }
+    if (current_lay) p.end_layer_processing(*current_lay);
+    deferred_labels_.clear();
+}
+
 }
@@ -63,6 +63,8 @@ private:
     boost::optional<composite_mode_e> comp_op_;
     float opacity_;
     bool image_filters_inflate_;
+    // number of features whose filters are evaluated together, 0 disables batching
+    unsigned filter_batch_size_;
     friend void swap(feature_type_style& lhs, feature_type_style & rhs);
 public:
     // ctor
@@ -95,6 +97,9 @@ public:
     float get_opacity() const;
     void set_image_filters_inflate(bool inflate);
     bool image_filters_inflate() const;
+    // batched filter evaluation
+    void set_filter_batch_size(unsigned size);
+    unsigned filter_batch_size() const;
     inline void reserve(std::size_t size)
     {
         rules_.reserve(size);
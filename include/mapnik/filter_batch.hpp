@@ -0,0 +1,332 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_FILTER_BATCH_HPP
+#define MAPNIK_FILTER_BATCH_HPP
+
+// mapnik
+#include <mapnik/feature.hpp>
+#include <mapnik/expression.hpp>
+#include <mapnik/expression_node.hpp>
+#include <mapnik/expression_evaluator.hpp>
+#include <mapnik/attribute.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/util/variant.hpp>
+
+// stl
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mapnik {
+
+namespace detail {
+
+enum class batch_compare : std::uint8_t
+{
+    none,
+    less,
+    less_equal,
+    greater,
+    greater_equal,
+    equal_to,
+    not_equal_to
+};
+
+// filter of the form [attr] <op> number, normalised so the attribute is on the left
+struct batch_comparison
+{
+    batch_compare op = batch_compare::none;
+    std::string name;
+    value_double rhs = 0.0;
+};
+
+// integers beyond this magnitude do not survive the round trip through double
+constexpr long long max_exact_integer = 9007199254740992LL;
+
+inline bool exact_double(value_integer val, value_double & out)
+{
+    // checked before converting: 2^53 + 1 would round into range
+    out = static_cast<value_double>(val);
+    return val <= max_exact_integer && val >= -max_exact_integer;
+}
+
+struct extract_number : util::static_visitor<bool>
+{
+    explicit extract_number(value_double & out)
+        : out_(out) {}
+
+    bool operator() (value_integer val) const
+    {
+        return exact_double(val, out_);
+    }
+
+    bool operator() (value_double val) const
+    {
+        out_ = val;
+        return true;
+    }
+
+    template <typename T>
+    bool operator() (T const&) const
+    {
+        return false;
+    }
+
+    value_double & out_;
+};
+
+inline batch_compare mirror(batch_compare op)
+{
+    switch (op)
+    {
+    case batch_compare::less: return batch_compare::greater;
+    case batch_compare::less_equal: return batch_compare::greater_equal;
+    case batch_compare::greater: return batch_compare::less;
+    case batch_compare::greater_equal: return batch_compare::less_equal;
+    default: return op;
+    }
+}
+
+struct extract_comparison : util::static_visitor<batch_comparison>
+{
+    batch_comparison operator() (binary_node<tags::less> const& x) const
+    {
+        return extract(batch_compare::less, x.left, x.right);
+    }
+
+    batch_comparison operator() (binary_node<tags::less_equal> const& x) const
+    {
+        return extract(batch_compare::less_equal, x.left, x.right);
+    }
+
+    batch_comparison operator() (binary_node<tags::greater> const& x) const
+    {
+        return extract(batch_compare::greater, x.left, x.right);
+    }
+
+    batch_comparison operator() (binary_node<tags::greater_equal> const& x) const
+    {
+        return extract(batch_compare::greater_equal, x.left, x.right);
+    }
+
+    batch_comparison operator() (binary_node<tags::equal_to> const& x) const
+    {
+        return extract(batch_compare::equal_to, x.left, x.right);
+    }
+
+    batch_comparison operator() (binary_node<tags::not_equal_to> const& x) const
+    {
+        return extract(batch_compare::not_equal_to, x.left, x.right);
+    }
+
+    template <typename T>
+    batch_comparison operator() (T const&) const
+    {
+        return batch_comparison();
+    }
+
+private:
+    static batch_comparison extract(batch_compare op, expr_node const& left, expr_node const& right)
+    {
+        batch_comparison result;
+        if (left.is<attribute>() && util::apply_visitor(extract_number(result.rhs), right))
+        {
+            result.op = op;
+            result.name = left.get<attribute>().name();
+        }
+        else if (right.is<attribute>() && util::apply_visitor(extract_number(result.rhs), left))
+        {
+            result.op = mirror(op);
+            result.name = right.get<attribute>().name();
+        }
+        return result;
+    }
+};
+
+// numeric view of one attribute across the current chunk
+struct batch_column
+{
+    std::vector<value_double> values;
+    // 1 when values[i] holds the attribute exactly, 0 when it must be evaluated generically
+    std::vector<std::uint8_t> numeric;
+};
+
+struct column_fill : util::static_visitor<bool>
+{
+    explicit column_fill(value_double & out)
+        : out_(out) {}
+
+    bool operator() (value_integer val) const
+    {
+        return exact_double(val, out_);
+    }
+
+    bool operator() (value_double val) const
+    {
+        out_ = val;
+        return true;
+    }
+
+    template <typename T>
+    bool operator() (T const&) const
+    {
+        out_ = 0.0;
+        return false;
+    }
+
+    value_double & out_;
+};
+
+template <typename Op>
+inline void compare_column(std::vector<value_double> const& values, value_double rhs,
+                           std::uint8_t * out, Op op)
+{
+    // branch free so the compiler can vectorize it
+    std::size_t size = values.size();
+    value_double const* data = values.data();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        out[i] = static_cast<std::uint8_t>(op(data[i], rhs));
+    }
+}
+
+} // namespace detail
+
+// Evaluates rule filters over a chunk of features at a time.
+// Filters comparing an attribute against a number run over a columnar
+// copy of that attribute; all other filters, and features whose attribute
+// is not numeric, fall back to the regular expression evaluator.
+class filter_batch : private mapnik::noncopyable
+{
+public:
+    using selection = std::vector<std::uint8_t>;
+
+    explicit filter_batch(attributes const& vars)
+        : vars_(vars),
+          features_(),
+          columns_(),
+          comparisons_() {}
+
+    std::vector<feature_ptr> & features()
+    {
+        return features_;
+    }
+
+    // call after refilling features(), invalidates cached columns
+    void reset()
+    {
+        for (auto & kv : columns_)
+        {
+            kv.second.values.clear();
+            kv.second.numeric.clear();
+        }
+    }
+
+    void evaluate(expression_ptr const& expr, selection & out)
+    {
+        std::size_t size = features_.size();
+        out.resize(size);
+        detail::batch_comparison const& cmp = comparison(expr);
+        if (cmp.op == detail::batch_compare::none)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                out[i] = evaluate_one(*expr, *features_[i]);
+            }
+            return;
+        }
+        detail::batch_column const& col = column(cmp.name);
+        std::uint8_t * dst = out.data();
+        switch (cmp.op)
+        {
+        case detail::batch_compare::less:
+            detail::compare_column(col.values, cmp.rhs, dst, std::less<value_double>());
+            break;
+        case detail::batch_compare::less_equal:
+            detail::compare_column(col.values, cmp.rhs, dst, std::less_equal<value_double>());
+            break;
+        case detail::batch_compare::greater:
+            detail::compare_column(col.values, cmp.rhs, dst, std::greater<value_double>());
+            break;
+        case detail::batch_compare::greater_equal:
+            detail::compare_column(col.values, cmp.rhs, dst, std::greater_equal<value_double>());
+            break;
+        case detail::batch_compare::equal_to:
+            detail::compare_column(col.values, cmp.rhs, dst, std::equal_to<value_double>());
+            break;
+        case detail::batch_compare::not_equal_to:
+            detail::compare_column(col.values, cmp.rhs, dst, std::not_equal_to<value_double>());
+            break;
+        default:
+            break;
+        }
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (!col.numeric[i]) out[i] = evaluate_one(*expr, *features_[i]);
+        }
+    }
+
+private:
+    std::uint8_t evaluate_one(expr_node const& expr, feature_impl const& feature) const
+    {
+        value_type result = util::apply_visitor(mapnik::evaluate<feature_impl,value_type,attributes>(feature,vars_),expr);
+        return static_cast<std::uint8_t>(result.to_bool());
+    }
+
+    detail::batch_comparison const& comparison(expression_ptr const& expr)
+    {
+        auto itr = comparisons_.find(expr.get());
+        if (itr == comparisons_.end())
+        {
+            itr = comparisons_.emplace(expr.get(), util::apply_visitor(detail::extract_comparison(), *expr)).first;
+        }
+        return itr->second;
+    }
+
+    detail::batch_column const& column(std::string const& name)
+    {
+        detail::batch_column & col = columns_[name];
+        std::size_t size = features_.size();
+        if (col.values.size() != size)
+        {
+            col.values.resize(size);
+            col.numeric.resize(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                feature_impl const& f = *features_[i];
+                col.numeric[i] = util::apply_visitor(detail::column_fill(col.values[i]), f.get(name));
+            }
+        }
+        return col;
+    }
+
+    attributes const& vars_;
+    std::vector<feature_ptr> features_;
+    std::unordered_map<std::string, detail::batch_column> columns_;
+    std::unordered_map<expr_node const*, detail::batch_comparison> comparisons_;
+};
+
+}
+
+#endif // MAPNIK_FILTER_BATCH_HPP
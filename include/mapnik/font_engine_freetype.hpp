@@ -28,10 +28,14 @@
 #include <mapnik/font_set.hpp>
 #include <mapnik/text/font_library.hpp>
 #include <mapnik/noncopyable.hpp>
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+#include <mapnik/mapped_memory_cache.hpp>
+#endif
 
 // stl
 #include <memory>
 #include <map>
+#include <thread>
 #include <utility> // pair
 #include <vector>
 
@@ -81,6 +85,14 @@ public:
                          freetype_engine::font_memory_cache_type const& font_cache,
                          font_file_mapping_type const& global_font_file_mapping,
                          freetype_engine::font_memory_cache_type & global_memory_fonts);
+    /*! \brief create a face owned by the calling thread
+     *  Faces are created once per thread from font data shared by all threads
+     *  and kept for the lifetime of the thread, so lookups need no locking.
+     *  @return face_ptr - null if the face is not registered or can not be loaded.
+     */
+    static face_ptr create_thread_face(std::string const& face_name,
+                                       font_file_mapping_type const& font_file_mapping,
+                                       font_file_mapping_type const& global_font_file_mapping);
     static bool register_font_impl(std::string const& file_name,
                                    font_library & libary,
                                    font_file_mapping_type & font_file_mapping);
@@ -93,16 +105,23 @@ public:
 private:
     static bool register_font_impl(std::string const& file_name, FT_LibraryRec_ * library);
     static bool register_fonts_impl(std::string const& dir, FT_LibraryRec_ * library, bool recurse = false);
+    static bool global_font_data(std::string const& file_name, char const*& data, std::size_t & size);
 #ifdef MAPNIK_THREADSAFE
     static std::mutex mutex_;
 #endif
     static font_file_mapping_type global_font_file_mapping_;
     static font_memory_cache_type global_memory_fonts_;
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+    static std::map<std::string, mapped_region_ptr> global_mapped_fonts_;
+#endif
 };
 
 class MAPNIK_DECL face_manager : private mapnik::noncopyable
 {
-    using face_ptr_cache_type = std::map<std::string, face_ptr>;
+    // faces of globally registered fonts belong to the thread that created
+    // them and are tagged with it; faces of the map's own font memory belong
+    // to the renderer and carry a default id
+    using face_ptr_cache_type = std::map<std::string, std::pair<face_ptr, std::thread::id> >;
 
 public:
     face_manager(font_library & library,
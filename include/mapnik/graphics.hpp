@@ -33,6 +33,7 @@
 
 // stl
 #include <string>
+#include <algorithm>
 #include <cstring> // memset
 #include <memory>
 
@@ -84,6 +85,20 @@ public:
         std::memset(data_.getData(),0,sizeof(mapnik::image_data_32::pixel_type)*data_.width()*data_.height());
     }
 
+    // clears the pixels inside box, whose maximum is exclusive
+    inline void clear(box2d<int> const& box)
+    {
+        int x0 = std::max(box.minx(), 0);
+        int y0 = std::max(box.miny(), 0);
+        int x1 = std::min(box.maxx(), static_cast<int>(width_));
+        int y1 = std::min(box.maxy(), static_cast<int>(height_));
+        if (x1 <= x0) return;
+        for (int y = y0; y < y1; ++y)
+        {
+            std::memset(data_.getRow(y) + x0,0,sizeof(mapnik::image_data_32::pixel_type)*(x1 - x0));
+        }
+    }
+
     boost::optional<color> const& get_background() const;
 
     void set_background(const color& c);
@@ -92,6 +107,10 @@ public:
 
     void demultiply();
 
+    // Smallest box, maximum exclusive, holding every pixel that is not all
+    // zero. Invalid when the whole image is.
+    box2d<int> bounding_box() const;
+
     void set_grayscale_to_alpha();
 
     void set_color_to_alpha(color const& c);
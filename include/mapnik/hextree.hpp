@@ -197,7 +197,8 @@ public:
         }
     }
 
-    void insert(T const& data)
+    // insert count pixels of the same color at once
+    void insert(T const& data, unsigned count = 1)
     {
         byte a = preprocessAlpha(data.a);
         unsigned level = 0;
@@ -207,17 +208,21 @@ public:
             has_holes_ = true;
             return;
         }
+        double reds   = gammaLUT_[data.r] * count;
+        double greens = gammaLUT_[data.g] * count;
+        double blues  = gammaLUT_[data.b] * count;
+        double alphas = double(a) * count;
         while (true)
         {
-            cur_node->pixel_count++;
-            cur_node->reds   += gammaLUT_[data.r];
-            cur_node->greens += gammaLUT_[data.g];
-            cur_node->blues  += gammaLUT_[data.b];
-            cur_node->alphas += a;
+            cur_node->pixel_count += count;
+            cur_node->reds   += reds;
+            cur_node->greens += greens;
+            cur_node->blues  += blues;
+            cur_node->alphas += alphas;
 
             if (level == InsertPolicy::MAX_LEVELS)
             {
-                if (cur_node->pixel_count == 1)
+                if (cur_node->pixel_count == count)
                 {
                     ++colors_;
                 }
@@ -25,6 +25,7 @@
 
 #include <mapnik/config.hpp>
 #include <mapnik/image_data.hpp>
+#include <mapnik/box2d.hpp>
 
 // boost
 #include <boost/optional.hpp>
@@ -98,5 +99,27 @@ extern template MAPNIK_DECL void composite<mapnik::image_data_32,mapnik::image_d
                            int dy,
                            bool premultiply_src);
 
+// Composites only src_box of src, maximum exclusive, onto the same place
+// composite() without a box would put it. src must be premultiplied.
+template <typename T1, typename T2>
+MAPNIK_DECL void composite(T1 & dst, T2 & src,
+                           box2d<int> const& src_box,
+                           composite_mode_e mode,
+                           float opacity=1,
+                           int dx=0,
+                           int dy=0);
+
+extern template MAPNIK_DECL void composite<mapnik::image_data_32,mapnik::image_data_32>(mapnik::image_data_32 & dst,
+                           mapnik::image_data_32 & src,
+                           box2d<int> const& src_box,
+                           composite_mode_e mode,
+                           float opacity,
+                           int dx,
+                           int dy);
+
+// True when compositing a fully transparent source pixel leaves the
+// destination pixel unchanged, so transparent areas can be skipped.
+MAPNIK_DECL bool composite_transparent_noop(composite_mode_e mode);
+
 }
 #endif // MAPNIK_IMAGE_COMPOSITING_HPP
@@ -25,6 +25,8 @@
 #define MAPNIK_IMAGE_FILTER_HPP
 
 //mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/box2d.hpp>
 #include <mapnik/image_filter_types.hpp>
 #include <mapnik/util/hsl.hpp>
 
@@ -41,6 +43,9 @@
 #include "agg_gradient_lut.h"
 // stl
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 
 // 8-bit YUV
 //Y = ( (  66 * R + 129 * G +  25 * B + 128) >> 8) +  16
@@ -117,13 +122,62 @@
 //convolve_rows_fixed<rgba32f_pixel_t>(src_view,kernel,src_view);
 // convolve_cols_fixed<rgba32f_pixel_t>(src_view,kernel,dst_view);
 
-namespace mapnik {  namespace filter { namespace detail {
+namespace mapnik {  namespace filter {
+
+// Images with at least this many pixels (512x512 by default) are filtered in
+// bands of rows (or columns) on the shared mapnik::thread_pool, the calling
+// thread included; 0 keeps every filter on the calling thread. Servers that
+// already render one map per core may want to turn this off.
+MAPNIK_DECL void set_parallel_threshold(std::size_t pixels);
+MAPNIK_DECL std::size_t parallel_threshold();
+
+namespace detail {
 
 static const float blur_matrix[] = {0.1111f,0.1111f,0.1111f,0.1111f,0.1111f,0.1111f,0.1111f,0.1111f,0.1111f};
 static const float emboss_matrix[] = {-2,-1,0,-1,1,1,0,1,2};
 static const float sharpen_matrix[] = {0,-1,0,-1,5,-1,0,-1,0 };
 static const float edge_detect_matrix[] = {0,1,0,1,-4,1,0,1,0 };
 
+// Calls func(begin, end) on consecutive slices of [0, size), in parallel on
+// the shared thread_pool when the image is at least parallel_threshold()
+// pixels large.
+MAPNIK_DECL void parallel_for(unsigned size, std::size_t pixels, std::function<void(unsigned, unsigned)> const& func);
+
+// Vectorized kernels (src/image_filter.cpp) on rgba8 images without padding,
+// giving the same result as the agg and gil based code they replace.
+MAPNIK_DECL void stack_blur(std::uint8_t * data, unsigned width, unsigned height, unsigned rx, unsigned ry);
+MAPNIK_DECL void convolve_3x3(std::uint8_t * data, unsigned width, unsigned height, float const* matrix);
+MAPNIK_DECL void sobel_3x3(std::uint8_t * data, unsigned width, unsigned height);
+// replaces every pixel with non zero alpha by lut[alpha]
+MAPNIK_DECL void map_alpha(std::uint8_t * data, unsigned width, unsigned height, std::uint32_t const* lut);
+MAPNIK_DECL void to_gray(std::uint8_t * data, unsigned width, unsigned height);
+MAPNIK_DECL void invert_colors(std::uint8_t * data, unsigned width, unsigned height);
+
+inline void apply_3x3(std::uint8_t * data, unsigned width, unsigned height, mapnik::filter::blur)
+{
+    convolve_3x3(data, width, height, blur_matrix);
+}
+
+inline void apply_3x3(std::uint8_t * data, unsigned width, unsigned height, mapnik::filter::emboss)
+{
+    convolve_3x3(data, width, height, emboss_matrix);
+}
+
+inline void apply_3x3(std::uint8_t * data, unsigned width, unsigned height, mapnik::filter::sharpen)
+{
+    convolve_3x3(data, width, height, sharpen_matrix);
+}
+
+inline void apply_3x3(std::uint8_t * data, unsigned width, unsigned height, mapnik::filter::edge_detect)
+{
+    convolve_3x3(data, width, height, edge_detect_matrix);
+}
+
+inline void apply_3x3(std::uint8_t * data, unsigned width, unsigned height, mapnik::filter::sobel)
+{
+    sobel_3x3(data, width, height);
+}
+
 }
 
 using boost::gil::rgba8_image_t;
@@ -220,186 +274,18 @@ void process_channel (Src const& src, Dst & dst, mapnik::filter::sobel)
     dst = out_value;
 }
 
-
-
-template <typename Src, typename Dst, typename Filter>
-void apply_convolution_3x3(Src const& src_view, Dst & dst_view, Filter const& filter)
-{
-    using boost::gil::bits32f;
-    using boost::gil::point2;
-
-    // p0 p1 p2
-    // p3 p4 p5
-    // p6 p7 p8
-
-    typename Src::xy_locator src_loc = src_view.xy_at(0,0);
-    typename Src::xy_locator::cached_location_t loc00 = src_loc.cache_location(-1,-1);
-    typename Src::xy_locator::cached_location_t loc10 = src_loc.cache_location( 0,-1);
-    typename Src::xy_locator::cached_location_t loc20 = src_loc.cache_location( 1,-1);
-    typename Src::xy_locator::cached_location_t loc01 = src_loc.cache_location(-1, 0);
-    typename Src::xy_locator::cached_location_t loc11 = src_loc.cache_location( 0, 0);
-    typename Src::xy_locator::cached_location_t loc21 = src_loc.cache_location( 1, 0);
-    typename Src::xy_locator::cached_location_t loc02 = src_loc.cache_location(-1, 1);
-    typename Src::xy_locator::cached_location_t loc12 = src_loc.cache_location( 0, 1);
-    typename Src::xy_locator::cached_location_t loc22 = src_loc.cache_location( 1, 1);
-
-    typename Src::x_iterator dst_it = dst_view.row_begin(0);
-
-    // top row
-    for (int x = 0 ; x < src_view.width(); ++x)
-    {
-        (*dst_it)[3] = src_loc[loc11][3]; // Dst.a = Src.a
-        for (int i = 0; i < 3; ++i)
-        {
-            bits32f p[9];
-
-            p[4] = src_loc[loc11][i];
-            p[7] = src_loc[loc12][i];
-
-            if (x == 0)
-            {
-                p[3] = p[4];
-                p[6] = p[7];
-            }
-            else
-            {
-                p[3] = src_loc[loc01][i];
-                p[6] = src_loc[loc02][i];
-            }
-
-            if ( x == src_view.width()-1)
-            {
-                p[5] = p[4];
-                p[8] = p[7];
-            }
-            else
-            {
-                p[5] = src_loc[loc21][i];
-                p[8] = src_loc[loc22][i];
-            }
-
-            p[0] = p[6];
-            p[1] = p[7];
-            p[2] = p[8];
-
-            process_channel(p, (*dst_it)[i], filter);
-        }
-        ++src_loc.x();
-        ++dst_it;
-    }
-    // carrige-return
-    src_loc += point2<std::ptrdiff_t>(-src_view.width(),1);
-
-    // 1... height-1 rows
-    for (int y = 1; y<src_view.height()-1; ++y)
-    {
-        for (int x = 0; x < src_view.width(); ++x)
-        {
-            (*dst_it)[3] = src_loc[loc11][3]; // Dst.a = Src.a
-            for (int i = 0; i < 3; ++i)
-            {
-                bits32f p[9];
-
-                p[1] = src_loc[loc10][i];
-                p[4] = src_loc[loc11][i];
-                p[7] = src_loc[loc12][i];
-
-                if (x == 0)
-                {
-                    p[0] = p[1];
-                    p[3] = p[4];
-                    p[6] = p[7];
-                }
-                else
-                {
-                    p[0] = src_loc[loc00][i];
-                    p[3] = src_loc[loc01][i];
-                    p[6] = src_loc[loc02][i];
-                }
-
-                if ( x == src_view.width() - 1)
-                {
-                    p[2] = p[1];
-                    p[5] = p[4];
-                    p[8] = p[7];
-                }
-                else
-                {
-                    p[2] = src_loc[loc20][i];
-                    p[5] = src_loc[loc21][i];
-                    p[8] = src_loc[loc22][i];
-                }
-                process_channel(p, (*dst_it)[i], filter);
-            }
-            ++dst_it;
-            ++src_loc.x();
-        }
-        // carrige-return
-        src_loc += point2<std::ptrdiff_t>(-src_view.width(),1);
-    }
-
-    // bottom row
-    //src_loc = src_view.xy_at(0,src_view.height()-1);
-    for (int x = 0 ; x < src_view.width(); ++x)
-    {
-        (*dst_it)[3] = src_loc[loc11][3]; // Dst.a = Src.a
-        for (int i = 0; i < 3; ++i)
-        {
-            bits32f p[9];
-
-            p[1] = src_loc[loc10][i];
-            p[4] = src_loc[loc11][i];
-
-            if (x == 0)
-            {
-                p[0] = p[1];
-                p[3] = p[4];
-            }
-            else
-            {
-                p[0] = src_loc[loc00][i];
-                p[3] = src_loc[loc01][i];
-            }
-
-            if ( x == src_view.width()-1)
-            {
-                p[2] = p[1];
-                p[5] = p[4];
-
-            }
-            else
-            {
-                p[2] = src_loc[loc20][i];
-                p[5] = src_loc[loc21][i];
-            }
-
-            p[6] = p[0];
-            p[7] = p[1];
-            p[8] = p[2];
-            process_channel(p, (*dst_it)[i], filter);
-        }
-        ++src_loc.x();
-        ++dst_it;
-    }
-}
-
 template <typename Src, typename Filter>
 void apply_filter(Src & src, Filter const& filter)
 {
-    {
-        src.demultiply();
-        double_buffer<Src> tb(src);
-        apply_convolution_3x3(tb.src_view, tb.dst_view, filter);
-    } // ensure ~double_buffer() is called before premultiplying
+    src.demultiply();
+    detail::apply_3x3(src.raw_data(), src.width(), src.height(), filter);
     src.premultiply();
 }
 
 template <typename Src>
 void apply_filter(Src & src, agg_stack_blur const& op)
 {
-    agg::rendering_buffer buf(src.raw_data(),src.width(),src.height(), src.width() * 4);
-    agg::pixfmt_rgba32_pre pixf(buf);
-    agg::stack_blur_rgba32(pixf,op.rx,op.ry);
+    detail::stack_blur(src.raw_data(), src.width(), src.height(), op.rx, op.ry);
 }
 
 inline double channel_delta(double source, double match)
@@ -423,84 +309,80 @@ void apply_filter(Src & src, color_to_alpha const& op)
     double cr = static_cast<double>(op.color.red())/255.0;
     double cg = static_cast<double>(op.color.green())/255.0;
     double cb = static_cast<double>(op.color.blue())/255.0;
-    for (int y=0; y<src_view.height(); ++y)
+    detail::parallel_for(src.height(), src.width() * src.height(), [&](unsigned y0, unsigned y1)
     {
-        rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
-        for (int x=0; x<src_view.width(); ++x)
+        for (int y=y0; y<static_cast<int>(y1); ++y)
         {
-            uint8_t & r = get_color(src_it[x], red_t());
-            uint8_t & g = get_color(src_it[x], green_t());
-            uint8_t & b = get_color(src_it[x], blue_t());
-            uint8_t & a = get_color(src_it[x], alpha_t());
-            double sr = static_cast<double>(r)/255.0;
-            double sg = static_cast<double>(g)/255.0;
-            double sb = static_cast<double>(b)/255.0;
-            double sa = static_cast<double>(a)/255.0;
-            // demultiply
-            if (sa <= 0.0)
-            {
-                r = g = b = 0;
-                continue;
-            }
-            else
-            {
-                sr /= sa;
-                sg /= sa;
-                sb /= sa;
-            }
-            // get that maximum color difference
-            double xa = std::max(channel_delta(sr,cr),std::max(channel_delta(sg,cg),channel_delta(sb,cb)));
-            if (xa > 0)
-            {
-                // apply difference to each channel, returning premultiplied
-                // TODO - experiment with difference in hsl color space
-                r = apply_alpha_shift(sr,cr,xa);
-                g = apply_alpha_shift(sg,cg,xa);
-                b = apply_alpha_shift(sb,cb,xa);
-                // combine new alpha with original
-                xa *= sa;
-                a = static_cast<uint8_t>(std::floor((xa*255.0)+.5));
-                // all color values must be <= alpha
-                if (r>a) r=a;
-                if (g>a) g=a;
-                if (b>a) b=a;
-            }
-            else
+            rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
+            for (int x=0; x<src_view.width(); ++x)
             {
-                r = g = b = a = 0;
+                uint8_t & r = get_color(src_it[x], red_t());
+                uint8_t & g = get_color(src_it[x], green_t());
+                uint8_t & b = get_color(src_it[x], blue_t());
+                uint8_t & a = get_color(src_it[x], alpha_t());
+                double sr = static_cast<double>(r)/255.0;
+                double sg = static_cast<double>(g)/255.0;
+                double sb = static_cast<double>(b)/255.0;
+                double sa = static_cast<double>(a)/255.0;
+                // demultiply
+                if (sa <= 0.0)
+                {
+                    r = g = b = 0;
+                    continue;
+                }
+                else
+                {
+                    sr /= sa;
+                    sg /= sa;
+                    sb /= sa;
+                }
+                // get that maximum color difference
+                double xa = std::max(channel_delta(sr,cr),std::max(channel_delta(sg,cg),channel_delta(sb,cb)));
+                if (xa > 0)
+                {
+                    // apply difference to each channel, returning premultiplied
+                    // TODO - experiment with difference in hsl color space
+                    r = apply_alpha_shift(sr,cr,xa);
+                    g = apply_alpha_shift(sg,cg,xa);
+                    b = apply_alpha_shift(sb,cb,xa);
+                    // combine new alpha with original
+                    xa *= sa;
+                    a = static_cast<uint8_t>(std::floor((xa*255.0)+.5));
+                    // all color values must be <= alpha
+                    if (r>a) r=a;
+                    if (g>a) g=a;
+                    if (b>a) b=a;
+                }
+                else
+                {
+                    r = g = b = a = 0;
+                }
             }
         }
-    }
+    });
 }
 
 template <typename Src>
 void apply_filter(Src & src, colorize_alpha const& op)
 {
-    using namespace boost::gil;
     std::size_t size = op.size();
+    // the result only depends on alpha: fill a table of output pixels first
+    std::uint32_t lut[256];
     if (op.size() == 1)
     {
         // no interpolation if only one stop
         mapnik::filter::color_stop const& stop = op[0];
         mapnik::color const& c = stop.color;
-        rgba8_view_t src_view = rgba8_view(src);
-        for (int y=0; y<src_view.height(); ++y)
+        for (unsigned a = 1; a < 256; ++a)
         {
-            rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
-            for (int x=0; x<src_view.width(); ++x)
-            {
-                uint8_t & r = get_color(src_it[x], red_t());
-                uint8_t & g = get_color(src_it[x], green_t());
-                uint8_t & b = get_color(src_it[x], blue_t());
-                uint8_t & a = get_color(src_it[x], alpha_t());
-                if ( a > 0)
-                {
-                    r = (c.red() * a + 255) >> 8;
-                    g = (c.green() * a + 255) >> 8;
-                    b = (c.blue() * a + 255) >> 8;
-                }
-            }
+            uint8_t pixel[4];
+            pixel[0] = (c.red() * a + 255) >> 8;
+            pixel[1] = (c.green() * a + 255) >> 8;
+            pixel[2] = (c.blue() * a + 255) >> 8;
+            pixel[3] = a;
+            std::memcpy(&lut[a], pixel, 4);
         }
+        detail::map_alpha(src.raw_data(), src.width(), src.height(), lut);
     }
     else if (size > 1)
     {
@@ -524,57 +406,22 @@ void apply_filter(Src & src, colorize_alpha const& op)
         }
         if (grad_lut.build_lut())
         {
-            rgba8_view_t src_view = rgba8_view(src);
-            for (int y=0; y<src_view.height(); ++y)
+            for (unsigned a = 1; a < 256; ++a)
             {
-                rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
-                for (int x=0; x<src_view.width(); ++x)
+                agg::rgba8 c = grad_lut[a];
+                uint8_t pixel[4];
+                pixel[0] = (c.r * a + 255) >> 8;
+                pixel[1] = (c.g * a + 255) >> 8;
+                pixel[2] = (c.b * a + 255) >> 8;
+                pixel[3] = a;
+                // all color values must be <= alpha
+                for (unsigned i = 0; i < 3; ++i)
                 {
-                    uint8_t & r = get_color(src_it[x], red_t());
-                    uint8_t & g = get_color(src_it[x], green_t());
-                    uint8_t & b = get_color(src_it[x], blue_t());
-                    uint8_t & a = get_color(src_it[x], alpha_t());
-                    if ( a > 0)
-                    {
-                        agg::rgba8 c = grad_lut[a];
-                        r = (c.r * a + 255) >> 8;
-                        g = (c.g * a + 255) >> 8;
-                        b = (c.b * a + 255) >> 8;
-                        if (r>a) r=a;
-                        if (g>a) g=a;
-                        if (b>a) b=a;
-        #if 0
-                        // rainbow
-                        r = 0;
-                        g = 0;
-                        b = 0;
-                        if (a < 64)
-                        {
-                            g = a * 4;
-                            b = 255;
-                        }
-                        else if (a >= 64 && a < 128)
-                        {
-                            g = 255;
-                            b = 255 - ((a - 64) * 4);
-                        }
-                        else if (a >= 128 && a < 192)
-                        {
-                            r = (a - 128) * 4;
-                            g = 255;
-                        }
-                        else // >= 192
-                        {
-                            r = 255;
-                            g = 255 - ((a - 192) * 4);
-                        }
-                        r = (r * a + 255) >> 8;
-                        g = (g * a + 255) >> 8;
-                        b = (b * a + 255) >> 8;
-        #endif
-                    }
+                    if (pixel[i] > a) pixel[i] = a;
                 }
+                std::memcpy(&lut[a], pixel, 4);
             }
+            detail::map_alpha(src.raw_data(), src.width(), src.height(), lut);
         }
     }
 }
@@ -590,102 +437,90 @@ void apply_filter(Src & src, scale_hsla const& transform)
     if (tinting || set_alpha)
     {
         rgba8_view_t src_view = rgba8_view(src);
-        for (int y=0; y<src_view.height(); ++y)
+        detail::parallel_for(src.height(), src.width() * src.height(), [&](unsigned y0, unsigned y1)
         {
-            rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
-            for (int x=0; x<src_view.width(); ++x)
+            for (int y=y0; y<static_cast<int>(y1); ++y)
             {
-                uint8_t & r = get_color(src_it[x], red_t());
-                uint8_t & g = get_color(src_it[x], green_t());
-                uint8_t & b = get_color(src_it[x], blue_t());
-                uint8_t & a = get_color(src_it[x], alpha_t());
-                double r2 = static_cast<double>(r)/255.0;
-                double g2 = static_cast<double>(g)/255.0;
-                double b2 = static_cast<double>(b)/255.0;
-                double a2 = static_cast<double>(a)/255.0;
-                // demultiply
-                if (a2 <= 0.0)
-                {
-                    r = g = b = 0;
-                    continue;
-                }
-                else
-                {
-                    r2 /= a2;
-                    g2 /= a2;
-                    b2 /= a2;
-                }
-                if (set_alpha)
+                rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
+                for (int x=0; x<src_view.width(); ++x)
                 {
-                    a2 = transform.a0 + (a2 * (transform.a1 - transform.a0));
-                    if (a2 <= 0)
+                    uint8_t & r = get_color(src_it[x], red_t());
+                    uint8_t & g = get_color(src_it[x], green_t());
+                    uint8_t & b = get_color(src_it[x], blue_t());
+                    uint8_t & a = get_color(src_it[x], alpha_t());
+                    double r2 = static_cast<double>(r)/255.0;
+                    double g2 = static_cast<double>(g)/255.0;
+                    double b2 = static_cast<double>(b)/255.0;
+                    double a2 = static_cast<double>(a)/255.0;
+                    // demultiply
+                    if (a2 <= 0.0)
                     {
-                        r = g = b = a = 0;
+                        r = g = b = 0;
                         continue;
                     }
-                    else if (a2 > 1)
+                    else
                     {
-                        a2 = 1;
-                        a = 255;
+                        r2 /= a2;
+                        g2 /= a2;
+                        b2 /= a2;
                     }
-                    else
+                    if (set_alpha)
                     {
-                        a = static_cast<uint8_t>(std::floor((a2 * 255.0) +.5));
+                        a2 = transform.a0 + (a2 * (transform.a1 - transform.a0));
+                        if (a2 <= 0)
+                        {
+                            r = g = b = a = 0;
+                            continue;
+                        }
+                        else if (a2 > 1)
+                        {
+                            a2 = 1;
+                            a = 255;
+                        }
+                        else
+                        {
+                            a = static_cast<uint8_t>(std::floor((a2 * 255.0) +.5));
+                        }
                     }
+                    if (tinting)
+                    {
+                        double h;
+                        double s;
+                        double l;
+                        rgb2hsl(r2,g2,b2,h,s,l);
+                        double h2 = transform.h0 + (h * (transform.h1 - transform.h0));
+                        double s2 = transform.s0 + (s * (transform.s1 - transform.s0));
+                        double l2 = transform.l0 + (l * (transform.l1 - transform.l0));
+                        if (h2 > 1) { h2 = 1; }
+                        else if (h2 < 0) { h2 = 0; }
+                        if (s2 > 1) { s2 = 1; }
+                        else if (s2 < 0) { s2 = 0; }
+                        if (l2 > 1) { l2 = 1; }
+                        else if (l2 < 0) { l2 = 0; }
+                        hsl2rgb(h2,s2,l2,r2,g2,b2);
+                    }
+                    // premultiply
+                    r2 *= a2;
+                    g2 *= a2;
+                    b2 *= a2;
+                    r = static_cast<uint8_t>(std::floor((r2*255.0)+.5));
+                    g = static_cast<uint8_t>(std::floor((g2*255.0)+.5));
+                    b = static_cast<uint8_t>(std::floor((b2*255.0)+.5));
+                    // all color values must be <= alpha
+                    if (r>a) r=a;
+                    if (g>a) g=a;
+                    if (b>a) b=a;
                 }
-                if (tinting)
-                {
-                    double h;
-                    double s;
-                    double l;
-                    rgb2hsl(r2,g2,b2,h,s,l);
-                    double h2 = transform.h0 + (h * (transform.h1 - transform.h0));
-                    double s2 = transform.s0 + (s * (transform.s1 - transform.s0));
-                    double l2 = transform.l0 + (l * (transform.l1 - transform.l0));
-                    if (h2 > 1) { h2 = 1; }
-                    else if (h2 < 0) { h2 = 0; }
-                    if (s2 > 1) { s2 = 1; }
-                    else if (s2 < 0) { s2 = 0; }
-                    if (l2 > 1) { l2 = 1; }
-                    else if (l2 < 0) { l2 = 0; }
-                    hsl2rgb(h2,s2,l2,r2,g2,b2);
-                }
-                // premultiply
-                r2 *= a2;
-                g2 *= a2;
-                b2 *= a2;
-                r = static_cast<uint8_t>(std::floor((r2*255.0)+.5));
-                g = static_cast<uint8_t>(std::floor((g2*255.0)+.5));
-                b = static_cast<uint8_t>(std::floor((b2*255.0)+.5));
-                // all color values must be <= alpha
-                if (r>a) r=a;
-                if (g>a) g=a;
-                if (b>a) b=a;
             }
-        }
+        });
     }
 }
 
 template <typename Src>
 void apply_filter(Src & src, gray const& /*op*/)
 {
-    using namespace boost::gil;
-
-    rgba8_view_t src_view = rgba8_view(src);
-
-    for (int y=0; y<src_view.height(); ++y)
-    {
-        rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
-        for (int x=0; x<src_view.width(); ++x)
-        {
-            // formula taken from boost/gil/color_convert.hpp:rgb_to_luminance
-            uint8_t & r = get_color(src_it[x], red_t());
-            uint8_t & g = get_color(src_it[x], green_t());
-            uint8_t & b = get_color(src_it[x], blue_t());
-            uint8_t   v = uint8_t((4915 * r + 9667 * g + 1802 * b + 8192) >> 14);
-            r = g = b = v;
-        }
-    }
+    // formula taken from boost/gil/color_convert.hpp:rgb_to_luminance
+    detail::to_gray(src.raw_data(), src.width(), src.height());
 }
 
 template <typename Src, typename Dst>
@@ -734,26 +569,9 @@ void apply_filter(Src & src, y_gradient const& /*op*/)
 template <typename Src>
 void apply_filter(Src & src, invert const& /*op*/)
 {
-    using namespace boost::gil;
-
-    rgba8_view_t src_view = rgba8_view(src);
-
-    for (int y=0; y<src_view.height(); ++y)
-    {
-        rgba8_view_t::x_iterator src_it = src_view.row_begin(y);
-        for (int x=0; x<src_view.width(); ++x)
-        {
-            // we only work with premultiplied source,
-            // thus all color values must be <= alpha
-            uint8_t   a = get_color(src_it[x], alpha_t());
-            uint8_t & r = get_color(src_it[x], red_t());
-            uint8_t & g = get_color(src_it[x], green_t());
-            uint8_t & b = get_color(src_it[x], blue_t());
-            r = a - r;
-            g = a - g;
-            b = a - b;
-        }
-    }
+    // we only work with premultiplied source,
+    // thus all color values must be <= alpha
+    detail::invert_colors(src.raw_data(), src.width(), src.height());
 }
 
 template <typename Src>
@@ -786,6 +604,43 @@ struct filter_radius_visitor : util::static_visitor<void>
     }
 };
 
+// Grows a box around the non transparent pixels of an image to everything a
+// filter can paint into and read from: outside of it the image stays
+// transparent and applying the filter to the box alone gives the same
+// pixels. Gradients paint transparent areas, they need the whole image.
+struct filter_extent_visitor : util::static_visitor<void>
+{
+    box2d<int> & box_;
+    box2d<int> const& image_;
+    filter_extent_visitor(box2d<int> & box, box2d<int> const& image)
+        : box_(box),
+          image_(image) {}
+
+    template <typename T>
+    void operator () (T const& /*filter*/) {}
+
+    void operator () (agg_stack_blur const& op)
+    {
+        grow(static_cast<int>(op.rx), static_cast<int>(op.ry));
+    }
+
+    void operator () (blur const&) { grow(1, 1); }
+    void operator () (emboss const&) { grow(1, 1); }
+    void operator () (sharpen const&) { grow(1, 1); }
+    void operator () (edge_detect const&) { grow(1, 1); }
+    void operator () (sobel const&) { grow(1, 1); }
+    void operator () (x_gradient const&) { box_ = image_; }
+    void operator () (y_gradient const&) { box_ = image_; }
+
+private:
+    void grow(int dx, int dy)
+    {
+        if (!box_.valid()) return;
+        box_.init(box_.minx() - dx, box_.miny() - dy, box_.maxx() + dx, box_.maxy() + dy);
+        box_.clip(image_);
+    }
+};
+
 }}
 
 #endif // MAPNIK_IMAGE_FILTER_HPP
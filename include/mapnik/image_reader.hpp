@@ -60,6 +60,11 @@ struct MAPNIK_DECL image_reader : private mapnik::noncopyable
     virtual bool has_alpha() const=0;
     virtual bool premultiplied_alpha() const=0;
     virtual void read(unsigned x,unsigned y,image_data_32& image)=0;
+    // Decode at 1/factor of the native size, for images that are drawn
+    // much smaller anyway. Readers round the factor down to one their
+    // format can decode to directly and return it; width(), height() and
+    // read() then work on the reduced image. The default keeps full size.
+    virtual unsigned set_reduction(unsigned /*factor*/) { return 1; }
     virtual ~image_reader() {}
 };
 
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_IMAGE_RESAMPLE_HPP
+#define MAPNIK_IMAGE_RESAMPLE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/image_data.hpp>
+
+// agg
+#include "agg_image_filters.h"
+#include "agg_trans_affine.h"
+
+// stl
+#include <vector>
+
+namespace mapnik { namespace resample {
+
+// Separable resampling for transforms without rotation or shear, used in
+// place of agg's span image filters, which evaluate the full 2D kernel for
+// every output pixel. Sampling positions, filter support and weights are
+// those of agg::span_image_resample_rgba_affine (span_image_filter_rgba_nn
+// for nearest) reading through agg::image_accessor_clone; only the
+// rounding differs, by at most a unit or two.
+
+// One output pixel along an axis: the source position of its center in
+// agg subpixels, and agg's resampling scale for it (m_rx, m_rx_inv).
+struct axis_sample
+{
+    int pos;
+    int r;
+    int r_inv;
+};
+
+// Source pixels contributing to every output pixel along an axis: `taps`
+// consecutive pixels from start[i] with weights[i * taps ...], summing to
+// one. Positions outside of the source are folded onto its edge.
+struct axis_weights
+{
+    std::vector<int> start;
+    std::vector<float> weights;
+    unsigned taps = 0;
+    // single taps copied as they are
+    bool nearest = false;
+
+    unsigned size() const { return static_cast<unsigned>(start.size()); }
+};
+
+// agg's m_rx, m_rx_inv, m_ry, m_ry_inv for a target to source transform
+MAPNIK_DECL void filter_scale(agg::trans_affine const& tr, int & rx, int & rx_inv, int & ry, int & ry_inv);
+
+// Taps of the given samples over a source of `size` pixels, nearest neighbour
+// when filter is null.
+MAPNIK_DECL void make_weights(axis_weights & out, std::vector<axis_sample> const& samples,
+                              unsigned size, agg::image_filter_lut const* filter);
+
+// Writes the xw.size() by yw.size() pixels at x0, y0 of target. Both
+// images are premultiplied rgba8.
+MAPNIK_DECL void resample(image_data_32 & target, unsigned x0, unsigned y0,
+                          image_data_32 const& source,
+                          axis_weights const& xw, axis_weights const& yw);
+
+}}
+
+#endif // MAPNIK_IMAGE_RESAMPLE_HPP
@@ -34,6 +34,7 @@
 
 // stl
 #include <string>
+#include <cstdint>
 #include <cmath>
 #include <exception>
 
@@ -119,6 +120,15 @@ MAPNIK_DECL void save_to_stream
     std::string const& type
 );
 
+// true if every pixel equals the first one, and for empty images
+template <typename T>
+MAPNIK_DECL bool is_solid(T const& image);
+
+// 64 bit hash of the size and pixels of an image, to spot duplicate tiles
+// without encoding them. A view hashes like the same pixels copied out.
+template <typename T>
+MAPNIK_DECL std::uint64_t image_hash(T const& image);
+
 template <typename T>
 void save_as_png(T const& image,
                  std::string const& filename,
@@ -235,6 +245,12 @@ MAPNIK_DECL std::string save_to_string(image_32 const& image,
 
 ///////////////////////////////////////////////////////////////////////////
 
+MAPNIK_DECL bool is_solid(image_32 const& image);
+
+MAPNIK_DECL std::uint64_t image_hash(image_32 const& image);
+
+///////////////////////////////////////////////////////////////////////////
+
 MAPNIK_DECL void save_to_stream(image_32 const& image,
                                 std::ostream & stream,
                                 std::string const& type,
@@ -279,6 +295,14 @@ extern template MAPNIK_DECL void save_to_file<image_view<image_data_32> > (image
 extern template MAPNIK_DECL void save_to_file<image_view<image_data_32> > (image_view<image_data_32> const&,
                                                                     std::string const&);
 
+extern template MAPNIK_DECL bool is_solid<image_data_32>(image_data_32 const&);
+
+extern template MAPNIK_DECL bool is_solid<image_view<image_data_32> >(image_view<image_data_32> const&);
+
+extern template MAPNIK_DECL std::uint64_t image_hash<image_data_32>(image_data_32 const&);
+
+extern template MAPNIK_DECL std::uint64_t image_hash<image_view<image_data_32> >(image_view<image_data_32> const&);
+
 extern template MAPNIK_DECL std::string save_to_string<image_data_32>(image_data_32 const&,
                                                                std::string const&);
 
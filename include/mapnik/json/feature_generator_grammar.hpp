@@ -142,7 +142,7 @@ struct extract_string
 
     result_type operator() (mapnik::value const& val) const
     {
-        bool need_quotes = val.is<value_unicode_string>();
+        bool need_quotes = val.is<value_unicode_string>() || val.is<value_utf8_string>();
         return std::make_tuple(val.to_string(), need_quotes);
     }
 };
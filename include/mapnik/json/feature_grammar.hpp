@@ -54,7 +54,7 @@ public:
 
     mapnik::value operator()(std::string const& val) const
     {
-        return mapnik::value(tr_.transcode(val.c_str()));
+        return mapnik::value(tr_.transcode_utf8(val.c_str()));
     }
 
     template <typename T>
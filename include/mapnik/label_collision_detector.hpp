@@ -32,6 +32,8 @@
 #include <unicode/unistr.h>
 
 // stl
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 namespace mapnik
@@ -125,7 +127,10 @@ public:
 };
 
 
-//quad tree based label collision detector so labels dont appear within a given distance
+// label collision detector so labels dont appear within a given distance.
+// Labels are indexed either by a quad tree (default) or, when constructed
+// with a positive cell size, by a fixed-cell uniform grid which avoids
+// node allocation and recursion on every query.
 class label_collision_detector4 : mapnik::noncopyable
 {
 public:
@@ -139,26 +144,45 @@ public:
     };
 
 private:
-    using tree_t = quad_tree< label >;
+    using tree_t = quad_tree< std::size_t >;
+    using labels_t = std::vector<label>;
+    using cell_t = std::vector<std::size_t>;
     tree_t tree_;
+    labels_t labels_;
+    double cell_size_;
+    std::size_t columns_;
+    std::size_t rows_;
+    std::vector<cell_t> cells_;
 
 public:
-    using query_iterator = tree_t::query_iterator;
-
-    explicit label_collision_detector4(box2d<double> const& extent)
-        : tree_(extent) {}
-
-    bool has_placement(box2d<double> const& box)
+    using query_iterator = labels_t::iterator;
+
+    explicit label_collision_detector4(box2d<double> const& extent, double cell_size = 0.0)
+        : tree_(extent),
+          labels_(),
+          cell_size_(cell_size),
+          columns_(0),
+          rows_(0),
+          cells_()
     {
-        tree_t::query_iterator itr = tree_.query_in_box(box);
-        tree_t::query_iterator end = tree_.query_end();
-
-        for ( ;itr != end; ++itr)
+        if (cell_size_ > 0.0)
         {
-            if (itr->box.intersects(box)) return false;
+            columns_ = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(extent.width() / cell_size_)));
+            rows_ = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(extent.height() / cell_size_)));
+            cells_.resize(columns_ * rows_);
         }
+    }
 
-        return true;
+    // grid cell size for a detector covering extent: about the size of
+    // a typical label, coarser on very large canvases to bound the cell count
+    static double default_cell_size(box2d<double> const& extent)
+    {
+        return std::max(64.0, std::max(extent.width(), extent.height()) / 128.0);
+    }
+
+    bool has_placement(box2d<double> const& box)
+    {
+        return query(box, [&box](label const& lbl) { return !lbl.box.intersects(box); });
     }
 
     bool has_placement(box2d<double> const& box, double margin)
@@ -168,17 +192,7 @@ public:
                                                                box.maxx() + margin, box.maxy() + margin)
                                                : box);
 
-        tree_t::query_iterator itr = tree_.query_in_box(margin_box);
-        tree_t::query_iterator end = tree_.query_end();
-
-        for (;itr != end; ++itr)
-        {
-            if (itr->box.intersects(margin_box))
-            {
-                return false;
-            }
-        }
-        return true;
+        return query(margin_box, [&margin_box](label const& lbl) { return !lbl.box.intersects(margin_box); });
     }
 
     bool has_placement(box2d<double> const& box, double margin, mapnik::value_unicode_string const& text, double repeat_distance)
@@ -196,33 +210,48 @@ public:
                                                                box.maxx() + margin, box.maxy() + margin)
                                                : box);
 
-        tree_t::query_iterator itr = tree_.query_in_box(repeat_box);
-        tree_t::query_iterator end = tree_.query_end();
-
-        for ( ;itr != end; ++itr)
+        if (cell_size_ > 0.0)
         {
-            if (itr->box.intersects(margin_box) || (text == itr->text && itr->box.intersects(repeat_box)))
+            // most candidates collide within the margin, which only
+            // touches a few cells; scan the wider repeat box afterwards
+            if (!query(margin_box, [&margin_box](label const& lbl) { return !lbl.box.intersects(margin_box); }))
             {
                 return false;
             }
+            return query(repeat_box, [&](label const& lbl)
+                         {
+                             return !(text == lbl.text && lbl.box.intersects(repeat_box));
+                         });
         }
 
-        return true;
+        return query(repeat_box, [&](label const& lbl)
+                     {
+                         return !(lbl.box.intersects(margin_box) || (text == lbl.text && lbl.box.intersects(repeat_box)));
+                     });
     }
 
     void insert(box2d<double> const& box)
     {
-        tree_.insert(label(box), box);
+        do_insert(label(box));
     }
 
     void insert(box2d<double> const& box, mapnik::value_unicode_string const& text)
     {
-        tree_.insert(label(box, text), box);
+        do_insert(label(box, text));
     }
 
     void clear()
     {
-        tree_.clear();
+        labels_.clear();
+        if (cell_size_ > 0.0)
+        {
+            // keep the cells' capacity for the next render
+            for (auto & cell : cells_) cell.clear();
+        }
+        else
+        {
+            tree_.clear();
+        }
     }
 
     box2d<double> const& extent() const
@@ -230,8 +259,90 @@ public:
         return tree_.extent();
     }
 
-    query_iterator begin() { return tree_.query_in_box(extent()); }
-    query_iterator end() { return tree_.query_end(); }
+    // zero when backed by the quad tree
+    double cell_size() const
+    {
+        return cell_size_;
+    }
+
+    query_iterator begin() { return labels_.begin(); }
+    query_iterator end() { return labels_.end(); }
+
+private:
+    void do_insert(label && lbl)
+    {
+        std::size_t index = labels_.size();
+        labels_.push_back(std::move(lbl));
+        box2d<double> const& box = labels_.back().box;
+        if (cell_size_ > 0.0)
+        {
+            std::size_t x0, y0, x1, y1;
+            cell_range(box, x0, y0, x1, y1);
+            for (std::size_t y = y0; y <= y1; ++y)
+            {
+                for (std::size_t x = x0; x <= x1; ++x)
+                {
+                    cells_[y * columns_ + x].push_back(index);
+                }
+            }
+        }
+        else
+        {
+            tree_.insert(index, box);
+        }
+    }
+
+    // calls pred for every label which may intersect box, false as soon as pred does
+    template <typename Predicate>
+    bool query(box2d<double> const& box, Predicate pred)
+    {
+        if (cell_size_ > 0.0)
+        {
+            // labels spanning several cells may be visited more than once,
+            // which is harmless for a pure test
+            std::size_t x0, y0, x1, y1;
+            cell_range(box, x0, y0, x1, y1);
+            for (std::size_t y = y0; y <= y1; ++y)
+            {
+                for (std::size_t x = x0; x <= x1; ++x)
+                {
+                    for (std::size_t index : cells_[y * columns_ + x])
+                    {
+                        if (!pred(labels_[index])) return false;
+                    }
+                }
+            }
+            return true;
+        }
+        tree_t::query_iterator itr = tree_.query_in_box(box);
+        tree_t::query_iterator end = tree_.query_end();
+        for ( ;itr != end; ++itr)
+        {
+            if (!pred(labels_[*itr])) return false;
+        }
+        return true;
+    }
+
+    // boxes outside of the extent are clamped onto the border cells, so
+    // any two intersecting boxes always share at least one cell
+    void cell_range(box2d<double> const& box,
+                    std::size_t & x0, std::size_t & y0,
+                    std::size_t & x1, std::size_t & y1) const
+    {
+        box2d<double> const& ext = tree_.extent();
+        x0 = cell_index(box.minx() - ext.minx(), columns_);
+        x1 = cell_index(box.maxx() - ext.minx(), columns_);
+        y0 = cell_index(box.miny() - ext.miny(), rows_);
+        y1 = cell_index(box.maxy() - ext.miny(), rows_);
+    }
+
+    std::size_t cell_index(double offset, std::size_t count) const
+    {
+        double cell = std::floor(offset / cell_size_);
+        if (!(cell > 0.0)) return 0;
+        if (cell >= static_cast<double>(count)) return count - 1;
+        return static_cast<std::size_t>(cell);
+    }
 };
 }
 
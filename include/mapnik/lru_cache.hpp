@@ -0,0 +1,181 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_LRU_CACHE_HPP
+#define MAPNIK_LRU_CACHE_HPP
+
+// mapnik
+#include <mapnik/noncopyable.hpp>
+
+// stl
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace mapnik
+{
+
+// every entry counts as one, bounding the cache by its number of entries
+struct lru_entry_count
+{
+    template <typename Key, typename Value>
+    std::size_t operator()(Key const&, Value const&) const
+    {
+        return 1;
+    }
+};
+
+struct lru_cache_stats
+{
+    std::size_t hits;
+    std::size_t misses;
+    std::size_t evictions;
+    std::size_t entries;
+    std::size_t size;
+};
+
+// Thread safe map from Key to a shared pointer Value that drops the least
+// recently used entries once the sum of SizeOf(key, value) over all entries
+// exceeds max_size. Entries larger than max_size on their own are not stored,
+// so a max_size of 0 disables the cache. Values are built outside of the
+// cache; when two threads miss on the same key the second insert wins.
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename SizeOf = lru_entry_count>
+class lru_cache : private mapnik::noncopyable
+{
+public:
+    explicit lru_cache(std::size_t max_size)
+        : lru_(),
+          index_(),
+          max_size_(max_size),
+          size_(0),
+          hits_(0),
+          misses_(0),
+          evictions_(0) {}
+
+    // an empty Value when key isn't cached
+    Value find(Key const& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto itr = index_.find(key);
+        if (itr == index_.end())
+        {
+            ++misses_;
+            return Value();
+        }
+        ++hits_;
+        lru_.splice(lru_.begin(), lru_, itr->second);
+        return itr->second->second;
+    }
+
+    void insert(Key key, Value value)
+    {
+        if (!value) return;
+        std::size_t entry_size = SizeOf()(key, value);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entry_size > max_size_) return;
+        auto itr = index_.find(key);
+        if (itr != index_.end())
+        {
+            size_ -= SizeOf()(itr->first, itr->second->second);
+            lru_.erase(itr->second);
+            index_.erase(itr);
+        }
+        lru_.emplace_front(std::move(key), std::move(value));
+        index_.emplace(lru_.front().first, lru_.begin());
+        size_ += entry_size;
+        evict();
+    }
+
+    // drops all entries and resets the statistics
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_.clear();
+        lru_.clear();
+        size_ = 0;
+        hits_ = 0;
+        misses_ = 0;
+        evictions_ = 0;
+    }
+
+    void set_max_size(std::size_t max_size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_size_ = max_size;
+        evict();
+    }
+
+    std::size_t max_size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_size_;
+    }
+
+    // sum of the sizes of all entries
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    std::size_t entries() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+    lru_cache_stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lru_cache_stats{ hits_, misses_, evictions_, index_.size(), size_ };
+    }
+
+private:
+    void evict()
+    {
+        while (size_ > max_size_ && !lru_.empty())
+        {
+            auto const& last = lru_.back();
+            size_ -= SizeOf()(last.first, last.second);
+            index_.erase(last.first);
+            lru_.pop_back();
+            ++evictions_;
+        }
+    }
+
+    using lru_list = std::list<std::pair<Key, Value> >;
+    lru_list lru_;
+    std::unordered_map<Key, typename lru_list::iterator, Hash> index_;
+    std::size_t max_size_;
+    std::size_t size_;
+    std::size_t hits_;
+    std::size_t misses_;
+    std::size_t evictions_;
+    mutable std::mutex mutex_;
+};
+
+}
+
+#endif // MAPNIK_LRU_CACHE_HPP
@@ -79,6 +79,15 @@ public:
         aspect_fix_mode_MAX
     };
 
+    enum collision_detector_mode
+    {
+        // label collisions indexed by a quad tree. default behaviour.
+        QUAD_TREE_DETECTOR,
+        // label collisions indexed by a uniform grid, faster on densely labelled maps
+        GRID_DETECTOR,
+        collision_detector_mode_MAX
+    };
+
 private:
     static const unsigned MIN_MAPSIZE=16;
     static const unsigned MAX_MAPSIZE=MIN_MAPSIZE<<10;
@@ -94,6 +103,8 @@ private:
     std::map<std::string,font_set> fontsets_;
     std::vector<layer> layers_;
     aspect_fix_mode aspectFixMode_;
+    collision_detector_mode collision_detector_;
+    bool deferred_labels_;
     box2d<double> current_extent_;
     boost::optional<box2d<double> > maximum_extent_;
     std::string base_path_;
@@ -455,6 +466,16 @@ public:
     inline void set_aspect_fix_mode(aspect_fix_mode afm) { aspectFixMode_ = afm; }
     inline aspect_fix_mode get_aspect_fix_mode() const { return aspectFixMode_; }
 
+    inline void set_collision_detector(collision_detector_mode mode) { collision_detector_ = mode; }
+    inline collision_detector_mode get_collision_detector() const { return collision_detector_; }
+
+    /*!
+     * @brief Collect labels from all layers and place them once by
+     * descending label-priority instead of in feature order.
+     */
+    inline void set_deferred_labels(bool deferred) { deferred_labels_ = deferred; }
+    inline bool deferred_labels() const { return deferred_labels_; }
+
     /*!
      * @brief Get extra, arbitrary Parameters attached to the Map
      */
@@ -506,6 +527,7 @@ private:
 };
 
 DEFINE_ENUM(aspect_fix_mode_e,Map::aspect_fix_mode);
+DEFINE_ENUM(collision_detector_e,Map::collision_detector_mode);
 }
 
 #endif // MAPNIK_MAP_HPP
@@ -39,6 +39,9 @@
 #endif
 
 // stl
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #define U2RED(x) ((x)&0xff)
@@ -120,10 +123,15 @@ public:
 
 private:
     void parse(std::string const& pal, palette_type type);
+    unsigned char search(rgba const& c) const;
 
 private:
     std::vector<rgba> sorted_pal_;
-    mutable rgba_hash_table color_hashmap_;
+    // palette index of colors quantized so far, packed as color << 8 | index
+    // with a valid bit above. The palette is fixed, so entries stay valid for
+    // its lifetime and are shared by all threads quantizing against it.
+    // Memory is bounded: when the table gets crowded, colors replace others.
+    std::unique_ptr<std::atomic<std::uint64_t>[]> nearest_;
 
     unsigned colors_;
     std::vector<rgb> rgb_pal_;
@@ -0,0 +1,96 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_PARALLEL_PNG_HPP
+#define MAPNIK_PARALLEL_PNG_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/palette.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_view.hpp>
+
+// stl
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mapnik {
+
+// PNG writer that deflates the scanlines in independent chunks on several
+// threads, the way pigz does. Each chunk ends on a sync flush and is primed
+// with the last 32KiB of the chunk before it, so the pieces join into one
+// zlib stream that compresses about as well as a single threaded one.
+// The interface follows MiniZ::PNGWriter.
+class MAPNIK_DECL parallel_png_writer : private mapnik::noncopyable
+{
+public:
+    // bytes of scanline data deflated by one task
+    static const std::size_t chunk_size = 128 * 1024;
+
+    // at most this many threads, the calling one included, compress on the
+    // shared thread pool; 0 uses all of them
+    parallel_png_writer(int level, int strategy, unsigned threads);
+
+    // pixel_depth is 32 for RGBA, 24 for RGB and the bit depth of paletted images
+    void write_ihdr(unsigned width, unsigned height, unsigned pixel_depth);
+    void write_plte(std::vector<rgb> const& palette);
+    void write_trns(std::vector<unsigned> const& alpha);
+    template <typename T>
+    void write_idat(T const& image);
+    template <typename T>
+    void write_idat_strip_alpha(T const& image);
+    void write_iend();
+
+    template <typename T>
+    void to_stream(T & stream) const
+    {
+        stream.write(buffer_.data(), buffer_.size());
+    }
+
+private:
+    std::size_t start_chunk(char const* type);
+    void finish_chunk(std::size_t start);
+    void put_uint32(std::uint32_t value);
+    // writes the zlib stream of filtered scanlines as IDAT chunks
+    void deflate_scanlines(std::vector<std::uint8_t> const& raw);
+
+    std::string buffer_;
+    // scanline bytes from IHDR, the rows of quantized images may be padded
+    std::size_t stride_;
+    int level_;
+    int strategy_;
+    unsigned threads_;
+};
+
+extern template MAPNIK_DECL void parallel_png_writer::write_idat<image_data_8>(image_data_8 const& image);
+extern template MAPNIK_DECL void parallel_png_writer::write_idat<image_view<image_data_8> >(image_view<image_data_8> const& image);
+extern template MAPNIK_DECL void parallel_png_writer::write_idat<image_data_32>(image_data_32 const& image);
+extern template MAPNIK_DECL void parallel_png_writer::write_idat<image_view<image_data_32> >(image_view<image_data_32> const& image);
+extern template MAPNIK_DECL void parallel_png_writer::write_idat_strip_alpha<image_data_32>(image_data_32 const& image);
+extern template MAPNIK_DECL void parallel_png_writer::write_idat_strip_alpha<image_view<image_data_32> >(image_view<image_data_32> const& image);
+
+}
+
+#endif // MAPNIK_PARALLEL_PNG_HPP
@@ -28,6 +28,7 @@
 #include <mapnik/octree.hpp>
 #include <mapnik/hextree.hpp>
 #include <mapnik/miniz_png.hpp>
+#include <mapnik/parallel_png.hpp>
 #include <mapnik/image_data.hpp>
 
 // zlib
@@ -54,6 +55,8 @@ struct png_options {
     bool paletted;
     bool use_hextree;
     bool use_miniz;
+    // deflate threads, 1 encodes through libpng, 0 uses one per core
+    unsigned threads;
     png_options() :
         colors(256),
         compression(Z_DEFAULT_COMPRESSION),
@@ -62,7 +65,8 @@ struct png_options {
         gamma(-1),
         paletted(true),
         use_hextree(true),
-        use_miniz(false) {}
+        use_miniz(false),
+        threads(1) {}
 };
 
 template <typename T>
@@ -102,6 +106,23 @@ void save_as_png(T1 & file,
         writer.toStream(file);
         return;
     }
+    if (opts.threads != 1)
+    {
+        parallel_png_writer writer(opts.compression, opts.strategy, opts.threads);
+        if (opts.trans_mode == 0)
+        {
+            writer.write_ihdr(image.width(), image.height(), 24);
+            writer.write_idat_strip_alpha(image);
+        }
+        else
+        {
+            writer.write_ihdr(image.width(), image.height(), 32);
+            writer.write_idat(image);
+        }
+        writer.write_iend();
+        writer.to_stream(file);
+        return;
+    }
     png_voidp error_ptr=0;
     png_structp png_ptr=png_create_write_struct(PNG_LIBPNG_VER_STRING,
                                                 error_ptr,0, 0);
@@ -286,6 +307,17 @@ void save_as_png(T & file, std::vector<mapnik::rgb> const& palette,
         writer.toStream(file);
         return;
     }
+    if (opts.threads != 1)
+    {
+        parallel_png_writer writer(opts.compression, opts.strategy, opts.threads);
+        writer.write_ihdr(width, height, color_depth);
+        writer.write_plte(palette);
+        writer.write_trns(alpha);
+        writer.write_idat(image);
+        writer.write_iend();
+        writer.to_stream(file);
+        return;
+    }
     png_voidp error_ptr=0;
     png_structp png_ptr=png_create_write_struct(PNG_LIBPNG_VER_STRING,
                                                 error_ptr,0, 0);
@@ -605,9 +637,15 @@ void save_as_png8(T1 & file,
         {
             mapnik::image_data_32::pixel_type const * row = image.getRow(y);
             mapnik::image_data_8::pixel_type  * row_out = reduced_image.getRow(y);
+            byte index = 0;
             for (unsigned x = 0; x < width; ++x)
             {
-                row_out[x] = tree.quantize(row[x]);
+                // runs of one color are frequent, quantize them once
+                if (x == 0 || row[x] != row[x - 1])
+                {
+                    index = tree.quantize(row[x]);
+                }
+                row_out[x] = index;
             }
         }
         save_as_png(file, palette, reduced_image, width, height, 8, alphaTable, opts);
@@ -634,13 +672,11 @@ void save_as_png8(T1 & file,
             byte index = 0;
             for (unsigned x = 0; x < width; ++x)
             {
-
-                index = tree.quantize(row[x]);
-                if (x%2 == 0)
+                if (x == 0 || row[x] != row[x - 1])
                 {
-                    index = index<<4;
+                    index = tree.quantize(row[x]);
                 }
-                row_out[x>>1] |= index;
+                row_out[x>>1] |= (x%2 == 0) ? index<<4 : index;
             }
         }
         save_as_png(file, palette, reduced_image, width, height, 4, alphaTable, opts);
@@ -667,13 +703,34 @@ void save_as_png8_hex(T1 & file,
             tree.setGamma(opts.gamma);
         }
 
+        // count repeated colors first, so that the tree is walked once per
+        // color and batch instead of once per pixel
+        std::size_t const hist_size = 4096;
+        std::vector<std::pair<unsigned, unsigned> > hist(hist_size, std::make_pair(0u, 0u));
         for (unsigned y = 0; y < height; ++y)
         {
             typename T2::pixel_type const * row = image.getRow(y);
             for (unsigned x = 0; x < width; ++x)
             {
                 unsigned val = row[x];
-                tree.insert(mapnik::rgba(U2RED(val), U2GREEN(val), U2BLUE(val), U2ALPHA(val)));
+                std::pair<unsigned, unsigned> & bucket = hist[(val * 2654435761u) >> 20];
+                if (bucket.first != val || bucket.second == 0)
+                {
+                    if (bucket.second > 0)
+                    {
+                        tree.insert(mapnik::rgba(bucket.first), bucket.second);
+                    }
+                    bucket.first = val;
+                    bucket.second = 0;
+                }
+                ++bucket.second;
+            }
+        }
+        for (auto const& bucket : hist)
+        {
+            if (bucket.second > 0)
+            {
+                tree.insert(mapnik::rgba(bucket.first), bucket.second);
             }
         }
 
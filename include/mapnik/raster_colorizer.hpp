@@ -52,6 +52,7 @@ namespace mapnik
 
 class feature_impl;
 class raster;
+struct colorizer_lut;
 
 
 //! \brief Enumerates the modes of interpolation
@@ -198,6 +199,10 @@ public:
 
     //! \brief Colorize a raster
     //!
+    //! Rasters holding only integer values in the 8 or 16 bit range are
+    //! colorized through a value to color table, built once per value range
+    //! and nodata value and reused until the colorizer changes.
+    //!
     //! \param[in, out] raster A raster stored in float32 single channel format, which gets colorized in place.
     void colorize(std::shared_ptr<raster> const& raster, feature_impl const& f) const;
 
@@ -223,6 +228,9 @@ private:
     colorizer_mode default_mode_;   //!< The default mode inherited by stops
     color default_color_;           //!< The default color
     float epsilon_;                 //!< The epsilon value for exact mode
+
+    //! \brief Lookup tables for 8 bit, unsigned and signed 16 bit values
+    mutable std::shared_ptr<colorizer_lut const> luts_[3];
 };
 
 
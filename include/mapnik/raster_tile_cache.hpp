@@ -0,0 +1,125 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_RASTER_TILE_CACHE_HPP
+#define MAPNIK_RASTER_TILE_CACHE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/utils.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/image_data.hpp>
+#include <mapnik/lru_cache.hpp>
+#include <mapnik/util/hash_combine.hpp>
+
+// stl
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace mapnik
+{
+
+// the tile of a raster file starting at native pixel x,y, decoded at
+// 1/reduction of its native size
+struct raster_tile_key
+{
+    std::string file;
+    unsigned x;
+    unsigned y;
+    unsigned reduction;
+
+    bool operator==(raster_tile_key const& rhs) const
+    {
+        return x == rhs.x && y == rhs.y &&
+            reduction == rhs.reduction && file == rhs.file;
+    }
+};
+
+struct raster_tile_key_hash
+{
+    std::size_t operator()(raster_tile_key const& key) const
+    {
+        std::size_t seed = std::hash<std::string>()(key.file);
+        util::hash_combine(seed, key.x);
+        util::hash_combine(seed, key.y);
+        util::hash_combine(seed, key.reduction);
+        return seed;
+    }
+};
+
+struct raster_tile
+{
+    raster_tile(unsigned width, unsigned height, bool premultiplied)
+        : data(width, height),
+          premultiplied_alpha(premultiplied) {}
+
+    image_data_32 data;
+    bool premultiplied_alpha;
+};
+
+using raster_tile_ptr = std::shared_ptr<raster_tile const>;
+
+// bytes of pixel data
+struct raster_tile_size
+{
+    std::size_t operator()(raster_tile_key const&, raster_tile_ptr const& tile) const
+    {
+        return tile->data.width() * tile->data.height() * sizeof(image_data_32::pixel_type);
+    }
+};
+
+struct raster_tile_cache_stats
+{
+    std::size_t hits;
+    std::size_t misses;
+    std::size_t evictions;
+    std::size_t tiles;
+    std::size_t bytes;
+};
+
+// Process wide LRU cache of decoded raster tiles, bounded by the bytes of
+// pixel data it holds. Neighbouring map tiles and metatiles read the same
+// source tiles of tiled rasters again and again, see raster_featureset.
+class MAPNIK_DECL raster_tile_cache :
+        public singleton<raster_tile_cache, CreateUsingNew>,
+        private mapnik::noncopyable
+{
+    friend class CreateUsingNew<raster_tile_cache>;
+public:
+    raster_tile_ptr find(raster_tile_key const& key);
+    void insert(raster_tile_key const& key, raster_tile_ptr tile);
+    // drops all tiles and resets the statistics
+    void clear();
+    // 0 disables the cache
+    void set_max_bytes(std::size_t max_bytes);
+    std::size_t max_bytes() const;
+    raster_tile_cache_stats stats() const;
+private:
+    raster_tile_cache();
+    ~raster_tile_cache();
+    lru_cache<raster_tile_key, raster_tile_ptr, raster_tile_key_hash, raster_tile_size> cache_;
+};
+
+}
+
+#endif // MAPNIK_RASTER_TILE_CACHE_HPP
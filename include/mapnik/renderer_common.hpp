@@ -33,6 +33,7 @@
 // fwd declarations to speed up compile
 namespace mapnik {
   class label_collision_detector4;
+  class vertex_cache_store;
   class Map;
   class request;
 //  class attributes;
@@ -61,6 +62,8 @@ struct renderer_common : private mapnik::noncopyable
     box2d<double> query_extent_;
     view_transform t_;
     std::shared_ptr<label_collision_detector4> detector_;
+    // measured label paths of the current feature, see text_symbolizer_helper
+    std::shared_ptr<vertex_cache_store> vertex_caches_;
 
 private:
     renderer_common(Map const &m, unsigned width, unsigned height, double scale_factor,
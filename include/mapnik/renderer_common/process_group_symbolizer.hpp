@@ -62,7 +62,7 @@ struct virtual_renderer_common : private mapnik::noncopyable
         font_manager_(common.font_manager_),
         query_extent_(common.query_extent_),
         t_(common.t_),
-        detector_(std::make_shared<label_collision_detector4>(common.detector_->extent())) {}
+        detector_(std::make_shared<label_collision_detector4>(common.detector_->extent(), common.detector_->cell_size())) {}
 
     unsigned & width_;
     unsigned & height_;
@@ -0,0 +1,58 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+
+#ifndef MAPNIK_SIMD_HPP
+#define MAPNIK_SIMD_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+
+// SSE2 is part of the x86-64 baseline and used unconditionally, AVX2
+// kernels are compiled with function level target options and only
+// entered after a runtime cpu check.
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define MAPNIK_SIMD_X86
+#endif
+
+namespace mapnik { namespace simd {
+
+enum level_e : int
+{
+    SCALAR = 0,
+    SSE2,
+    AVX2
+};
+
+// Best instruction set supported by both this build and the cpu.
+MAPNIK_DECL level_e detected_level();
+
+// Instruction set image kernels dispatch on, detected_level() by default.
+MAPNIK_DECL level_e active_level();
+
+// Caps active_level(), mainly to compare code paths in tests and
+// benchmarks. Returns the level now in effect.
+MAPNIK_DECL level_e set_level(level_e level);
+
+}}
+
+#endif // MAPNIK_SIMD_HPP
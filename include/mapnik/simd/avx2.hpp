@@ -0,0 +1,116 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_SIMD_AVX2_HPP
+#define MAPNIK_SIMD_AVX2_HPP
+
+// mapnik
+#include <mapnik/simd.hpp>
+
+#if defined(MAPNIK_SIMD_X86)
+
+// stl
+#include <cstdint>
+
+#include <immintrin.h>
+
+// Functions defined between these markers are compiled for AVX2 regardless
+// of the build flags. Only call them after simd::active_level() said so.
+#if defined(__clang__)
+#define MAPNIK_SIMD_AVX2_BEGIN _Pragma("clang attribute push (__attribute__((target(\"avx2\"))), apply_to = function)")
+#define MAPNIK_SIMD_AVX2_END _Pragma("clang attribute pop")
+#else
+#define MAPNIK_SIMD_AVX2_BEGIN _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+#define MAPNIK_SIMD_AVX2_END _Pragma("GCC pop_options")
+#endif
+
+// Same interface as simd/sse2.hpp on 256 bit registers. Widening and
+// narrowing work within each 128 bit half, which keeps pixel order intact.
+
+MAPNIK_SIMD_AVX2_BEGIN
+
+namespace mapnik { namespace simd { namespace avx2 {
+
+using reg = __m256i;
+
+constexpr unsigned pixels = 8;
+
+inline reg load(std::uint8_t const* p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+inline void store(std::uint8_t * p, reg v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+inline reg zero() { return _mm256_setzero_si256(); }
+inline reg set1(unsigned v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+
+inline reg widen_lo(reg v) { return _mm256_unpacklo_epi8(v, _mm256_setzero_si256()); }
+inline reg widen_hi(reg v) { return _mm256_unpackhi_epi8(v, _mm256_setzero_si256()); }
+inline reg narrow(reg lo, reg hi)
+{
+    reg mask = _mm256_set1_epi16(0xff);
+    return _mm256_packus_epi16(_mm256_and_si256(lo, mask), _mm256_and_si256(hi, mask));
+}
+
+inline reg add(reg a, reg b) { return _mm256_add_epi16(a, b); }
+inline reg sub(reg a, reg b) { return _mm256_sub_epi16(a, b); }
+inline reg mul(reg a, reg b) { return _mm256_mullo_epi16(a, b); }
+inline reg shr8(reg a) { return _mm256_srli_epi16(a, 8); }
+inline reg cmpeq(reg a, reg b) { return _mm256_cmpeq_epi16(a, b); }
+inline reg cmplt(reg a, reg b) { return _mm256_cmpgt_epi16(b, a); }
+inline reg select(reg mask, reg a, reg b) { return _mm256_blendv_epi8(b, a, mask); }
+
+inline reg alpha(reg v) { return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xff), 0xff); }
+inline reg alpha_lanes() { return _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0); }
+
+using freg = __m256;
+
+constexpr unsigned float_pixels = 2;
+
+inline freg fload(std::uint8_t const* p)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(p))));
+}
+inline void fstore(std::uint8_t * p, freg v)
+{
+    reg i = _mm256_cvttps_epi32(v);
+    i = _mm256_packs_epi32(i, i);
+    i = _mm256_packus_epi16(i, i);
+    // first four bytes of each 128 bit half
+    i = _mm256_permutevar8x32_epi32(i, _mm256_set_epi32(0, 0, 0, 0, 0, 0, 4, 0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(i));
+}
+inline freg fset1(float v) { return _mm256_set1_ps(v); }
+inline freg fadd(freg a, freg b) { return _mm256_add_ps(a, b); }
+inline freg fsub(freg a, freg b) { return _mm256_sub_ps(a, b); }
+inline freg fmul(freg a, freg b) { return _mm256_mul_ps(a, b); }
+inline freg fdiv(freg a, freg b) { return _mm256_div_ps(a, b); }
+inline freg fmin(freg a, freg b) { return _mm256_min_ps(a, b); }
+inline freg fmax(freg a, freg b) { return _mm256_max_ps(a, b); }
+inline freg fsqrt(freg a) { return _mm256_sqrt_ps(a); }
+
+inline freg falpha(freg v) { return _mm256_permute_ps(v, 0xff); }
+inline freg fwith_alpha(freg rgb, freg a) { return _mm256_blend_ps(rgb, a, 0x88); }
+
+}}}
+
+MAPNIK_SIMD_AVX2_END
+
+#endif // MAPNIK_SIMD_X86
+
+#endif // MAPNIK_SIMD_AVX2_HPP
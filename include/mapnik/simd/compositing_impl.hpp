@@ -0,0 +1,183 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// NOTE: This is an implementation header file and is only meant to be included
+//    from src/image_compositing.cpp, once per instruction set with
+//    MAPNIK_SIMD_NS naming the namespace of simd/sse2.hpp or simd/avx2.hpp.
+//    It therefore doesn't have an include guard.
+
+namespace mapnik { namespace simd { namespace MAPNIK_SIMD_NS { namespace compositing {
+
+// Vector versions of the agg::comp_op_rgba_* blenders on premultiplied rgba8,
+// producing bit identical results. The formulas follow the agg code term by
+// term, including its rounding.
+
+inline reg apply_cover(reg s, reg cover)
+{
+    return shr8(add(mul(s, cover), set1(255)));
+}
+
+// Sa + Da - Sa.Da, the alpha of all separable modes
+inline reg union_alpha(reg sa, reg da)
+{
+    return sub(add(sa, da), shr8(add(mul(sa, da), set1(255))));
+}
+
+struct src_over
+{
+    using agg_blender = agg::comp_op_rgba_src_over<agg::rgba8, agg::order_rgba>;
+
+    template <bool Partial>
+    static reg blend(reg s, reg d, reg cover)
+    {
+        if (Partial) s = apply_cover(s, cover);
+        reg s1a = sub(set1(255), alpha(s));
+        return add(s, shr8(add(mul(d, s1a), set1(255))));
+    }
+};
+
+struct dst_in
+{
+    using agg_blender = agg::comp_op_rgba_dst_in<agg::rgba8, agg::order_rgba>;
+
+    template <bool Partial>
+    static reg blend(reg s, reg d, reg cover)
+    {
+        reg sa = alpha(s);
+        if (Partial) sa = sub(set1(255), apply_cover(sub(set1(255), sa), cover));
+        return shr8(add(mul(d, sa), set1(255)));
+    }
+};
+
+struct dst_out
+{
+    using agg_blender = agg::comp_op_rgba_dst_out<agg::rgba8, agg::order_rgba>;
+
+    template <bool Partial>
+    static reg blend(reg s, reg d, reg cover)
+    {
+        reg sa = alpha(s);
+        if (Partial) sa = apply_cover(sa, cover);
+        // agg rounds with base_shift instead of base_mask here
+        return shr8(add(mul(d, sub(set1(255), sa)), set1(8)));
+    }
+};
+
+struct multiply
+{
+    using agg_blender = agg::comp_op_rgba_multiply<agg::rgba8, agg::order_rgba>;
+
+    template <bool Partial>
+    static reg blend(reg s, reg d, reg cover)
+    {
+        if (Partial) s = apply_cover(s, cover);
+        reg sa = alpha(s);
+        reg da = alpha(d);
+        reg s1a = sub(set1(255), sa);
+        reg d1a = sub(set1(255), da);
+        reg color = shr8(add(add(add(mul(s, d), mul(s, d1a)), mul(d, s1a)), set1(255)));
+        reg result = select(alpha_lanes(), union_alpha(sa, da), color);
+        // fully transparent source leaves the destination untouched
+        return select(cmpeq(sa, zero()), d, result);
+    }
+};
+
+struct screen
+{
+    using agg_blender = agg::comp_op_rgba_screen<agg::rgba8, agg::order_rgba>;
+
+    template <bool Partial>
+    static reg blend(reg s, reg d, reg cover)
+    {
+        if (Partial) s = apply_cover(s, cover);
+        reg result = sub(add(s, d), shr8(add(mul(s, d), set1(255))));
+        return select(cmpeq(alpha(s), zero()), d, result);
+    }
+};
+
+struct overlay
+{
+    using agg_blender = agg::comp_op_rgba_overlay<agg::rgba8, agg::order_rgba>;
+
+    template <bool Partial>
+    static reg blend(reg s, reg d, reg cover)
+    {
+        if (Partial) s = apply_cover(s, cover);
+        reg sa = alpha(s);
+        reg da = alpha(d);
+        reg s1a = sub(set1(255), sa);
+        reg d1a = sub(set1(255), da);
+        reg rest = add(mul(s, d1a), mul(d, s1a));
+        // 2.Dca < Da ? 2.Sca.Dca + rest : Sa.Da - 2.(Da - Dca).(Sa - Sca) + rest
+        reg dark = add(mul(add(s, s), d), rest);
+        reg ddiff = sub(da, d);
+        reg light = add(sub(mul(sa, da), mul(add(ddiff, ddiff), sub(sa, s))), add(rest, set1(255)));
+        reg color = shr8(select(cmplt(add(d, d), da), dark, light));
+        reg result = select(alpha_lanes(), union_alpha(sa, da), color);
+        return select(cmpeq(sa, zero()), d, result);
+    }
+};
+
+using row_func = void (*)(std::uint8_t *, std::uint8_t const*, unsigned, unsigned);
+
+template <typename Blend, bool Partial>
+void blend_row(std::uint8_t * dst, std::uint8_t const* src, unsigned len, unsigned cover)
+{
+    reg c = set1(cover);
+    unsigned x = 0;
+    for (; x + pixels <= len; x += pixels)
+    {
+        reg s = load(src + x * 4);
+        reg d = load(dst + x * 4);
+        reg lo = Blend::template blend<Partial>(widen_lo(s), widen_lo(d), c);
+        reg hi = Blend::template blend<Partial>(widen_hi(s), widen_hi(d), c);
+        store(dst + x * 4, narrow(lo, hi));
+    }
+    for (; x < len; ++x)
+    {
+        std::uint8_t const* p = src + x * 4;
+        Blend::agg_blender::blend_pix(dst + x * 4, p[0], p[1], p[2], p[3], cover);
+    }
+}
+
+template <typename Blend>
+row_func select_row(unsigned cover)
+{
+    return cover < 255 ? &blend_row<Blend, true> : &blend_row<Blend, false>;
+}
+
+// nullptr for modes without a vector implementation
+inline row_func composite_row(composite_mode_e mode, unsigned cover)
+{
+    switch (mode)
+    {
+    case mapnik::src_over: return select_row<src_over>(cover);
+    case mapnik::dst_in: return select_row<dst_in>(cover);
+    case mapnik::dst_out: return select_row<dst_out>(cover);
+    case mapnik::multiply: return select_row<multiply>(cover);
+    case mapnik::screen: return select_row<screen>(cover);
+    case mapnik::overlay: return select_row<overlay>(cover);
+    default: return nullptr;
+    }
+}
+
+}}}}
@@ -0,0 +1,324 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// NOTE: This is an implementation header file and is only meant to be included
+//    from src/image_filter.cpp, once per instruction set with MAPNIK_SIMD_NS
+//    naming the namespace. It therefore doesn't have an include guard.
+
+namespace mapnik { namespace filter { namespace detail { namespace MAPNIK_SIMD_NS {
+
+namespace lanes = mapnik::simd::MAPNIK_SIMD_NS;
+
+// The kernels repeat the arithmetic of the scalar filters operation by
+// operation and produce the same bytes. Those without explicit float lanes
+// are loops over independent bytes, laid out for the compiler to vectorize
+// for the instruction set they are compiled for.
+
+struct stack_blur_state
+{
+    std::vector<std::uint32_t> sum;
+    std::vector<std::uint32_t> sum_in;
+    std::vector<std::uint32_t> sum_out;
+    std::vector<std::uint8_t> stack;
+};
+
+// agg::stack_blur_rgba32 along `len` steps of `stride` bytes, for `lanes`
+// consecutive bytes at a time. Like agg it works in place, so the source
+// of the last steps is read after it has been written.
+inline void stack_blur_lanes(std::uint8_t * data, unsigned lanes, unsigned len,
+                             std::size_t stride, unsigned r, stack_blur_state & state)
+{
+    unsigned div = r * 2 + 1;
+    std::uint32_t mul_sum = agg::stack_blur_tables<int>::g_stack_blur8_mul[r];
+    std::uint32_t shr_sum = agg::stack_blur_tables<int>::g_stack_blur8_shr[r];
+    unsigned lm = len - 1;
+
+    state.sum.assign(lanes, 0);
+    state.sum_in.assign(lanes, 0);
+    state.sum_out.assign(lanes, 0);
+    state.stack.resize(div * lanes);
+    std::uint32_t * sum = state.sum.data();
+    std::uint32_t * sum_in = state.sum_in.data();
+    std::uint32_t * sum_out = state.sum_out.data();
+
+    std::uint8_t const* src = data;
+    for (unsigned i = 0; i <= r; ++i)
+    {
+        std::uint8_t * s = &state.stack[i * lanes];
+        for (unsigned l = 0; l < lanes; ++l)
+        {
+            s[l] = src[l];
+            sum[l] += src[l] * (i + 1);
+            sum_out[l] += src[l];
+        }
+    }
+    for (unsigned i = 1; i <= r; ++i)
+    {
+        if (i <= lm) src += stride;
+        std::uint8_t * s = &state.stack[(i + r) * lanes];
+        for (unsigned l = 0; l < lanes; ++l)
+        {
+            s[l] = src[l];
+            sum[l] += src[l] * (r + 1 - i);
+            sum_in[l] += src[l];
+        }
+    }
+
+    unsigned stack_ptr = r;
+    unsigned ip = r < lm ? r : lm;
+    src = data + ip * stride;
+    std::uint8_t * dst = data;
+    for (unsigned i = 0; i < len; ++i)
+    {
+        for (unsigned l = 0; l < lanes; ++l)
+        {
+            dst[l] = static_cast<std::uint8_t>((sum[l] * mul_sum) >> shr_sum);
+            sum[l] -= sum_out[l];
+        }
+        dst += stride;
+
+        unsigned stack_start = stack_ptr + div - r;
+        if (stack_start >= div) stack_start -= div;
+        if (ip < lm)
+        {
+            src += stride;
+            ++ip;
+        }
+        std::uint8_t * s = &state.stack[stack_start * lanes];
+        for (unsigned l = 0; l < lanes; ++l)
+        {
+            sum_out[l] -= s[l];
+            s[l] = src[l];
+            sum_in[l] += src[l];
+            sum[l] += sum_in[l];
+        }
+
+        if (++stack_ptr >= div) stack_ptr = 0;
+        s = &state.stack[stack_ptr * lanes];
+        for (unsigned l = 0; l < lanes; ++l)
+        {
+            sum_out[l] += s[l];
+            sum_in[l] -= s[l];
+        }
+    }
+}
+
+// Horizontal pass over rows [y0, y1): blocks of rows are transposed so that
+// each row becomes a group of four lanes.
+inline void stack_blur_rows(std::uint8_t * data, unsigned width, unsigned y0, unsigned y1, unsigned r)
+{
+    const unsigned block = 16;
+    std::vector<std::uint32_t> tmp(width * block);
+    stack_blur_state state;
+    for (unsigned y = y0; y < y1; y += block)
+    {
+        unsigned rows = std::min(block, y1 - y);
+        for (unsigned k = 0; k < rows; ++k)
+        {
+            std::uint32_t const* row = reinterpret_cast<std::uint32_t const*>(data + (y + k) * width * 4);
+            for (unsigned x = 0; x < width; ++x) tmp[x * rows + k] = row[x];
+        }
+        stack_blur_lanes(reinterpret_cast<std::uint8_t*>(tmp.data()), rows * 4, width, rows * 4, r, state);
+        for (unsigned k = 0; k < rows; ++k)
+        {
+            std::uint32_t * row = reinterpret_cast<std::uint32_t*>(data + (y + k) * width * 4);
+            for (unsigned x = 0; x < width; ++x) row[x] = tmp[x * rows + k];
+        }
+    }
+}
+
+// Vertical pass over columns [x0, x1), all of them advance together.
+inline void stack_blur_columns(std::uint8_t * data, unsigned width, unsigned height,
+                               unsigned x0, unsigned x1, unsigned r)
+{
+    stack_blur_state state;
+    stack_blur_lanes(data + x0 * 4, (x1 - x0) * 4, height, width * 4, r, state);
+}
+
+// 3x3 kernels see their neighbourhood as rows a (above), b and c (below),
+// on single floats for edge pixels and on float lanes for the rest.
+struct convolution
+{
+    float const* k;
+
+    float operator() (float a0, float a1, float a2,
+                      float b0, float b1, float b2,
+                      float c0, float c1, float c2) const
+    {
+        return k[0]*a0 + k[1]*a1 + k[2]*a2 +
+            k[3]*b0 + k[4]*b1 + k[5]*b2 +
+            k[6]*c0 + k[7]*c1 + k[8]*c2;
+    }
+
+    lanes::freg operator() (lanes::freg a0, lanes::freg a1, lanes::freg a2,
+                            lanes::freg b0, lanes::freg b1, lanes::freg b2,
+                            lanes::freg c0, lanes::freg c1, lanes::freg c2) const
+    {
+        using namespace lanes;
+        freg sum = fmul(fset1(k[0]), a0);
+        sum = fadd(sum, fmul(fset1(k[1]), a1));
+        sum = fadd(sum, fmul(fset1(k[2]), a2));
+        sum = fadd(sum, fmul(fset1(k[3]), b0));
+        sum = fadd(sum, fmul(fset1(k[4]), b1));
+        sum = fadd(sum, fmul(fset1(k[5]), b2));
+        sum = fadd(sum, fmul(fset1(k[6]), c0));
+        sum = fadd(sum, fmul(fset1(k[7]), c1));
+        return fadd(sum, fmul(fset1(k[8]), c2));
+    }
+};
+
+struct sobel_gradient
+{
+    float operator() (float a0, float a1, float a2,
+                      float b0, float, float b2,
+                      float c0, float c1, float c2) const
+    {
+        float x_gradient = (a2 + 2*b2 + c2) - (a0 + 2*b0 + c0);
+        float y_gradient = (a0 + 2*a1 + a2) - (c0 + 2*c1 + c2);
+        return static_cast<float>(std::sqrt(static_cast<double>(x_gradient) * x_gradient +
+                                             static_cast<double>(y_gradient) * y_gradient));
+    }
+
+    // The gradients are small integers, so their squares are exact in float
+    // and the single precision root truncates to the same channel value.
+    lanes::freg operator() (lanes::freg a0, lanes::freg a1, lanes::freg a2,
+                            lanes::freg b0, lanes::freg, lanes::freg b2,
+                            lanes::freg c0, lanes::freg c1, lanes::freg c2) const
+    {
+        using namespace lanes;
+        freg two = fset1(2.0f);
+        freg x_gradient = fsub(fadd(fadd(a2, fmul(two, b2)), c2), fadd(fadd(a0, fmul(two, b0)), c0));
+        freg y_gradient = fsub(fadd(fadd(a0, fmul(two, a1)), a2), fadd(fadd(c0, fmul(two, c1)), c2));
+        return fsqrt(fadd(fmul(x_gradient, x_gradient), fmul(y_gradient, y_gradient)));
+    }
+};
+
+inline std::uint8_t clamp_channel(float value)
+{
+    if (value < 0) value = 0;
+    if (value > 255) value = 255;
+    return static_cast<std::uint8_t>(value);
+}
+
+// One output row of a 3x3 filter: the colour channels are filtered
+// with edge pixels repeated, alpha is copied.
+template <typename Kernel>
+void filter_3x3_row(std::uint8_t const* a, std::uint8_t const* b, std::uint8_t const* c,
+                    std::uint8_t * out, unsigned width, Kernel const& kernel)
+{
+    using namespace lanes;
+    unsigned x = 1;
+    for (; x + float_pixels < width; x += float_pixels)
+    {
+        unsigned j = x * 4;
+        fstore(out + j, kernel(fload(a + j - 4), fload(a + j), fload(a + j + 4),
+                               fload(b + j - 4), fload(b + j), fload(b + j + 4),
+                               fload(c + j - 4), fload(c + j), fload(c + j + 4)));
+    }
+    for (unsigned j = x * 4; j + 4 < width * 4; ++j)
+    {
+        out[j] = clamp_channel(kernel(float(a[j - 4]), float(a[j]), float(a[j + 4]),
+                                      float(b[j - 4]), float(b[j]), float(b[j + 4]),
+                                      float(c[j - 4]), float(c[j]), float(c[j + 4])));
+    }
+    unsigned last = (width - 1) * 4;
+    unsigned step = width > 1 ? 4 : 0;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        out[i] = clamp_channel(kernel(float(a[i]), float(a[i]), float(a[i + step]),
+                                      float(b[i]), float(b[i]), float(b[i + step]),
+                                      float(c[i]), float(c[i]), float(c[i + step])));
+        unsigned j = last + i;
+        out[j] = clamp_channel(kernel(float(a[j - step]), float(a[j]), float(a[j]),
+                                      float(b[j - step]), float(b[j]), float(b[j]),
+                                      float(c[j - step]), float(c[j]), float(c[j])));
+    }
+    for (unsigned i = 0; i < width; ++i)
+    {
+        out[i * 4 + 3] = b[i * 4 + 3];
+    }
+}
+
+// Rows [y0, y1) of the filtered image; the first and last row use their
+// single neighbour row on both sides.
+template <typename Kernel>
+void filter_3x3(std::uint8_t const* src, std::uint8_t * dst, unsigned width, unsigned height,
+                unsigned y0, unsigned y1, Kernel const& kernel)
+{
+    std::size_t stride = width * 4;
+    for (unsigned y = y0; y < y1; ++y)
+    {
+        std::uint8_t const* b = src + y * stride;
+        std::uint8_t const* a = (y > 0) ? b - stride : (height > 1 ? b + stride : b);
+        std::uint8_t const* c = (y + 1 < height) ? b + stride : (height > 1 ? b - stride : b);
+        filter_3x3_row(a, b, c, dst + y * stride, width, kernel);
+    }
+}
+
+inline void convolve_3x3(std::uint8_t const* src, std::uint8_t * dst, unsigned width, unsigned height,
+                         unsigned y0, unsigned y1, float const* matrix)
+{
+    filter_3x3(src, dst, width, height, y0, y1, convolution{matrix});
+}
+
+inline void sobel_3x3(std::uint8_t const* src, std::uint8_t * dst, unsigned width, unsigned height,
+                  unsigned y0, unsigned y1)
+{
+    filter_3x3(src, dst, width, height, y0, y1, sobel_gradient());
+}
+
+// Replaces every pixel with non zero alpha by the table entry for its
+// alpha, entries hold whole pixels in memory order.
+inline void map_alpha(std::uint8_t * data, std::size_t size, std::uint32_t const* lut)
+{
+    std::uint32_t * pixels = reinterpret_cast<std::uint32_t*>(data);
+    for (std::size_t i = 0; i < size; i += 4)
+    {
+        std::uint8_t a = data[i + 3];
+        if (a) pixels[i / 4] = lut[a];
+    }
+}
+
+inline void to_gray(std::uint8_t * data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i += 4)
+    {
+        unsigned r = data[i];
+        unsigned g = data[i + 1];
+        unsigned b = data[i + 2];
+        std::uint8_t v = static_cast<std::uint8_t>((4915 * r + 9667 * g + 1802 * b + 8192) >> 14);
+        data[i] = data[i + 1] = data[i + 2] = v;
+    }
+}
+
+inline void invert_colors(std::uint8_t * data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i += 4)
+    {
+        std::uint8_t a = data[i + 3];
+        data[i] = static_cast<std::uint8_t>(a - data[i]);
+        data[i + 1] = static_cast<std::uint8_t>(a - data[i + 1]);
+        data[i + 2] = static_cast<std::uint8_t>(a - data[i + 2]);
+    }
+}
+
+}}}}
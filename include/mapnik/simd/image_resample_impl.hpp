@@ -0,0 +1,95 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// NOTE: This is an implementation header file and is only meant to be included
+//    from src/image_scaling.cpp, once per instruction set with MAPNIK_SIMD_NS
+//    naming the namespace. It therefore doesn't have an include guard.
+
+namespace mapnik { namespace resample { namespace MAPNIK_SIMD_NS {
+
+// Plain loops over floats, laid out for the compiler to vectorize for the
+// instruction set they are compiled for.
+
+// one source row filtered horizontally into width * 4 channels
+inline void horizontal(float * out, std::uint8_t const* row, unsigned width,
+                       int const* start, float const* weights, unsigned taps)
+{
+    for (unsigned x = 0; x < width; ++x)
+    {
+        std::uint8_t const* p = row + start[x] * 4;
+        float const* w = weights + std::size_t(x) * taps;
+        float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (unsigned k = 0; k < taps; ++k, p += 4)
+        {
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                acc[c] += w[k] * p[c];
+            }
+        }
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            out[x * 4 + c] = acc[c];
+        }
+    }
+}
+
+// weighted sum of `taps` horizontally filtered rows
+inline void vertical(float * out, float const* const* rows, float const* weights,
+                     unsigned taps, std::size_t size)
+{
+    float w = weights[0];
+    float const* row = rows[0];
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        out[i] = w * row[i];
+    }
+    for (unsigned k = 1; k < taps; ++k)
+    {
+        w = weights[k];
+        row = rows[k];
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            out[i] += w * row[i];
+        }
+    }
+}
+
+// rounds and clamps like agg: channels to 0..255, colors to at most alpha
+inline void store_row(std::uint8_t * out, float const* acc, unsigned width)
+{
+    for (unsigned x = 0; x < width; ++x, out += 4, acc += 4)
+    {
+        std::int32_t v[4];
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            float f = acc[c] + 0.5f;
+            v[c] = static_cast<std::int32_t>(f < 0.0f ? 0.0f : f);
+        }
+        std::int32_t a = v[3] > 255 ? 255 : v[3];
+        out[0] = static_cast<std::uint8_t>(v[0] > a ? a : v[0]);
+        out[1] = static_cast<std::uint8_t>(v[1] > a ? a : v[1]);
+        out[2] = static_cast<std::uint8_t>(v[2] > a ? a : v[2]);
+        out[3] = static_cast<std::uint8_t>(a);
+    }
+}
+
+}}}
@@ -0,0 +1,78 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// NOTE: This is an implementation header file and is only meant to be included
+//    from src/graphics.cpp, once per instruction set with MAPNIK_SIMD_NS
+//    naming the namespace of simd/sse2.hpp or simd/avx2.hpp.
+//    It therefore doesn't have an include guard.
+
+namespace mapnik { namespace simd { namespace MAPNIK_SIMD_NS { namespace premultiplication {
+
+// Same results as agg::multiplier_rgba. Its special cases need no branches:
+// (c * 255 + 255) >> 8 == c, and c * 255 / 255 == c for opaque pixels.
+
+inline reg premultiply_pixels(reg v)
+{
+    reg p = shr8(add(mul(v, alpha(v)), set1(255)));
+    return select(alpha_lanes(), v, p);
+}
+
+inline void premultiply_row(std::uint8_t * p, unsigned width)
+{
+    using multiplier = agg::multiplier_rgba<agg::rgba8, agg::order_rgba>;
+    unsigned x = 0;
+    for (; x + pixels <= width; x += pixels, p += pixels * 4)
+    {
+        reg v = load(p);
+        store(p, narrow(premultiply_pixels(widen_lo(v)), premultiply_pixels(widen_hi(v))));
+    }
+    for (; x < width; ++x, p += 4)
+    {
+        multiplier::premultiply(p);
+    }
+}
+
+// c * 255 / a in float is exact after truncation: whenever the quotient is
+// below 256 its rounding error is far smaller than its distance to the next
+// integer. Larger quotients saturate in fstore like agg clamps them.
+inline void demultiply_row(std::uint8_t * p, unsigned width)
+{
+    using multiplier = agg::multiplier_rgba<agg::rgba8, agg::order_rgba>;
+    freg one = fset1(1.0f);
+    freg base_mask = fset1(255.0f);
+    unsigned x = 0;
+    for (; x + float_pixels <= width; x += float_pixels, p += float_pixels * 4)
+    {
+        freg v = fload(p);
+        freg a = falpha(v);
+        freg q = fdiv(fmul(v, base_mask), fmax(a, one));
+        // transparent pixels become all zero
+        q = fmul(q, fmin(a, one));
+        fstore(p, fwith_alpha(q, v));
+    }
+    for (; x < width; ++x, p += 4)
+    {
+        multiplier::demultiply(p);
+    }
+}
+
+}}}}
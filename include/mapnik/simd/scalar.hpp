@@ -0,0 +1,69 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_SIMD_SCALAR_HPP
+#define MAPNIK_SIMD_SCALAR_HPP
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Portable stand in for the float lane interface of simd/sse2.hpp, used
+// at simd::SCALAR level and on other architectures.
+
+namespace mapnik { namespace simd { namespace scalar {
+
+struct freg
+{
+    float v[4];
+};
+
+constexpr unsigned float_pixels = 1;
+
+inline freg fload(std::uint8_t const* p)
+{
+    return freg{{ float(p[0]), float(p[1]), float(p[2]), float(p[3]) }};
+}
+inline void fstore(std::uint8_t * p, freg const& a)
+{
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        int v = static_cast<int>(a.v[i]);
+        p[i] = static_cast<std::uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+}
+inline freg fset1(float v) { return freg{{ v, v, v, v }}; }
+inline freg fadd(freg const& a, freg const& b) { return freg{{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }}; }
+inline freg fsub(freg const& a, freg const& b) { return freg{{ a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }}; }
+inline freg fmul(freg const& a, freg const& b) { return freg{{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }}; }
+inline freg fdiv(freg const& a, freg const& b) { return freg{{ a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] }}; }
+inline freg fmin(freg const& a, freg const& b) { return freg{{ std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]) }}; }
+inline freg fmax(freg const& a, freg const& b) { return freg{{ std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3]) }}; }
+inline freg fsqrt(freg const& a) { return freg{{ std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]) }}; }
+
+inline freg falpha(freg const& a) { return fset1(a.v[3]); }
+inline freg fwith_alpha(freg const& rgb, freg const& a) { return freg{{ rgb.v[0], rgb.v[1], rgb.v[2], a.v[3] }}; }
+
+}}}
+
+#endif // MAPNIK_SIMD_SCALAR_HPP
@@ -0,0 +1,119 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_SIMD_SSE2_HPP
+#define MAPNIK_SIMD_SSE2_HPP
+
+// mapnik
+#include <mapnik/simd.hpp>
+
+#if defined(MAPNIK_SIMD_X86)
+
+// stl
+#include <cstdint>
+#include <cstring>
+
+#include <emmintrin.h>
+
+// Building blocks for image kernels working on widened rgba pixels: every
+// 8 bit channel sits in a 16 bit lane so that products of two channels fit.
+// Lane arithmetic wraps like the unsigned math of the agg blenders, whose
+// results are the low 8 bits of (expression >> 8).
+
+namespace mapnik { namespace simd { namespace sse2 {
+
+using reg = __m128i;
+
+// rgba pixels held by one register before widening
+constexpr unsigned pixels = 4;
+
+inline reg load(std::uint8_t const* p) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+inline void store(std::uint8_t * p, reg v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline reg zero() { return _mm_setzero_si128(); }
+inline reg set1(unsigned v) { return _mm_set1_epi16(static_cast<short>(v)); }
+
+inline reg widen_lo(reg v) { return _mm_unpacklo_epi8(v, _mm_setzero_si128()); }
+inline reg widen_hi(reg v) { return _mm_unpackhi_epi8(v, _mm_setzero_si128()); }
+// keeps the low 8 bits of every lane, as a cast to the channel type would
+inline reg narrow(reg lo, reg hi)
+{
+    reg mask = _mm_set1_epi16(0xff);
+    return _mm_packus_epi16(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+}
+
+inline reg add(reg a, reg b) { return _mm_add_epi16(a, b); }
+inline reg sub(reg a, reg b) { return _mm_sub_epi16(a, b); }
+inline reg mul(reg a, reg b) { return _mm_mullo_epi16(a, b); }
+inline reg shr8(reg a) { return _mm_srli_epi16(a, 8); }
+inline reg cmpeq(reg a, reg b) { return _mm_cmpeq_epi16(a, b); }
+inline reg cmplt(reg a, reg b) { return _mm_cmplt_epi16(a, b); }
+// lanes of a where mask is set, of b elsewhere
+inline reg select(reg mask, reg a, reg b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+// alpha of every widened pixel copied to its four lanes
+inline reg alpha(reg v) { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xff), 0xff); }
+// mask of the alpha lanes
+inline reg alpha_lanes() { return _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0); }
+
+// Float lanes, one per channel, for kernels that mirror scalar float code.
+using freg = __m128;
+
+constexpr unsigned float_pixels = 1;
+
+inline freg fload(std::uint8_t const* p)
+{
+    int v;
+    std::memcpy(&v, p, 4);
+    reg z = _mm_setzero_si128();
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), z), z));
+}
+// truncates and saturates to 0..255, as clamping before a cast to uint8 does
+inline void fstore(std::uint8_t * p, freg v)
+{
+    reg i = _mm_cvttps_epi32(v);
+    i = _mm_packs_epi32(i, i);
+    int out = _mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+    std::memcpy(p, &out, 4);
+}
+inline freg fset1(float v) { return _mm_set1_ps(v); }
+inline freg fadd(freg a, freg b) { return _mm_add_ps(a, b); }
+inline freg fsub(freg a, freg b) { return _mm_sub_ps(a, b); }
+inline freg fmul(freg a, freg b) { return _mm_mul_ps(a, b); }
+inline freg fdiv(freg a, freg b) { return _mm_div_ps(a, b); }
+inline freg fmin(freg a, freg b) { return _mm_min_ps(a, b); }
+inline freg fmax(freg a, freg b) { return _mm_max_ps(a, b); }
+inline freg fsqrt(freg a) { return _mm_sqrt_ps(a); }
+
+// alpha of every pixel copied to its four lanes
+inline freg falpha(freg v) { return _mm_shuffle_ps(v, v, 0xff); }
+// color lanes of rgb with the alpha lane of a
+inline freg fwith_alpha(freg rgb, freg a)
+{
+    freg mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, rgb));
+}
+
+}}}
+
+#endif // MAPNIK_SIMD_X86
+
+#endif // MAPNIK_SIMD_SSE2_HPP
@@ -92,6 +92,7 @@ enum class keys : std::uint8_t
     upright,
     avoid_edges,
     font_feature_settings,
+    label_priority,
     MAX_SYMBOLIZER_KEY
 };
 
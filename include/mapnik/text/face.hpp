@@ -48,7 +48,8 @@ class font_face : mapnik::noncopyable
 {
 public:
     using glyph_info_cache_type = std::unordered_map<glyph_index_t, glyph_info>;
-    font_face(FT_Face face);
+    // file_name and face_index identify the font the face was loaded from
+    font_face(FT_Face face, std::string const& file_name, int face_index);
 
     std::string family_name() const
     {
@@ -65,6 +66,13 @@ public:
         return face_;
     }
 
+    // same for every face loaded from the same font file and face index,
+    // used to share rasterized glyphs and shaping results between renderers
+    unsigned id() const
+    {
+        return id_;
+    }
+
     double get_char_height(double size) const;
 
     bool set_character_sizes(double size);
@@ -76,6 +84,7 @@ public:
 
 private:
     FT_Face face_;
+    unsigned id_;
     mutable glyph_info_cache_type glyph_info_cache_;
     mutable double char_height_;
 };
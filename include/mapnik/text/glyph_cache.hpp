@@ -0,0 +1,143 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_GLYPH_CACHE_HPP
+#define MAPNIK_GLYPH_CACHE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/utils.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/lru_cache.hpp>
+#include <mapnik/util/hash_combine.hpp>
+#include <mapnik/text/glyph_info.hpp>
+
+// stl
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mapnik
+{
+
+// 8 bit coverage bitmap of one rasterized glyph or halo. left/top follow the
+// FreeType convention and are relative to the integer pen position.
+struct glyph_bitmap
+{
+    int left;
+    int top;
+    unsigned width;
+    unsigned rows;
+    std::vector<std::uint8_t> buffer;
+};
+
+using glyph_bitmap_ptr = std::shared_ptr<glyph_bitmap const>;
+
+struct glyph_cache_key
+{
+    unsigned face_id;
+    glyph_index_t glyph_index;
+    // character size in 26.6
+    std::int32_t size;
+    // cosine and sine of the rotation in 16.16, as FreeType gets them
+    std::int32_t rotation_cos;
+    std::int32_t rotation_sin;
+    // fractional pen offset in 26.6, see glyph_cache::set_snapping
+    std::int32_t subpixel_x;
+    std::int32_t subpixel_y;
+    // stroker radius in 26.6, -1 for the plain glyph
+    std::int32_t halo_radius;
+
+    bool operator==(glyph_cache_key const& rhs) const
+    {
+        return face_id == rhs.face_id &&
+            glyph_index == rhs.glyph_index &&
+            size == rhs.size &&
+            rotation_cos == rhs.rotation_cos &&
+            rotation_sin == rhs.rotation_sin &&
+            subpixel_x == rhs.subpixel_x &&
+            subpixel_y == rhs.subpixel_y &&
+            halo_radius == rhs.halo_radius;
+    }
+};
+
+struct glyph_cache_key_hash
+{
+    std::size_t operator()(glyph_cache_key const& key) const
+    {
+        std::size_t seed = key.face_id;
+        util::hash_combine(seed, key.glyph_index);
+        util::hash_combine(seed, static_cast<std::size_t>(key.size));
+        util::hash_combine(seed, static_cast<std::size_t>(key.rotation_cos));
+        util::hash_combine(seed, static_cast<std::size_t>(key.rotation_sin));
+        util::hash_combine(seed, static_cast<std::size_t>((key.subpixel_x << 8) | key.subpixel_y));
+        util::hash_combine(seed, static_cast<std::size_t>(key.halo_radius));
+        return seed;
+    }
+};
+
+struct glyph_bitmap_size
+{
+    std::size_t operator()(glyph_cache_key const&, glyph_bitmap_ptr const& bitmap) const
+    {
+        return bitmap->buffer.size() + sizeof(glyph_bitmap) + sizeof(glyph_cache_key);
+    }
+};
+
+// Process wide LRU cache of rasterized glyph and halo bitmaps shared by all
+// renderers. Rasterization happens outside of the lock; when two threads
+// miss on the same key the second insert simply wins.
+class MAPNIK_DECL glyph_cache :
+        public singleton<glyph_cache, CreateUsingNew>,
+        private mapnik::noncopyable
+{
+    friend class CreateUsingNew<glyph_cache>;
+public:
+    glyph_bitmap_ptr find(glyph_cache_key const& key);
+    void insert(glyph_cache_key const& key, glyph_bitmap_ptr bitmap);
+    void clear();
+    // 0 disables the cache, text is then rasterized as it was before
+    void set_max_bytes(std::size_t max_bytes);
+    std::size_t max_bytes() const;
+    std::size_t size() const;
+    std::size_t bytes() const;
+    // Glyphs are cached at the exact 26.6 pen offset and rotation they are
+    // drawn at, so cached text matches uncached text; only full halos,
+    // stroked at the subpixel offset, can differ slightly at their edges.
+    // Snapping pen offsets to multiples of subpixel_step (in 1/64 pixel) and
+    // rotations to 1/rotation_steps of a turn (0 keeps them exact) gets more
+    // hits on curved labels, at the price of moving glyphs by up to half a step.
+    void set_snapping(unsigned subpixel_step, unsigned rotation_steps);
+    unsigned subpixel_step() const;
+    unsigned rotation_steps() const;
+private:
+    glyph_cache();
+    ~glyph_cache();
+    lru_cache<glyph_cache_key, glyph_bitmap_ptr, glyph_cache_key_hash, glyph_bitmap_size> cache_;
+    std::atomic<unsigned> subpixel_step_;
+    std::atomic<unsigned> rotation_steps_;
+};
+
+}
+
+#endif // MAPNIK_GLYPH_CACHE_HPP
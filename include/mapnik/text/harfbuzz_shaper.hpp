@@ -28,10 +28,15 @@
 #include <mapnik/text/text_line.hpp>
 #include <mapnik/text/face.hpp>
 #include <mapnik/text/font_feature_settings.hpp>
+#include <mapnik/text/shaping_cache.hpp>
 
 // stl
 #include <list>
+#include <map>
+#include <memory>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 // harfbuzz
 #include <harfbuzz/hb.h>
@@ -58,6 +63,108 @@ static inline const uint16_t * uchar_to_utf16(const UChar* src)
 
 struct harfbuzz_shaper
 {
+static void add_glyph(text_line & line,
+                      std::map<unsigned,double> & width_map,
+                      face_ptr const& face,
+                      evaluated_format_properties_ptr const& format,
+                      shaped_glyph const& shaped,
+                      double size,
+                      double scale_factor)
+{
+    glyph_info tmp;
+    tmp.glyph_index = shaped.glyph_index;
+    if (face->glyph_dimensions(tmp))
+    {
+        tmp.char_index = shaped.cluster;
+        tmp.face = face;
+        tmp.format = format;
+        tmp.scale_multiplier = size / face->get_face()->units_per_EM;
+        //Overwrite default advance with better value provided by HarfBuzz
+        tmp.unscaled_advance = shaped.x_advance;
+
+        tmp.offset.set(shaped.x_offset * tmp.scale_multiplier, shaped.y_offset * tmp.scale_multiplier);
+        width_map[shaped.cluster] += tmp.advance();
+        line.add_glyph(tmp, scale_factor);
+    }
+}
+
+// Everything the shaping result depends on apart from the text itself.
+// Face names are resolved to the fonts they stand for: maps may register
+// different fonts under the same name.
+static void make_key_params(text_itemizer const& itemizer,
+                            unsigned start,
+                            unsigned end,
+                            double scale_factor,
+                            face_manager_freetype & font_manager,
+                            std::string & params)
+{
+    auto append = [&params](void const* data, std::size_t size)
+    {
+        params.append(static_cast<char const*>(data), size);
+    };
+    append(&start, sizeof(start));
+    append(&end, sizeof(end));
+    append(&scale_factor, sizeof(scale_factor));
+    itemizer.visit_formats(start, end, [&](unsigned run_start, unsigned run_end, evaluated_format_properties_ptr const& format)
+    {
+        append(&run_start, sizeof(run_start));
+        append(&run_end, sizeof(run_end));
+        append(&format->text_size, sizeof(format->text_size));
+        face_set_ptr face_set = font_manager.get_face_set(format->face_name, format->fontset);
+        unsigned num_faces = face_set->size();
+        append(&num_faces, sizeof(num_faces));
+        for (auto const& face : *face_set)
+        {
+            unsigned id = face->id();
+            append(&id, sizeof(id));
+        }
+        font_feature_settings const& features = *format->font_feature_settings;
+        append(features.get_features(), features.count() * sizeof(font_feature_settings::font_feature));
+    });
+}
+
+// Rebuild a line from a cached shaping result without touching ICU or HarfBuzz.
+// Returns false, leaving the line untouched, if a face can not be resolved to
+// the font it was shaped with.
+static bool replay(shaped_line const& shaped,
+                   text_line & line,
+                   text_itemizer const& itemizer,
+                   std::map<unsigned,double> & width_map,
+                   face_manager_freetype & font_manager,
+                   double scale_factor)
+{
+    std::vector<face_ptr> faces;
+    faces.reserve(shaped.items.size());
+    for (auto const& item : shaped.items)
+    {
+        face_ptr face;
+        if (item.face_index >= 0)
+        {
+            evaluated_format_properties_ptr const& format = itemizer.format_at(item.start);
+            face_set_ptr face_set = font_manager.get_face_set(format->face_name, format->fontset);
+            if (static_cast<unsigned>(item.face_index) >= face_set->size()) return false;
+            face = *(face_set->begin() + item.face_index);
+            if (face->id() != item.face_id) return false;
+        }
+        faces.push_back(face);
+    }
+    for (std::size_t i = 0; i < faces.size(); ++i)
+    {
+        face_ptr const& face = faces[i];
+        if (!face) continue;
+        shaped_item const& item = shaped.items[i];
+        evaluated_format_properties_ptr const& format = itemizer.format_at(item.start);
+        double size = format->text_size * scale_factor;
+        face->set_unscaled_character_sizes();
+        for (auto const& glyph : item.glyphs)
+        {
+            add_glyph(line, width_map, face, format, glyph, size, scale_factor);
+        }
+        line.update_max_char_height(face->get_char_height(size));
+    }
+    return true;
+}
+
 static void shape_text(text_line & line,
                        text_itemizer & itemizer,
                        std::map<unsigned,double> & width_map,
@@ -69,6 +176,18 @@ static void shape_text(text_line & line,
     size_t length = end - start;
     if (!length) return;
     line.reserve(length);
+
+    shaping_cache & cache = shaping_cache::instance();
+    shaping_key key;
+    key.text = itemizer.text();
+    make_key_params(itemizer, start, end, scale_factor, font_manager, key.params);
+    shaped_line_ptr cached = cache.find(key);
+    if (cached && replay(*cached, line, itemizer, width_map, font_manager, scale_factor))
+    {
+        return;
+    }
+    auto shaped = std::make_shared<shaped_line>();
+
     std::list<text_item> const& list = itemizer.itemize(start, end);
 
     auto hb_buffer_deleter = [](hb_buffer_t * buffer) { hb_buffer_destroy(buffer);};
@@ -85,6 +204,11 @@ static void shape_text(text_line & line,
         face_set->set_unscaled_character_sizes();
         std::size_t num_faces = face_set->size();
         std::size_t pos = 0;
+        shaped->items.emplace_back();
+        shaped_item & item = shaped->items.back();
+        item.face_index = -1;
+        item.face_id = 0;
+        item.start = text_item.start;
         for (auto const& face : *face_set)
         {
             ++pos;
@@ -117,28 +241,25 @@ static void shape_text(text_line & line,
                 continue;
             }
 
+            item.face_index = static_cast<int>(pos - 1);
+            item.face_id = face->id();
+            item.glyphs.reserve(num_glyphs);
             for (unsigned i=0; i<num_glyphs; ++i)
             {
-                glyph_info tmp;
-                tmp.glyph_index = glyphs[i].codepoint;
-                if (face->glyph_dimensions(tmp))
-                {
-                    tmp.char_index = glyphs[i].cluster;
-                    tmp.face = face;
-                    tmp.format = text_item.format;
-                    tmp.scale_multiplier = size / face->get_face()->units_per_EM;
-                    //Overwrite default advance with better value provided by HarfBuzz
-                    tmp.unscaled_advance = positions[i].x_advance;
-
-                    tmp.offset.set(positions[i].x_offset * tmp.scale_multiplier, positions[i].y_offset * tmp.scale_multiplier);
-                    width_map[glyphs[i].cluster] += tmp.advance();
-                    line.add_glyph(tmp, scale_factor);
-                }
+                shaped_glyph glyph;
+                glyph.glyph_index = glyphs[i].codepoint;
+                glyph.cluster = glyphs[i].cluster;
+                glyph.x_advance = positions[i].x_advance;
+                glyph.x_offset = positions[i].x_offset;
+                glyph.y_offset = positions[i].y_offset;
+                item.glyphs.push_back(glyph);
+                add_glyph(line, width_map, face, text_item.format, glyph, size, scale_factor);
             }
             line.update_max_char_height(face->get_char_height(size));
             break; //When we reach this point the current font had all glyphs.
         }
     }
+    cache.insert(std::move(key), shaped);
 }
 };
 } // namespace mapnik
@@ -24,6 +24,7 @@
 #define MAPNIK_TEXT_ITEMIZER_HPP
 
 //mapnik
+#include <mapnik/config.hpp>
 #include <mapnik/text/evaluated_format_properties_ptr.hpp>
 #include <mapnik/value_types.hpp>
 
@@ -55,7 +56,7 @@ struct text_item
 // - format
 // - script (http://en.wikipedia.org/wiki/Scripts_in_Unicode)
 
-class text_itemizer
+class MAPNIK_DECL text_itemizer
 {
 public:
     text_itemizer();
@@ -67,6 +68,17 @@ public:
     // Only forced line breaks with \n characters are handled here.
     std::pair<unsigned, unsigned> line(unsigned i) const;
     unsigned num_lines() const;
+    // Format of the character at position.
+    evaluated_format_properties_ptr const& format_at(unsigned position) const;
+    // Calls f(start, end, format) for each format run overlapping [start, end).
+    template <typename F>
+    void visit_formats(unsigned start, unsigned end, F f) const
+    {
+        for (auto const& run : format_runs_)
+        {
+            if (run.end > start && run.start < end) f(run.start, run.end, run.data);
+        }
+    }
 private:
     template<typename T> struct run
     {
@@ -90,11 +102,14 @@ private:
     direction_run_list direction_runs_;
     /// Script runs are always sorted by char index
     script_run_list script_runs_;
+    /// Script of the whole text if it only has Latin and Common characters,
+    /// which are all left to right, USCRIPT_INVALID_CODE otherwise.
+    UScriptCode simple_script_;
     void itemize_direction(unsigned start, unsigned end);
     void itemize_script();
     void create_item_list();
     std::list<text_item> output_;
-    template <typename T> typename T::const_iterator find_run(T const& list, unsigned position);
+    template <typename T> typename T::const_iterator find_run(T const& list, unsigned position) const;
     std::vector<unsigned> forced_line_breaks_; //Positions of \n characters
 };
 } //ns mapnik
@@ -58,6 +58,8 @@ public:
     // Iterate over the given path, placing line-following labels or point labels with respect to label_spacing.
     template <typename T>
     bool find_line_placements(T & path, bool points);
+    // Same as above for a path that has already been measured.
+    bool find_line_placements(vertex_cache & pp, bool points);
     // Try next position alternative from placement_info.
     bool next_position();
 
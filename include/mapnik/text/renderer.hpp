@@ -28,6 +28,7 @@
 #include <mapnik/image_compositing.hpp>
 #include <mapnik/symbolizer_enumerations.hpp>
 #include <mapnik/noncopyable.hpp>
+#include <mapnik/text/glyph_cache.hpp>
 // agg
 #include <agg_trans_affine.h>
 
@@ -78,6 +79,8 @@ public:
 protected:
     using glyph_vector = std::vector<glyph_t>;
     void prepare_glyphs(glyph_positions const& positions);
+    // rasterize a glyph (or its stroked halo when key.halo_radius >= 0) for glyph_cache
+    glyph_bitmap_ptr rasterize_glyph(glyph_info const& glyph, glyph_cache_key const& key);
     halo_rasterizer_e rasterizer_;
     composite_mode_e comp_op_;
     composite_mode_e halo_comp_op_;
@@ -101,6 +104,8 @@ public:
     void render(glyph_positions const& positions);
 private:
     pixmap_type & pixmap_;
+    // render through glyph_cache, only valid when transforms have no linear part
+    void render_cached(glyph_positions const& positions);
     void render_halo(FT_Bitmap_ *bitmap, unsigned rgba, int x, int y,
                      double halo_radius, double opacity,
                      composite_mode_e comp_op);
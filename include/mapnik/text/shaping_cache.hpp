@@ -0,0 +1,120 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_SHAPING_CACHE_HPP
+#define MAPNIK_SHAPING_CACHE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/utils.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/value_types.hpp>
+#include <mapnik/lru_cache.hpp>
+#include <mapnik/util/hash_combine.hpp>
+#include <mapnik/text/glyph_info.hpp>
+
+// stl
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// icu
+#include <unicode/unistr.h>
+
+namespace mapnik
+{
+
+// One glyph as returned by the shaper, independent of any FT_Face object.
+struct shaped_glyph
+{
+    glyph_index_t glyph_index;
+    unsigned cluster;
+    std::int32_t x_advance;
+    std::int32_t x_offset;
+    std::int32_t y_offset;
+};
+
+struct shaped_item
+{
+    // position of the chosen face in the item's face set, -1 if none was found
+    int face_index;
+    // font_face::id() of the chosen face, checked on replay
+    unsigned face_id;
+    // first char of the item, used to look up its format on replay
+    unsigned start;
+    std::vector<shaped_glyph> glyphs;
+};
+
+struct shaped_line
+{
+    std::vector<shaped_item> items;
+};
+
+using shaped_line_ptr = std::shared_ptr<shaped_line const>;
+
+struct shaping_key
+{
+    // whole itemizer text: script detection of neutral characters
+    // depends on their neighbours, even outside the shaped range
+    value_unicode_string text;
+    // line range, scale factor and the shaping relevant format of each run,
+    // with the fonts its face names resolve to
+    std::string params;
+
+    bool operator==(shaping_key const& rhs) const
+    {
+        return params == rhs.params && text == rhs.text;
+    }
+};
+
+struct shaping_key_hash
+{
+    std::size_t operator()(shaping_key const& key) const
+    {
+        std::size_t seed = static_cast<std::size_t>(key.text.hashCode());
+        util::hash_combine(seed, key.params);
+        return seed;
+    }
+};
+
+// Process wide LRU cache of shaping results, see harfbuzz_shaper.
+class MAPNIK_DECL shaping_cache :
+        public singleton<shaping_cache, CreateUsingNew>,
+        private mapnik::noncopyable
+{
+    friend class CreateUsingNew<shaping_cache>;
+public:
+    shaped_line_ptr find(shaping_key const& key);
+    void insert(shaping_key && key, shaped_line_ptr line);
+    void clear();
+    void set_max_size(std::size_t max_size);
+    std::size_t size() const;
+private:
+    shaping_cache();
+    ~shaping_cache();
+    lru_cache<shaping_key, shaped_line_ptr, shaping_key_hash> cache_;
+};
+
+}
+
+#endif // MAPNIK_SHAPING_CACHE_HPP
@@ -25,6 +25,8 @@
 //mapnik
 #include <mapnik/text/placement_finder.hpp>
 #include <mapnik/vertex_converters.hpp>
+#include <mapnik/text/vertex_cache_store.hpp>
+#include <mapnik/make_unique.hpp>
 
 namespace mapnik {
 
@@ -44,6 +46,11 @@ struct placement_finder_adapter
     template <typename PathT>
     void add_path(PathT & path)
     {
+        if (measured_)
+        {
+            *measured_ = std::make_unique<vertex_cache>(path);
+            return;
+        }
         status_ = finder_.find_line_placements(path, points_on_line_);
     }
 
@@ -52,6 +59,8 @@ struct placement_finder_adapter
     placement_finder_type & finder_;
     bool points_on_line_;
     mutable bool status_ = false;
+    // When set the converted path is only measured and stored here.
+    vertex_cache_ptr * measured_ = nullptr;
 
 };
 
@@ -119,7 +128,8 @@ public:
                            FaceManagerT & font_manager,
                            DetectorT & detector,
                            box2d<double> const& query_extent,
-                           agg::trans_affine const&);
+                           agg::trans_affine const&,
+                           vertex_cache_store * vertex_caches = nullptr);
 
     template <typename FaceManagerT, typename DetectorT>
     text_symbolizer_helper(shield_symbolizer const& sym,
@@ -133,7 +143,8 @@ public:
                            FaceManagerT & font_manager,
                            DetectorT & detector,
                            box2d<double> const& query_extent,
-                           agg::trans_affine const&);
+                           agg::trans_affine const&,
+                           vertex_cache_store * vertex_caches = nullptr);
 
     // Return all placements.
     placements_list const& get();
@@ -145,6 +156,12 @@ protected:
 
     placement_finder_adapter<placement_finder> adapter_;
     vertex_converter_type converter_;
+    // Measured paths shared with other symbolizers of the feature, may be null.
+    vertex_cache_store * vertex_caches_;
+    vertex_cache_store::params_type converter_params_;
+    void init_vertex_caches(vertex_cache_store * vertex_caches, bool clip,
+                            double simplify_tolerance, double smooth,
+                            agg::trans_affine const& affine_trans);
     //ShieldSymbolizer only
     void init_marker();
 };
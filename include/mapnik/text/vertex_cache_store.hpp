@@ -0,0 +1,86 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+
+#ifndef MAPNIK_VERTEX_CACHE_STORE_HPP
+#define MAPNIK_VERTEX_CACHE_STORE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/noncopyable.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/value_types.hpp>
+#include <mapnik/text/vertex_cache.hpp>
+
+// stl
+#include <array>
+#include <vector>
+
+namespace mapnik
+{
+
+class feature_impl;
+
+// Measured screen space paths of the feature currently being rendered.
+// Text and shield symbolizers placing labels along the same geometry with
+// the same converter settings share one vertex_cache, including the offset
+// lines it has already computed. Entries are dropped as soon as the renderer
+// moves on to another feature or layer.
+class MAPNIK_DECL vertex_cache_store : private mapnik::noncopyable
+{
+public:
+    // clip, simplify tolerance and algorithm, smooth, affine transform
+    // and clipping box: everything the text vertex converter depends on
+    // besides the view and projection, which are fixed within a layer.
+    using params_type = std::array<double, 14>;
+
+    vertex_cache_store();
+
+    // Drops all entries if feature differs from the one last seen.
+    void set_feature(feature_impl const& feature);
+    // Returns nullptr when geom has not been measured with params yet.
+    vertex_cache * find(geometry_type const& geom, params_type const& params);
+    vertex_cache * insert(geometry_type const& geom, params_type const& params, vertex_cache_ptr && path);
+    void clear();
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    struct entry
+    {
+        geometry_type const* geom;
+        std::size_t geom_size;
+        double first_x;
+        double first_y;
+        params_type params;
+        vertex_cache_ptr path;
+    };
+
+    bool matches(entry const& e, geometry_type const& geom, params_type const& params) const;
+
+    feature_impl const* feature_;
+    value_integer feature_id_;
+    std::vector<entry> entries_;
+};
+
+}
+
+#endif // MAPNIK_VERTEX_CACHE_STORE_HPP
@@ -0,0 +1,77 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_THREAD_POOL_HPP
+#define MAPNIK_THREAD_POOL_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/utils.hpp>
+#include <mapnik/noncopyable.hpp>
+
+// stl
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mapnik
+{
+
+// Process wide pool of hardware_concurrency() - 1 worker threads, started on
+// first use and shared by everything that splits work across cores (image
+// filters, png compression, raster tile decoding) so that concurrent renders
+// don't multiply the number of threads.
+class MAPNIK_DECL thread_pool :
+        public singleton<thread_pool, CreateUsingNew>,
+        private mapnik::noncopyable
+{
+    friend class CreateUsingNew<thread_pool>;
+public:
+    // Calls func(i) for every i in [0, count) on at most max_workers threads
+    // (0 for no limit), the calling thread included. The caller takes part in
+    // the work, so this never waits on a busy pool and may be nested. Returns
+    // once every call is done; the first exception thrown by func is rethrown
+    // and the remaining indices are skipped.
+    void parallel_for(std::size_t count, unsigned max_workers,
+                      std::function<void(std::size_t)> const& func);
+    // number of worker threads, not counting callers
+    unsigned size() const;
+private:
+    struct job;
+    thread_pool();
+    ~thread_pool();
+    void work();
+    void run(job & j);
+    std::vector<std::thread> threads_;
+    std::deque<job*> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+};
+
+}
+
+#endif // MAPNIK_THREAD_POOL_HPP
@@ -41,9 +41,16 @@ class MAPNIK_DECL transcoder : private mapnik::noncopyable
 public:
     explicit transcoder (std::string const& encoding);
     mapnik::value_unicode_string transcode(const char* data, std::int32_t length = -1) const;
+    // same text as utf-8, for attribute values that are only widened to
+    // utf-16 if they get shaped; valid utf-8 input is copied as is
+    mapnik::value_utf8_string transcode_utf8(const char* data, std::int32_t length = -1) const;
     ~transcoder();
 private:
     bool ok_;
+    // true when bytes < 0x80 always map to the same code point
+    // so pure ascii input can bypass ICU
+    bool ascii_compatible_;
+    bool utf8_;
     UConverter * conv_;
 };
 }
@@ -32,6 +32,7 @@
 // stl
 #include <string>
 #include <cmath>
+#include <algorithm>
 #include <memory>
 
 #include <iosfwd>
@@ -41,6 +42,8 @@
 // icu
 #include <unicode/unistr.h>
 #include <unicode/ustring.h>
+#include <unicode/utf8.h>
+#include <unicode/utf16.h>
 
 namespace mapnik  {
 
@@ -48,6 +51,24 @@ inline void to_utf8(mapnik::value_unicode_string const& input, std::string & tar
 {
     if (input.isEmpty()) return;
 
+    // ascii fast path: narrow code units directly instead of going through ICU
+    UChar const* src = input.getBuffer();
+    int32_t const src_len = input.length();
+    int32_t i = 0;
+    for (; i < src_len; ++i)
+    {
+        if (src[i] >= 0x80) break;
+    }
+    if (i == src_len)
+    {
+        target.resize(static_cast<std::size_t>(src_len));
+        for (i = 0; i < src_len; ++i)
+        {
+            target[static_cast<std::size_t>(i)] = static_cast<char>(src[i]);
+        }
+        return;
+    }
+
     const int BUF_SIZE = 256;
     char buf [BUF_SIZE];
     int len;
@@ -67,10 +88,68 @@ inline void to_utf8(mapnik::value_unicode_string const& input, std::string & tar
     }
 }
 
-using value_base = util::variant<value_null, value_bool, value_integer,value_double, value_unicode_string>;
+inline value_unicode_string utf8_to_unicode(value_utf8_string const& input)
+{
+    return value_unicode_string::fromUTF8(U_NAMESPACE_QUALIFIER StringPiece(input.data(), static_cast<int32_t>(input.size())));
+}
+
+using value_base = util::variant<value_null, value_bool, value_integer,value_double, value_unicode_string, value_utf8_string>;
 
 namespace impl {
 
+// strings order by utf-16 code units as UnicodeString does, whichever
+// representation each side holds. utf-8 byte order differs from that only
+// where a supplementary character (lead byte 0xf0-0xf4) meets one from
+// U+E000-U+FFFF (lead byte 0xee-0xef), so those lead bytes are moved up
+inline int compare_strings(value_utf8_string const& lhs, value_utf8_string const& rhs)
+{
+    std::size_t const size = std::min(lhs.size(), rhs.size());
+    std::size_t i = 0;
+    while (i < size && lhs[i] == rhs[i]) ++i;
+    if (i == size)
+    {
+        return (lhs.size() < rhs.size()) ? -1 : (lhs.size() > rhs.size()) ? 1 : 0;
+    }
+    unsigned l = static_cast<unsigned char>(lhs[i]);
+    unsigned r = static_cast<unsigned char>(rhs[i]);
+    if (l == 0xee || l == 0xef) l += 0x10;
+    if (r == 0xee || r == 0xef) r += 0x10;
+    return (l < r) ? -1 : 1;
+}
+
+// decodes lhs on the fly instead of converting it, malformed sequences
+// compare as U+FFFD like they read after to_unicode
+inline int compare_strings(value_utf8_string const& lhs, value_unicode_string const& rhs)
+{
+    char const* s = lhs.data();
+    int32_t const length = static_cast<int32_t>(lhs.size());
+    UChar const* u = rhs.getBuffer();
+    int32_t const ulength = rhs.length();
+    int32_t i = 0;
+    int32_t j = 0;
+    while (i < length)
+    {
+        UChar32 c;
+        U8_NEXT(s, i, length, c);
+        if (c < 0) c = 0xfffd;
+        UChar units[2];
+        int32_t count = 0;
+        UBool error = false;
+        U16_APPEND(units, count, 2, c, error);
+        for (int32_t k = 0; k < count; ++k, ++j)
+        {
+            if (j == ulength) return 1;
+            if (units[k] != u[j]) return (units[k] < u[j]) ? -1 : 1;
+        }
+    }
+    return (j < ulength) ? -1 : 0;
+}
+
+inline int compare_strings(value_unicode_string const& lhs, value_utf8_string const& rhs)
+{
+    return -compare_strings(rhs, lhs);
+}
+
 struct equals
     : public util::static_visitor<bool>
 {
@@ -110,6 +189,24 @@ struct equals
         return  (lhs == rhs) ? true: false;
     }
 
+    bool operator() (value_utf8_string const& lhs,
+                     value_utf8_string const& rhs) const
+    {
+        return lhs == rhs;
+    }
+
+    bool operator() (value_utf8_string const& lhs,
+                     value_unicode_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) == 0;
+    }
+
+    bool operator() (value_unicode_string const& lhs,
+                     value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) == 0;
+    }
+
     template <typename T>
     bool operator() (T lhs, T rhs) const
     {
@@ -174,6 +271,24 @@ struct not_equals
         return  (lhs != rhs)? true : false;
     }
 
+    bool operator() (value_utf8_string const& lhs,
+                     value_utf8_string const& rhs) const
+    {
+        return lhs != rhs;
+    }
+
+    bool operator() (value_utf8_string const& lhs,
+                     value_unicode_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) != 0;
+    }
+
+    bool operator() (value_unicode_string const& lhs,
+                     value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) != 0;
+    }
+
     // back compatibility shim to equate empty string with null for != test
     // https://github.com/mapnik/mapnik/issues/1859
     // TODO - consider removing entire specialization at Mapnik 3.x
@@ -183,6 +298,11 @@ struct not_equals
         return true;
     }
 
+    bool operator() (value_null, value_utf8_string const& rhs) const
+    {
+        return !rhs.empty();
+    }
+
 };
 
 struct greater_than
@@ -215,6 +335,21 @@ struct greater_than
         return  (lhs > rhs) ? true : false ;
     }
 
+    bool operator() (value_utf8_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) > 0;
+    }
+
+    bool operator() (value_utf8_string const& lhs, value_unicode_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) > 0;
+    }
+
+    bool operator() (value_unicode_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) > 0;
+    }
+
     bool operator() (value_null, value_null) const
     {
         return false;
@@ -251,6 +386,21 @@ struct greater_or_equal
         return ( lhs >= rhs ) ? true : false ;
     }
 
+    bool operator() (value_utf8_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) >= 0;
+    }
+
+    bool operator() (value_utf8_string const& lhs, value_unicode_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) >= 0;
+    }
+
+    bool operator() (value_unicode_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) >= 0;
+    }
+
     bool operator() (value_null, value_null) const
     {
         return false;
@@ -288,6 +438,21 @@ struct less_than
         return (lhs < rhs) ? true : false ;
     }
 
+    bool operator() (value_utf8_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) < 0;
+    }
+
+    bool operator() (value_utf8_string const& lhs, value_unicode_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) < 0;
+    }
+
+    bool operator() (value_unicode_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) < 0;
+    }
+
     bool operator() (value_null, value_null) const
     {
         return false;
@@ -325,6 +490,21 @@ struct less_or_equal
         return (lhs <= rhs) ? true : false ;
     }
 
+    bool operator() (value_utf8_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) <= 0;
+    }
+
+    bool operator() (value_utf8_string const& lhs, value_unicode_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) <= 0;
+    }
+
+    bool operator() (value_unicode_string const& lhs, value_utf8_string const& rhs) const
+    {
+        return compare_strings(lhs, rhs) <= 0;
+    }
+
     bool operator() (value_null, value_null) const
     {
         return false;
@@ -379,6 +559,52 @@ struct add : public util::static_visitor<V>
         return rhs;
     }
 
+    value_type operator() (value_utf8_string const& lhs,
+                           value_utf8_string const& rhs) const
+    {
+        return lhs + rhs;
+    }
+
+    value_type operator() (value_utf8_string const& lhs,
+                           value_unicode_string const& rhs) const
+    {
+        return utf8_to_unicode(lhs) + rhs;
+    }
+
+    value_type operator() (value_unicode_string const& lhs,
+                           value_utf8_string const& rhs) const
+    {
+        return lhs + utf8_to_unicode(rhs);
+    }
+
+    value_type operator() (value_utf8_string const& lhs, value_null) const
+    {
+        return lhs;
+    }
+
+    value_type operator() (value_null, value_utf8_string const& rhs) const
+    {
+        return rhs;
+    }
+
+    template <typename R>
+    value_type operator() (value_utf8_string const& lhs, R const& rhs) const
+    {
+        std::string val;
+        if (util::to_string(val,rhs))
+            return lhs + val;
+        return lhs;
+    }
+
+    template <typename L>
+    value_type operator() (L const& lhs , value_utf8_string const& rhs) const
+    {
+        std::string val;
+        if (util::to_string(val,lhs))
+            return val + rhs;
+        return rhs;
+    }
+
     template <typename T>
     value_type operator() (T lhs, T rhs) const
     {
@@ -419,6 +645,24 @@ struct sub : public util::static_visitor<V>
         return value_type();
     }
 
+    value_type operator() (value_utf8_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_utf8_string const&,
+                           value_unicode_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_unicode_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
     value_type operator() (value_double lhs, value_integer rhs) const
     {
         return lhs - rhs;
@@ -456,6 +700,24 @@ struct mult : public util::static_visitor<V>
         return value_type();
     }
 
+    value_type operator() (value_utf8_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_utf8_string const&,
+                           value_unicode_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_unicode_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
     value_type operator() (value_double lhs, value_integer rhs) const
     {
         return lhs * rhs;
@@ -500,6 +762,24 @@ struct div: public util::static_visitor<V>
         return value_type();
     }
 
+    value_type operator() (value_utf8_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_utf8_string const&,
+                           value_unicode_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_unicode_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
     value_type operator() (value_double lhs, value_integer rhs) const
     {
         if (rhs == 0) return value_type();
@@ -535,6 +815,24 @@ struct mod: public util::static_visitor<V>
         return value_type();
     }
 
+    value_type operator() (value_utf8_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_utf8_string const&,
+                           value_unicode_string const&) const
+    {
+        return value_type();
+    }
+
+    value_type operator() (value_unicode_string const&,
+                           value_utf8_string const&) const
+    {
+        return value_type();
+    }
+
     value_type operator() (value_bool,
                            value_bool) const
     {
@@ -582,6 +880,11 @@ struct negate : public util::static_visitor<V>
     {
         return value_type();
     }
+
+    value_type operator() (value_utf8_string const&) const
+    {
+        return value_type();
+    }
 };
 
 // converters
@@ -601,6 +904,11 @@ struct convert<value_bool> : public util::static_visitor<value_bool>
         return !ustr.isEmpty();
     }
 
+    value_bool operator() (value_utf8_string const& str) const
+    {
+        return !str.empty();
+    }
+
     value_bool operator() (value_null const&) const
     {
         return false;
@@ -710,6 +1018,11 @@ struct convert<std::string> : public util::static_visitor<std::string>
         return utf8;
     }
 
+    std::string const& operator() (value_utf8_string const& val) const
+    {
+        return val;
+    }
+
     std::string operator() (value_double val) const
     {
         std::string str;
@@ -740,6 +1053,11 @@ struct to_unicode : public util::static_visitor<value_unicode_string>
         return val;
     }
 
+    value_unicode_string operator() (value_utf8_string const& val) const
+    {
+        return utf8_to_unicode(val);
+    }
+
     value_unicode_string operator() (value_double val) const
     {
         std::string str;
@@ -765,6 +1083,11 @@ struct to_expression_string : public util::static_visitor<std::string>
         return quote_ + utf8 + quote_;
     }
 
+    std::string operator() (value_utf8_string const& val) const
+    {
+        return quote_ + val + quote_;
+    }
+
     std::string operator() (value_integer val) const
     {
         std::string output;
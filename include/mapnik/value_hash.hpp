@@ -26,6 +26,7 @@
 // mapnik
 #include <mapnik/util/variant.hpp>
 #include <mapnik/value_types.hpp>
+#include <mapnik/util/hash_combine.hpp>
 
 // stl
 #include <functional>
@@ -35,13 +36,6 @@
 
 namespace mapnik { namespace detail {
 
-template <class T>
-inline void hash_combine(std::size_t & seed, T const& v)
-{
-    std::hash<T> hasher;
-    seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-}
-
 struct value_hasher: public util::static_visitor<std::size_t>
 {
     std::size_t operator() (value_null val) const
@@ -54,6 +48,12 @@ struct value_hasher: public util::static_visitor<std::size_t>
         return val.hashCode();
     }
 
+    // hashed as utf-16 so equal text hashes alike in either representation
+    std::size_t operator() (value_utf8_string const& val) const
+    {
+        return value_unicode_string::fromUTF8(U_NAMESPACE_QUALIFIER StringPiece(val.data(), static_cast<int32_t>(val.size()))).hashCode();
+    }
+
     template <class T>
     std::size_t operator()(T const& val) const
     {
@@ -68,7 +68,11 @@ template <typename T>
 std::size_t mapnik_hash_value(T const& val)
 {
     std::size_t seed = util::apply_visitor(detail::value_hasher(), val);
-    detail::hash_combine(seed, val.get_type_index());
+    // both string representations leave the type out, as they compare equal
+    if (!val.template is<value_unicode_string>() && !val.template is<value_utf8_string>())
+    {
+        util::hash_combine(seed, val.get_type_index());
+    }
     return seed;
 }
 
@@ -33,6 +33,7 @@
 #include <type_traits>
 #include <iosfwd>
 #include <cstddef>
+#include <string>
 
 namespace U_ICU_NAMESPACE {
     class UnicodeString;
@@ -49,6 +50,9 @@ using value_integer = int;
 
 using value_double = double;
 using value_unicode_string = U_NAMESPACE_QUALIFIER UnicodeString;
+// text as read from utf-8 sources, widened to value_unicode_string only
+// where it is shaped or meets a value_unicode_string
+using value_utf8_string = std::string;
 using value_bool = bool;
 
 struct MAPNIK_DECL value_null
@@ -515,7 +515,7 @@ void csv_datasource::parse_csv(T & stream,
                 {
                     // add an empty string here to represent a missing value
                     // not using null type here since nulls are not a csv thing
-                    feature->put(fld_name,tr.transcode(value.c_str()));
+                    feature->put(fld_name,tr.transcode_utf8(value.c_str()));
                     if (feature_count == 1)
                     {
                         desc_.add_descriptor(mapnik::attribute_descriptor(fld_name,mapnik::String));
@@ -688,7 +688,7 @@ void csv_datasource::parse_csv(T & stream,
                     (value_length > 1 && !has_dot && value[0] == '0'))
                 {
                     matched = true;
-                    feature->put(fld_name,std::move(tr.transcode(value.c_str())));
+                    feature->put(fld_name,std::move(tr.transcode_utf8(value.c_str())));
                     if (feature_count == 1)
                     {
                         desc_.add_descriptor(mapnik::attribute_descriptor(fld_name,mapnik::String));
@@ -759,7 +759,7 @@ void csv_datasource::parse_csv(T & stream,
                     else
                     {
                         // fallback to normal string
-                        feature->put(fld_name,std::move(tr.transcode(value.c_str())));
+                        feature->put(fld_name,std::move(tr.transcode_utf8(value.c_str())));
                         if (feature_count == 1)
                         {
                             desc_.add_descriptor(
@@ -31,6 +31,10 @@
 #include <mapnik/value_types.hpp>
 #include <mapnik/boolean.hpp>
 
+// stl
+#include <algorithm>
+#include <thread>
+
 #include <gdal_version.h>
 
 using mapnik::datasource;
@@ -46,24 +50,33 @@ using mapnik::layer_descriptor;
 using mapnik::datasource_exception;
 
 
-/*
- * Opens a GDALDataset and returns a pointer to it.
- * Caller is responsible for calling GDALClose on it
- */
-inline GDALDataset* gdal_datasource::open_dataset() const
+gdal_dataset_pool::gdal_dataset_pool(std::string const& name, bool shared, std::size_t max_idle)
+    : name_(name),
+      shared_(shared),
+      max_idle_(max_idle) {}
+
+gdal_dataset_pool::~gdal_dataset_pool()
+{
+    for (GDALDataset* dataset : idle_)
+    {
+        GDALClose(dataset);
+    }
+}
+
+GDALDataset* gdal_dataset_pool::open() const
 {
-    MAPNIK_LOG_DEBUG(gdal) << "gdal_datasource: Opening " << dataset_name_;
+    MAPNIK_LOG_DEBUG(gdal) << "gdal_datasource: Opening " << name_;
 
     GDALDataset *dataset;
 #if GDAL_VERSION_NUM >= 1600
-    if (shared_dataset_)
+    if (shared_)
     {
-        dataset = reinterpret_cast<GDALDataset*>(GDALOpenShared((dataset_name_).c_str(), GA_ReadOnly));
+        dataset = reinterpret_cast<GDALDataset*>(GDALOpenShared((name_).c_str(), GA_ReadOnly));
     }
     else
 #endif
     {
-        dataset = reinterpret_cast<GDALDataset*>(GDALOpen((dataset_name_).c_str(), GA_ReadOnly));
+        dataset = reinterpret_cast<GDALDataset*>(GDALOpen((name_).c_str(), GA_ReadOnly));
     }
 
     if (! dataset)
@@ -74,6 +87,44 @@ inline GDALDataset* gdal_datasource::open_dataset() const
     return dataset;
 }
 
+std::shared_ptr<GDALDataset> gdal_dataset_pool::acquire()
+{
+    GDALDataset* dataset = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty())
+        {
+            dataset = idle_.back();
+            idle_.pop_back();
+        }
+    }
+    if (!dataset) dataset = open();
+    // the handle keeps the pool alive, featuresets may outlive their datasource
+    std::shared_ptr<gdal_dataset_pool> self = shared_from_this();
+    return std::shared_ptr<GDALDataset>(dataset, [self](GDALDataset* d) { self->release(d); });
+}
+
+std::size_t gdal_dataset_pool::idle() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+void gdal_dataset_pool::release(GDALDataset* dataset)
+{
+    MAPNIK_LOG_DEBUG(gdal) << "gdal_datasource: Releasing Dataset=" << dataset;
+
+    if (!shared_)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle_)
+        {
+            idle_.push_back(dataset);
+            return;
+        }
+    }
+    GDALClose(dataset);
+}
 
 gdal_datasource::gdal_datasource(parameters const& params)
     : datasource(params),
@@ -104,8 +155,13 @@ gdal_datasource::gdal_datasource(parameters const& params)
 
     shared_dataset_ = *params.get<mapnik::boolean_type>("shared", false);
     band_ = *params.get<mapnik::value_integer>("band", -1);
+    // handles kept open between queries, one per rendering thread by default
+    mapnik::value_integer max_idle = *params.get<mapnik::value_integer>("max_idle_datasets",
+                                                                         std::max(1u, std::thread::hardware_concurrency()));
 
-    GDALDataset *dataset = open_dataset();
+    pool_ = std::make_shared<gdal_dataset_pool>(dataset_name_, shared_dataset_,
+                                                static_cast<std::size_t>(std::max<mapnik::value_integer>(max_idle, 0)));
+    std::shared_ptr<GDALDataset> dataset = pool_->acquire();
 
     nbands_ = dataset->GetRasterCount();
     width_ = dataset->GetRasterXSize();
@@ -188,8 +244,6 @@ gdal_datasource::gdal_datasource(parameters const& params)
         extent_.init(x0, y0, x1, y1);
     }
 
-    GDALClose(dataset);
-
     MAPNIK_LOG_DEBUG(gdal) << "gdal_datasource: Raster Size=" << width_ << "," << height_;
     MAPNIK_LOG_DEBUG(gdal) << "gdal_datasource: Raster Extent=" << extent_;
 
@@ -233,7 +287,7 @@ featureset_ptr gdal_datasource::features(query const& q) const
     gdal_query gq = q;
 
     // TODO - move to std::make_shared, but must reduce # of args to <= 9
-    return featureset_ptr(new gdal_featureset(*open_dataset(),
+    return featureset_ptr(new gdal_featureset(pool_->acquire(),
                                               band_,
                                               gq,
                                               extent_,
@@ -255,7 +309,7 @@ featureset_ptr gdal_datasource::features_at_point(coord2d const& pt, double tol)
     gdal_query gq = pt;
 
     // TODO - move to std::make_shared, but must reduce # of args to <= 9
-    return featureset_ptr(new gdal_featureset(*open_dataset(),
+    return featureset_ptr(new gdal_featureset(pool_->acquire(),
                                               band_,
                                               gq,
                                               extent_,
@@ -36,12 +36,36 @@
 #include <boost/optional.hpp>
 
 // stl
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
 // gdal
 #include <gdal_priv.h>
 
+// Open handles of one dataset. A GDALDataset must not be used by two
+// threads at once, so every featureset checks out a handle of its own and
+// hands it back for the next query instead of reopening the file. At most
+// max_idle handles are kept, the others are closed when handed back. Shared
+// datasets are already shared per thread by GDAL and are never pooled.
+class gdal_dataset_pool : public std::enable_shared_from_this<gdal_dataset_pool>
+{
+public:
+    gdal_dataset_pool(std::string const& name, bool shared, std::size_t max_idle);
+    ~gdal_dataset_pool();
+    std::shared_ptr<GDALDataset> acquire();
+    std::size_t idle() const;
+private:
+    GDALDataset* open() const;
+    void release(GDALDataset* dataset);
+    std::string name_;
+    bool shared_;
+    std::size_t max_idle_;
+    mutable std::mutex mutex_;
+    std::vector<GDALDataset*> idle_;
+};
+
 class gdal_datasource : public mapnik::datasource
 {
 public:
@@ -55,7 +79,7 @@ public:
     boost::optional<mapnik::datasource::geometry_t> get_geometry_type() const;
     mapnik::layer_descriptor get_descriptor() const;
 private:
-    GDALDataset* open_dataset() const;
+    std::shared_ptr<gdal_dataset_pool> pool_;
     mapnik::box2d<double> extent_;
     std::string dataset_name_;
     int band_;
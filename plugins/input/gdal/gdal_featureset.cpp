@@ -48,7 +48,7 @@ using mapnik::geometry_type;
 using mapnik::datasource_exception;
 using mapnik::feature_factory;
 
-gdal_featureset::gdal_featureset(GDALDataset& dataset,
+gdal_featureset::gdal_featureset(std::shared_ptr<GDALDataset> const& dataset,
                                  int band,
                                  gdal_query q,
                                  mapnik::box2d<double> extent,
@@ -78,9 +78,6 @@ gdal_featureset::gdal_featureset(GDALDataset& dataset,
 
 gdal_featureset::~gdal_featureset()
 {
-    MAPNIK_LOG_DEBUG(gdal) << "gdal_featureset: Closing Dataset=" << &dataset_;
-
-    GDALClose(&dataset_);
 }
 
 feature_ptr gdal_featureset::next()
@@ -88,7 +85,7 @@ feature_ptr gdal_featureset::next()
     if (first_)
     {
         first_ = false;
-        MAPNIK_LOG_DEBUG(gdal) << "gdal_featureset: Next feature in Dataset=" << &dataset_;
+        MAPNIK_LOG_DEBUG(gdal) << "gdal_featureset: Next feature in Dataset=" << dataset_.get();
         return mapnik::util::apply_visitor(query_dispatch(*this), gquery_);
     }
     return feature_ptr();
@@ -108,7 +105,7 @@ feature_ptr gdal_featureset::get_feature(mapnik::query const& q)
     /*
 #ifdef MAPNIK_LOG
       double tr[6];
-      dataset_.GetGeoTransform(tr);
+      dataset_->GetGeoTransform(tr);
 
       const double dx = tr[1];
       const double dy = tr[5];
@@ -215,7 +212,7 @@ feature_ptr gdal_featureset::get_feature(mapnik::query const& q)
                     throw datasource_exception(s.str());
                 }
                 float* imageData = (float*)image.getBytes();
-                GDALRasterBand * band = dataset_.GetRasterBand(band_);
+                GDALRasterBand * band = dataset_->GetRasterBand(band_);
                 raster_nodata = band->GetNoDataValue(&raster_has_nodata);
                 band->RasterIO(GF_Read, x_off, y_off, width, height,
                                imageData, image.width(), image.height(),
@@ -225,7 +222,7 @@ feature_ptr gdal_featureset::get_feature(mapnik::query const& q)
             {
                 for (int i = 0; i < nbands_; ++i)
                 {
-                    GDALRasterBand * band = dataset_.GetRasterBand(i + 1);
+                    GDALRasterBand * band = dataset_->GetRasterBand(i + 1);
 #ifdef MAPNIK_LOG
                     get_overview_meta(band);
 #endif
@@ -325,12 +322,18 @@ feature_ptr gdal_featureset::get_feature(mapnik::query const& q)
                             }
                         }
                     }
-                    red->RasterIO(GF_Read, x_off, y_off, width, height, image.getBytes() + 0,
-                                  image.width(), image.height(), GDT_Byte, 4, 4 * image.width());
-                    green->RasterIO(GF_Read, x_off, y_off, width, height, image.getBytes() + 1,
-                                    image.width(), image.height(), GDT_Byte, 4, 4 * image.width());
-                    blue->RasterIO(GF_Read, x_off, y_off, width, height, image.getBytes() + 2,
-                                   image.width(), image.height(), GDT_Byte, 4, 4 * image.width());
+                    // one interleaved read walks each block once for all bands, the
+                    // alpha band included unless nodata takes its place
+                    int band_map[4] = { red->GetBand(), green->GetBand(), blue->GetBand(), 0 };
+                    int band_count = 3;
+                    if (alpha && !raster_has_nodata)
+                    {
+                        band_map[band_count++] = alpha->GetBand();
+                        alpha = 0;
+                    }
+                    dataset_->RasterIO(GF_Read, x_off, y_off, width, height, image.getBytes(),
+                                       image.width(), image.height(), GDT_Byte,
+                                       band_count, band_map, 4, 4 * image.width(), 1);
                 }
                 else if (grey)
                 {
@@ -360,12 +363,17 @@ feature_ptr gdal_featureset::get_feature(mapnik::query const& q)
                             }
                         }
                     }
-                    grey->RasterIO(GF_Read, x_off, y_off, width, height, image.getBytes() + 0,
-                                   image.width(), image.height(), GDT_Byte, 4, 4 * image.width());
-                    grey->RasterIO(GF_Read,x_off, y_off, width, height, image.getBytes() + 1,
-                                   image.width(), image.height(), GDT_Byte, 4, 4 * image.width());
-                    grey->RasterIO(GF_Read,x_off, y_off, width, height, image.getBytes() + 2,
-                                   image.width(), image.height(), GDT_Byte, 4, 4 * image.width());
+                    // the color table replaces whole pixels, alpha is read after it
+                    int band_map[4] = { grey->GetBand(), grey->GetBand(), grey->GetBand(), 0 };
+                    int band_count = 3;
+                    if (alpha && !raster_has_nodata && !color_table)
+                    {
+                        band_map[band_count++] = alpha->GetBand();
+                        alpha = 0;
+                    }
+                    dataset_->RasterIO(GF_Read, x_off, y_off, width, height, image.getBytes(),
+                                       image.width(), image.height(), GDT_Byte,
+                                       band_count, band_map, 4, 4 * image.width(), 1);
 
                     if (color_table)
                     {
@@ -430,11 +438,11 @@ feature_ptr gdal_featureset::get_feature_at_point(mapnik::coord2d const& pt)
 {
     if (band_ > 0)
     {
-        unsigned raster_xsize = dataset_.GetRasterXSize();
-        unsigned raster_ysize = dataset_.GetRasterYSize();
+        unsigned raster_xsize = dataset_->GetRasterXSize();
+        unsigned raster_ysize = dataset_->GetRasterYSize();
 
         double gt[6];
-        dataset_.GetGeoTransform(gt);
+        dataset_->GetGeoTransform(gt);
 
         double det = gt[1] * gt[5] - gt[2] * gt[4];
         // subtract half a pixel width & height because gdal coord reference
@@ -451,7 +459,7 @@ feature_ptr gdal_featureset::get_feature_at_point(mapnik::coord2d const& pt)
             MAPNIK_LOG_DEBUG(gdal) << "gdal_featureset: pt.x=" << pt.x << " pt.y=" << pt.y;
             MAPNIK_LOG_DEBUG(gdal) << "gdal_featureset: x=" << x << " y=" << y;
 
-            GDALRasterBand* band = dataset_.GetRasterBand(band_);
+            GDALRasterBand* band = dataset_->GetRasterBand(band_);
             int raster_has_nodata;
             double nodata = band->GetNoDataValue(&raster_has_nodata);
             double value;
@@ -28,6 +28,8 @@
 #include <mapnik/util/variant.hpp>
 // boost
 #include <boost/optional.hpp>
+// stl
+#include <memory>
 
 #include "gdal_datasource.hpp"
 
@@ -57,7 +59,7 @@ class gdal_featureset : public mapnik::Featureset
     };
 
 public:
-    gdal_featureset(GDALDataset& dataset,
+    gdal_featureset(std::shared_ptr<GDALDataset> const& dataset,
                     int band,
                     gdal_query q,
                     mapnik::box2d<double> extent,
@@ -79,7 +81,7 @@ private:
     void get_overview_meta(GDALRasterBand * band);
 #endif
 
-    GDALDataset & dataset_;
+    std::shared_ptr<GDALDataset> dataset_;
     mapnik::context_ptr ctx_;
     int band_;
     gdal_query gquery_;
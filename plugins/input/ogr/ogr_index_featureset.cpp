@@ -154,7 +154,7 @@ feature_ptr ogr_index_featureset<filterT>::next()
             case OFTString:
             case OFTWideString:     // deprecated !
             {
-                feature->put(fld_name,tr_->transcode(poFeature->GetFieldAsString (i)));
+                feature->put(fld_name,tr_->transcode_utf8(poFeature->GetFieldAsString (i)));
                 break;
             }
 
@@ -114,7 +114,7 @@ feature_ptr osm_featureset<filterT>::next()
         std::map<std::string,std::string>::iterator i = cur_item->keyvals.find(*itr);
         if (i != end_keyvals)
         {
-            feature->put_new(i->first, tr_->transcode(i->second.c_str()));
+            feature->put_new(i->first, tr_->transcode_utf8(i->second.c_str()));
         }
     }
     return feature;
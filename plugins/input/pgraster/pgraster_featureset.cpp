@@ -200,14 +200,14 @@ feature_ptr pgraster_featureset::next()
                     case 1043: //varchar
                     case 705:  //literal
                     {
-                        feature->put(name, tr_->transcode(buf));
+                        feature->put(name, tr_->transcode_utf8(buf));
                         break;
                     }
 
                     case 1042: //bpchar
                     {
                         std::string str = mapnik::util::trim_copy(buf);
-                        feature->put(name, tr_->transcode(str.c_str()));
+                        feature->put(name, tr_->transcode_utf8(str.c_str()));
                         break;
                     }
 
@@ -34,6 +34,9 @@
 #include "raster_info.hpp"
 #include "raster_datasource.hpp"
 
+// stl
+#include <algorithm>
+
 using mapnik::layer_descriptor;
 using mapnik::featureset_ptr;
 using mapnik::query;
@@ -64,6 +67,10 @@ raster_datasource::raster_datasource(parameters const& params)
     multi_tiles_ = *params.get<mapnik::boolean_type>("multi", false);
     tile_size_ = *params.get<mapnik::value_integer>("tile_size", 256);
     tile_stride_ = *params.get<mapnik::value_integer>("tile_stride", 1);
+    // threads, the rendering one included, decoding the source tiles of a
+    // multi-file query on the shared thread pool; 1 decodes them one by one
+    mapnik::value_integer decode_threads = *params.get<mapnik::value_integer>("decode_threads", 1);
+    decode_threads_ = static_cast<unsigned>(std::max<mapnik::value_integer>(decode_threads, 1));
 
     boost::optional<std::string> format_from_filename = mapnik::type_from_filename(*file);
     format_ = *params.get<std::string>("format",format_from_filename?(*format_from_filename) : "tiff");
@@ -188,7 +195,7 @@ featureset_ptr raster_datasource::features(query const& q) const
 
         tiled_multi_file_policy policy(filename_, format_, tile_size_, extent_, q.get_bbox(), width_, height_, tile_stride_);
 
-        return std::make_shared<raster_featureset<tiled_multi_file_policy> >(policy, extent_, q);
+        return std::make_shared<raster_featureset<tiled_multi_file_policy> >(policy, extent_, q, decode_threads_);
     }
     else if (width * height > static_cast<int>(tile_size_ * tile_size_ << 2))
     {
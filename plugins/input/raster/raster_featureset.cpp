@@ -28,11 +28,17 @@
 #include <mapnik/image_reader.hpp>
 #include <mapnik/image_util.hpp>
 #include <mapnik/feature_factory.hpp>
+#include <mapnik/raster_tile_cache.hpp>
+#include <mapnik/thread_pool.hpp>
 
 // boost
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/format.hpp>
 
+// stl
+#include <algorithm>
+#include <vector>
+
 #include "raster_featureset.hpp"
 
 using mapnik::query;
@@ -45,14 +51,19 @@ using mapnik::feature_factory;
 template <typename LookupPolicy>
 raster_featureset<LookupPolicy>::raster_featureset(LookupPolicy const& policy,
                                                    box2d<double> const& extent,
-                                                   query const& q)
+                                                   query const& q,
+                                                   unsigned decode_threads)
     : policy_(policy),
       feature_id_(1),
       ctx_(std::make_shared<mapnik::context_type>()),
       extent_(extent),
       bbox_(q.get_bbox()),
+      res_x_(std::get<0>(q.resolution()) * q.get_filter_factor()),
+      res_y_(std::get<1>(q.resolution()) * q.get_filter_factor()),
       curIter_(policy_.begin()),
-      endIter_(policy_.end())
+      endIter_(policy_.end()),
+      decode_threads_(decode_threads),
+      next_decoded_(0)
 {
 }
 
@@ -62,75 +73,209 @@ raster_featureset<LookupPolicy>::~raster_featureset()
 }
 
 template <typename LookupPolicy>
-feature_ptr raster_featureset<LookupPolicy>::next()
+feature_ptr raster_featureset<LookupPolicy>::decode(raster_info const& info, mapnik::value_integer id) const
 {
-    if (curIter_ != endIter_)
+    feature_ptr feature(feature_factory::create(ctx_,id));
+
+    try
     {
-        feature_ptr feature(feature_factory::create(ctx_,feature_id_++));
+        std::unique_ptr<image_reader> reader(mapnik::get_image_reader(info.file(),info.format()));
 
-        try
-        {
-            std::unique_ptr<image_reader> reader(mapnik::get_image_reader(curIter_->file(),curIter_->format()));
+        MAPNIK_LOG_DEBUG(raster) << "raster_featureset: Reader=" << info.format() << "," << info.file()
+                                 << ",size(" << info.width() << "," << info.height() << ")";
 
-            MAPNIK_LOG_DEBUG(raster) << "raster_featureset: Reader=" << curIter_->format() << "," << curIter_->file()
-                                     << ",size(" << curIter_->width() << "," << curIter_->height() << ")";
+        if (reader.get())
+        {
+            int image_width = policy_.img_width(reader->width());
+            int image_height = policy_.img_height(reader->height());
+            int file_width = reader->width();
+            int file_height = reader->height();
 
-            if (reader.get())
+            if (image_width > 0 && image_height > 0)
             {
-                int image_width = policy_.img_width(reader->width());
-                int image_height = policy_.img_height(reader->height());
-
-                if (image_width > 0 && image_height > 0)
+                mapnik::view_transform t(image_width, image_height, extent_, 0, 0);
+                box2d<double> intersect = bbox_.intersect(info.envelope());
+                box2d<double> ext = t.forward(intersect);
+                box2d<double> rem = policy_.transform(ext);
+                if (ext.width() > 0.5 && ext.height() > 0.5 )
                 {
-                    mapnik::view_transform t(image_width, image_height, extent_, 0, 0);
-                    box2d<double> intersect = bbox_.intersect(curIter_->envelope());
-                    box2d<double> ext = t.forward(intersect);
-                    box2d<double> rem = policy_.transform(ext);
-                    if (ext.width() > 0.5 && ext.height() > 0.5 )
+                    // select minimum raster containing whole ext
+                    int x_off = static_cast<int>(std::floor(ext.minx()));
+                    int y_off = static_cast<int>(std::floor(ext.miny()));
+                    int end_x = static_cast<int>(std::ceil(ext.maxx()));
+                    int end_y = static_cast<int>(std::ceil(ext.maxy()));
+
+                    // clip to available data
+                    if (x_off < 0) x_off = 0;
+                    if (y_off < 0) y_off = 0;
+                    if (end_x > image_width)  end_x = image_width;
+                    if (end_y > image_height) end_y = image_height;
+
+                    // windows of tiled rasters are decoded as part of the source tile they
+                    // lie in, which goes through the process wide cache; windows may only
+                    // spill over the tile by rounding. A single file is one tile as large as
+                    // the image, so its windows are read on their own as before
+                    mapnik::raster_tile_cache & cache = mapnik::raster_tile_cache::instance();
+                    int tile_width = std::max(1, static_cast<int>(info.width()));
+                    int tile_height = std::max(1, static_cast<int>(info.height()));
+                    int tile_x0 = x_off - x_off % tile_width;
+                    int grid_y = policy_.grid_offset_y(file_height);
+                    int tile_y0 = y_off - ((y_off - grid_y) % tile_height + tile_height) % tile_height;
+                    int tile_x1 = std::min(tile_x0 + tile_width, file_width);
+                    int tile_y1 = std::min(tile_y0 + tile_height, file_height);
+                    tile_y0 = std::max(tile_y0, 0);
+                    std::size_t tile_bytes = static_cast<std::size_t>(tile_x1 - tile_x0) * (tile_y1 - tile_y0) *
+                        sizeof(image_data_32::pixel_type);
+                    bool cached = policy_.cache_tiles() && tile_bytes <= cache.max_bytes() &&
+                        x_off < tile_x1 && ext.maxx() < tile_x1 + 0.5 &&
+                        y_off < tile_y1 && ext.maxy() < tile_y1 + 0.5;
+                    if (cached)
+                    {
+                        end_x = std::min(end_x, tile_x1);
+                        end_y = std::min(end_y, tile_y1);
+                    }
+
+                    // rasters drawn at a fraction of their resolution are decoded
+                    // downsampled where the format allows it, on a window aligned
+                    // to whole reduced pixels
+                    double ratio = std::min(image_width / (extent_.width() * res_x_),
+                                            image_height / (extent_.height() * res_y_));
+                    int reduction = 1;
+                    if (ratio >= 2.0)
                     {
-                        // select minimum raster containing whole ext
-                        int x_off = static_cast<int>(std::floor(ext.minx()));
-                        int y_off = static_cast<int>(std::floor(ext.miny()));
-                        int end_x = static_cast<int>(std::ceil(ext.maxx()));
-                        int end_y = static_cast<int>(std::ceil(ext.maxy()));
-
-                        // clip to available data
-                        if (x_off < 0) x_off = 0;
-                        if (y_off < 0) y_off = 0;
-                        if (end_x > image_width)  end_x = image_width;
-                        if (end_y > image_height) end_y = image_height;
-
-                        int width = end_x - x_off;
-                        int height = end_y - y_off;
-
-                        // calculate actual box2d of returned raster
-                        box2d<double> feature_raster_extent(rem.minx() + x_off,
-                                                            rem.miny() + y_off,
-                                                            rem.maxx() + x_off + width,
-                                                            rem.maxy() + y_off + height);
-                        intersect = t.backward(feature_raster_extent);
-
-                        mapnik::raster_ptr raster = std::make_shared<mapnik::raster>(intersect, width, height, 1.0);
-                        reader->read(x_off, y_off, raster->data_);
+                        reduction = reader->set_reduction(static_cast<unsigned>(std::min(ratio, 64.0)));
+                        while (cached && reduction > 1 && (tile_x0 % reduction || tile_y0 % reduction))
+                        {
+                            reduction = reader->set_reduction(reduction - 1);
+                        }
+                    }
+                    if (reduction > 1)
+                    {
+                        x_off -= x_off % reduction;
+                        y_off -= y_off % reduction;
+                        end_x = std::min(end_x + (reduction - end_x % reduction) % reduction,
+                                         cached ? tile_x1 : file_width);
+                        end_y = std::min(end_y + (reduction - end_y % reduction) % reduction,
+                                         cached ? tile_y1 : file_height);
+                    }
+
+                    int width = end_x - x_off;
+                    int height = end_y - y_off;
+
+                    // calculate actual box2d of returned raster
+                    box2d<double> feature_raster_extent(rem.minx() + x_off,
+                                                        rem.miny() + y_off,
+                                                        rem.maxx() + x_off + width,
+                                                        rem.maxy() + y_off + height);
+                    intersect = t.backward(feature_raster_extent);
+
+                    mapnik::raster_ptr raster = std::make_shared<mapnik::raster>(intersect,
+                                                                                 (width + reduction - 1) / reduction,
+                                                                                 (height + reduction - 1) / reduction,
+                                                                                 1.0);
+                    if (cached)
+                    {
+                        int tile_rx = tile_x0 / reduction;
+                        int tile_ry = tile_y0 / reduction;
+                        mapnik::raster_tile_key key { info.file(),
+                                                      static_cast<unsigned>(tile_x0),
+                                                      static_cast<unsigned>(tile_y0),
+                                                      static_cast<unsigned>(reduction) };
+                        mapnik::raster_tile_ptr tile = cache.find(key);
+                        if (!tile)
+                        {
+                            auto decoded = std::make_shared<mapnik::raster_tile>((tile_x1 + reduction - 1) / reduction - tile_rx,
+                                                                                 (tile_y1 + reduction - 1) / reduction - tile_ry,
+                                                                                 reader->premultiplied_alpha());
+                            reader->read(tile_rx, tile_ry, decoded->data);
+                            cache.insert(key, decoded);
+                            tile = decoded;
+                        }
+                        // the renderer premultiplies and scales in place, so copy out
+                        for (unsigned y = 0; y < raster->data_.height(); ++y)
+                        {
+                            image_data_32::pixel_type const* row = tile->data.getRow(y_off / reduction - tile_ry + y) +
+                                x_off / reduction - tile_rx;
+                            std::copy(row, row + raster->data_.width(), raster->data_.getRow(y));
+                        }
+                        raster->premultiplied_alpha_ = tile->premultiplied_alpha;
+                    }
+                    else
+                    {
+                        reader->read(x_off / reduction, y_off / reduction, raster->data_);
                         raster->premultiplied_alpha_ = reader->premultiplied_alpha();
-                        feature->set_raster(raster);
                     }
+                    feature->set_raster(raster);
                 }
             }
         }
-        catch (mapnik::image_reader_exception const& ex)
+    }
+    catch (mapnik::image_reader_exception const& ex)
+    {
+        MAPNIK_LOG_ERROR(raster) << "Raster Plugin: image reader exception caught: " << ex.what();
+    }
+    catch (std::exception const& ex)
+    {
+        MAPNIK_LOG_ERROR(raster) << "Raster Plugin: " << ex.what();
+    }
+    catch (...)
+    {
+        MAPNIK_LOG_ERROR(raster) << "Raster Plugin: exception caught";
+    }
+
+    return feature;
+}
+
+template <typename LookupPolicy>
+void raster_featureset<LookupPolicy>::prefetch()
+{
+    // at most decode_threads tiles are held decoded at a time
+    decoded_.clear();
+    next_decoded_ = 0;
+    std::vector<raster_info const*> infos;
+    for (iterator_type itr = curIter_; itr != endIter_ && infos.size() < decode_threads_; ++itr)
+    {
+        infos.push_back(&*itr);
+    }
+    if (infos.size() < 2) return;
+
+    MAPNIK_LOG_DEBUG(raster) << "raster_featureset: Decoding " << infos.size() << " tiles concurrently";
+
+    decoded_.resize(infos.size());
+    try
+    {
+        mapnik::thread_pool::instance().parallel_for(infos.size(), decode_threads_, [&](std::size_t i) {
+            decoded_[i] = decode(*infos[i], feature_id_ + i);
+        });
+    }
+    catch (...)
+    {
+        decoded_.clear();
+        throw;
+    }
+}
+
+template <typename LookupPolicy>
+feature_ptr raster_featureset<LookupPolicy>::next()
+{
+    if (curIter_ != endIter_)
+    {
+        // source tiles are decoded on the shared thread pool in batches of
+        // decode_threads tiles, then handed out one by one
+        if (decode_threads_ > 1 && next_decoded_ == decoded_.size())
         {
-            MAPNIK_LOG_ERROR(raster) << "Raster Plugin: image reader exception caught: " << ex.what();
+            prefetch();
         }
-        catch (std::exception const& ex)
+        feature_ptr feature;
+        if (next_decoded_ < decoded_.size())
         {
-            MAPNIK_LOG_ERROR(raster) << "Raster Plugin: " << ex.what();
+            feature = std::move(decoded_[next_decoded_++]);
         }
-        catch (...)
+        else
         {
-            MAPNIK_LOG_ERROR(raster) << "Raster Plugin: exception caught";
+            feature = decode(*curIter_, feature_id_);
         }
-
+        ++feature_id_;
         ++curIter_;
         return feature;
     }
@@ -115,6 +115,16 @@ public:
     {
         return box2d<double>(0, 0, 0, 0);
     }
+
+    inline int grid_offset_y(int) const
+    {
+        return 0;
+    }
+
+    inline bool cache_tiles() const
+    {
+        return false;
+    }
 };
 
 class tiled_file_policy
@@ -130,6 +140,7 @@ public:
                       box2d<double> const& bbox,
                       unsigned width,
                       unsigned height)
+        : tile_size_(tile_size)
     {
         double lox = extent.minx();
         double loy = extent.miny();
@@ -190,8 +201,21 @@ public:
         return box2d<double>(0, 0, 0, 0);
     }
 
+    // tiles are laid out from the bottom of the image, which leaves the
+    // first row of tiles short
+    inline int grid_offset_y(int file_height) const
+    {
+        return file_height % tile_size_;
+    }
+
+    inline bool cache_tiles() const
+    {
+        return true;
+    }
+
 private:
 
+    int tile_size_;
     std::vector<raster_info> infos_;
 };
 
@@ -293,6 +317,16 @@ public:
         return rem;
     }
 
+    inline int grid_offset_y(int) const
+    {
+        return 0;
+    }
+
+    inline bool cache_tiles() const
+    {
+        return true;
+    }
+
 private:
 
     std::string interpolate(std::string const& pattern, int x, int y) const;
@@ -309,18 +343,27 @@ class raster_featureset : public mapnik::Featureset
 public:
     raster_featureset(LookupPolicy const& policy,
                       box2d<double> const& exttent,
-                      mapnik::query const& q);
+                      mapnik::query const& q,
+                      unsigned decode_threads = 1);
     virtual ~raster_featureset();
     mapnik::feature_ptr next();
 
 private:
+    mapnik::feature_ptr decode(raster_info const& info, mapnik::value_integer id) const;
+    void prefetch();
+
     LookupPolicy policy_;
     mapnik::value_integer feature_id_;
     mapnik::context_ptr ctx_;
     mapnik::box2d<double> extent_;
     mapnik::box2d<double> bbox_;
+    double res_x_;
+    double res_y_;
     iterator_type curIter_;
     iterator_type endIter_;
+    unsigned decode_threads_;
+    std::vector<mapnik::feature_ptr> decoded_;
+    std::size_t next_decoded_;
 };
 
 #endif // RASTER_FEATURESET_HPP
@@ -36,6 +36,7 @@
 #endif
 
 // stl
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <cstring>
@@ -80,10 +81,7 @@ dbf_file::dbf_file(std::string const& file_name)
 }
 
 
-dbf_file::~dbf_file()
-{
-    ::operator delete(record_);
-}
+dbf_file::~dbf_file() {}
 
 
 bool dbf_file::is_open()
@@ -111,9 +109,21 @@ void dbf_file::move_to(int index)
 {
     if (index>0 && index<=num_records_)
     {
-        std::streampos pos=(num_fields_<<5)+34+(index-1)*(record_length_+1);
+        std::size_t pos=(num_fields_<<5)+34+(index-1)*(record_length_+1);
+#ifdef SHAPE_MEMORY_MAPPED_FILE
+        // fields are decoded straight from the mapping, no copy of the record
+        if (pos + record_length_ <= mapped_region_->get_size())
+        {
+            record_ = static_cast<char const*>(mapped_region_->get_address()) + pos;
+        }
+        else
+        {
+            record_ = buffer_.data();
+        }
+#else
         file_.seekg(pos,std::ios::beg);
-        file_.read(record_,record_length_);
+        file_.read(buffer_.data(),record_length_);
+#endif
     }
 }
 
@@ -149,10 +159,13 @@ void dbf_file::add_attribute(int col, mapnik::transcoder const& tr, mapnik::feat
         case 'C':
         case 'D':
         {
-            // FIXME - avoid constructing std::string on stack
-            std::string str(record_+fields_[col].offset_,fields_[col].length_);
-            mapnik::util::trim(str);
-            f.put(name,tr.transcode(str.c_str()));
+            // trimmed in place, and like a c string up to the first nul
+            const char *begin = record_+fields_[col].offset_;
+            const char *end = begin + fields_[col].length_;
+            while (end != begin && !mapnik::util::not_whitespace(*(end - 1))) --end;
+            begin = std::find_if(begin, end, mapnik::util::not_whitespace);
+            end = std::find(begin, end, '\0');
+            f.put(name,tr.transcode_utf8(begin, static_cast<std::int32_t>(end - begin)));
             break;
         }
         case 'L':
@@ -245,10 +258,8 @@ void dbf_file::read_header()
             fields_.push_back(desc);
         }
         record_length_=offset;
-        if (record_length_>0)
-        {
-            record_=static_cast<char*>(::operator new (sizeof(char)*record_length_));
-        }
+        buffer_.assign(record_length_, ' ');
+        record_=buffer_.data();
     }
 }
 
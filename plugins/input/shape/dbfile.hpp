@@ -65,7 +65,10 @@ private:
 #else
     std::ifstream file_;
 #endif
-    char* record_;
+    // the current record, in place in the mapped file or else read into
+    // the buffer, which also stands in for records that don't exist
+    char const* record_;
+    std::vector<char> buffer_;
 public:
     dbf_file();
     dbf_file(std::string const& file_name);
@@ -124,7 +124,7 @@ feature_ptr sqlite_featureset::next()
             {
                 int text_col_size;
                 const char * text_data = rs_->column_text(i, text_col_size);
-                feature->put(fld_name_str, tr_->transcode(text_data, text_col_size));
+                feature->put(fld_name_str, tr_->transcode_utf8(text_data, text_col_size));
                 break;
             }
 
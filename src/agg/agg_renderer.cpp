@@ -29,6 +29,7 @@
 #include <mapnik/debug.hpp>
 #include <mapnik/layer.hpp>
 #include <mapnik/label_collision_detector.hpp>
+#include <mapnik/text/vertex_cache_store.hpp>
 #include <mapnik/feature_type_style.hpp>
 #include <mapnik/marker.hpp>
 #include <mapnik/marker_cache.hpp>
@@ -58,6 +59,7 @@
 
 // stl
 #include <cmath>
+#include <cstring>
 
 namespace mapnik
 {
@@ -67,6 +69,7 @@ agg_renderer<T0,T1>::agg_renderer(Map const& m, T0 & pixmap, double scale_factor
     : feature_style_processor<agg_renderer>(m, scale_factor),
       pixmap_(pixmap),
       internal_buffer_(),
+      internal_buffer_dirty_(),
       current_buffer_(&pixmap),
       style_level_compositing_(false),
       ras_ptr(new rasterizer),
@@ -82,6 +85,7 @@ agg_renderer<T0,T1>::agg_renderer(Map const& m, request const& req, attributes c
     : feature_style_processor<agg_renderer>(m, scale_factor),
       pixmap_(pixmap),
       internal_buffer_(),
+      internal_buffer_dirty_(),
       current_buffer_(&pixmap),
       style_level_compositing_(false),
       ras_ptr(new rasterizer),
@@ -98,6 +102,7 @@ agg_renderer<T0,T1>::agg_renderer(Map const& m, T0 & pixmap, std::shared_ptr<T1>
     : feature_style_processor<agg_renderer>(m, scale_factor),
       pixmap_(pixmap),
       internal_buffer_(),
+      internal_buffer_dirty_(),
       current_buffer_(&pixmap),
       style_level_compositing_(false),
       ras_ptr(new rasterizer),
@@ -185,6 +190,7 @@ void agg_renderer<T0,T1>::start_layer_processing(layer const& lay, box2d<double>
     {
         common_.detector_->clear();
     }
+    common_.vertex_caches_->clear();
 
     common_.query_extent_ = query_extent;
     boost::optional<box2d<double> > const& maximum_extent = lay.maximum_extent();
@@ -236,10 +242,11 @@ void agg_renderer<T0,T1>::start_style_processing(feature_type_style const& st)
                 internal_buffer_->height() < target_height))
             {
                 internal_buffer_ = std::make_shared<buffer_type>(target_width,target_height);
+                internal_buffer_dirty_ = box2d<int>();
             }
             else
             {
-                internal_buffer_->set_background(color(0,0,0,0)); // fill with transparent colour
+                internal_buffer_->clear(internal_buffer_dirty_);
             }
         }
         else
@@ -247,10 +254,11 @@ void agg_renderer<T0,T1>::start_style_processing(feature_type_style const& st)
             if (!internal_buffer_)
             {
                 internal_buffer_ = std::make_shared<buffer_type>(common_.width_,common_.height_);
+                internal_buffer_dirty_ = box2d<int>();
             }
             else
             {
-                internal_buffer_->set_background(color(0,0,0,0)); // fill with transparent colour
+                internal_buffer_->clear(internal_buffer_dirty_);
             }
             common_.t_.set_offset(0);
             ras_ptr->clip_box(0,0,common_.width_,common_.height_);
@@ -270,30 +278,72 @@ void agg_renderer<T0,T1>::end_style_processing(feature_type_style const& st)
 {
     if (style_level_compositing_)
     {
+        // Everything outside of the painted box is transparent, filters and
+        // compositing are limited to it and the next style only clears it.
+        buffer_type & buffer = *current_buffer_;
+        box2d<int> image(0, 0, buffer.width(), buffer.height());
+        box2d<int> dirty = buffer.bounding_box();
         bool blend_from = false;
         if (st.image_filters().size() > 0)
         {
             blend_from = true;
-            mapnik::filter::filter_visitor<image_32> visitor(*current_buffer_);
+            box2d<int> extent = dirty;
+            mapnik::filter::filter_extent_visitor extent_visitor(extent, image);
             for (mapnik::filter::filter_type const& filter_tag : st.image_filters())
             {
-                util::apply_visitor(visitor, filter_tag);
+                util::apply_visitor(extent_visitor, filter_tag);
             }
+            if (extent == image)
+            {
+                mapnik::filter::filter_visitor<image_32> visitor(buffer);
+                for (mapnik::filter::filter_type const& filter_tag : st.image_filters())
+                {
+                    util::apply_visitor(visitor, filter_tag);
+                }
+            }
+            else if (extent.valid())
+            {
+                unsigned x0 = extent.minx();
+                unsigned y0 = extent.miny();
+                unsigned width = extent.width();
+                unsigned height = extent.height();
+                std::size_t row_bytes = width * sizeof(image_data_32::pixel_type);
+                buffer_type region(width, height);
+                for (unsigned y = 0; y < height; ++y)
+                {
+                    std::memcpy(region.data().getRow(y), buffer.data().getRow(y0 + y) + x0, row_bytes);
+                }
+                mapnik::filter::filter_visitor<image_32> visitor(region);
+                for (mapnik::filter::filter_type const& filter_tag : st.image_filters())
+                {
+                    util::apply_visitor(visitor, filter_tag);
+                }
+                for (unsigned y = 0; y < height; ++y)
+                {
+                    std::memcpy(buffer.data().getRow(y0 + y) + x0, region.data().getRow(y), row_bytes);
+                }
+            }
+            dirty = extent;
         }
-        if (st.comp_op())
-        {
-            composite(pixmap_.data(), current_buffer_->data(),
-                      *st.comp_op(), st.get_opacity(),
-                      -common_.t_.offset(),
-                      -common_.t_.offset(), false);
-        }
-        else if (blend_from || st.get_opacity() < 1.0)
+        if (st.comp_op() || blend_from || st.get_opacity() < 1.0)
         {
-            composite(pixmap_.data(), current_buffer_->data(),
-                      src_over, st.get_opacity(),
-                      -common_.t_.offset(),
-                      -common_.t_.offset(), false);
+            composite_mode_e comp_op = st.comp_op() ? *st.comp_op() : src_over;
+            if (!composite_transparent_noop(comp_op))
+            {
+                composite(pixmap_.data(), buffer.data(),
+                          comp_op, st.get_opacity(),
+                          -common_.t_.offset(),
+                          -common_.t_.offset(), false);
+            }
+            else if (dirty.valid())
+            {
+                composite(pixmap_.data(), buffer.data(), dirty,
+                          comp_op, st.get_opacity(),
+                          -common_.t_.offset(),
+                          -common_.t_.offset());
+            }
         }
+        internal_buffer_dirty_ = dirty;
     }
     // apply any 'direct' image filters
     mapnik::filter::filter_visitor<image_32> visitor(pixmap_);
@@ -151,10 +151,16 @@ source = Split(
     well_known_srs.cpp
     params.cpp
     image_filter_types.cpp
+    image_filter.cpp
     miniz_png.cpp
+    parallel_png.cpp
+    thread_pool.cpp
+    encoded_image_cache.cpp
+    raster_tile_cache.cpp
     color.cpp
     conversions.cpp
     image_compositing.cpp
+    simd.cpp
     image_scaling.cpp
     box2d.cpp
     datasource_cache.cpp
@@ -205,11 +211,14 @@ source = Split(
     css_color_grammar.cpp
     text/font_library.cpp
     text/vertex_cache.cpp
+    text/vertex_cache_store.cpp
     text/text_layout.cpp
     text/text_line.cpp
     text/itemizer.cpp
     text/scrptrun.cpp
     text/face.cpp
+    text/glyph_cache.cpp
+    text/shaping_cache.cpp
     text/placement_finder.cpp
     text/properties_util.cpp
     text/renderer.cpp
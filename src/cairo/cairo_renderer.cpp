@@ -34,6 +34,7 @@
 #include <mapnik/attribute.hpp>
 #include <mapnik/request.hpp>
 #include <mapnik/label_collision_detector.hpp>
+#include <mapnik/text/vertex_cache_store.hpp>
 #include <mapnik/marker.hpp>
 #include <mapnik/marker_cache.hpp>
 
@@ -166,6 +167,7 @@ void cairo_renderer<T>::start_layer_processing(layer const& lay, box2d<double> c
     {
         common_.detector_->clear();
     }
+    common_.vertex_caches_->clear();
     common_.query_extent_ = query_extent;
 }
 
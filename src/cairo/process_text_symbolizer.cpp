@@ -47,7 +47,7 @@ void cairo_renderer<T>::process(shield_symbolizer const& sym,
             common_.width_, common_.height_,
             common_.scale_factor_,
             common_.t_, common_.font_manager_, *common_.detector_,
-            common_.query_extent_, tr);
+            common_.query_extent_, tr, common_.vertex_caches_.get());
 
     cairo_save_restore guard(context_);
     composite_mode_e comp_op = get<composite_mode_e>(sym, keys::comp_op, feature, common_.vars_, src_over);
@@ -85,7 +85,7 @@ void cairo_renderer<T>::process(text_symbolizer const& sym,
             common_.width_, common_.height_,
             common_.scale_factor_,
             common_.t_, common_.font_manager_, *common_.detector_,
-            common_.query_extent_, tr);
+            common_.query_extent_, tr, common_.vertex_caches_.get());
 
     cairo_save_restore guard(context_);
     composite_mode_e comp_op = get<composite_mode_e>(sym, keys::comp_op, feature, common_.vars_,  src_over);
@@ -0,0 +1,66 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/encoded_image_cache.hpp>
+
+namespace mapnik
+{
+
+template class singleton<encoded_image_cache, CreateUsingNew>;
+
+encoded_image_cache::encoded_image_cache()
+    : cache_(1024) {}
+
+encoded_image_cache::~encoded_image_cache() {}
+
+encoded_image_ptr encoded_image_cache::find(encoded_image_key const& key)
+{
+    return cache_.find(key);
+}
+
+void encoded_image_cache::insert(encoded_image_key const& key, encoded_image_ptr data)
+{
+    cache_.insert(key, data);
+}
+
+void encoded_image_cache::clear()
+{
+    cache_.clear();
+}
+
+void encoded_image_cache::set_max_size(std::size_t max_size)
+{
+    cache_.set_max_size(max_size);
+}
+
+std::size_t encoded_image_cache::max_size() const
+{
+    return cache_.max_size();
+}
+
+std::size_t encoded_image_cache::size() const
+{
+    return cache_.entries();
+}
+
+}
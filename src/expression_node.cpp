@@ -30,35 +30,395 @@
 #include <boost/regex.hpp>
 #endif
 
+// stl
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace mapnik
 {
 
+namespace detail {
+
+// Literal parts of a regex pattern which every match must contain.
+// Only a conservative subset of the perl syntax is understood: anything
+// that could change the meaning of a literal (inline flags, lookaround,
+// escapes with arguments, alternation at the top level, anchors in the middle)
+// disables the prefilter entirely.
+template <typename CharT>
+struct regex_literals
+{
+    using string_type = std::basic_string<CharT>;
+    bool usable = false;
+    bool exact = false;       // whole pattern is a plain literal
+    string_type prefix;       // leading literal run
+    string_type suffix;       // trailing literal run (disjoint from prefix)
+    string_type required;     // longest literal run in between
+    string_type longest;      // longest literal run anywhere
+};
+
+template <typename CharT>
+struct regex_atom
+{
+    bool literal;
+    bool quantified;
+    CharT c;
+};
+
+inline bool is_ascii_alnum(std::uint32_t c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// alphanumeric escapes which stand for exactly one character, class or
+// assertion and take no arguments; all others (\x41, \0101, \cA, \pL,
+// \N{..}, \Q..\E, \u, backreferences, ...) consume the characters that
+// follow them and must not leave those behind as literals
+inline bool is_plain_escape(std::uint32_t c)
+{
+    switch (c)
+    {
+    case 'd': case 'D': case 'w': case 'W': case 's': case 'S':
+    case 'b': case 'B': case 'A': case 'z': case 'Z':
+    case 'a': case 'e': case 'f': case 'n': case 'r': case 't':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// \< \> \` and \' are word and buffer assertions in perl syntax,
+// not the punctuation they escape
+inline bool is_assertion_escape(std::uint32_t c)
+{
+    return c == '<' || c == '>' || c == '`' || c == '\'';
+}
+
+// \Q..\E and \c quote or swallow the next characters wherever they are,
+// even inside groups and classes which are otherwise skipped unparsed
+template <typename Iterator>
+bool has_quoting_escape(Iterator itr, Iterator end)
+{
+    while (itr != end)
+    {
+        if (*itr++ == '\\')
+        {
+            if (itr == end) return false;
+            auto e = *itr++;
+            if (e == 'Q' || e == 'E' || e == 'c') return true;
+        }
+    }
+    return false;
+}
+
+// skip a [...] class starting at itr (pointing at '['), returns false if unterminated
+template <typename Iterator>
+bool skip_char_class(Iterator & itr, Iterator end)
+{
+    ++itr;
+    if (itr != end && *itr == '^') ++itr;
+    if (itr != end && *itr == ']') ++itr;
+    while (itr != end)
+    {
+        if (*itr == '\\')
+        {
+            if (++itr == end) return false;
+        }
+        else if (*itr == '[')
+        {
+            // posix classes like [:alpha:]
+            Iterator next = itr;
+            ++next;
+            if (next != end && (*next == ':' || *next == '=' || *next == '.'))
+            {
+                auto delim = *next;
+                itr = ++next;
+                while (itr != end && !(*itr == delim && (itr + 1) != end && *(itr + 1) == ']')) ++itr;
+                if (itr == end) return false;
+                ++itr;
+            }
+        }
+        else if (*itr == ']')
+        {
+            ++itr;
+            return true;
+        }
+        ++itr;
+    }
+    return false;
+}
+
+template <typename CharT>
+regex_literals<CharT> extract_regex_literals(std::basic_string<CharT> const& pattern)
+{
+    using string_type = std::basic_string<CharT>;
+    regex_literals<CharT> result;
+    std::vector<regex_atom<CharT>> atoms;
+    auto itr = pattern.begin();
+    auto end = pattern.end();
+    if (has_quoting_escape(itr, end)) return result;
+    if (itr != end && *itr == '^') ++itr;
+    while (itr != end)
+    {
+        CharT c = *itr;
+        if (c == '\\')
+        {
+            if (++itr == end) return result;
+            CharT e = *itr++;
+            if (is_assertion_escape(e)) atoms.push_back({false, false, e});
+            else if (!is_ascii_alnum(e)) atoms.push_back({true, false, e});
+            else if (is_plain_escape(e)) atoms.push_back({false, false, e});
+            else return result;
+        }
+        else if (c == '[')
+        {
+            if (!skip_char_class(itr, end)) return result;
+            atoms.push_back({false, false, c});
+        }
+        else if (c == '(')
+        {
+            ++itr;
+            if (itr != end && *itr == '?') return result;
+            int depth = 1;
+            while (itr != end && depth > 0)
+            {
+                if (*itr == '\\')
+                {
+                    if (++itr == end) return result;
+                    ++itr;
+                }
+                else if (*itr == '[')
+                {
+                    if (!skip_char_class(itr, end)) return result;
+                }
+                else
+                {
+                    if (*itr == '(') ++depth;
+                    else if (*itr == ')') --depth;
+                    ++itr;
+                }
+            }
+            if (depth != 0) return result;
+            atoms.push_back({false, false, c});
+        }
+        else if (c == '*' || c == '+' || c == '?' || c == '{')
+        {
+            if (atoms.empty()) return result;
+            if (c == '{')
+            {
+                while (itr != end && *itr != '}') ++itr;
+                if (itr == end) return result;
+            }
+            ++itr;
+            // lazy and possessive modifiers
+            if (itr != end && (*itr == '?' || *itr == '+')) ++itr;
+            atoms.back().quantified = true;
+        }
+        else if (c == '$')
+        {
+            if (++itr != end) return result;
+        }
+        else if (c == '|' || c == '^' || c == ')')
+        {
+            return result;
+        }
+        else
+        {
+            atoms.push_back({c != '.', false, c});
+            ++itr;
+        }
+    }
+
+    // split into runs of fixed literals
+    std::vector<string_type> runs;
+    bool leading = true;
+    bool trailing = false;
+    string_type current;
+    for (auto const& atom : atoms)
+    {
+        if (atom.literal && !atom.quantified)
+        {
+            current += atom.c;
+            trailing = true;
+        }
+        else
+        {
+            if (leading) result.prefix = current;
+            else if (!current.empty()) runs.push_back(current);
+            leading = false;
+            trailing = false;
+            current.clear();
+        }
+    }
+    result.usable = true;
+    if (leading)
+    {
+        result.exact = true;
+        result.prefix = current;
+        result.longest = current;
+        return result;
+    }
+    if (trailing) result.suffix = current;
+    result.longest = result.prefix.size() >= result.suffix.size() ? result.prefix : result.suffix;
+    for (auto const& run : runs)
+    {
+        if (run.size() > result.required.size()) result.required = run;
+    }
+    if (result.required.size() > result.longest.size()) result.longest = result.required;
+    return result;
+}
+
+#if defined(BOOST_REGEX_HAS_ICU)
+using regex_string = value_unicode_string;
+
+inline regex_string make_regex_string(std::basic_string<UChar32> const& str)
+{
+    return value_unicode_string::fromUTF32(str.data(), static_cast<std::int32_t>(str.size()));
+}
+
+inline bool starts_with(regex_string const& str, regex_string const& prefix)
+{
+    return str.startsWith(prefix);
+}
+
+inline bool ends_with(regex_string const& str, regex_string const& suffix)
+{
+    return str.endsWith(suffix);
+}
+
+inline bool contains(regex_string const& str, regex_string const& needle, std::size_t start, std::size_t length)
+{
+    if (needle.isEmpty()) return true;
+    return str.indexOf(needle, static_cast<std::int32_t>(start), static_cast<std::int32_t>(length)) >= 0;
+}
+#else
+using regex_string = std::string;
+
+inline regex_string make_regex_string(std::string const& str)
+{
+    return str;
+}
+
+inline bool starts_with(regex_string const& str, regex_string const& prefix)
+{
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+inline bool ends_with(regex_string const& str, regex_string const& suffix)
+{
+    if (suffix.size() > str.size()) return false;
+    return str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+inline bool contains(regex_string const& str, regex_string const& needle, std::size_t start, std::size_t length)
+{
+    if (needle.empty()) return true;
+    std::size_t pos = str.find(needle, start);
+    return pos != std::string::npos && pos + needle.size() <= start + length;
+}
+#endif
+
+inline std::size_t regex_string_length(regex_string const& str)
+{
+    return static_cast<std::size_t>(str.length());
+}
+
+} // namespace detail
+
 struct _regex_match_impl : noncopyable {
 #if defined(BOOST_REGEX_HAS_ICU)
     _regex_match_impl(value_unicode_string const& ustr) :
-        pattern_(boost::make_u32regex(ustr)) {}
+        pattern_(boost::make_u32regex(ustr)),
+        has_literals_(false),
+        exact_(false),
+        min_length_(0)
+    {
+        init(pattern_.str());
+    }
     boost::u32regex pattern_;
 #else
     _regex_match_impl(std::string const& ustr) :
-        pattern_(ustr) {}
+        pattern_(ustr),
+        has_literals_(false),
+        exact_(false),
+        min_length_(0)
+    {
+        init(pattern_.str());
+    }
     boost::regex pattern_;
 #endif
+
+    template <typename String>
+    void init(String const& str)
+    {
+        auto literals = detail::extract_regex_literals(str);
+        if (!literals.usable) return;
+        has_literals_ = true;
+        exact_ = literals.exact;
+        prefix_ = detail::make_regex_string(literals.prefix);
+        suffix_ = detail::make_regex_string(literals.suffix);
+        required_ = detail::make_regex_string(literals.required);
+        min_length_ = detail::regex_string_length(prefix_) +
+            detail::regex_string_length(suffix_) +
+            detail::regex_string_length(required_);
+    }
+
+    // returns false when the input cannot possibly match
+    bool may_match(detail::regex_string const& str) const
+    {
+        if (!has_literals_) return true;
+        std::size_t length = detail::regex_string_length(str);
+        if (length < min_length_) return false;
+        if (!detail::starts_with(str, prefix_)) return false;
+        if (!detail::ends_with(str, suffix_)) return false;
+        if (detail::regex_string_length(required_) > 0)
+        {
+            std::size_t start = detail::regex_string_length(prefix_);
+            std::size_t span = length - start - detail::regex_string_length(suffix_);
+            if (!detail::contains(str, required_, start, span)) return false;
+        }
+        return true;
+    }
+
+    bool has_literals_;
+    // pattern without any metacharacters: matching is plain equality against prefix_
+    bool exact_;
+    std::size_t min_length_;
+    detail::regex_string prefix_;
+    detail::regex_string suffix_;
+    detail::regex_string required_;
 };
 
 struct _regex_replace_impl : noncopyable {
 #if defined(BOOST_REGEX_HAS_ICU)
     _regex_replace_impl(value_unicode_string const& ustr, value_unicode_string const& f) :
         pattern_(boost::make_u32regex(ustr)),
-        format_(f) {}
+        format_(f)
+    {
+        init(pattern_.str());
+    }
     boost::u32regex pattern_;
     value_unicode_string format_;
 #else
     _regex_replace_impl(std::string const& ustr,std::string const& f) :
         pattern_(ustr),
-        format_(f) {}
+        format_(f)
+    {
+        init(pattern_.str());
+    }
     boost::regex pattern_;
     std::string format_;
 #endif
+
+    template <typename String>
+    void init(String const& str)
+    {
+        auto literals = detail::extract_regex_literals(str);
+        if (literals.usable) required_ = detail::make_regex_string(literals.longest);
+    }
+
+    // longest literal every match must contain, empty if unknown
+    detail::regex_string required_;
 };
 
 
@@ -76,11 +436,18 @@ regex_match_node::regex_match_node(transcoder const& tr,
 
 value regex_match_node::apply(value const& v) const
 {
-    auto const& pattern = impl_.get()->pattern_;
+    auto const& impl = *impl_;
 #if defined(BOOST_REGEX_HAS_ICU)
-    return boost::u32regex_match(v.to_unicode(),pattern);
+    value_unicode_string str = v.to_unicode();
 #else
-    return boost::regex_match(v.to_string(),pattern);
+    std::string str = v.to_string();
+#endif
+    if (impl.exact_) return str == impl.prefix_;
+    if (!impl.may_match(str)) return false;
+#if defined(BOOST_REGEX_HAS_ICU)
+    return boost::u32regex_match(str,impl.pattern_);
+#else
+    return boost::regex_match(str,impl.pattern_);
 #endif
 }
 
@@ -118,14 +485,18 @@ regex_replace_node::regex_replace_node(transcoder const& tr,
 
 value regex_replace_node::apply(value const& v) const
 {
-    auto const& pattern = impl_.get()->pattern_;
-    auto const& format = impl_.get()->format_;
+    auto const& impl = *impl_;
+    auto const& pattern = impl.pattern_;
+    auto const& format = impl.format_;
 #if defined(BOOST_REGEX_HAS_ICU)
-    return boost::u32regex_replace(v.to_unicode(),pattern,format);
+    value_unicode_string str = v.to_unicode();
+    // no match possible: replacement would return the input unchanged
+    if (!detail::contains(str, impl.required_, 0, detail::regex_string_length(str))) return str;
+    return boost::u32regex_replace(str,pattern,format);
 #else
-    std::string repl = boost::regex_replace(v.to_string(),pattern,format);
-    transcoder tr_("utf8");
-    return tr_.transcode(repl.c_str());
+    std::string str = v.to_string();
+    if (!detail::contains(str, impl.required_, 0, str.size())) return value_utf8_string(str);
+    return value_utf8_string(boost::regex_replace(str,pattern,format));
 #endif
 }
 
@@ -46,7 +46,8 @@ feature_type_style::feature_type_style()
       direct_filters_(),
       comp_op_(),
       opacity_(1.0f),
-      image_filters_inflate_(false)
+      image_filters_inflate_(false),
+      filter_batch_size_(0)
 {}
 
 feature_type_style::feature_type_style(feature_type_style const& rhs)
@@ -56,7 +57,8 @@ feature_type_style::feature_type_style(feature_type_style const& rhs)
       direct_filters_(rhs.direct_filters_),
       comp_op_(rhs.comp_op_),
       opacity_(rhs.opacity_),
-      image_filters_inflate_(rhs.image_filters_inflate_) {}
+      image_filters_inflate_(rhs.image_filters_inflate_),
+      filter_batch_size_(rhs.filter_batch_size_) {}
 
 feature_type_style::feature_type_style(feature_type_style && rhs)
     : rules_(std::move(rhs.rules_)),
@@ -65,7 +67,8 @@ feature_type_style::feature_type_style(feature_type_style && rhs)
       direct_filters_(std::move(rhs.direct_filters_)),
       comp_op_(std::move(rhs.comp_op_)),
       opacity_(std::move(rhs.opacity_)),
-      image_filters_inflate_(std::move(rhs.image_filters_inflate_)) {}
+      image_filters_inflate_(std::move(rhs.image_filters_inflate_)),
+      filter_batch_size_(std::move(rhs.filter_batch_size_)) {}
 
 feature_type_style& feature_type_style::operator=(feature_type_style rhs)
 {
@@ -77,6 +80,7 @@ feature_type_style& feature_type_style::operator=(feature_type_style rhs)
     std::swap(this->comp_op_, rhs.comp_op_);
     std::swap(this->opacity_, rhs.opacity_);
     std::swap(this->image_filters_inflate_, rhs.image_filters_inflate_);
+    std::swap(this->filter_batch_size_, rhs.filter_batch_size_);
     return *this;
 }
 
@@ -88,7 +92,8 @@ bool feature_type_style::operator==(feature_type_style const& rhs) const
         (direct_filters_ == rhs.direct_filters_) &&
         (comp_op_ == rhs.comp_op_) &&
         (opacity_ == rhs.opacity_) &&
-        (image_filters_inflate_ == rhs.image_filters_inflate_);
+        (image_filters_inflate_ == rhs.image_filters_inflate_) &&
+        (filter_batch_size_ == rhs.filter_batch_size_);
 }
 
 void feature_type_style::add_rule(rule && rule)
@@ -178,4 +183,14 @@ bool feature_type_style::image_filters_inflate() const
     return image_filters_inflate_;
 }
 
+void feature_type_style::set_filter_batch_size(unsigned size)
+{
+    filter_batch_size_ = size;
+}
+
+unsigned feature_type_style::filter_batch_size() const
+{
+    return filter_batch_size_;
+}
+
 }
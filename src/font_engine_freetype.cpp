@@ -34,6 +34,9 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+#include <boost/interprocess/mapped_region.hpp>
+#endif
 
 // stl
 #include <algorithm>
@@ -308,7 +311,6 @@ face_ptr freetype_engine::create_face(std::string const& family_name,
                                       freetype_engine::font_file_mapping_type const& global_font_file_mapping,
                                       freetype_engine::font_memory_cache_type & global_memory_fonts)
 {
-    bool found_font_file = false;
     font_file_mapping_type::const_iterator itr = font_file_mapping.find(family_name);
     // look for font registered on specific map
     if (itr != font_file_mapping.end())
@@ -323,59 +325,123 @@ face_ptr freetype_engine::create_face(std::string const& family_name,
                                                 static_cast<FT_Long>(mem_font_itr->second.second), // size
                                                 itr->second.first, // face index
                                                 &face);
-            if (!error) return std::make_shared<font_face>(face);
+            if (!error) return std::make_shared<font_face>(face, itr->second.second, itr->second.first);
         }
         // we don't add to cache here because the map and its font_cache
         // must be immutable during rendering for predictable thread safety
-        found_font_file = true;
     }
     else
     {
         // otherwise search global registry
         itr = global_font_file_mapping.find(family_name);
-        if (itr != global_font_file_mapping.end())
-        {
-            auto mem_font_itr = global_memory_fonts_.find(itr->second.second);
-            // if font already in memory, use it
-            if (mem_font_itr != global_memory_fonts_.end())
-            {
-                FT_Face face;
-                FT_Error error = FT_New_Memory_Face(library.get(),
-                                                    reinterpret_cast<FT_Byte const*>(mem_font_itr->second.first.get()), // data
-                                                    static_cast<FT_Long>(mem_font_itr->second.second), // size
-                                                    itr->second.first, // face index
-                                                    &face);
-                if (!error) return std::make_shared<font_face>(face);
-            }
-            found_font_file = true;
-        }
+        if (itr == global_font_file_mapping.end()) return face_ptr();
     }
-    // if we found file file but it is not yet in memory
-    if (found_font_file)
+    char const* data = nullptr;
+    std::size_t size = 0;
+    if (global_font_data(itr->second.second, data, size))
     {
-        mapnik::util::file file(itr->second.second);
-        if (file.open())
-        {
+        FT_Face face;
+        FT_Error error = FT_New_Memory_Face(library.get(),
+                                            reinterpret_cast<FT_Byte const*>(data),
+                                            static_cast<FT_Long>(size),
+                                            itr->second.first, // face index
+                                            &face);
+        if (!error) return std::make_shared<font_face>(face, itr->second.second, itr->second.first);
+    }
+    return face_ptr();
+}
+
+namespace {
+
+// FreeType library and faces of the calling thread. Faces hold on to the
+// library so they stay valid if they happen to outlive the thread.
+struct thread_face_cache
+{
+    thread_face_cache()
+        : library(std::make_shared<font_library>()),
+          faces() {}
+
+    std::shared_ptr<font_library> library;
+    // keyed by face index and file name
+    std::map<std::pair<int,std::string>, face_ptr> faces;
+};
+
+thread_face_cache & local_face_cache()
+{
+    static thread_local thread_face_cache cache;
+    return cache;
+}
+
+}
+
+face_ptr freetype_engine::create_thread_face(std::string const& family_name,
+                                             freetype_engine::font_file_mapping_type const& font_file_mapping,
+                                             freetype_engine::font_file_mapping_type const& global_font_file_mapping)
+{
+    font_file_mapping_type::const_iterator itr = font_file_mapping.find(family_name);
+    if (itr == font_file_mapping.end())
+    {
+        itr = global_font_file_mapping.find(family_name);
+        if (itr == global_font_file_mapping.end()) return face_ptr();
+    }
+    thread_face_cache & cache = local_face_cache();
+    auto face_itr = cache.faces.find(itr->second);
+    if (face_itr != cache.faces.end())
+    {
+        return face_itr->second;
+    }
+    char const* data = nullptr;
+    std::size_t size = 0;
+    if (!global_font_data(itr->second.second, data, size)) return face_ptr();
+    FT_Face face;
+    FT_Error error = FT_New_Memory_Face(cache.library->get(),
+                                        reinterpret_cast<FT_Byte const*>(data),
+                                        static_cast<FT_Long>(size),
+                                        itr->second.first, // face index
+                                        &face);
+    if (error) return face_ptr();
+    std::shared_ptr<font_library> library = cache.library;
+    face_ptr result(new font_face(face, itr->second.second, itr->second.first), [library](font_face * f) { delete f; });
+    cache.faces.emplace(itr->second, result);
+    return result;
+}
+
+bool freetype_engine::global_font_data(std::string const& file_name, char const*& data, std::size_t & size)
+{
 #ifdef MAPNIK_THREADSAFE
-            mapnik::scoped_lock lock(mutex_);
+    mapnik::scoped_lock lock(mutex_);
 #endif
-            auto result = global_memory_fonts_.emplace(itr->second.second, std::make_pair(std::move(file.data()),file.size()));
-            FT_Face face;
-            FT_Error error = FT_New_Memory_Face(library.get(),
-                                                reinterpret_cast<FT_Byte const*>(result.first->second.first.get()), // data
-                                                static_cast<FT_Long>(result.first->second.second), // size
-                                                itr->second.first, // face index
-                                                &face);
-            if (error)
-            {
-                // we can't load font, erase it.
-                global_memory_fonts_.erase(result.first);
-                return face_ptr();
-            }
-            return std::make_shared<font_face>(face);
+    auto mem_font_itr = global_memory_fonts_.find(file_name);
+    if (mem_font_itr != global_memory_fonts_.end())
+    {
+        data = mem_font_itr->second.first.get();
+        size = mem_font_itr->second.second;
+        return true;
+    }
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+    // map font files once and share the read only pages between all threads
+    auto mapped_itr = global_mapped_fonts_.find(file_name);
+    if (mapped_itr == global_mapped_fonts_.end())
+    {
+        boost::optional<mapped_region_ptr> region = mapped_memory_cache::instance().find(file_name);
+        if (region)
+        {
+            mapped_itr = global_mapped_fonts_.emplace(file_name, *region).first;
         }
     }
-    return face_ptr();
+    if (mapped_itr != global_mapped_fonts_.end())
+    {
+        data = static_cast<char const*>(mapped_itr->second->get_address());
+        size = mapped_itr->second->get_size();
+        return true;
+    }
+#endif
+    mapnik::util::file file(file_name);
+    if (!file.open()) return false;
+    auto result = global_memory_fonts_.emplace(file_name, std::make_pair(std::move(file.data()),file.size()));
+    data = result.first->second.first.get();
+    size = result.first->second.second;
+    return true;
 }
 
 
@@ -398,21 +464,40 @@ face_manager::face_manager(font_library & library,
 face_ptr face_manager::get_face(std::string const& name)
 {
     auto itr = face_ptr_cache_.find(name);
-    if (itr != face_ptr_cache_.end())
+    // renderers may move between threads, faces of another thread's
+    // FreeType library must not be used from this one
+    if (itr != face_ptr_cache_.end() &&
+        (itr->second.second == std::thread::id() ||
+         itr->second.second == std::this_thread::get_id()))
     {
-        return itr->second;
+        return itr->second.first;
     }
     else
     {
-        face_ptr face = freetype_engine::create_face(name,
-                                                     library_,
-                                                     font_file_mapping_,
-                                                     font_memory_cache_,
-                                                     freetype_engine::get_mapping(),
-                                                     freetype_engine::get_cache());
+        face_ptr face;
+        std::thread::id owner;
+        auto mapping_itr = font_file_mapping_.find(name);
+        if (mapping_itr != font_file_mapping_.end() &&
+            font_memory_cache_.find(mapping_itr->second.second) != font_memory_cache_.end())
+        {
+            // font memory owned by the map, faces must not outlive the renderer
+            face = freetype_engine::create_face(name,
+                                                library_,
+                                                font_file_mapping_,
+                                                font_memory_cache_,
+                                                freetype_engine::get_mapping(),
+                                                freetype_engine::get_cache());
+        }
+        else
+        {
+            face = freetype_engine::create_thread_face(name,
+                                                       font_file_mapping_,
+                                                       freetype_engine::get_mapping());
+            owner = std::this_thread::get_id();
+        }
         if (face)
         {
-            face_ptr_cache_.emplace(name,face);
+            face_ptr_cache_[name] = std::make_pair(face, owner);
         }
         return face;
     }
@@ -468,5 +553,8 @@ std::mutex freetype_engine::mutex_;
 #endif
 freetype_engine::font_file_mapping_type freetype_engine::global_font_file_mapping_;
 freetype_engine::font_memory_cache_type freetype_engine::global_memory_fonts_;
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+std::map<std::string, mapped_region_ptr> freetype_engine::global_mapped_fonts_;
+#endif
 
 }
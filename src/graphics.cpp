@@ -26,18 +26,79 @@
 #include <mapnik/image_util.hpp>
 #include <mapnik/global.hpp>
 #include <mapnik/color.hpp>
+#include <mapnik/simd.hpp>
+#include <mapnik/simd/sse2.hpp>
+#include <mapnik/simd/avx2.hpp>
 
 // agg
 #include "agg_rendering_buffer.h"
 #include "agg_pixfmt_rgba.h"
 #include "agg_color_rgba.h"
 
+// stl
+#include <cstdint>
+
 #ifdef HAVE_CAIRO
 #include <mapnik/cairo/cairo_context.hpp>
 #endif
 
+#if defined(MAPNIK_SIMD_X86)
+#define MAPNIK_SIMD_NS sse2
+#include <mapnik/simd/premultiply_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_BEGIN
+#define MAPNIK_SIMD_NS avx2
+#include <mapnik/simd/premultiply_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_END
+#endif
+
 namespace mapnik
 {
+
+namespace {
+
+using row_func = void (*)(std::uint8_t *, unsigned);
+
+// vectorized premultiply_row / demultiply_row for the active instruction set,
+// nullptr if the agg pixel format has to do it
+row_func alpha_row_func(bool premultiply)
+{
+#if defined(MAPNIK_SIMD_X86)
+    switch (simd::active_level())
+    {
+    case simd::AVX2:
+        return premultiply ? &simd::avx2::premultiplication::premultiply_row
+                           : &simd::avx2::premultiplication::demultiply_row;
+    case simd::SSE2:
+        return premultiply ? &simd::sse2::premultiplication::premultiply_row
+                           : &simd::sse2::premultiplication::demultiply_row;
+    default:
+        break;
+    }
+#endif
+    return nullptr;
+}
+
+// true when none of the pixels in [begin, end) has a bit set
+inline bool transparent(unsigned const* begin, unsigned const* end)
+{
+    // blocks without early exit so that the compiler vectorizes them
+    const std::size_t block = 32;
+    while (static_cast<std::size_t>(end - begin) >= block)
+    {
+        unsigned bits = 0;
+        for (std::size_t i = 0; i < block; ++i) bits |= begin[i];
+        if (bits) return false;
+        begin += block;
+    }
+    unsigned bits = 0;
+    for (; begin != end; ++begin) bits |= *begin;
+    return bits == 0;
+}
+
+}
+
 image_32::image_32(int width,int height)
     :width_(width),
      height_(height),
@@ -174,20 +235,74 @@ boost::optional<color> const& image_32::get_background() const
 
 void image_32::premultiply()
 {
-    agg::rendering_buffer buffer(data_.getBytes(),width_,height_,width_ * 4);
-    agg::pixfmt_rgba32 pixf(buffer);
-    pixf.premultiply();
+    row_func row = alpha_row_func(true);
+    if (row)
+    {
+        for (unsigned y = 0; y < height_; ++y)
+        {
+            row(reinterpret_cast<std::uint8_t*>(data_.getRow(y)), width_);
+        }
+    }
+    else
+    {
+        agg::rendering_buffer buffer(data_.getBytes(),width_,height_,width_ * 4);
+        agg::pixfmt_rgba32 pixf(buffer);
+        pixf.premultiply();
+    }
     premultiplied_ = true;
 }
 
 void image_32::demultiply()
 {
-    agg::rendering_buffer buffer(data_.getBytes(),width_,height_,width_ * 4);
-    agg::pixfmt_rgba32_pre pixf(buffer);
-    pixf.demultiply();
+    row_func row = alpha_row_func(false);
+    if (row)
+    {
+        for (unsigned y = 0; y < height_; ++y)
+        {
+            row(reinterpret_cast<std::uint8_t*>(data_.getRow(y)), width_);
+        }
+    }
+    else
+    {
+        agg::rendering_buffer buffer(data_.getBytes(),width_,height_,width_ * 4);
+        agg::pixfmt_rgba32_pre pixf(buffer);
+        pixf.demultiply();
+    }
     premultiplied_ = false;
 }
 
+box2d<int> image_32::bounding_box() const
+{
+    int w = static_cast<int>(width_);
+    int h = static_cast<int>(height_);
+    int y0 = 0;
+    while (y0 < h && transparent(data_.getRow(y0), data_.getRow(y0) + w)) ++y0;
+    if (y0 == h) return box2d<int>();
+    int y1 = h;
+    while (transparent(data_.getRow(y1 - 1), data_.getRow(y1 - 1) + w)) --y1;
+    // only the parts of a row outside of the columns found so far are scanned
+    int x0 = w;
+    int x1 = 0;
+    for (int y = y0; y < y1; ++y)
+    {
+        unsigned const* row = data_.getRow(y);
+        if (!transparent(row, row + x0))
+        {
+            int x = 0;
+            while (row[x] == 0) ++x;
+            x0 = x;
+        }
+        if (x1 < x0) x1 = x0;
+        if (!transparent(row + x1, row + w))
+        {
+            int x = w;
+            while (row[x - 1] == 0) --x;
+            x1 = x;
+        }
+    }
+    return box2d<int>(x0, y0, x1, y1);
+}
+
 void image_32::composite_pixel(unsigned op, int x,int y, unsigned c, unsigned cover, double opacity)
 {
     using color_type = agg::rgba8;
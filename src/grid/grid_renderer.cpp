@@ -34,6 +34,7 @@
 #include <mapnik/debug.hpp>
 #include <mapnik/layer.hpp>
 #include <mapnik/label_collision_detector.hpp>
+#include <mapnik/text/vertex_cache_store.hpp>
 #include <mapnik/feature_type_style.hpp>
 #include <mapnik/marker.hpp>
 #include <mapnik/marker_cache.hpp>
@@ -111,6 +112,7 @@ void grid_renderer<T>::start_layer_processing(layer const& lay, box2d<double> co
     {
         common_.detector_->clear();
     }
+    common_.vertex_caches_->clear();
     common_.query_extent_ = query_extent;
     boost::optional<box2d<double> > const& maximum_extent = lay.maximum_extent();
     if (maximum_extent)
@@ -23,6 +23,9 @@
 // mapnik
 #include <mapnik/image_compositing.hpp>
 #include <mapnik/image_data.hpp>
+#include <mapnik/simd.hpp>
+#include <mapnik/simd/sse2.hpp>
+#include <mapnik/simd/avx2.hpp>
 
 // boost
 #include <boost/assign/list_of.hpp>
@@ -36,6 +39,21 @@
 #include "agg_pixfmt_rgba.h"
 #include "agg_color_rgba.h"
 
+// stl
+#include <algorithm>
+#include <cstdint>
+
+#if defined(MAPNIK_SIMD_X86)
+#define MAPNIK_SIMD_NS sse2
+#include <mapnik/simd/compositing_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_BEGIN
+#define MAPNIK_SIMD_NS avx2
+#include <mapnik/simd/compositing_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_END
+#endif
+
 namespace mapnik
 {
 
@@ -117,12 +135,47 @@ For example, if you generate some pattern with AGG (premultiplied) and would lik
 */
 
 
-template <typename T1, typename T2>
-void composite(T1 & dst, T2 & src, composite_mode_e mode,
-               float opacity,
-               int dx,
-               int dy,
-               bool premultiply_src)
+namespace {
+
+// Vectorized equivalent of renderer_base::blend_from for the most common
+// modes, returns false when the agg path has to be taken.
+bool composite_vectorized(agg::rendering_buffer & dst, agg::rendering_buffer const& src,
+                          composite_mode_e mode, unsigned cover, int dx, int dy)
+{
+#if defined(MAPNIK_SIMD_X86)
+    // agg walks overlapping rows backwards, keep that case on the agg path
+    if (dst.buf() == src.buf()) return false;
+    simd::sse2::compositing::row_func row = nullptr;
+    switch (simd::active_level())
+    {
+    case simd::AVX2:
+        row = simd::avx2::compositing::composite_row(mode, cover);
+        break;
+    case simd::SSE2:
+        row = simd::sse2::compositing::composite_row(mode, cover);
+        break;
+    default:
+        break;
+    }
+    if (!row) return false;
+    int x0 = std::max(dx, 0);
+    int x1 = std::min(static_cast<int>(dst.width()), static_cast<int>(src.width()) + dx);
+    int y0 = std::max(dy, 0);
+    int y1 = std::min(static_cast<int>(dst.height()), static_cast<int>(src.height()) + dy);
+    if (x1 <= x0) return true;
+    unsigned len = static_cast<unsigned>(x1 - x0);
+    for (int y = y0; y < y1; ++y)
+    {
+        row(dst.row_ptr(y) + x0 * 4, src.row_ptr(y - dy) + (x0 - dx) * 4, len, cover);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void composite_buffers(agg::rendering_buffer & dst_buffer, agg::rendering_buffer & src_buffer,
+                       composite_mode_e mode, float opacity, int dx, int dy, bool premultiply_src)
 {
     using color = agg::rgba8;
     using order = agg::order_rgba;
@@ -130,16 +183,76 @@ void composite(T1 & dst, T2 & src, composite_mode_e mode,
     using pixfmt_type = agg::pixfmt_custom_blend_rgba<blender_type, agg::rendering_buffer>;
     using renderer_type = agg::renderer_base<pixfmt_type>;
 
-    agg::rendering_buffer dst_buffer(dst.getBytes(),dst.width(),dst.height(),dst.width() * 4);
-    agg::rendering_buffer src_buffer(src.getBytes(),src.width(),src.height(),src.width() * 4);
-
     pixfmt_type pixf(dst_buffer);
     pixf.comp_op(static_cast<agg::comp_op_e>(mode));
 
     agg::pixfmt_rgba32 pixf_mask(src_buffer);
     if (premultiply_src)  pixf_mask.premultiply();
+    agg::cover_type cover = static_cast<agg::cover_type>(unsigned(255*opacity));
+    if (composite_vectorized(dst_buffer, src_buffer, mode, cover, dx, dy)) return;
     renderer_type ren(pixf);
-    ren.blend_from(pixf_mask,0,dx,dy,unsigned(255*opacity));
+    ren.blend_from(pixf_mask,0,dx,dy,cover);
+}
+
+}
+
+template <typename T1, typename T2>
+void composite(T1 & dst, T2 & src, composite_mode_e mode,
+               float opacity,
+               int dx,
+               int dy,
+               bool premultiply_src)
+{
+    agg::rendering_buffer dst_buffer(dst.getBytes(),dst.width(),dst.height(),dst.width() * 4);
+    agg::rendering_buffer src_buffer(src.getBytes(),src.width(),src.height(),src.width() * 4);
+    composite_buffers(dst_buffer, src_buffer, mode, opacity, dx, dy, premultiply_src);
+}
+
+template <typename T1, typename T2>
+void composite(T1 & dst, T2 & src, box2d<int> const& src_box,
+               composite_mode_e mode,
+               float opacity,
+               int dx,
+               int dy)
+{
+    box2d<int> box = src_box.intersect(box2d<int>(0, 0, src.width(), src.height()));
+    if (!box.valid() || box.width() <= 0 || box.height() <= 0) return;
+    agg::rendering_buffer dst_buffer(dst.getBytes(),dst.width(),dst.height(),dst.width() * 4);
+    // view of the box, rows keep the stride of the whole source
+    agg::rendering_buffer src_buffer(src.getBytes() + (box.miny() * src.width() + box.minx()) * 4,
+                                     box.width(), box.height(), src.width() * 4);
+    composite_buffers(dst_buffer, src_buffer, mode, opacity, dx + box.minx(), dy + box.miny(), false);
+}
+
+bool composite_transparent_noop(composite_mode_e mode)
+{
+    switch (mode)
+    {
+    case dst:
+    case src_over:
+    case dst_over:
+    case src_atop:
+    case _xor:
+    case plus:
+    case minus:
+    case multiply:
+    case screen:
+    case overlay:
+    case darken:
+    case lighten:
+    case color_dodge:
+    case color_burn:
+    case hard_light:
+    case soft_light:
+    case difference:
+    case exclusion:
+    case invert:
+    case invert_rgb:
+    case grain_merge:
+        return true;
+    default:
+        return false;
+    }
 }
 
 template void composite<mapnik::image_data_32,mapnik::image_data_32>(mapnik::image_data_32&,
@@ -150,4 +263,12 @@ template void composite<mapnik::image_data_32,mapnik::image_data_32>(mapnik::ima
                                                                      int,
                                                                      bool);
 
+template void composite<mapnik::image_data_32,mapnik::image_data_32>(mapnik::image_data_32&,
+                                                                     mapnik::image_data_32&,
+                                                                     box2d<int> const&,
+                                                                     composite_mode_e,
+                                                                     float,
+                                                                     int,
+                                                                     int);
+
 }
@@ -0,0 +1,182 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/image_filter.hpp>
+#include <mapnik/simd.hpp>
+#include <mapnik/simd/scalar.hpp>
+#include <mapnik/simd/sse2.hpp>
+#include <mapnik/simd/avx2.hpp>
+#include <mapnik/thread_pool.hpp>
+
+// agg
+#include "agg_blur.h"
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#define MAPNIK_SIMD_NS scalar
+#include <mapnik/simd/image_filter_impl.hpp>
+#undef MAPNIK_SIMD_NS
+#if defined(MAPNIK_SIMD_X86)
+#define MAPNIK_SIMD_NS sse2
+#include <mapnik/simd/image_filter_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_BEGIN
+#define MAPNIK_SIMD_NS avx2
+#include <mapnik/simd/image_filter_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_END
+#endif
+
+namespace mapnik { namespace filter {
+
+namespace {
+
+std::atomic<std::size_t> & threshold()
+{
+    static std::atomic<std::size_t> pixels(512 * 512);
+    return pixels;
+}
+
+#if defined(MAPNIK_SIMD_X86)
+#define MAPNIK_FILTER_KERNEL(name, ...)                                 \
+    switch (simd::active_level())                                       \
+    {                                                                   \
+    case simd::AVX2: avx2::name(__VA_ARGS__); break;                    \
+    case simd::SSE2: sse2::name(__VA_ARGS__); break;                    \
+    default: scalar::name(__VA_ARGS__); break;                          \
+    }
+#else
+#define MAPNIK_FILTER_KERNEL(name, ...) scalar::name(__VA_ARGS__)
+#endif
+
+// column bands of the vertical blur pass, in pixels
+const unsigned blur_band = 128;
+
+}
+
+void set_parallel_threshold(std::size_t pixels)
+{
+    threshold().store(pixels, std::memory_order_relaxed);
+}
+
+std::size_t parallel_threshold()
+{
+    return threshold().load(std::memory_order_relaxed);
+}
+
+namespace detail {
+
+void parallel_for(unsigned size, std::size_t pixels, std::function<void(unsigned, unsigned)> const& func)
+{
+    std::size_t min_pixels = parallel_threshold();
+    if (min_pixels == 0 || pixels < min_pixels || size < 2)
+    {
+        func(0, size);
+        return;
+    }
+    thread_pool & pool = thread_pool::instance();
+    unsigned slices = std::min(pool.size() + 1, size);
+    pool.parallel_for(slices, 0, [&func, size, slices](std::size_t i) {
+        func(static_cast<unsigned>(std::size_t(size) * i / slices),
+             static_cast<unsigned>(std::size_t(size) * (i + 1) / slices));
+    });
+}
+
+void stack_blur(std::uint8_t * data, unsigned width, unsigned height, unsigned rx, unsigned ry)
+{
+    if (width == 0 || height == 0) return;
+    std::size_t pixels = std::size_t(width) * height;
+    if (rx > 0)
+    {
+        rx = std::min(rx, 254u);
+        parallel_for(height, pixels, [&](unsigned y0, unsigned y1) {
+            MAPNIK_FILTER_KERNEL(stack_blur_rows, data, width, y0, y1, rx);
+        });
+    }
+    if (ry > 0)
+    {
+        ry = std::min(ry, 254u);
+        unsigned bands = (width + blur_band - 1) / blur_band;
+        parallel_for(bands, pixels, [&](unsigned b0, unsigned b1) {
+            for (unsigned b = b0; b < b1; ++b)
+            {
+                unsigned x0 = b * blur_band;
+                unsigned x1 = std::min(width, x0 + blur_band);
+                MAPNIK_FILTER_KERNEL(stack_blur_columns, data, width, height, x0, x1, ry);
+            }
+        });
+    }
+}
+
+void convolve_3x3(std::uint8_t * data, unsigned width, unsigned height, float const* matrix)
+{
+    if (width == 0 || height == 0) return;
+    std::vector<std::uint8_t> out(std::size_t(width) * height * 4);
+    parallel_for(height, std::size_t(width) * height, [&](unsigned y0, unsigned y1) {
+        MAPNIK_FILTER_KERNEL(convolve_3x3, data, out.data(), width, height, y0, y1, matrix);
+    });
+    std::copy(out.begin(), out.end(), data);
+}
+
+void sobel_3x3(std::uint8_t * data, unsigned width, unsigned height)
+{
+    if (width == 0 || height == 0) return;
+    std::vector<std::uint8_t> out(std::size_t(width) * height * 4);
+    parallel_for(height, std::size_t(width) * height, [&](unsigned y0, unsigned y1) {
+        MAPNIK_FILTER_KERNEL(sobel_3x3, data, out.data(), width, height, y0, y1);
+    });
+    std::copy(out.begin(), out.end(), data);
+}
+
+void map_alpha(std::uint8_t * data, unsigned width, unsigned height, std::uint32_t const* lut)
+{
+    std::size_t stride = std::size_t(width) * 4;
+    parallel_for(height, std::size_t(width) * height, [&](unsigned y0, unsigned y1) {
+        MAPNIK_FILTER_KERNEL(map_alpha, data + y0 * stride, (y1 - y0) * stride, lut);
+    });
+}
+
+void to_gray(std::uint8_t * data, unsigned width, unsigned height)
+{
+    std::size_t stride = std::size_t(width) * 4;
+    parallel_for(height, std::size_t(width) * height, [&](unsigned y0, unsigned y1) {
+        MAPNIK_FILTER_KERNEL(to_gray, data + y0 * stride, (y1 - y0) * stride);
+    });
+}
+
+void invert_colors(std::uint8_t * data, unsigned width, unsigned height)
+{
+    std::size_t stride = std::size_t(width) * 4;
+    parallel_for(height, std::size_t(width) * height, [&](unsigned y0, unsigned y1) {
+        MAPNIK_FILTER_KERNEL(invert_colors, data + y0 * stride, (y1 - y0) * stride);
+    });
+}
+
+}
+
+}}
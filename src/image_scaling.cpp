@@ -23,6 +23,10 @@
 // mapnik
 #include <mapnik/image_data.hpp>
 #include <mapnik/image_scaling.hpp>
+#include <mapnik/image_resample.hpp>
+#include <mapnik/simd.hpp>
+#include <mapnik/simd/sse2.hpp>
+#include <mapnik/simd/avx2.hpp>
 // does not handle alpha correctly
 //#include <mapnik/span_image_filter.hpp>
 
@@ -44,9 +48,184 @@
 #include "agg_trans_affine.h"
 #include "agg_image_filters.h"
 
+// stl
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#define MAPNIK_SIMD_NS scalar
+#include <mapnik/simd/image_resample_impl.hpp>
+#undef MAPNIK_SIMD_NS
+#if defined(MAPNIK_SIMD_X86)
+#define MAPNIK_SIMD_NS sse2
+#include <mapnik/simd/image_resample_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_BEGIN
+#define MAPNIK_SIMD_NS avx2
+#include <mapnik/simd/image_resample_impl.hpp>
+#undef MAPNIK_SIMD_NS
+MAPNIK_SIMD_AVX2_END
+#endif
+
 namespace mapnik
 {
 
+namespace resample {
+
+#if defined(MAPNIK_SIMD_X86)
+#define MAPNIK_RESAMPLE_KERNEL(name, ...)                               \
+    switch (simd::active_level())                                       \
+    {                                                                   \
+    case simd::AVX2: avx2::name(__VA_ARGS__); break;                    \
+    case simd::SSE2: sse2::name(__VA_ARGS__); break;                    \
+    default: scalar::name(__VA_ARGS__); break;                          \
+    }
+#else
+#define MAPNIK_RESAMPLE_KERNEL(name, ...) scalar::name(__VA_ARGS__)
+#endif
+
+void filter_scale(agg::trans_affine const& tr, int & rx, int & rx_inv, int & ry, int & ry_inv)
+{
+    // agg::span_image_resample_affine::prepare() with its default scale
+    // limit and no blur
+    const double scale_limit = 200.0;
+    double scale_x;
+    double scale_y;
+    tr.scaling_abs(&scale_x, &scale_y);
+    if (scale_x * scale_y > scale_limit)
+    {
+        scale_x = scale_x * scale_limit / (scale_x * scale_y);
+        scale_y = scale_y * scale_limit / (scale_x * scale_y);
+    }
+    scale_x = std::min(std::max(scale_x, 1.0), scale_limit);
+    scale_y = std::min(std::max(scale_y, 1.0), scale_limit);
+    rx = agg::uround(scale_x * double(agg::image_subpixel_scale));
+    rx_inv = agg::uround(1.0 / scale_x * double(agg::image_subpixel_scale));
+    ry = agg::uround(scale_y * double(agg::image_subpixel_scale));
+    ry_inv = agg::uround(1.0 / scale_y * double(agg::image_subpixel_scale));
+}
+
+void make_weights(axis_weights & out, std::vector<axis_sample> const& samples,
+                  unsigned size, agg::image_filter_lut const* filter)
+{
+    std::size_t count = samples.size();
+    out.start.resize(count);
+    out.nearest = (filter == nullptr);
+    int last = static_cast<int>(size) - 1;
+    if (!filter)
+    {
+        out.taps = 1;
+        out.weights.assign(count, 1.0f);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int pos = samples[i].pos >> agg::image_subpixel_shift;
+            out.start[i] = std::min(std::max(pos, 0), last);
+        }
+        return;
+    }
+    // the support of every sample, walked the way the agg span generator
+    // walks it, with positions clamped to the edge
+    int diameter = static_cast<int>(filter->diameter());
+    int filter_scale = diameter << agg::image_subpixel_shift;
+    agg::int16 const* weight_array = filter->weight_array();
+    std::vector<std::pair<int, int> > first_last(count);
+    std::vector<int> support;
+    std::vector<std::size_t> offsets(count + 1, 0);
+    unsigned taps = 1;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        axis_sample const& sample = samples[i];
+        int pos = sample.pos + agg::image_subpixel_scale / 2 - ((diameter * sample.r) >> 1);
+        int lr = pos >> agg::image_subpixel_shift;
+        int hr = ((agg::image_subpixel_mask - (pos & agg::image_subpixel_mask)) * sample.r_inv) >>
+            agg::image_subpixel_shift;
+        int first = std::min(std::max(lr, 0), last);
+        int end = first;
+        for (;;)
+        {
+            int x = std::min(std::max(lr, 0), last);
+            first = std::min(first, x);
+            end = std::max(end, x + 1);
+            support.push_back(x);
+            support.push_back(weight_array[hr]);
+            hr += sample.r_inv;
+            if (hr >= filter_scale) break;
+            ++lr;
+        }
+        first_last[i] = std::make_pair(first, end);
+        offsets[i + 1] = support.size();
+        taps = std::max(taps, static_cast<unsigned>(end - first));
+    }
+    out.taps = taps;
+    out.weights.assign(count * taps, 0.0f);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int start = std::min(first_last[i].first, static_cast<int>(size - taps));
+        out.start[i] = start;
+        float * w = &out.weights[i * taps];
+        double total = 0.0;
+        for (std::size_t j = offsets[i]; j < offsets[i + 1]; j += 2)
+        {
+            w[support[j] - start] += support[j + 1];
+            total += support[j + 1];
+        }
+        if (total != 0.0)
+        {
+            for (unsigned k = 0; k < taps; ++k) w[k] = static_cast<float>(w[k] / total);
+        }
+    }
+}
+
+void resample(image_data_32 & target, unsigned x0, unsigned y0,
+              image_data_32 const& source,
+              axis_weights const& xw, axis_weights const& yw)
+{
+    unsigned width = xw.size();
+    unsigned height = yw.size();
+    if (width == 0 || height == 0 || source.width() == 0 || source.height() == 0) return;
+    if (xw.nearest && yw.nearest)
+    {
+        for (unsigned y = 0; y < height; ++y)
+        {
+            unsigned const* src = source.getRow(yw.start[y]);
+            unsigned * dst = target.getRow(y0 + y) + x0;
+            for (unsigned x = 0; x < width; ++x)
+            {
+                dst[x] = src[xw.start[x]];
+            }
+        }
+        return;
+    }
+    // horizontally filtered source rows, row r lives in slot r % taps
+    unsigned taps = yw.taps;
+    std::size_t row_size = std::size_t(width) * 4;
+    std::vector<float> ring(row_size * taps);
+    std::vector<int> ring_rows(taps, -1);
+    std::vector<float const*> rows(taps);
+    std::vector<float> acc(row_size);
+    for (unsigned y = 0; y < height; ++y)
+    {
+        for (unsigned k = 0; k < taps; ++k)
+        {
+            int r = yw.start[y] + static_cast<int>(k);
+            unsigned slot = static_cast<unsigned>(r) % taps;
+            float * row = &ring[slot * row_size];
+            if (ring_rows[slot] != r)
+            {
+                MAPNIK_RESAMPLE_KERNEL(horizontal, row,
+                                       reinterpret_cast<std::uint8_t const*>(source.getRow(r)),
+                                       width, xw.start.data(), xw.weights.data(), xw.taps);
+                ring_rows[slot] = r;
+            }
+            rows[k] = row;
+        }
+        MAPNIK_RESAMPLE_KERNEL(vertical, acc.data(), rows.data(), &yw.weights[std::size_t(y) * taps], taps, row_size);
+        MAPNIK_RESAMPLE_KERNEL(store_row, reinterpret_cast<std::uint8_t*>(target.getRow(y0 + y) + x0), acc.data(), width);
+    }
+}
+
+}
+
 using scaling_method_lookup_type = boost::bimap<scaling_method_e, std::string>;
 static const scaling_method_lookup_type scaling_lookup = boost::assign::list_of<scaling_method_lookup_type::relation>
     (SCALING_NEAR,"near")
@@ -90,6 +269,42 @@ boost::optional<std::string> scaling_method_to_string(scaling_method_e scaling_m
     return mode;
 }
 
+namespace {
+
+// samples of agg's linear interpolator over the whole target, one span per row
+template <typename Image>
+void scale_separable(Image & target, Image const& source, agg::trans_affine const& tr,
+                     agg::image_filter_lut const* filter)
+{
+    int rx, rx_inv, ry, ry_inv;
+    resample::filter_scale(tr, rx, rx_inv, ry, ry_inv);
+    agg::span_interpolator_linear<> interpolator(tr);
+    std::vector<resample::axis_sample> samples;
+    samples.reserve(std::max(target.width(), target.height()));
+    interpolator.begin(0.5, 0.5, target.width());
+    for (unsigned x = 0; x < target.width(); ++x, ++interpolator)
+    {
+        int sx, sy;
+        interpolator.coordinates(&sx, &sy);
+        samples.push_back(resample::axis_sample { sx, rx, rx_inv });
+    }
+    resample::axis_weights xw;
+    resample::make_weights(xw, samples, source.width(), filter);
+    samples.clear();
+    for (unsigned y = 0; y < target.height(); ++y)
+    {
+        int sx, sy;
+        interpolator.begin(0.5, y + 0.5, 1);
+        interpolator.coordinates(&sx, &sy);
+        samples.push_back(resample::axis_sample { sy, ry, ry_inv });
+    }
+    resample::axis_weights yw;
+    resample::make_weights(yw, samples, source.height(), filter);
+    resample::resample(target, 0, 0, source, xw, yw);
+}
+
+}
+
 template <typename Image>
 void scale_image_agg(Image & target,
                      Image const& source,
@@ -132,6 +347,12 @@ void scale_image_agg(Image & target,
     using interpolator_type = agg::span_interpolator_linear<>;
     interpolator_type interpolator(img_mtx);
 
+    // Without offset the polygon below covers the whole target and the
+    // scaling can run as two one dimensional passes instead.
+    bool separable = x_off_f == 0.0 && y_off_f == 0.0 &&
+        source.width() > 0 && source.height() > 0 &&
+        target.width() > 0 && target.height() > 0;
+
     // draw an anticlockwise polygon to render our image into
     double scaled_width = target.width();
     double scaled_height = target.height();
@@ -145,6 +366,11 @@ void scale_image_agg(Image & target,
     {
     case SCALING_NEAR:
     {
+        if (separable)
+        {
+            scale_separable(target, source, img_mtx, nullptr);
+            return;
+        }
         using span_gen_type = agg::span_image_filter_rgba_nn<img_src_type, interpolator_type>;
         span_gen_type sg(img_src, interpolator);
         agg::render_scanlines_aa(ras, sl, rb_dst_pre, sa, sg);
@@ -183,6 +409,12 @@ void scale_image_agg(Image & target,
     case SCALING_BLACKMAN:
         filter.calculate(agg::image_filter_blackman(filter_factor), true); break;
     }
+    if (separable)
+    {
+        scale_separable(target, source, img_mtx, &filter);
+        return;
+    }
+
     // details on various resampling considerations
     // http://old.nabble.com/Re%3A-Newbie---texture-p5057255.html
 
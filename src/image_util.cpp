@@ -52,6 +52,7 @@ extern "C"
 #include <mapnik/palette.hpp>
 #include <mapnik/map.hpp>
 #include <mapnik/util/conversions.hpp>
+#include <mapnik/encoded_image_cache.hpp>
 
 #ifdef HAVE_CAIRO
 #include <mapnik/cairo/cairo_renderer.hpp>
@@ -76,10 +77,107 @@ extern "C"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 
 namespace mapnik
 {
 
+namespace {
+
+// pixels compared or hashed per step, small enough to bail out early on
+// the first block of a busy image, large enough for the compiler to
+// vectorize the block
+const unsigned scan_block = 32;
+
+const std::uint64_t hash_prime1 = 0x9e3779b185ebca87ULL;
+const std::uint64_t hash_prime2 = 0xc2b2ae3d27d4eb4fULL;
+
+inline std::uint64_t hash_round(std::uint64_t acc, std::uint64_t input)
+{
+    acc += input * hash_prime2;
+    acc = (acc << 31) | (acc >> 33);
+    return acc * hash_prime1;
+}
+
+}
+
+template <typename T>
+bool is_solid(T const& image)
+{
+    using pixel_type = typename T::pixel_type;
+    if (image.width() == 0 || image.height() == 0) return true;
+    pixel_type const first = image.getRow(0)[0];
+    unsigned width = image.width();
+    for (unsigned y = 0; y < image.height(); ++y)
+    {
+        pixel_type const* row = image.getRow(y);
+        unsigned x = 0;
+        for (; x + scan_block <= width; x += scan_block)
+        {
+            pixel_type diff = 0;
+            for (unsigned i = 0; i < scan_block; ++i)
+            {
+                diff |= row[x + i] ^ first;
+            }
+            if (diff) return false;
+        }
+        for (; x < width; ++x)
+        {
+            if (row[x] != first) return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+std::uint64_t image_hash(T const& image)
+{
+    // four independent lanes over pairs of pixels, rows padded to whole pairs
+    std::uint64_t acc[4] = { hash_prime1 + hash_prime2, hash_prime2, 0, 0 - hash_prime1 };
+    std::size_t n = 0;
+    unsigned width = image.width();
+    for (unsigned y = 0; y < image.height(); ++y)
+    {
+        std::uint32_t const* row = reinterpret_cast<std::uint32_t const*>(image.getRow(y));
+        unsigned x = 0;
+        for (; x + 1 < width; x += 2, ++n)
+        {
+            std::uint64_t word = row[x] | (static_cast<std::uint64_t>(row[x + 1]) << 32);
+            acc[n & 3] = hash_round(acc[n & 3], word);
+        }
+        if (x < width)
+        {
+            acc[n & 3] = hash_round(acc[n & 3], row[x]);
+            ++n;
+        }
+    }
+    std::uint64_t h = ((acc[0] << 1) | (acc[0] >> 63)) + ((acc[1] << 7) | (acc[1] >> 57)) +
+        ((acc[2] << 12) | (acc[2] >> 52)) + ((acc[3] << 18) | (acc[3] >> 46));
+    h ^= (static_cast<std::uint64_t>(image.width()) << 32) | image.height();
+    // final avalanche
+    h ^= h >> 33;
+    h *= hash_prime2;
+    h ^= h >> 29;
+    h *= hash_prime1;
+    h ^= h >> 32;
+    return h;
+}
+
+template bool is_solid<image_data_32>(image_data_32 const&);
+template bool is_solid<image_view<image_data_32> >(image_view<image_data_32> const&);
+template std::uint64_t image_hash<image_data_32>(image_data_32 const&);
+template std::uint64_t image_hash<image_view<image_data_32> >(image_view<image_data_32> const&);
+
+bool is_solid(image_32 const& image)
+{
+    return is_solid<image_data_32>(image.data());
+}
+
+std::uint64_t image_hash(image_32 const& image)
+{
+    return image_hash<image_data_32>(image.data());
+}
 
 template <typename T>
 std::string save_to_string(T const& image,
@@ -168,6 +266,15 @@ void handle_png_options(std::string const& type,
         {
             opts.use_miniz = true;
         }
+        else if (boost::algorithm::starts_with(t, "p="))
+        {
+            int threads = 0;
+            if (!mapnik::util::string2int(t.substr(2),threads) || threads < 0 || threads > 256)
+            {
+                throw ImageWriterException("invalid threads parameter: " + t.substr(2) + " (only 0 through 256 are valid)");
+            }
+            opts.threads = static_cast<unsigned>(threads);
+        }
         else if (boost::algorithm::starts_with(t, "c="))
         {
             set_colors = true;
@@ -252,6 +359,10 @@ void handle_png_options(std::string const& type,
     {
         throw ImageWriterException("invalid compression value: (only -1 through 9 are valid)");
     }
+    if (opts.use_miniz && opts.threads != 1)
+    {
+        throw ImageWriterException("invalid threads parameter: unavailable with the miniz encoder");
+    }
 }
 #endif
 
@@ -585,82 +696,307 @@ void save_to_stream(T const& image,
 }
 
 
-template <typename T>
-void save_to_stream(T const& image,
-                    std::ostream & stream,
-                    std::string const& type)
+namespace {
+
+// Colors, transparency and texture of an image, as far as they matter for
+// picking its output format. Colors are collected until there are more
+// than a palette can hold.
+struct image_analysis
 {
-    if (stream && image.width() > 0 && image.height() > 0)
+    static const unsigned max_colors = 256;
+
+    std::vector<std::uint32_t> colors;
+    bool overflow = false;
+    bool opaque = true;
+    // pixels repeating their left neighbour, few of them mean a photo
+    std::size_t repeated = 0;
+    std::size_t pixels = 0;
+
+    template <typename T>
+    explicit image_analysis(T const& image)
     {
-        std::string t = type;
-        std::transform(t.begin(), t.end(), t.begin(), ::tolower);
-        if (t == "png" || boost::algorithm::starts_with(t, "png"))
+        // open addressing set of 512 slots, at most half full while colors
+        // fit a palette
+        std::vector<std::uint32_t> slots(max_colors * 2, 0);
+        bool has_zero = false;
+        std::uint32_t alpha = 0xff;
+        for (unsigned y = 0; y < image.height(); ++y)
         {
-#if defined(HAVE_PNG)
-            png_options opts;
-            handle_png_options(t,opts);
-            if (opts.paletted)
+            typename T::pixel_type const* row = image.getRow(y);
+            for (unsigned x = 0; x < image.width(); ++x)
             {
-                if (opts.use_hextree)
+                std::uint32_t val = row[x];
+                alpha &= val >> 24;
+                // too many colors with alpha leave only png32
+                if (overflow && alpha != 0xff) break;
+                if (x > 0 && val == row[x - 1])
+                {
+                    ++repeated;
+                    continue;
+                }
+                if (overflow) continue;
+                if (val == 0)
                 {
-                    save_as_png8_hex(stream, image, opts);
+                    if (!has_zero) colors.push_back(0);
+                    has_zero = true;
                 }
                 else
                 {
-                    save_as_png8_oct(stream, image, opts);
+                    std::size_t pos = (val * 2654435761u) >> 23;
+                    while (slots[pos] != 0 && slots[pos] != val) pos = (pos + 1) & (slots.size() - 1);
+                    if (slots[pos] == 0)
+                    {
+                        slots[pos] = val;
+                        colors.push_back(val);
+                    }
                 }
+                overflow = colors.size() > max_colors;
             }
-            else
+        }
+        opaque = alpha == 0xff;
+        pixels = std::size_t(image.width()) * image.height();
+        if (overflow) colors.clear();
+    }
+
+    bool photographic() const
+    {
+        return overflow && repeated * 4 < pixels;
+    }
+};
+
+#if defined(HAVE_PNG)
+// maps every color of an image to its own palette entry, for png8 without
+// quantization loss
+class exact_palette
+{
+public:
+    explicit exact_palette(std::vector<std::uint32_t> colors)
+        : colors_(std::move(colors)),
+          slots_(image_analysis::max_colors * 2, -1)
+    {
+        std::sort(colors_.begin(), colors_.end(), order);
+        for (unsigned i = 0; i < colors_.size(); ++i)
+        {
+            slots_[find(colors_[i])] = i;
+        }
+    }
+
+    unsigned char quantize(unsigned val) const
+    {
+        return static_cast<unsigned char>(slots_[find(val)]);
+    }
+
+    std::vector<rgb> palette() const
+    {
+        std::vector<rgb> palette;
+        for (std::uint32_t val : colors_)
+        {
+            palette.emplace_back(U2RED(val), U2GREEN(val), U2BLUE(val));
+        }
+        return palette;
+    }
+
+    std::vector<unsigned> alpha_table() const
+    {
+        std::vector<unsigned> alpha;
+        for (std::uint32_t val : colors_)
+        {
+            alpha.push_back(U2ALPHA(val));
+        }
+        return alpha;
+    }
+
+private:
+    // translucent colors first, so tRNS is small
+    static bool order(std::uint32_t lhs, std::uint32_t rhs)
+    {
+        return ((lhs >> 24) == 0xff) != ((rhs >> 24) == 0xff) ? (lhs >> 24) != 0xff : lhs < rhs;
+    }
+
+    // slot holding val, or the empty one it goes to
+    std::size_t find(std::uint32_t val) const
+    {
+        std::size_t pos = (val * 2654435761u) >> 23;
+        while (slots_[pos] >= 0 && colors_[slots_[pos]] != val) pos = (pos + 1) & (slots_.size() - 1);
+        return pos;
+    }
+
+    std::vector<std::uint32_t> colors_;
+    std::vector<int> slots_;
+};
+#endif
+
+// "auto" picks the smallest lossless png that holds the image: png8 with
+// an exact palette up to 256 colors, else 24 or 32 bit png. Opaque photos
+// go to jpeg unless "auto:png" is asked for.
+template <typename T>
+void save_as_auto(T const& image,
+                  std::ostream & stream,
+                  std::string const& t)
+{
+#if defined(HAVE_PNG)
+    int quality = 85;
+    bool allow_jpeg = true;
+    std::string png_type = "png";
+    boost::char_separator<char> sep(":");
+    boost::tokenizer< boost::char_separator<char> > tokens(t, sep);
+    for (std::string const& token : tokens)
+    {
+        if (token == "auto")
+        {
+            continue;
+        }
+        else if (token == "png")
+        {
+            allow_jpeg = false;
+        }
+        else if (boost::algorithm::starts_with(token, "q="))
+        {
+            if (!mapnik::util::string2int(token.substr(2),quality) || quality < 0 || quality > 100)
             {
-                save_as_png(stream, image, opts);
+                throw ImageWriterException("invalid jpeg quality: '" + token.substr(2) + "'");
             }
+        }
+        else
+        {
+            // compression options go to the png encoder
+            png_type += ":" + token;
+        }
+    }
+    png_options opts;
+    handle_png_options(png_type, opts);
+
+    image_analysis analysis(image);
+#if defined(HAVE_JPEG)
+    if (allow_jpeg && analysis.opaque && analysis.photographic())
+    {
+        save_as_jpeg(stream, quality, image);
+        return;
+    }
+#endif
+    if (!analysis.overflow)
+    {
+        exact_palette pal(std::move(analysis.colors));
+        save_as_png8(stream, image, pal, pal.palette(), pal.alpha_table(), opts);
+    }
+    else
+    {
+        opts.paletted = false;
+        opts.trans_mode = analysis.opaque ? 0 : -1;
+        save_as_png(stream, image, opts);
+    }
 #else
-            throw ImageWriterException("png output is not enabled in your build of Mapnik");
+    throw ImageWriterException("png output is not enabled in your build of Mapnik");
 #endif
+}
+
+// t is the lower cased type
+template <typename T>
+void encode_to_stream(T const& image,
+                      std::ostream & stream,
+                      std::string const& t,
+                      std::string const& type)
+{
+    if (t == "auto" || boost::algorithm::starts_with(t, "auto:"))
+    {
+        save_as_auto(image, stream, t);
+    }
+    else if (t == "png" || boost::algorithm::starts_with(t, "png"))
+    {
+#if defined(HAVE_PNG)
+        png_options opts;
+        handle_png_options(t,opts);
+        if (opts.paletted)
+        {
+            if (opts.use_hextree)
+            {
+                save_as_png8_hex(stream, image, opts);
+            }
+            else
+            {
+                save_as_png8_oct(stream, image, opts);
+            }
         }
-        else if (boost::algorithm::starts_with(t, "tif"))
+        else
         {
+            save_as_png(stream, image, opts);
+        }
+#else
+        throw ImageWriterException("png output is not enabled in your build of Mapnik");
+#endif
+    }
+    else if (boost::algorithm::starts_with(t, "tif"))
+    {
 #if defined(HAVE_TIFF)
-            save_as_tiff(stream, image);
+        save_as_tiff(stream, image);
 #else
-            throw ImageWriterException("tiff output is not enabled in your build of Mapnik");
+        throw ImageWriterException("tiff output is not enabled in your build of Mapnik");
 #endif
-        }
-        else if (boost::algorithm::starts_with(t, "jpeg"))
-        {
+    }
+    else if (boost::algorithm::starts_with(t, "jpeg"))
+    {
 #if defined(HAVE_JPEG)
-            int quality = 85;
-            std::string val = t.substr(4);
-            if (!val.empty())
+        int quality = 85;
+        std::string val = t.substr(4);
+        if (!val.empty())
+        {
+            if (!mapnik::util::string2int(val,quality) || quality < 0 || quality > 100)
             {
-                if (!mapnik::util::string2int(val,quality) || quality < 0 || quality > 100)
-                {
-                    throw ImageWriterException("invalid jpeg quality: '" + val + "'");
-                }
+                throw ImageWriterException("invalid jpeg quality: '" + val + "'");
             }
-            save_as_jpeg(stream, quality, image);
+        }
+        save_as_jpeg(stream, quality, image);
 #else
-            throw ImageWriterException("jpeg output is not enabled in your build of Mapnik");
+        throw ImageWriterException("jpeg output is not enabled in your build of Mapnik");
 #endif
+    }
+    else if (boost::algorithm::starts_with(t, "webp"))
+    {
+#if defined(HAVE_WEBP)
+        WebPConfig config;
+        // Default values set here will be lossless=0 and quality=75 (as least as of webp v0.3.1)
+        if (!WebPConfigInit(&config))
+        {
+            throw std::runtime_error("version mismatch");
         }
-        else if (boost::algorithm::starts_with(t, "webp"))
+        // see for more details: https://github.com/mapnik/mapnik/wiki/Image-IO#webp-output-options
+        bool alpha = true;
+        handle_webp_options(t,config,alpha);
+        save_as_webp(stream,image,config,alpha);
+#else
+        throw ImageWriterException("webp output is not enabled in your build of Mapnik");
+#endif
+    }
+    else throw ImageWriterException("unknown file type: " + type);
+}
+
+}
+
+template <typename T>
+void save_to_stream(T const& image,
+                    std::ostream & stream,
+                    std::string const& type)
+{
+    if (stream && image.width() > 0 && image.height() > 0)
+    {
+        std::string t = type;
+        std::transform(t.begin(), t.end(), t.begin(), ::tolower);
+        encoded_image_cache & cache = encoded_image_cache::instance();
+        if (cache.max_size() > 0 && is_solid(image))
         {
-#if defined(HAVE_WEBP)
-            WebPConfig config;
-            // Default values set here will be lossless=0 and quality=75 (as least as of webp v0.3.1)
-            if (!WebPConfigInit(&config))
+            encoded_image_key key { t, image.getRow(0)[0], image.width(), image.height() };
+            encoded_image_ptr data = cache.find(key);
+            if (!data)
             {
-                throw std::runtime_error("version mismatch");
+                std::ostringstream ss(std::ios::out|std::ios::binary);
+                encode_to_stream(image, ss, t, type);
+                data = std::make_shared<std::string const>(ss.str());
+                cache.insert(key, data);
             }
-            // see for more details: https://github.com/mapnik/mapnik/wiki/Image-IO#webp-output-options
-            bool alpha = true;
-            handle_webp_options(t,config,alpha);
-            save_as_webp(stream,image,config,alpha);
-#else
-            throw ImageWriterException("webp output is not enabled in your build of Mapnik");
-#endif
+            stream.write(data->data(), data->size());
+            return;
         }
-        else throw ImageWriterException("unknown file type: " + type);
+        encode_to_stream(image, stream, t, type);
     }
     else throw ImageWriterException("Could not write to empty stream" );
 }
@@ -74,6 +74,9 @@ private:
     input_stream stream_;
     unsigned width_;
     unsigned height_;
+    unsigned native_width_;
+    unsigned native_height_;
+    unsigned reduction_;
 public:
     explicit jpeg_reader(std::string const& file_name);
     explicit jpeg_reader(char const* data, size_t size);
@@ -83,6 +86,7 @@ public:
     inline bool has_alpha() const { return false; }
     inline bool premultiplied_alpha() const { return true; }
     void read(unsigned x,unsigned y,image_data_32& image);
+    unsigned set_reduction(unsigned factor);
 private:
     void init();
     static void on_error(j_common_ptr cinfo);
@@ -116,7 +120,10 @@ jpeg_reader<T>::jpeg_reader(std::string const& file_name)
     : source_(file_name,std::ios_base::in | std::ios_base::binary),
       stream_(source_),
       width_(0),
-      height_(0)
+      height_(0),
+      native_width_(0),
+      native_height_(0),
+      reduction_(1)
 {
     if (!stream_) throw image_reader_exception("cannot open image file "+ file_name);
     init();
@@ -127,7 +134,10 @@ jpeg_reader<T>::jpeg_reader(char const* data, size_t size)
     : source_(data, size),
       stream_(source_),
       width_(0),
-      height_(0)
+      height_(0),
+      native_width_(0),
+      native_height_(0),
+      reduction_(1)
 {
     if (!stream_) throw image_reader_exception("cannot open image stream");
     init();
@@ -228,9 +238,11 @@ void jpeg_reader<T>::init()
     int ret = jpeg_read_header(&cinfo, TRUE);
     if (ret != JPEG_HEADER_OK)
         throw image_reader_exception("JPEG Reader: failed to read header");
-    jpeg_start_decompress(&cinfo);
-    width_ = cinfo.output_width;
-    height_ = cinfo.output_height;
+    // output size without starting the decompressor, which for
+    // progressive images would already decode all of the scans
+    jpeg_calc_output_dimensions(&cinfo);
+    width_ = native_width_ = cinfo.output_width;
+    height_ = native_height_ = cinfo.output_height;
 
     if (cinfo.out_color_space == JCS_UNKNOWN)
     {
@@ -254,6 +266,21 @@ unsigned jpeg_reader<T>::height() const
     return height_;
 }
 
+template <typename T>
+unsigned jpeg_reader<T>::set_reduction(unsigned factor)
+{
+    // libjpeg scales by 1/2, 1/4 and 1/8 in the inverse DCT, which does
+    // the work of a box filter at a fraction of the full decode cost
+    reduction_ = 1;
+    while (reduction_ < 8 && reduction_ * 2 <= factor)
+    {
+        reduction_ *= 2;
+    }
+    width_ = (native_width_ + reduction_ - 1) / reduction_;
+    height_ = (native_height_ + reduction_ - 1) / reduction_;
+    return reduction_;
+}
+
 template <typename T>
 void jpeg_reader<T>::read(unsigned x0, unsigned y0, image_data_32& image)
 {
@@ -270,6 +297,8 @@ void jpeg_reader<T>::read(unsigned x0, unsigned y0, image_data_32& image)
     attach_stream(&cinfo, &stream_);
     int ret = jpeg_read_header(&cinfo, TRUE);
     if (ret != JPEG_HEADER_OK) throw image_reader_exception("JPEG Reader read(): failed to read header");
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = reduction_;
     jpeg_start_decompress(&cinfo);
     JSAMPARRAY buffer;
     int row_stride;
@@ -282,7 +311,8 @@ void jpeg_reader<T>::read(unsigned x0, unsigned y0, image_data_32& image)
 
     const std::unique_ptr<unsigned int[]> out_row(new unsigned int[w]);
     unsigned row = 0;
-    while (cinfo.output_scanline < cinfo.output_height)
+    // rows below the window are not decoded at all
+    while (row < y0 + h && cinfo.output_scanline < cinfo.output_height)
     {
         jpeg_read_scanlines(&cinfo, buffer, 1);
         if (row >= y0 && row < y0 + h)
@@ -306,7 +336,7 @@ void jpeg_reader<T>::read(unsigned x0, unsigned y0, image_data_32& image)
         }
         ++row;
     }
-    jpeg_finish_decompress(&cinfo);
+    jpeg_abort_decompress(&cinfo);
 }
 
 }
@@ -240,6 +240,13 @@ void map_parser::parse_map(Map & map, xml_node const& node, std::string const& b
                 map.set_buffer_size(*buffer_size);
             }
 
+            map.set_collision_detector(map_node.get_attr<collision_detector_e>("collision-detector", Map::QUAD_TREE_DETECTOR));
+            optional<mapnik::boolean_type> deferred_labels = map_node.get_opt_attr<mapnik::boolean_type>("deferred-labels");
+            if (deferred_labels)
+            {
+                map.set_deferred_labels(*deferred_labels);
+            }
+
             optional<std::string> maximum_extent = map_node.get_opt_attr<std::string>("maximum-extent");
             if (maximum_extent)
             {
@@ -440,6 +447,12 @@ void map_parser::parse_style(Map & map, xml_node const& node)
             style.set_image_filters_inflate(*image_filters_inflate);
         }
 
+        optional<unsigned> filter_batch_size = node.get_opt_attr<unsigned>("filter-batch-size");
+        if (filter_batch_size)
+        {
+            style.set_filter_batch_size(*filter_batch_size);
+        }
+
         // image filters
         optional<std::string> filters = node.get_opt_attr<std::string>("image-filters");
         if (filters)
@@ -890,6 +903,7 @@ void map_parser::parse_point_symbolizer(rule & rule, xml_node const & node)
         set_symbolizer_property<symbolizer_base,boolean_type>(sym, keys::ignore_placement, node);
         set_symbolizer_property<symbolizer_base,point_placement_enum>(sym, keys::point_placement_type, node);
         set_symbolizer_property<symbolizer_base,transform_type>(sym, keys::image_transform, node);
+        set_symbolizer_property<symbolizer_base,double>(sym, keys::label_priority, node);
         if (file && !file->empty())
         {
             if(base)
@@ -1093,6 +1107,7 @@ void map_parser::parse_text_symbolizer(rule & rule, xml_node const& node)
         set_symbolizer_property<symbolizer_base,composite_mode_e>(sym, keys::halo_comp_op, node);
         set_symbolizer_property<symbolizer_base,halo_rasterizer_enum>(sym, keys::halo_rasterizer, node);
         set_symbolizer_property<symbolizer_base,transform_type>(sym, keys::halo_transform, node);
+        set_symbolizer_property<symbolizer_base,double>(sym, keys::label_priority, node);
         rule.append(std::move(sym));
     }
     catch (config_error const& ex)
@@ -1130,6 +1145,7 @@ void map_parser::parse_shield_symbolizer(rule & rule, xml_node const& node)
         set_symbolizer_property<symbolizer_base,double>(sym, keys::opacity, node);
         set_symbolizer_property<symbolizer_base,double>(sym, keys::text_opacity, node);
         set_symbolizer_property<symbolizer_base,mapnik::boolean_type>(sym, keys::unlock_image, node);
+        set_symbolizer_property<symbolizer_base,double>(sym, keys::label_priority, node);
 
         std::string file = node.get_attr<std::string>("file");
         if (file.empty())
@@ -63,6 +63,14 @@ static const char * aspect_fix_mode_strings[] = {
 
 IMPLEMENT_ENUM( aspect_fix_mode_e, aspect_fix_mode_strings )
 
+static const char * collision_detector_strings[] = {
+    "quad-tree",
+    "grid",
+    ""
+};
+
+IMPLEMENT_ENUM( collision_detector_e, collision_detector_strings )
+
 Map::Map()
 : width_(400),
     height_(400),
@@ -71,6 +79,8 @@ Map::Map()
     background_image_comp_op_(src_over),
     background_image_opacity_(1.0),
     aspectFixMode_(GROW_BBOX),
+    collision_detector_(QUAD_TREE_DETECTOR),
+    deferred_labels_(false),
     base_path_(""),
     extra_params_(),
     font_directory_(),
@@ -85,6 +95,8 @@ Map::Map(int width,int height, std::string const& srs)
       background_image_comp_op_(src_over),
       background_image_opacity_(1.0),
       aspectFixMode_(GROW_BBOX),
+      collision_detector_(QUAD_TREE_DETECTOR),
+      deferred_labels_(false),
       base_path_(""),
       extra_params_(),
       font_directory_(),
@@ -104,6 +116,8 @@ Map::Map(Map const& rhs)
       fontsets_(rhs.fontsets_),
       layers_(rhs.layers_),
       aspectFixMode_(rhs.aspectFixMode_),
+      collision_detector_(rhs.collision_detector_),
+      deferred_labels_(rhs.deferred_labels_),
       current_extent_(rhs.current_extent_),
       maximum_extent_(rhs.maximum_extent_),
       base_path_(rhs.base_path_),
@@ -127,6 +141,8 @@ Map::Map(Map && rhs)
       fontsets_(std::move(rhs.fontsets_)),
       layers_(std::move(rhs.layers_)),
       aspectFixMode_(std::move(rhs.aspectFixMode_)),
+      collision_detector_(std::move(rhs.collision_detector_)),
+      deferred_labels_(std::move(rhs.deferred_labels_)),
       current_extent_(std::move(rhs.current_extent_)),
       maximum_extent_(std::move(rhs.maximum_extent_)),
       base_path_(std::move(rhs.base_path_)),
@@ -158,6 +174,8 @@ void swap (Map & lhs, Map & rhs)
     std::swap(lhs.fontsets_, rhs.fontsets_);
     std::swap(lhs.layers_, rhs.layers_);
     std::swap(lhs.aspectFixMode_, rhs.aspectFixMode_);
+    std::swap(lhs.collision_detector_, rhs.collision_detector_);
+    std::swap(lhs.deferred_labels_, rhs.deferred_labels_);
     std::swap(lhs.current_extent_, rhs.current_extent_);
     std::swap(lhs.maximum_extent_, rhs.maximum_extent_);
     std::swap(lhs.base_path_, rhs.base_path_);
@@ -182,6 +200,8 @@ bool Map::operator==(Map const& rhs) const
         (fontsets_ == rhs.fontsets_) &&
         (layers_ == rhs.layers_) &&
         (aspectFixMode_ == rhs.aspectFixMode_) &&
+        (collision_detector_ == rhs.collision_detector_) &&
+        (deferred_labels_ == rhs.deferred_labels_) &&
         (current_extent_ == rhs.current_extent_) &&
         (maximum_extent_ == rhs.maximum_extent_) &&
         (base_path_ == rhs.base_path_) &&
@@ -24,6 +24,7 @@
 #include <mapnik/config_error.hpp>
 
 // stl
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <iterator>
@@ -31,6 +32,14 @@
 namespace mapnik
 {
 
+namespace {
+
+std::size_t const nearest_bits = 17;
+std::size_t const nearest_probes = 8;
+std::uint64_t const nearest_valid = std::uint64_t(1) << 40;
+
+}
+
 rgb::rgb(rgba const& c)
     : r(c.r), g(c.g), b(c.b) {}
 
@@ -49,21 +58,15 @@ bool rgba::mean_sort_cmp::operator() (const rgba& x, const rgba& y) const
 }
 
 rgba_palette::rgba_palette(std::string const& pal, palette_type type)
-    : colors_(0)
+    : nearest_(new std::atomic<std::uint64_t>[std::size_t(1) << nearest_bits]()),
+      colors_(0)
 {
-#ifdef USE_DENSE_HASH_MAP
-    color_hashmap_.set_empty_key(0);
-#endif
     parse(pal, type);
 }
 
 rgba_palette::rgba_palette()
-    : colors_(0)
-{
-#ifdef USE_DENSE_HASH_MAP
-    color_hashmap_.set_empty_key(0);
-#endif
-}
+    : nearest_(new std::atomic<std::uint64_t>[std::size_t(1) << nearest_bits]()),
+      colors_(0) {}
 
 const std::vector<rgb>& rgba_palette::palette() const
 {
@@ -109,76 +112,101 @@ std::string rgba_palette::to_string() const
 // return color index in returned earlier palette
 unsigned char rgba_palette::quantize(unsigned val) const
 {
-    unsigned char index = 0;
-    if (colors_ == 1 || val == 0) return index;
+    if (colors_ == 1 || val == 0) return 0;
 
-    rgba_hash_table::iterator it = color_hashmap_.find(val);
-    if (it != color_hashmap_.end())
+    // open addressing, probing a few slots before giving up on a color
+    std::uint64_t key = nearest_valid | std::uint64_t(val) << 8;
+    std::size_t const mask = (std::size_t(1) << nearest_bits) - 1;
+    std::size_t const pos = (val * 2654435761u) >> (32 - nearest_bits);
+    for (std::size_t i = 0; i < nearest_probes; ++i)
     {
-        index = it->second;
+        std::uint64_t entry = nearest_[(pos + i) & mask].load(std::memory_order_relaxed);
+        if ((entry & ~std::uint64_t(0xff)) == key)
+        {
+            return static_cast<unsigned char>(entry & 0xff);
+        }
+        if (entry == 0) break;
     }
-    else
+    unsigned char index = search(rgba(val));
+    for (std::size_t i = 0; i < nearest_probes; ++i)
     {
-        rgba c(val);
-        int dr, dg, db, da;
-        int dist, newdist;
-
-        // find closest match based on mean of r,g,b,a
-        std::vector<rgba>::const_iterator pit =
-            std::lower_bound(sorted_pal_.begin(), sorted_pal_.end(), c, rgba::mean_sort_cmp());
-        index = std::distance(sorted_pal_.begin(),pit);
-        if (index == sorted_pal_.size()) index--;
-
-        dr = sorted_pal_[index].r - c.r;
-        dg = sorted_pal_[index].g - c.g;
-        db = sorted_pal_[index].b - c.b;
-        da = sorted_pal_[index].a - c.a;
-        dist = dr*dr + dg*dg + db*db + da*da;
-        int poz = index;
-
-        // search neighbour positions in both directions for better match
-        for (int i = poz - 1; i >= 0; i--)
+        std::uint64_t empty = 0;
+        if (nearest_[(pos + i) & mask].compare_exchange_strong(empty, key | index, std::memory_order_relaxed))
         {
-            dr = sorted_pal_[i].r - c.r;
-            dg = sorted_pal_[i].g - c.g;
-            db = sorted_pal_[i].b - c.b;
-            da = sorted_pal_[i].a - c.a;
-            // stop criteria based on properties of used sorting
-            if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
-            {
-                break;
-            }
-            newdist = dr*dr + dg*dg + db*db + da*da;
-            if (newdist < dist)
-            {
-                index = i;
-                dist = newdist;
-            }
+            return index;
         }
+    }
+    // table is crowded around this color, replace its home slot
+    nearest_[pos].store(key | index, std::memory_order_relaxed);
+    return index;
+}
+
+unsigned char rgba_palette::search(rgba const& c) const
+{
+    unsigned char index = 0;
+    int dr, dg, db, da;
+    int dist, newdist;
+
+    // find closest match based on mean of r,g,b,a
+    std::vector<rgba>::const_iterator pit =
+        std::lower_bound(sorted_pal_.begin(), sorted_pal_.end(), c, rgba::mean_sort_cmp());
+    index = std::distance(sorted_pal_.begin(),pit);
+    if (index == sorted_pal_.size()) index--;
 
-        for (unsigned i = poz + 1; i < sorted_pal_.size(); i++)
+    dr = sorted_pal_[index].r - c.r;
+    dg = sorted_pal_[index].g - c.g;
+    db = sorted_pal_[index].b - c.b;
+    da = sorted_pal_[index].a - c.a;
+    dist = dr*dr + dg*dg + db*db + da*da;
+    int poz = index;
+
+    // search neighbour positions in both directions for better match
+    for (int i = poz - 1; i >= 0; i--)
+    {
+        dr = sorted_pal_[i].r - c.r;
+        dg = sorted_pal_[i].g - c.g;
+        db = sorted_pal_[i].b - c.b;
+        da = sorted_pal_[i].a - c.a;
+        // stop criteria based on properties of used sorting
+        if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
         {
-            dr = sorted_pal_[i].r - c.r;
-            dg = sorted_pal_[i].g - c.g;
-            db = sorted_pal_[i].b - c.b;
-            da = sorted_pal_[i].a - c.a;
-            // stop criteria based on properties of used sorting
-            if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
-            {
-                break;
-            }
-            newdist = dr*dr + dg*dg + db*db + da*da;
-            if (newdist < dist)
-            {
-                index = i;
-                dist = newdist;
-            }
+            break;
         }
+        newdist = dr*dr + dg*dg + db*db + da*da;
+        if (newdist < dist)
+        {
+            index = i;
+            dist = newdist;
+        }
+    }
 
-        // Cache found index for the color c into the hashmap.
-        color_hashmap_[val] = index;
+    for (unsigned i = poz + 1; i < sorted_pal_.size(); i++)
+    {
+        dr = sorted_pal_[i].r - c.r;
+        dg = sorted_pal_[i].g - c.g;
+        db = sorted_pal_[i].b - c.b;
+        da = sorted_pal_[i].a - c.a;
+        // stop criteria based on properties of used sorting
+        if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
+        {
+            break;
+        }
+        newdist = dr*dr + dg*dg + db*db + da*da;
+        if (newdist < dist)
+        {
+            index = i;
+            dist = newdist;
+        }
     }
 
+    // colors of the palette itself map to their last duplicate
+    if (dist == 0)
+    {
+        while (index + 1u < sorted_pal_.size() && sorted_pal_[index + 1] == c)
+        {
+            ++index;
+        }
+    }
     return index;
 }
 
@@ -225,23 +253,13 @@ void rgba_palette::parse(std::string const& pal, palette_type type)
 
     colors_ = sorted_pal_.size();
 
-#ifdef USE_DENSE_HASH_MAP
-    color_hashmap_.resize((colors_*2));
-#endif
-    color_hashmap_.clear();
-
     // Sort palette for binary searching in quantization
     std::sort(sorted_pal_.begin(), sorted_pal_.end(), rgba::mean_sort_cmp());
 
-    // Insert all palette colors into the hashmap and into the palette vectors.
+    // Insert all palette colors into the palette vectors.
     for (unsigned i = 0; i < colors_; i++)
     {
         rgba c = sorted_pal_[i];
-        unsigned val = c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
-        if (val != 0)
-        {
-            color_hashmap_[val] = i;
-        }
         rgb_pal_.push_back(rgb(c));
         if (c.a < 0xFF)
         {
@@ -0,0 +1,282 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/parallel_png.hpp>
+#include <mapnik/thread_pool.hpp>
+
+// zlib
+#include <zlib.h>
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace mapnik {
+
+namespace {
+
+// deflate window, primed from the preceding chunk
+const std::size_t dictionary_size = 32768;
+
+struct deflate_chunk
+{
+    std::string data;
+    uLong adler;
+    std::size_t size;
+};
+
+bool deflate_raw(std::uint8_t const* raw, std::size_t begin, std::size_t end, bool last,
+                 int level, int strategy, deflate_chunk & chunk)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // raw deflate, the zlib header and trailer are written once for all chunks
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, strategy) != Z_OK) return false;
+    std::size_t window = std::min(begin, dictionary_size);
+    if (window > 0 &&
+        deflateSetDictionary(&stream, raw + begin - window, static_cast<uInt>(window)) != Z_OK)
+    {
+        deflateEnd(&stream);
+        return false;
+    }
+    std::size_t size = end - begin;
+    stream.next_in = const_cast<Bytef*>(raw + begin);
+    stream.avail_in = static_cast<uInt>(size);
+    // the bound covers a finished stream, leave room for the sync flush marker
+    chunk.data.resize(deflateBound(&stream, size) + 16);
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    std::size_t produced = 0;
+    for (;;)
+    {
+        stream.next_out = reinterpret_cast<Bytef*>(&chunk.data[produced]);
+        stream.avail_out = static_cast<uInt>(chunk.data.size() - produced);
+        int ret = deflate(&stream, flush);
+        produced = chunk.data.size() - stream.avail_out;
+        if (ret == Z_STREAM_ERROR)
+        {
+            deflateEnd(&stream);
+            return false;
+        }
+        if (last ? ret == Z_STREAM_END : stream.avail_out != 0) break;
+        chunk.data.resize(chunk.data.size() * 2);
+    }
+    deflateEnd(&stream);
+    chunk.data.resize(produced);
+    chunk.adler = adler32(adler32(0L, Z_NULL, 0), raw + begin, static_cast<uInt>(size));
+    chunk.size = size;
+    return true;
+}
+
+}
+
+const std::size_t parallel_png_writer::chunk_size;
+
+parallel_png_writer::parallel_png_writer(int level, int strategy, unsigned threads)
+    : buffer_("\x89PNG\r\n\x1a\n", 8),
+      stride_(0),
+      level_(level),
+      strategy_(strategy),
+      threads_(threads)
+{
+    if (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION)
+    {
+        throw std::runtime_error("compression level must be between -1 and 9");
+    }
+}
+
+void parallel_png_writer::put_uint32(std::uint32_t value)
+{
+    buffer_.push_back(static_cast<char>((value >> 24) & 0xff));
+    buffer_.push_back(static_cast<char>((value >> 16) & 0xff));
+    buffer_.push_back(static_cast<char>((value >> 8) & 0xff));
+    buffer_.push_back(static_cast<char>(value & 0xff));
+}
+
+std::size_t parallel_png_writer::start_chunk(char const* type)
+{
+    std::size_t start = buffer_.size();
+    // length is filled in by finish_chunk
+    put_uint32(0);
+    buffer_.append(type, 4);
+    return start;
+}
+
+void parallel_png_writer::finish_chunk(std::size_t start)
+{
+    std::size_t length = buffer_.size() - start - 8;
+    std::uint32_t value = static_cast<std::uint32_t>(length);
+    buffer_[start] = static_cast<char>((value >> 24) & 0xff);
+    buffer_[start + 1] = static_cast<char>((value >> 16) & 0xff);
+    buffer_[start + 2] = static_cast<char>((value >> 8) & 0xff);
+    buffer_[start + 3] = static_cast<char>(value & 0xff);
+    // the crc covers the chunk type and data, not the length
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, reinterpret_cast<Bytef const*>(buffer_.data() + start + 4), static_cast<uInt>(length + 4));
+    put_uint32(static_cast<std::uint32_t>(crc));
+}
+
+void parallel_png_writer::write_ihdr(unsigned width, unsigned height, unsigned pixel_depth)
+{
+    stride_ = (std::size_t(width) * pixel_depth + 7) / 8;
+    std::size_t start = start_chunk("IHDR");
+    put_uint32(width);
+    put_uint32(height);
+    if (pixel_depth == 32)
+    {
+        buffer_.push_back(8); // bit depth
+        buffer_.push_back(6); // true color with alpha
+    }
+    else if (pixel_depth == 24)
+    {
+        buffer_.push_back(8);
+        buffer_.push_back(2); // true color
+    }
+    else
+    {
+        buffer_.push_back(static_cast<char>(pixel_depth));
+        buffer_.push_back(3); // indexed color
+    }
+    buffer_.push_back(0); // compression method
+    buffer_.push_back(0); // filter method
+    buffer_.push_back(0); // interlace method
+    finish_chunk(start);
+}
+
+void parallel_png_writer::write_plte(std::vector<rgb> const& palette)
+{
+    std::size_t start = start_chunk("PLTE");
+    for (rgb const& c : palette)
+    {
+        buffer_.push_back(static_cast<char>(c.r));
+        buffer_.push_back(static_cast<char>(c.g));
+        buffer_.push_back(static_cast<char>(c.b));
+    }
+    finish_chunk(start);
+}
+
+void parallel_png_writer::write_trns(std::vector<unsigned> const& alpha)
+{
+    // truncated after the last translucent entry, omitted if all are opaque
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < alpha.size(); ++i)
+    {
+        if (alpha[i] < 255) size = i + 1;
+    }
+    if (size == 0) return;
+    std::size_t start = start_chunk("tRNS");
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        buffer_.push_back(static_cast<char>(alpha[i]));
+    }
+    finish_chunk(start);
+}
+
+void parallel_png_writer::write_iend()
+{
+    finish_chunk(start_chunk("IEND"));
+}
+
+void parallel_png_writer::deflate_scanlines(std::vector<std::uint8_t> const& raw)
+{
+    std::size_t count = std::max<std::size_t>(1, (raw.size() + chunk_size - 1) / chunk_size);
+    std::vector<deflate_chunk> chunks(count);
+    std::atomic<bool> failed(false);
+    thread_pool::instance().parallel_for(count, threads_, [&](std::size_t i) {
+        std::size_t begin = i * chunk_size;
+        std::size_t end = std::min(raw.size(), begin + chunk_size);
+        if (!deflate_raw(raw.data(), begin, end, i + 1 == count, level_, strategy_, chunks[i]))
+        {
+            failed = true;
+        }
+    });
+    if (failed) throw std::runtime_error("failed to compress image");
+
+    // zlib header: 32K window, deflate, level hint as zlib writes it
+    int level = (level_ == Z_DEFAULT_COMPRESSION) ? 6 : level_;
+    unsigned flevel = (level < 2) ? 0 : (level < 6) ? 1 : (level == 6) ? 2 : 3;
+    unsigned header = (0x78 << 8) | (flevel << 6);
+    header += 31 - header % 31;
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::size_t start = start_chunk("IDAT");
+        if (i == 0)
+        {
+            buffer_.push_back(static_cast<char>(header >> 8));
+            buffer_.push_back(static_cast<char>(header & 0xff));
+        }
+        buffer_.append(chunks[i].data);
+        adler = adler32_combine(adler, chunks[i].adler, static_cast<z_off_t>(chunks[i].size));
+        if (i + 1 == count)
+        {
+            put_uint32(static_cast<std::uint32_t>(adler));
+        }
+        finish_chunk(start);
+        std::string().swap(chunks[i].data);
+    }
+}
+
+template <typename T>
+void parallel_png_writer::write_idat(T const& image)
+{
+    std::size_t stride = std::min(stride_, image.width() * sizeof(typename T::pixel_type));
+    std::vector<std::uint8_t> raw((stride_ + 1) * image.height());
+    for (unsigned y = 0; y < image.height(); ++y)
+    {
+        // filter type none, already zero
+        std::uint8_t * out = &raw[y * (stride_ + 1) + 1];
+        std::memcpy(out, image.getRow(y), stride);
+    }
+    deflate_scanlines(raw);
+}
+
+template <typename T>
+void parallel_png_writer::write_idat_strip_alpha(T const& image)
+{
+    unsigned width = static_cast<unsigned>(std::min<std::size_t>(stride_ / 3, image.width()));
+    std::vector<std::uint8_t> raw((stride_ + 1) * image.height());
+    for (unsigned y = 0; y < image.height(); ++y)
+    {
+        // filter type none, already zero
+        std::uint8_t * out = &raw[y * (stride_ + 1) + 1];
+        std::uint8_t const* row = reinterpret_cast<std::uint8_t const*>(image.getRow(y));
+        for (unsigned x = 0; x < width; ++x)
+        {
+            *out++ = row[x * 4];
+            *out++ = row[x * 4 + 1];
+            *out++ = row[x * 4 + 2];
+        }
+    }
+    deflate_scanlines(raw);
+}
+
+template void parallel_png_writer::write_idat<image_data_8>(image_data_8 const& image);
+template void parallel_png_writer::write_idat<image_view<image_data_8> >(image_view<image_data_8> const& image);
+template void parallel_png_writer::write_idat<image_data_32>(image_data_32 const& image);
+template void parallel_png_writer::write_idat<image_view<image_data_32> >(image_view<image_data_32> const& image);
+template void parallel_png_writer::write_idat_strip_alpha<image_data_32>(image_data_32 const& image);
+template void parallel_png_writer::write_idat_strip_alpha<image_view<image_data_32> >(image_view<image_data_32> const& image);
+
+}
@@ -30,8 +30,11 @@
 #include <mapnik/enumeration.hpp>
 
 // stl
+#include <algorithm>
 #include <limits>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace mapnik
 {
@@ -122,25 +125,136 @@ bool raster_colorizer::add_stop(colorizer_stop const& stop)
     return true;
 }
 
+//! \brief Colors of every value of an integer range, valid for one colorizer state
+struct colorizer_lut
+{
+    colorizer_stops stops;
+    colorizer_mode default_mode;
+    color default_color;
+    float epsilon;
+    boost::optional<double> nodata;
+    int offset;
+    std::vector<unsigned> colors;
+};
+
+namespace {
+
+enum lut_kind
+{
+    LUT_UINT8 = 0,
+    LUT_UINT16,
+    LUT_INT16,
+    LUT_NONE
+};
+
+inline bool integral(float value, int & out)
+{
+    // also rejects NaN
+    if (!(value >= -32768.0f && value <= 65535.0f)) return false;
+    out = static_cast<int>(value);
+    return static_cast<float>(out) == value;
+}
+
+inline bool same_nodata(boost::optional<double> const& a, boost::optional<double> const& b)
+{
+    return a ? (b && *a == *b) : !b;
+}
+
+}
+
 void raster_colorizer::colorize(raster_ptr const& raster, feature_impl const& f) const
 {
     unsigned *imageData = raster->data_.getData();
 
     int len = raster->data_.width() * raster->data_.height();
     boost::optional<double> const& nodata = raster->nodata();
+
+    // find the smallest integer type holding every value but nodata
+    int min_value = 0;
+    int max_value = 0;
+    lut_kind kind = LUT_UINT8;
     for (int i=0; i<len; ++i)
     {
-        // the GDAL plugin reads single bands as floats
         float value = *reinterpret_cast<float *> (&imageData[i]);
-        if (nodata && (std::fabs(value - *nodata) < epsilon_))
+        int ivalue;
+        if (integral(value, ivalue))
         {
-            imageData[i] = 0;
+            min_value = std::min(min_value, ivalue);
+            max_value = std::max(max_value, ivalue);
         }
-        else
+        else if (!nodata || !(std::fabs(value - *nodata) < epsilon_))
         {
-            imageData[i] = get_color(value);
+            kind = LUT_NONE;
+            break;
         }
     }
+    if (kind != LUT_NONE)
+    {
+        if (min_value >= 0) kind = (max_value <= 255) ? LUT_UINT8 : LUT_UINT16;
+        else kind = (max_value <= 32767) ? LUT_INT16 : LUT_NONE;
+    }
+
+    // colors floats stored in data in place
+    auto colorize_values = [this, &nodata](unsigned * data, std::size_t size)
+    {
+        for (std::size_t i=0; i<size; ++i)
+        {
+            float value = *reinterpret_cast<float *> (&data[i]);
+            if (nodata && (std::fabs(value - *nodata) < epsilon_))
+            {
+                data[i] = 0;
+            }
+            else
+            {
+                data[i] = get_color(value);
+            }
+        }
+    };
+
+    if (kind == LUT_NONE)
+    {
+        // the GDAL plugin reads single bands as floats
+        colorize_values(imageData, len);
+        return;
+    }
+
+    std::shared_ptr<colorizer_lut const> lut = std::atomic_load(&luts_[kind]);
+    if (!lut ||
+        !same_nodata(lut->nodata, nodata) ||
+        lut->epsilon != epsilon_ ||
+        lut->default_mode != default_mode_ ||
+        !(lut->default_color == default_color_) ||
+        !(lut->stops == stops_))
+    {
+        // stops are public through get_stops, so the table is checked
+        // against the colorizer state rather than invalidated by setters
+        auto table = std::make_shared<colorizer_lut>();
+        table->stops = stops_;
+        table->default_mode = default_mode_;
+        table->default_color = default_color_;
+        table->epsilon = epsilon_;
+        table->nodata = nodata;
+        table->offset = (kind == LUT_INT16) ? -32768 : 0;
+        table->colors.resize(kind == LUT_UINT8 ? 256 : 65536);
+        for (std::size_t i = 0; i < table->colors.size(); ++i)
+        {
+            float value = static_cast<float>(static_cast<int>(i) + table->offset);
+            std::memcpy(&table->colors[i], &value, sizeof(float));
+        }
+        colorize_values(table->colors.data(), table->colors.size());
+        lut = table;
+        std::atomic_store(&luts_[kind], lut);
+    }
+
+    unsigned const* colors = lut->colors.data();
+    int offset = lut->offset;
+    for (int i=0; i<len; ++i)
+    {
+        float value = *reinterpret_cast<float *> (&imageData[i]);
+        int ivalue;
+        // anything not integral is nodata, see above
+        imageData[i] = integral(value, ivalue) ? colors[ivalue - offset] : 0;
+    }
 }
 
 inline unsigned interpolate(unsigned start, unsigned end, float fraction)
@@ -0,0 +1,69 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/raster_tile_cache.hpp>
+
+namespace mapnik
+{
+
+template class singleton<raster_tile_cache, CreateUsingNew>;
+
+raster_tile_cache::raster_tile_cache()
+    : cache_(64 << 20) {}
+
+raster_tile_cache::~raster_tile_cache() {}
+
+raster_tile_ptr raster_tile_cache::find(raster_tile_key const& key)
+{
+    return cache_.find(key);
+}
+
+void raster_tile_cache::insert(raster_tile_key const& key, raster_tile_ptr tile)
+{
+    // a tile that alone fills the cache would only flush everything else,
+    // lru_cache doesn't store it
+    cache_.insert(key, tile);
+}
+
+void raster_tile_cache::clear()
+{
+    cache_.clear();
+}
+
+void raster_tile_cache::set_max_bytes(std::size_t max_bytes)
+{
+    cache_.set_max_size(max_bytes);
+}
+
+std::size_t raster_tile_cache::max_bytes() const
+{
+    return cache_.max_size();
+}
+
+raster_tile_cache_stats raster_tile_cache::stats() const
+{
+    lru_cache_stats stats = cache_.stats();
+    return raster_tile_cache_stats{ stats.hits, stats.misses, stats.evictions, stats.entries, stats.size };
+}
+
+}
@@ -25,9 +25,23 @@
 #include <mapnik/map.hpp>
 #include <mapnik/request.hpp>
 #include <mapnik/attribute.hpp>
+#include <mapnik/text/vertex_cache_store.hpp>
 
 namespace mapnik {
 
+namespace {
+
+std::shared_ptr<label_collision_detector4> make_detector(Map const& m, int buffer_size,
+                                                         unsigned width, unsigned height)
+{
+    box2d<double> extent(-buffer_size, -buffer_size, width + buffer_size, height + buffer_size);
+    double cell_size = (m.get_collision_detector() == Map::GRID_DETECTOR)
+        ? label_collision_detector4::default_cell_size(extent) : 0.0;
+    return std::make_shared<label_collision_detector4>(extent, cell_size);
+}
+
+}
+
 renderer_common::renderer_common(Map const& map, unsigned width, unsigned height, double scale_factor,
                                  attributes const& vars,
                                  view_transform && t,
@@ -41,7 +55,8 @@ renderer_common::renderer_common(Map const& map, unsigned width, unsigned height
      font_manager_(font_library_,map.get_font_file_mapping(),map.get_font_memory_cache()),
      query_extent_(),
      t_(t),
-     detector_(detector)
+     detector_(detector),
+     vertex_caches_(std::make_shared<vertex_cache_store>())
 {}
 
 renderer_common::renderer_common(Map const &m, attributes const& vars, unsigned offset_x, unsigned offset_y,
@@ -49,9 +64,7 @@ renderer_common::renderer_common(Map const &m, attributes const& vars, unsigned
    : renderer_common(m, width, height, scale_factor,
                      vars,
                      view_transform(m.width(),m.height(),m.get_current_extent(),offset_x,offset_y),
-                     std::make_shared<label_collision_detector4>(
-                        box2d<double>(-m.buffer_size(), -m.buffer_size(),
-                                      m.width() + m.buffer_size() ,m.height() + m.buffer_size())))
+                     make_detector(m, m.buffer_size(), m.width(), m.height()))
 {}
 
 renderer_common::renderer_common(Map const &m, attributes const& vars, unsigned offset_x, unsigned offset_y,
@@ -68,9 +81,7 @@ renderer_common::renderer_common(Map const &m, request const &req, attributes co
    : renderer_common(m, width, height, scale_factor,
                      vars,
                      view_transform(req.width(),req.height(),req.extent(),offset_x,offset_y),
-                     std::make_shared<label_collision_detector4>(
-                        box2d<double>(-req.buffer_size(), -req.buffer_size(),
-                                      req.width() + req.buffer_size() ,req.height() + req.buffer_size())))
+                     make_detector(m, req.buffer_size(), req.width(), req.height()))
 {}
 
 }
@@ -414,6 +414,12 @@ void serialize_style( ptree & map_node, std::string const& name, feature_type_st
         set_attr(style_node, "image-filters-inflate", image_filters_inflate);
     }
 
+    unsigned filter_batch_size = style.filter_batch_size();
+    if (filter_batch_size != dfl.filter_batch_size() || explicit_defaults)
+    {
+        set_attr(style_node, "filter-batch-size", filter_batch_size);
+    }
+
     boost::optional<composite_mode_e> comp_op = style.comp_op();
     if (comp_op)
     {
@@ -656,6 +662,18 @@ void serialize_map(ptree & pt, Map const& map, bool explicit_defaults)
         set_attr( map_node, "buffer-size", buffer_size );
     }
 
+    collision_detector_e collision_detector = map.get_collision_detector();
+    if (collision_detector != Map::QUAD_TREE_DETECTOR || explicit_defaults)
+    {
+        set_attr( map_node, "collision-detector", collision_detector );
+    }
+
+    bool deferred_labels = map.deferred_labels();
+    if (deferred_labels || explicit_defaults)
+    {
+        set_attr( map_node, "deferred-labels", deferred_labels );
+    }
+
     std::string const& base_path = map.base_path();
     if ( !base_path.empty() || explicit_defaults)
     {
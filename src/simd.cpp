@@ -0,0 +1,70 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/simd.hpp>
+
+// stl
+#include <atomic>
+
+namespace mapnik { namespace simd {
+
+namespace {
+
+level_e detect()
+{
+#if defined(MAPNIK_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+    return SSE2;
+#else
+    return SCALAR;
+#endif
+}
+
+std::atomic<int> & active()
+{
+    static std::atomic<int> level(detected_level());
+    return level;
+}
+
+}
+
+level_e detected_level()
+{
+    static const level_e level = detect();
+    return level;
+}
+
+level_e active_level()
+{
+    return static_cast<level_e>(active().load(std::memory_order_relaxed));
+}
+
+level_e set_level(level_e level)
+{
+    if (level > detected_level()) level = detected_level();
+    active().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+}}
@@ -28,11 +28,32 @@ extern "C"
 #include FT_GLYPH_H
 }
 
+// stl
+#include <map>
+#include <mutex>
+
 namespace mapnik
 {
 
-font_face::font_face(FT_Face face)
+namespace {
+
+// faces of different fonts may well share family and style names, think of
+// a map's own font directory next to the system fonts, so faces are told
+// apart by the font they were loaded from
+unsigned face_id(std::string const& file_name, int face_index)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<std::string, int>, unsigned> ids;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto itr = ids.emplace(std::make_pair(file_name, face_index), static_cast<unsigned>(ids.size())).first;
+    return itr->second;
+}
+
+}
+
+font_face::font_face(FT_Face face, std::string const& file_name, int face_index)
     : face_(face),
+      id_(face_id(file_name, face_index)),
       glyph_info_cache_(),
       char_height_(0.0) {}
 
@@ -0,0 +1,92 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/text/glyph_cache.hpp>
+
+// stl
+#include <algorithm>
+
+namespace mapnik
+{
+
+template class singleton<glyph_cache, CreateUsingNew>;
+
+glyph_cache::glyph_cache()
+    : cache_(32 * 1024 * 1024),
+      subpixel_step_(1),
+      rotation_steps_(0) {}
+
+glyph_cache::~glyph_cache() {}
+
+glyph_bitmap_ptr glyph_cache::find(glyph_cache_key const& key)
+{
+    return cache_.find(key);
+}
+
+void glyph_cache::insert(glyph_cache_key const& key, glyph_bitmap_ptr bitmap)
+{
+    cache_.insert(key, bitmap);
+}
+
+void glyph_cache::clear()
+{
+    cache_.clear();
+}
+
+void glyph_cache::set_max_bytes(std::size_t max_bytes)
+{
+    cache_.set_max_size(max_bytes);
+}
+
+std::size_t glyph_cache::max_bytes() const
+{
+    return cache_.max_size();
+}
+
+std::size_t glyph_cache::size() const
+{
+    return cache_.entries();
+}
+
+std::size_t glyph_cache::bytes() const
+{
+    return cache_.size();
+}
+
+void glyph_cache::set_snapping(unsigned subpixel_step, unsigned rotation_steps)
+{
+    subpixel_step_ = std::max(1u, std::min(subpixel_step, 64u));
+    rotation_steps_ = rotation_steps;
+}
+
+unsigned glyph_cache::subpixel_step() const
+{
+    return subpixel_step_;
+}
+
+unsigned glyph_cache::rotation_steps() const
+{
+    return rotation_steps_;
+}
+
+}
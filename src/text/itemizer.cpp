@@ -31,8 +31,42 @@
 namespace mapnik
 {
 
+namespace {
+
+// Characters below U+0250 are either Latin or Common script and none of them
+// is right to left. Returns USCRIPT_INVALID_CODE if str has any other character.
+UScriptCode simple_script(value_unicode_string const& str)
+{
+    UScriptCode script = USCRIPT_COMMON;
+    UChar const* buffer = str.getBuffer();
+    for (int32_t i = 0, length = str.length(); i < length; ++i)
+    {
+        UChar c = buffer[i];
+        if (c < 0x80)
+        {
+            UChar lower = c | 0x20;
+            if (lower >= 'a' && lower <= 'z') script = USCRIPT_LATIN;
+        }
+        else if (c < 0x250)
+        {
+            if (script != USCRIPT_LATIN)
+            {
+                UErrorCode error = U_ZERO_ERROR;
+                if (uscript_getScript(c, &error) == USCRIPT_LATIN) script = USCRIPT_LATIN;
+            }
+        }
+        else
+        {
+            return USCRIPT_INVALID_CODE;
+        }
+    }
+    return script;
+}
+
+}
+
 text_itemizer::text_itemizer()
-    : text_(), format_runs_(), direction_runs_(), script_runs_()
+    : text_(), format_runs_(), direction_runs_(), script_runs_(), simple_script_(USCRIPT_COMMON)
 {
     forced_line_breaks_.push_back(0);
 }
@@ -43,6 +77,12 @@ void text_itemizer::add_text(mapnik::value_unicode_string const& str, evaluated_
     text_ += str;
     format_runs_.emplace_back(format, start, text_.length());
 
+    if (simple_script_ != USCRIPT_INVALID_CODE)
+    {
+        UScriptCode script = simple_script(str);
+        if (script != USCRIPT_COMMON) simple_script_ = script;
+    }
+
     while ((start = text_.indexOf('\n', start)+1) > 0)
     {
         forced_line_breaks_.push_back(start);
@@ -55,8 +95,19 @@ std::list<text_item> const& text_itemizer::itemize(unsigned start, unsigned end)
         end = text_.length();
     }
     // format itemiziation is done by add_text()
-    itemize_direction(start, end);
-    itemize_script();
+    if (simple_script_ != USCRIPT_INVALID_CODE)
+    {
+        // same runs as BiDi and ScriptRun produce for such text
+        direction_runs_.clear();
+        direction_runs_.emplace_back(UBIDI_LTR, start, end);
+        script_runs_.clear();
+        script_runs_.emplace_back(simple_script_, 0, text_.length());
+    }
+    else
+    {
+        itemize_direction(start, end);
+        itemize_script();
+    }
     create_item_list();
     return output_;
 }
@@ -66,6 +117,7 @@ void text_itemizer::clear()
     output_.clear();
     text_.remove();
     format_runs_.clear();
+    simple_script_ = USCRIPT_COMMON;
     forced_line_breaks_.clear();
     forced_line_breaks_.push_back(0);
 }
@@ -88,6 +140,13 @@ unsigned text_itemizer::num_lines() const
     return forced_line_breaks_.size();
 }
 
+evaluated_format_properties_ptr const& text_itemizer::format_at(unsigned position) const
+{
+    format_run_list::const_iterator itr = find_run(format_runs_, position);
+    if (itr == format_runs_.end()) return format_runs_.back().data;
+    return itr->data;
+}
+
 void text_itemizer::itemize_direction(unsigned start, unsigned end)
 {
     direction_runs_.clear();
@@ -143,7 +202,7 @@ void text_itemizer::itemize_script()
 }
 
 template <typename T>
-typename T::const_iterator text_itemizer::find_run(T const& list, unsigned position)
+typename T::const_iterator text_itemizer::find_run(T const& list, unsigned position) const
 {
     typename T::const_iterator itr = list.begin(), end = list.end();
     for ( ;itr!=end; ++itr)
@@ -27,10 +27,69 @@
 #include <mapnik/text/text_properties.hpp>
 #include <mapnik/font_engine_freetype.hpp>
 #include <mapnik/text/face.hpp>
+#include <mapnik/text/glyph_cache.hpp>
+
+// stl
+#include <algorithm>
+#include <cmath>
 
 namespace mapnik
 {
 
+namespace {
+
+inline bool has_identity_matrix(agg::trans_affine const& tr)
+{
+    return tr.sx == 1.0 && tr.shx == 0.0 && tr.shy == 0.0 && tr.sy == 1.0;
+}
+
+inline FT_Pos floor_div(FT_Pos a, FT_Pos b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// split a 26.6 position into whole pixels and a subpixel remainder,
+// snapped to multiples of step
+inline void snap_pen(FT_Pos pos, FT_Pos step, FT_Pos & whole, std::int32_t & subpixel)
+{
+    FT_Pos snapped = step > 1 ? floor_div(pos + step / 2, step) * step : pos;
+    whole = floor_div(snapped, 64);
+    subpixel = static_cast<std::int32_t>(snapped - whole * 64);
+}
+
+// the rotation as prepare_glyphs hands it to FreeType, optionally snapped
+// to 1/steps of a full turn
+inline void rotation_key(rotation const& rot, unsigned steps, glyph_cache_key & key)
+{
+    double cos_a = rot.cos;
+    double sin_a = rot.sin;
+    if (steps > 0)
+    {
+        double step = 2.0 * M_PI / steps;
+        double angle = std::round(std::atan2(sin_a, cos_a) / step) * step;
+        cos_a = std::cos(angle);
+        sin_a = std::sin(angle);
+    }
+    key.rotation_cos = static_cast<std::int32_t>(cos_a * 0x10000L);
+    key.rotation_sin = static_cast<std::int32_t>(sin_a * 0x10000L);
+}
+
+inline FT_Bitmap bitmap_view(glyph_bitmap const& bitmap)
+{
+    FT_Bitmap view;
+    view.rows = bitmap.rows;
+    view.width = bitmap.width;
+    view.pitch = static_cast<int>(bitmap.width);
+    view.buffer = const_cast<unsigned char*>(bitmap.buffer.data());
+    view.num_grays = 256;
+    view.pixel_mode = FT_PIXEL_MODE_GRAY;
+    view.palette_mode = 0;
+    view.palette = nullptr;
+    return view;
+}
+
+}
+
 text_renderer::text_renderer (halo_rasterizer_e rasterizer, composite_mode_e comp_op,
                               composite_mode_e halo_comp_op, double scale_factor, stroker_ptr stroker)
     : rasterizer_(rasterizer),
@@ -87,6 +146,52 @@ void text_renderer::prepare_glyphs(glyph_positions const& positions)
     }
 }
 
+glyph_bitmap_ptr text_renderer::rasterize_glyph(glyph_info const& glyph, glyph_cache_key const& key)
+{
+    glyph.face->set_character_sizes(glyph.format->text_size * scale_factor_);
+
+    FT_Matrix matrix;
+    matrix.xx = key.rotation_cos;
+    matrix.xy = -key.rotation_sin;
+    matrix.yx = key.rotation_sin;
+    matrix.yy = key.rotation_cos;
+    FT_Vector pen;
+    pen.x = key.subpixel_x;
+    pen.y = key.subpixel_y;
+
+    FT_Face face = glyph.face->get_face();
+    FT_Set_Transform(face, &matrix, &pen);
+    if (FT_Load_Glyph(face, glyph.glyph_index, FT_LOAD_NO_HINTING)) return glyph_bitmap_ptr();
+
+    FT_Glyph image;
+    if (FT_Get_Glyph(face->glyph, &image)) return glyph_bitmap_ptr();
+    if (key.halo_radius >= 0)
+    {
+        stroker_->init(key.halo_radius / 64.0);
+        FT_Glyph_Stroke(&image, stroker_->get(), 1);
+    }
+    if (FT_Glyph_To_Bitmap(&image, FT_RENDER_MODE_NORMAL, 0, 1))
+    {
+        FT_Done_Glyph(image);
+        return glyph_bitmap_ptr();
+    }
+    FT_BitmapGlyph bit = reinterpret_cast<FT_BitmapGlyph>(image);
+    auto bitmap = std::make_shared<glyph_bitmap>();
+    bitmap->left = bit->left;
+    bitmap->top = bit->top;
+    bitmap->width = bit->bitmap.width;
+    bitmap->rows = bit->bitmap.rows;
+    bitmap->buffer.resize(bitmap->width * bitmap->rows);
+    for (unsigned row = 0; row < bitmap->rows; ++row)
+    {
+        std::copy(bit->bitmap.buffer + row * bit->bitmap.pitch,
+                  bit->bitmap.buffer + row * bit->bitmap.pitch + bitmap->width,
+                  bitmap->buffer.begin() + row * bitmap->width);
+    }
+    FT_Done_Glyph(image);
+    return bitmap;
+}
+
 template <typename T>
 void composite_bitmap(T & pixmap, FT_Bitmap *bitmap, unsigned rgba, int x, int y, double opacity, composite_mode_e comp_op)
 {
@@ -120,6 +225,12 @@ agg_text_renderer<T>::agg_text_renderer (pixmap_type & pixmap,
 template <typename T>
 void agg_text_renderer<T>::render(glyph_positions const& pos)
 {
+    if (has_identity_matrix(transform_) && has_identity_matrix(halo_transform_) &&
+        glyph_cache::instance().max_bytes() > 0)
+    {
+        render_cached(pos);
+        return;
+    }
     glyphs_.clear();
     prepare_glyphs(pos);
     FT_Error  error;
@@ -229,6 +340,100 @@ void agg_text_renderer<T>::render(glyph_positions const& pos)
 }
 
 
+template <typename T>
+void agg_text_renderer<T>::render_cached(glyph_positions const& pos)
+{
+    glyph_cache & cache = glyph_cache::instance();
+    FT_Pos const subpixel_step = cache.subpixel_step();
+    unsigned const rotation_steps = cache.rotation_steps();
+    int height = pixmap_.height();
+    pixel_position const& base_point = pos.get_base_point();
+
+    FT_Vector start;
+    start.x =  static_cast<FT_Pos>(base_point.x * (1 << 6));
+    start.y =  static_cast<FT_Pos>((height - base_point.y) * (1 << 6));
+    FT_Vector start_halo = start;
+    start.x += transform_.tx * 64;
+    start.y += transform_.ty * 64;
+    start_halo.x += halo_transform_.tx * 64;
+    start_halo.y += halo_transform_.ty * 64;
+
+    auto lookup = [&](glyph_position const& glyph_pos, FT_Vector const& origin,
+                      std::int32_t halo, FT_Pos & x, FT_Pos & y) -> glyph_bitmap_ptr
+    {
+        glyph_info const& glyph = *(glyph_pos.glyph);
+        pixel_position p = glyph_pos.pos + glyph.offset.rotate(glyph_pos.rot);
+        glyph_cache_key key;
+        key.face_id = glyph.face->id();
+        key.glyph_index = glyph.glyph_index;
+        key.size = static_cast<std::int32_t>(glyph.format->text_size * scale_factor_ * (1 << 6));
+        rotation_key(glyph_pos.rot, rotation_steps, key);
+        key.halo_radius = halo;
+        snap_pen(static_cast<FT_Pos>(p.x * 64) + origin.x, subpixel_step, x, key.subpixel_x);
+        snap_pen(static_cast<FT_Pos>(p.y * 64) + origin.y, subpixel_step, y, key.subpixel_y);
+        glyph_bitmap_ptr bitmap = cache.find(key);
+        if (!bitmap)
+        {
+            bitmap = rasterize_glyph(glyph, key);
+            cache.insert(key, bitmap);
+        }
+        return bitmap;
+    };
+
+    FT_Pos x, y;
+    //render halo
+    for (auto const& glyph_pos : pos)
+    {
+        detail::evaluated_format_properties const& format = *(glyph_pos.glyph->format);
+        double halo_radius = format.halo_radius * scale_factor_;
+        // make sure we've got reasonable values.
+        if (halo_radius <= 0.0 || halo_radius > 1024.0) continue;
+        if (rasterizer_ == HALO_RASTERIZER_FULL)
+        {
+            glyph_bitmap_ptr bitmap = lookup(glyph_pos, start_halo,
+                                             static_cast<std::int32_t>(halo_radius * (1 << 6)), x, y);
+            if (!bitmap) continue;
+            FT_Bitmap view = bitmap_view(*bitmap);
+            composite_bitmap(pixmap_,
+                             &view,
+                             format.halo_fill.rgba(),
+                             bitmap->left + x,
+                             height - (bitmap->top + y),
+                             format.halo_opacity,
+                             halo_comp_op_);
+        }
+        else
+        {
+            glyph_bitmap_ptr bitmap = lookup(glyph_pos, start_halo, -1, x, y);
+            if (!bitmap) continue;
+            FT_Bitmap view = bitmap_view(*bitmap);
+            render_halo(&view,
+                        format.halo_fill.rgba(),
+                        bitmap->left + x,
+                        height - (bitmap->top + y),
+                        halo_radius,
+                        format.halo_opacity,
+                        halo_comp_op_);
+        }
+    }
+
+    // render actual text
+    for (auto const& glyph_pos : pos)
+    {
+        detail::evaluated_format_properties const& format = *(glyph_pos.glyph->format);
+        glyph_bitmap_ptr bitmap = lookup(glyph_pos, start, -1, x, y);
+        if (!bitmap) continue;
+        FT_Bitmap view = bitmap_view(*bitmap);
+        composite_bitmap(pixmap_,
+                         &view,
+                         format.fill.rgba(),
+                         bitmap->left + x,
+                         height - (bitmap->top + y),
+                         format.text_opacity,
+                         comp_op_);
+    }
+}
+
 template <typename T>
 void grid_text_renderer<T>::render(glyph_positions const& pos, value_integer feature_id)
 {
@@ -182,7 +182,8 @@ text_symbolizer_helper::text_symbolizer_helper(
         unsigned width, unsigned height, double scale_factor,
         view_transform const& t, FaceManagerT & font_manager,
         DetectorT &detector, box2d<double> const& query_extent,
-        agg::trans_affine const& affine_trans)
+        agg::trans_affine const& affine_trans,
+        vertex_cache_store * vertex_caches)
     : base_symbolizer_helper(sym, feature, vars, prj_trans, width, height, scale_factor, t, query_extent),
       finder_(feature, vars, detector, dims_, *placement_, font_manager, scale_factor),
     adapter_(finder_,false),
@@ -199,6 +200,7 @@ text_symbolizer_helper::text_symbolizer_helper(
     converter_.template set<affine_transform_tag>();
     if (simplify_tolerance > 0.0) converter_.template set<simplify_tag>(); // optional simplify converter
     if (smooth > 0.0) converter_.template set<smooth_tag>(); // optional smooth converter
+    init_vertex_caches(vertex_caches, clip, simplify_tolerance, smooth, affine_trans);
 
     if (geometries_to_process_.size()) finder_.next_position();
 }
@@ -229,7 +231,24 @@ bool text_symbolizer_helper::next_line_placement(bool clipped)
             continue; //Reexecute size check
         }
 
-        converter_.apply(**geo_itr_);
+        if (vertex_caches_)
+        {
+            geometry_type & geom = **geo_itr_;
+            vertex_cache * pp = vertex_caches_->find(geom, converter_params_);
+            if (!pp)
+            {
+                vertex_cache_ptr measured;
+                adapter_.measured_ = &measured;
+                converter_.apply(geom);
+                adapter_.measured_ = nullptr;
+                pp = vertex_caches_->insert(geom, converter_params_, std::move(measured));
+            }
+            adapter_.status_ = pp && finder_.find_line_placements(*pp, adapter_.points_on_line_);
+        }
+        else
+        {
+            converter_.apply(**geo_itr_);
+        }
         if (adapter_.status())
         {
             //Found a placement
@@ -274,7 +293,8 @@ text_symbolizer_helper::text_symbolizer_helper(
         proj_transform const& prj_trans,
         unsigned width, unsigned height, double scale_factor,
         view_transform const& t, FaceManagerT & font_manager,
-        DetectorT & detector, box2d<double> const& query_extent, agg::trans_affine const& affine_trans)
+        DetectorT & detector, box2d<double> const& query_extent, agg::trans_affine const& affine_trans,
+        vertex_cache_store * vertex_caches)
     : base_symbolizer_helper(sym, feature, vars, prj_trans, width, height, scale_factor, t, query_extent),
       finder_(feature, vars, detector, dims_, *placement_, font_manager, scale_factor),
       adapter_(finder_,true),
@@ -290,6 +310,7 @@ text_symbolizer_helper::text_symbolizer_helper(
     converter_.template set<affine_transform_tag>();
     if (simplify_tolerance > 0.0) converter_.template set<simplify_tag>(); // optional simplify converter
     if (smooth > 0.0) converter_.template set<smooth_tag>(); // optional smooth converter
+    init_vertex_caches(vertex_caches, clip, simplify_tolerance, smooth, affine_trans);
     if (geometries_to_process_.size())
     {
         init_marker();
@@ -297,6 +318,22 @@ text_symbolizer_helper::text_symbolizer_helper(
     }
 }
 
+void text_symbolizer_helper::init_vertex_caches(vertex_cache_store * vertex_caches, bool clip,
+                                                double simplify_tolerance, double smooth,
+                                                agg::trans_affine const& affine_trans)
+{
+    vertex_caches_ = vertex_caches;
+    if (!vertex_caches_) return;
+    // everything converter_ depends on besides the view and projection
+    value_integer simplify_algorithm = mapnik::get<value_integer>(sym_, keys::simplify_algorithm, feature_, vars_);
+    converter_params_ = {{ clip ? 1.0 : 0.0, simplify_tolerance,
+                           static_cast<double>(simplify_algorithm), smooth,
+                           affine_trans.sx, affine_trans.shy, affine_trans.shx,
+                           affine_trans.sy, affine_trans.tx, affine_trans.ty,
+                           query_extent_.minx(), query_extent_.miny(),
+                           query_extent_.maxx(), query_extent_.maxy() }};
+    vertex_caches_->set_feature(feature_);
+}
 
 void text_symbolizer_helper::init_marker()
 {
@@ -347,7 +384,8 @@ template text_symbolizer_helper::text_symbolizer_helper(
     face_manager_freetype & font_manager,
     label_collision_detector4 &detector,
     box2d<double> const& query_extent,
-    agg::trans_affine const&);
+    agg::trans_affine const&,
+    vertex_cache_store *);
 
 template text_symbolizer_helper::text_symbolizer_helper(
     shield_symbolizer const& sym,
@@ -361,5 +399,6 @@ template text_symbolizer_helper::text_symbolizer_helper(
     face_manager_freetype & font_manager,
     label_collision_detector4 &detector,
     box2d<double> const& query_extent,
-    agg::trans_affine const&);
+    agg::trans_affine const&,
+    vertex_cache_store *);
 } //namespace
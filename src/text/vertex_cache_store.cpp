@@ -0,0 +1,100 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/text/vertex_cache_store.hpp>
+#include <mapnik/feature.hpp>
+
+namespace mapnik
+{
+
+namespace {
+
+// The geometry address alone is not enough: a feature allocated at the
+// address of a freed one would otherwise pick up stale paths.
+inline void first_vertex(geometry_type const& geom, double & x, double & y)
+{
+    x = y = 0.0;
+    if (geom.size() > 0) geom.data().get_vertex(0, &x, &y);
+}
+
+}
+
+vertex_cache_store::vertex_cache_store()
+    : feature_(nullptr),
+      feature_id_(0),
+      entries_() {}
+
+void vertex_cache_store::set_feature(feature_impl const& feature)
+{
+    if (feature_ != &feature || feature_id_ != feature.id())
+    {
+        entries_.clear();
+        feature_ = &feature;
+        feature_id_ = feature.id();
+    }
+}
+
+bool vertex_cache_store::matches(entry const& e, geometry_type const& geom, params_type const& params) const
+{
+    if (e.geom != &geom || e.geom_size != geom.size() || e.params != params) return false;
+    double x, y;
+    first_vertex(geom, x, y);
+    return e.first_x == x && e.first_y == y;
+}
+
+vertex_cache * vertex_cache_store::find(geometry_type const& geom, params_type const& params)
+{
+    // a feature rarely has more than a handful of geometries,
+    // so a linear scan beats any index here
+    for (auto & e : entries_)
+    {
+        if (matches(e, geom, params))
+        {
+            e.path->reset();
+            return e.path.get();
+        }
+    }
+    return nullptr;
+}
+
+vertex_cache * vertex_cache_store::insert(geometry_type const& geom, params_type const& params, vertex_cache_ptr && path)
+{
+    if (!path) return nullptr;
+    entry e;
+    e.geom = &geom;
+    e.geom_size = geom.size();
+    first_vertex(geom, e.first_x, e.first_y);
+    e.params = params;
+    e.path = std::move(path);
+    entries_.push_back(std::move(e));
+    return entries_.back().path.get();
+}
+
+void vertex_cache_store::clear()
+{
+    entries_.clear();
+    feature_ = nullptr;
+    feature_id_ = 0;
+}
+
+}
@@ -0,0 +1,144 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2014 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/thread_pool.hpp>
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace mapnik
+{
+
+struct thread_pool::job
+{
+    job(std::function<void(std::size_t)> const& f, std::size_t n, unsigned helpers)
+        : func(f), count(n), next(0), slots(helpers), active(0) {}
+
+    std::function<void(std::size_t)> const& func;
+    std::size_t count;
+    std::atomic<std::size_t> next;
+    // the fields below are guarded by thread_pool::mutex_
+    unsigned slots;
+    unsigned active;
+    std::exception_ptr error;
+    std::condition_variable idle;
+};
+
+thread_pool::thread_pool()
+    : stop_(false)
+{
+    unsigned hardware = std::thread::hardware_concurrency();
+    unsigned workers = hardware > 1 ? hardware - 1 : 0;
+    threads_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        threads_.emplace_back([this] { work(); });
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto & thread : threads_) thread.join();
+}
+
+unsigned thread_pool::size() const
+{
+    return static_cast<unsigned>(threads_.size());
+}
+
+void thread_pool::run(job & j)
+{
+    for (;;)
+    {
+        std::size_t i = j.next.fetch_add(1);
+        if (i >= j.count) return;
+        try
+        {
+            j.func(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!j.error) j.error = std::current_exception();
+            j.next.store(j.count);
+        }
+    }
+}
+
+void thread_pool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_) return;
+        job * j = queue_.front();
+        if (--j->slots == 0) queue_.pop_front();
+        ++j->active;
+        lock.unlock();
+        run(*j);
+        lock.lock();
+        // notify while holding the lock: the caller owns the job and
+        // may return as soon as it sees active drop to zero
+        if (--j->active == 0) j->idle.notify_all();
+    }
+}
+
+void thread_pool::parallel_for(std::size_t count, unsigned max_workers,
+                               std::function<void(std::size_t)> const& func)
+{
+    if (count == 0) return;
+    std::size_t helpers = std::min<std::size_t>(threads_.size(), count - 1);
+    if (max_workers > 0) helpers = std::min<std::size_t>(helpers, max_workers - 1);
+    if (helpers == 0)
+    {
+        for (std::size_t i = 0; i < count; ++i) func(i);
+        return;
+    }
+    job j(func, count, static_cast<unsigned>(helpers));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(&j);
+    }
+    if (helpers == 1) wake_.notify_one();
+    else wake_.notify_all();
+    run(j);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (j.slots > 0)
+    {
+        // no index is left, stop idle workers from picking the job up
+        queue_.erase(std::find(queue_.begin(), queue_.end(), &j));
+        j.slots = 0;
+    }
+    j.idle.wait(lock, [&j] { return j.active == 0; });
+    if (j.error) std::rethrow_exception(j.error);
+}
+
+}
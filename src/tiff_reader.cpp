@@ -23,8 +23,14 @@
 // mapnik
 #include <mapnik/debug.hpp>
 #include <mapnik/image_reader.hpp>
-
-// boost
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+#include <mapnik/mapped_memory_cache.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#endif
+
+// stl
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 // iostreams
@@ -97,6 +103,57 @@ static int tiff_map_proc(thandle_t, tdata_t* , toff_t*)
     return 0;
 }
 
+// tiffs already in memory, or mapped into it, are read without a stream
+// and handed to libtiff as a mapping, so that strips and tiles are decoded
+// straight from their pages
+struct tiff_memory
+{
+    char const* data;
+    toff_t size;
+    toff_t pos;
+};
+
+static toff_t tiff_memory_seek_proc(thandle_t fd, toff_t off, int whence)
+{
+    tiff_memory * mem = reinterpret_cast<tiff_memory*>(fd);
+    switch(whence)
+    {
+    case SEEK_SET:
+        mem->pos = off;
+        break;
+    case SEEK_CUR:
+        mem->pos += off;
+        break;
+    case SEEK_END:
+        mem->pos = mem->size + off;
+        break;
+    }
+    return mem->pos;
+}
+
+static toff_t tiff_memory_size_proc(thandle_t fd)
+{
+    return reinterpret_cast<tiff_memory*>(fd)->size;
+}
+
+static tsize_t tiff_memory_read_proc(thandle_t fd, tdata_t buf, tsize_t size)
+{
+    tiff_memory * mem = reinterpret_cast<tiff_memory*>(fd);
+    if (size < 0 || mem->pos >= mem->size) return 0;
+    toff_t count = std::min(static_cast<toff_t>(size), mem->size - mem->pos);
+    std::memcpy(buf, mem->data + mem->pos, count);
+    mem->pos += count;
+    return static_cast<tsize_t>(count);
+}
+
+static int tiff_memory_map_proc(thandle_t fd, tdata_t* base, toff_t* size)
+{
+    tiff_memory * mem = reinterpret_cast<tiff_memory*>(fd);
+    *base = const_cast<char*>(mem->data);
+    *size = mem->size;
+    return 1;
+}
+
 }
 
 template <typename T>
@@ -118,8 +175,13 @@ class tiff_reader : public image_reader
     };
 
 private:
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+    mapped_region_ptr region_;
+#endif
     source_type source_;
     input_stream stream_;
+    // set for sources in memory, see impl::tiff_memory
+    impl::tiff_memory memory_;
     int read_method_;
     std::size_t width_;
     std::size_t height_;
@@ -137,6 +199,9 @@ public:
     };
     explicit tiff_reader(std::string const& file_name);
     tiff_reader(char const* data, std::size_t size);
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+    explicit tiff_reader(mapped_region_ptr const& region);
+#endif
     virtual ~tiff_reader();
     unsigned width() const;
     unsigned height() const;
@@ -158,6 +223,14 @@ namespace
 
 image_reader* create_tiff_reader(std::string const& file)
 {
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+    // map large rasters once, windows read later only touch their pages
+    boost::optional<mapped_region_ptr> region = mapped_memory_cache::instance().find(file, true);
+    if (region)
+    {
+        return new tiff_reader<boost::iostreams::array_source>(*region);
+    }
+#endif
     return new tiff_reader<boost::iostreams::file_source>(file);
 }
 
@@ -175,6 +248,7 @@ template <typename T>
 tiff_reader<T>::tiff_reader(std::string const& file_name)
     : source_(file_name, std::ios_base::in | std::ios_base::binary),
       stream_(source_),
+      memory_{nullptr, 0, 0},
       read_method_(generic),
       width_(0),
       height_(0),
@@ -192,6 +266,7 @@ template <typename T>
 tiff_reader<T>::tiff_reader(char const* data, std::size_t size)
     : source_(data, size),
       stream_(source_),
+      memory_{data, size, 0},
       read_method_(generic),
       width_(0),
       height_(0),
@@ -206,6 +281,27 @@ tiff_reader<T>::tiff_reader(char const* data, std::size_t size)
     init();
 }
 
+#if defined(SHAPE_MEMORY_MAPPED_FILE)
+template <typename T>
+tiff_reader<T>::tiff_reader(mapped_region_ptr const& region)
+    : region_(region),
+      source_(static_cast<char const*>(region->get_address()), region->get_size()),
+      stream_(source_),
+      memory_{static_cast<char const*>(region->get_address()), region->get_size(), 0},
+      read_method_(generic),
+      width_(0),
+      height_(0),
+      rows_per_strip_(0),
+      tile_width_(0),
+      tile_height_(0),
+      premultiplied_alpha_(false),
+      has_alpha_(false)
+{
+    if (!stream_) throw image_reader_exception("TIFF reader: cannot open image stream ");
+    init();
+}
+#endif
+
 template <typename T>
 void tiff_reader<T>::init()
 {
@@ -309,37 +405,28 @@ void tiff_reader<T>::read_tiled(unsigned x0,unsigned y0,image_data_32& image)
     TIFF* tif = open(stream_);
     if (tif)
     {
-        uint32* buf = (uint32*)_TIFFmalloc(tile_width_*tile_height_*sizeof(uint32));
-        int width=image.width();
-        int height=image.height();
-
-        int start_y=(y0/tile_height_)*tile_height_;
-        int end_y=((y0+height)/tile_height_+1)*tile_height_;
-
-        int start_x=(x0/tile_width_)*tile_width_;
-        int end_x=((x0+width)/tile_width_+1)*tile_width_;
-        int row,tx0,tx1,ty0,ty1;
-
-        for (int y=start_y;y<end_y;y+=tile_height_)
+        // decode only the tiles intersecting the window
+        unsigned x1 = std::min(x0 + image.width(), static_cast<unsigned>(width_));
+        unsigned y1 = std::min(y0 + image.height(), static_cast<unsigned>(height_));
+        unsigned tile_width = tile_width_;
+        unsigned tile_height = tile_height_;
+        uint32* buf = (uint32*)_TIFFmalloc(tile_width*tile_height*sizeof(uint32));
+
+        for (unsigned y = (y0 / tile_height) * tile_height; y < y1; y += tile_height)
         {
-            ty0 = std::max(y0,(unsigned)y) - y;
-            ty1 = std::min(height+y0,(unsigned)(y+tile_height_)) - y;
-
-            int n0=tile_height_-ty1;
-            int n1=tile_height_-ty0-1;
-
-            for (int x=start_x;x<end_x;x+=tile_width_)
+            unsigned ty0 = std::max(y0, y) - y;
+            unsigned ty1 = std::min(y1, y + tile_height) - y;
+            for (unsigned x = (x0 / tile_width) * tile_width; x < x1; x += tile_width)
             {
-
                 if (!TIFFReadRGBATile(tif,x,y,buf)) break;
 
-                tx0=std::max(x0,(unsigned)x);
-                tx1=std::min(width+x0,(unsigned)(x+tile_width_));
-                row=y+ty0-y0;
-                for (int n=n1;n>=n0;--n)
+                unsigned tx0 = std::max(x0, x);
+                unsigned tx1 = std::min(x1, x + tile_width);
+                // rgba tiles are bottom up, also partial ones at the edges
+                for (unsigned n = ty0; n < ty1; ++n)
                 {
-                    image.setRow(row,tx0-x0,tx1-x0,(const unsigned*)&buf[n*tile_width_+tx0-x]);
-                    ++row;
+                    image.setRow(y + n - y0, tx0 - x0, tx1 - x0,
+                                 (const unsigned*)&buf[(tile_height - n - 1) * tile_width + tx0 - x]);
                 }
             }
         }
@@ -353,34 +440,23 @@ void tiff_reader<T>::read_stripped(unsigned x0,unsigned y0,image_data_32& image)
     TIFF* tif = open(stream_);
     if (tif)
     {
-        uint32* buf = (uint32*)_TIFFmalloc(width_*rows_per_strip_*sizeof(uint32));
-
-        int width=image.width();
-        int height=image.height();
-
-        unsigned start_y=(y0/rows_per_strip_)*rows_per_strip_;
-        unsigned end_y=((y0+height)/rows_per_strip_+1)*rows_per_strip_;
-        bool laststrip=((unsigned)end_y > height_)?true:false;
-        int row,tx0,tx1,ty0,ty1;
-
-        tx0=x0;
-        tx1=std::min(width+x0,(unsigned)width_);
+        unsigned x1 = std::min(x0 + image.width(), static_cast<unsigned>(width_));
+        unsigned y1 = std::min(y0 + image.height(), static_cast<unsigned>(height_));
+        if (x0 >= x1) return;
+        unsigned rows_per_strip = rows_per_strip_;
+        uint32* buf = (uint32*)_TIFFmalloc(width_*rows_per_strip*sizeof(uint32));
 
-        for (unsigned y=start_y; y < end_y; y+=rows_per_strip_)
+        for (unsigned y = (y0 / rows_per_strip) * rows_per_strip; y < y1; y += rows_per_strip)
         {
-            ty0 = std::max(y0,y)-y;
-            ty1 = std::min(height+y0,y+rows_per_strip_)-y;
-
             if (!TIFFReadRGBAStrip(tif,y,buf)) break;
 
-            row=y+ty0-y0;
-
-            int n0=laststrip ? 0:(rows_per_strip_-ty1);
-            int n1=laststrip ? (ty1-ty0-1):(rows_per_strip_-ty0-1);
-            for (int n=n1;n>=n0;--n)
+            // rgba strips are bottom up, the last one may hold fewer rows
+            unsigned rows = std::min(rows_per_strip, static_cast<unsigned>(height_) - y);
+            unsigned ty0 = std::max(y0, y) - y;
+            unsigned ty1 = std::min(y1, y + rows_per_strip) - y;
+            for (unsigned n = ty0; n < ty1; ++n)
             {
-                image.setRow(row,tx0-x0,tx1-x0,(const unsigned*)&buf[n*width_+tx0]);
-                ++row;
+                image.setRow(y + n - y0, 0, x1 - x0, (const unsigned*)&buf[(rows - n - 1) * width_ + x0]);
             }
         }
         _TIFFfree(buf);
@@ -390,7 +466,20 @@ void tiff_reader<T>::read_stripped(unsigned x0,unsigned y0,image_data_32& image)
 template <typename T>
 TIFF* tiff_reader<T>::open(std::istream & input)
 {
-    if (!tif_)
+    if (!tif_ && memory_.data)
+    {
+        memory_.pos = 0;
+        tif_ = tiff_ptr(TIFFClientOpen("tiff_input_memory", "r",
+                                       reinterpret_cast<thandle_t>(&memory_),
+                                       impl::tiff_memory_read_proc,
+                                       impl::tiff_write_proc,
+                                       impl::tiff_memory_seek_proc,
+                                       impl::tiff_close_proc,
+                                       impl::tiff_memory_size_proc,
+                                       impl::tiff_memory_map_proc,
+                                       impl::tiff_unmap_proc), tiff_closer());
+    }
+    else if (!tif_)
     {
         tif_ = tiff_ptr(TIFFClientOpen("tiff_input_stream", "rm",
                                        reinterpret_cast<thandle_t>(&input),
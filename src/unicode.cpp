@@ -23,28 +23,118 @@
 // mapnik
 #include <mapnik/unicode.hpp>
 #include <mapnik/value_types.hpp>
+#include <mapnik/value.hpp>
 
 // stl
 #include <cstdlib>
+#include <cstring>
 #include <string>
 
 // icu
 #include <unicode/ucnv.h>
+#include <unicode/unistr.h>
+#include <unicode/ustring.h>
+#include <unicode/utf8.h>
 
 namespace mapnik {
 
+namespace {
+
+inline bool is_ascii(const char* data, std::int32_t length)
+{
+    unsigned char const* itr = reinterpret_cast<unsigned char const*>(data);
+    unsigned char const* end = itr + length;
+    for (; itr != end; ++itr)
+    {
+        if (*itr & 0x80) return false;
+    }
+    return true;
+}
+
+inline bool is_utf8(const char* data, std::int32_t length)
+{
+    std::int32_t i = 0;
+    while (i < length)
+    {
+        UChar32 c;
+        U8_NEXT(data, i, length, c);
+        if (c < 0) return false;
+    }
+    return true;
+}
+
+// ICU names most single and multi byte charsets after their ibm tables,
+// so rather than matching names decode 0x00-0x7f and check each byte
+// comes back as itself. stateful encodings (iso-2022, utf-7) fail on
+// the escape or shift bytes and utf-16/32 on the length
+bool maps_ascii_to_itself(UConverter * conv)
+{
+    char bytes[0x80];
+    for (int i = 0; i < 0x80; ++i) bytes[i] = static_cast<char>(i);
+    UChar chars[0x80];
+    UErrorCode err = U_ZERO_ERROR;
+    std::int32_t length = ucnv_toUChars(conv, chars, 0x80, bytes, 0x80, &err);
+    ucnv_reset(conv);
+    if (U_FAILURE(err) || length != 0x80) return false;
+    for (int i = 0; i < 0x80; ++i)
+    {
+        if (chars[i] != static_cast<UChar>(i)) return false;
+    }
+    return true;
+}
+
+}
+
 transcoder::transcoder (std::string const& encoding)
     : ok_(false),
+      ascii_compatible_(false),
+      utf8_(false),
       conv_(0)
 {
     UErrorCode err = U_ZERO_ERROR;
     conv_ = ucnv_open(encoding.c_str(),&err);
-    if (U_SUCCESS(err)) ok_ = true;
+    if (U_SUCCESS(err))
+    {
+        ok_ = true;
+        utf8_ = ucnv_getType(conv_) == UCNV_UTF8;
+        ascii_compatible_ = utf8_ || maps_ascii_to_itself(conv_);
+    }
     // TODO ??
 }
 
 mapnik::value_unicode_string transcoder::transcode(const char* data, std::int32_t length) const
 {
+    if (length < 0 && data) length = static_cast<std::int32_t>(std::strlen(data));
+    if (ascii_compatible_ && data && is_ascii(data, length))
+    {
+        // widen bytes directly, skipping the converter callbacks
+        mapnik::value_unicode_string ustr;
+        UChar * buf = ustr.getBuffer(length);
+        if (buf)
+        {
+            for (std::int32_t i = 0; i < length; ++i)
+            {
+                buf[i] = static_cast<UChar>(data[i]);
+            }
+            ustr.releaseBuffer(length);
+            return ustr;
+        }
+    }
+    else if (utf8_ && data)
+    {
+        // decode valid utf-8 directly; anything malformed is left to the
+        // converter below so it is substituted exactly as before
+        mapnik::value_unicode_string ustr;
+        UChar * buf = ustr.getBuffer(length);
+        if (buf)
+        {
+            UErrorCode err = U_ZERO_ERROR;
+            std::int32_t ulength = 0;
+            u_strFromUTF8(buf, length, &ulength, data, length, &err);
+            ustr.releaseBuffer(U_SUCCESS(err) ? ulength : 0);
+            if (U_SUCCESS(err)) return ustr;
+        }
+    }
     UErrorCode err = U_ZERO_ERROR;
 
     mapnik::value_unicode_string ustr(data,length,conv_,err);
@@ -55,6 +145,37 @@ mapnik::value_unicode_string transcoder::transcode(const char* data, std::int32_
     return ustr;
 }
 
+mapnik::value_utf8_string transcoder::transcode_utf8(const char* data, std::int32_t length) const
+{
+    if (!data) return mapnik::value_utf8_string();
+    if (length < 0) length = static_cast<std::int32_t>(std::strlen(data));
+    if ((ascii_compatible_ && is_ascii(data, length)) || (utf8_ && is_utf8(data, length)))
+    {
+        return mapnik::value_utf8_string(data, static_cast<std::size_t>(length));
+    }
+    if (!conv_)
+    {
+        mapnik::value_utf8_string utf8;
+        to_utf8(transcode(data, length), utf8);
+        return utf8;
+    }
+    // one pass from the source charset to utf-8, with the same substitution
+    // for malformed input as transcode
+    mapnik::value_utf8_string utf8(static_cast<std::size_t>(length) * 3, '\0');
+    UErrorCode err = U_ZERO_ERROR;
+    std::int32_t size = ucnv_toAlgorithmic(UCNV_UTF8, conv_, &utf8[0], static_cast<std::int32_t>(utf8.size()),
+                                           data, length, &err);
+    if (err == U_BUFFER_OVERFLOW_ERROR)
+    {
+        utf8.resize(static_cast<std::size_t>(size));
+        err = U_ZERO_ERROR;
+        size = ucnv_toAlgorithmic(UCNV_UTF8, conv_, &utf8[0], size, data, length, &err);
+    }
+    if (U_FAILURE(err)) return mapnik::value_utf8_string();
+    utf8.resize(static_cast<std::size_t>(size));
+    return utf8;
+}
+
 transcoder::~transcoder()
 {
     if (conv_) ucnv_close(conv_);
@@ -29,6 +29,7 @@
 #include <mapnik/view_transform.hpp>
 #include <mapnik/raster.hpp>
 #include <mapnik/proj_transform.hpp>
+#include <mapnik/image_resample.hpp>
 
 // agg
 #include "agg_image_filters.h"
@@ -45,8 +46,131 @@
 #include "agg_image_accessors.h"
 #include "agg_renderer_scanline.h"
 
+// stl
+#include <cmath>
+#include <vector>
+
 namespace mapnik {
 
+namespace {
+
+// Target to source transform of mesh cell i, j, null when agg rejects it.
+bool cell_transform(agg::trans_affine & tr, double * polygon,
+                    ImageData<double> const& xs, ImageData<double> const& ys,
+                    view_transform const& tt, unsigned i, unsigned j,
+                    unsigned mesh_size, unsigned width, unsigned height)
+{
+    polygon[0] = xs(i,j); polygon[1] = ys(i,j);
+    polygon[2] = xs(i+1,j); polygon[3] = ys(i+1,j);
+    polygon[4] = xs(i+1,j+1); polygon[5] = ys(i+1,j+1);
+    polygon[6] = xs(i,j+1); polygon[7] = ys(i,j+1);
+    tt.forward(polygon+0, polygon+1);
+    tt.forward(polygon+2, polygon+3);
+    tt.forward(polygon+4, polygon+5);
+    tt.forward(polygon+6, polygon+7);
+    unsigned x0 = i * mesh_size;
+    unsigned y0 = j * mesh_size;
+    unsigned x1 = std::min((i+1) * mesh_size, width);
+    unsigned y1 = std::min((j+1) * mesh_size, height);
+    tr.parl_to_rect(polygon, x0, y0, x1, y1);
+    return tr.is_valid();
+}
+
+// When every mesh column lands on the same target columns and every mesh
+// row on the same target rows, as between lon/lat and mercator, the whole
+// reprojection is a separable resampling: each target column reads one
+// source position, and so does each target row. Returns false, leaving
+// target alone, for any other mesh.
+bool reproject_separable(raster & target, raster const& source,
+                         ImageData<double> const& xs, ImageData<double> const& ys,
+                         view_transform const& tt, unsigned mesh_size,
+                         agg::image_filter_lut const* filter)
+{
+    unsigned mesh_nx = xs.width();
+    unsigned mesh_ny = xs.height();
+    int width = static_cast<int>(target.data_.width());
+    int height = static_cast<int>(target.data_.height());
+    // tolerance on target positions, in pixels
+    double const eps = 1e-3;
+    std::vector<double> col_x(mesh_nx);
+    std::vector<double> row_y(mesh_ny);
+    for (unsigned i = 0; i < mesh_nx; ++i)
+    {
+        for (unsigned j = 0; j < mesh_ny; ++j)
+        {
+            double x = xs(i,j);
+            double y = ys(i,j);
+            tt.forward(&x, &y);
+            if (j == 0) col_x[i] = x;
+            if (i == 0) row_y[j] = y;
+            if (std::fabs(x - col_x[i]) > eps || std::fabs(y - row_y[j]) > eps) return false;
+        }
+    }
+    // cells cover [floor(left), floor(right)) like the rasterizer fills them
+    for (unsigned i = 0; i + 1 < mesh_nx; ++i)
+    {
+        if (std::floor(col_x[i + 1]) < std::floor(col_x[i])) return false;
+    }
+    for (unsigned j = 0; j + 1 < mesh_ny; ++j)
+    {
+        if (std::floor(row_y[j + 1]) < std::floor(row_y[j])) return false;
+    }
+    int x_begin = std::max(static_cast<int>(std::floor(col_x.front())), 0);
+    int x_end = std::min(static_cast<int>(std::floor(col_x.back())), width);
+    int y_begin = std::max(static_cast<int>(std::floor(row_y.front())), 0);
+    int y_end = std::min(static_cast<int>(std::floor(row_y.back())), height);
+    if (x_end <= x_begin || y_end <= y_begin) return true;
+
+    unsigned src_width = source.data_.width();
+    unsigned src_height = source.data_.height();
+    double polygon[8];
+    agg::trans_affine tr;
+    std::vector<resample::axis_sample> x_samples;
+    std::vector<resample::axis_sample> y_samples;
+    for (unsigned i = 0; i + 1 < mesh_nx; ++i)
+    {
+        int begin = std::max(static_cast<int>(std::floor(col_x[i])), x_begin);
+        int end = std::min(static_cast<int>(std::floor(col_x[i + 1])), x_end);
+        if (end <= begin) continue;
+        if (!cell_transform(tr, polygon, xs, ys, tt, i, 0, mesh_size, src_width, src_height)) return false;
+        if (std::fabs(tr.shx) * height > eps || std::fabs(tr.shy) * width > eps) return false;
+        int rx, rx_inv, ry, ry_inv;
+        resample::filter_scale(tr, rx, rx_inv, ry, ry_inv);
+        for (int x = begin; x < end; ++x)
+        {
+            double px = x + 0.5;
+            double py = row_y[0];
+            tr.transform(&px, &py);
+            x_samples.push_back(resample::axis_sample { agg::iround(px * agg::image_subpixel_scale), rx, rx_inv });
+        }
+    }
+    for (unsigned j = 0; j + 1 < mesh_ny; ++j)
+    {
+        int begin = std::max(static_cast<int>(std::floor(row_y[j])), y_begin);
+        int end = std::min(static_cast<int>(std::floor(row_y[j + 1])), y_end);
+        if (end <= begin) continue;
+        if (!cell_transform(tr, polygon, xs, ys, tt, 0, j, mesh_size, src_width, src_height)) return false;
+        if (std::fabs(tr.shx) * height > eps || std::fabs(tr.shy) * width > eps) return false;
+        int rx, rx_inv, ry, ry_inv;
+        resample::filter_scale(tr, rx, rx_inv, ry, ry_inv);
+        for (int y = begin; y < end; ++y)
+        {
+            double px = col_x[0];
+            double py = y + 0.5;
+            tr.transform(&px, &py);
+            y_samples.push_back(resample::axis_sample { agg::iround(py * agg::image_subpixel_scale), ry, ry_inv });
+        }
+    }
+    resample::axis_weights xw;
+    resample::make_weights(xw, x_samples, src_width, filter);
+    resample::axis_weights yw;
+    resample::make_weights(yw, y_samples, src_height, filter);
+    resample::resample(target.data_, x_begin, y_begin, source.data_, xw, yw);
+    return true;
+}
+
+}
+
 void reproject_and_scale_raster(raster & target, raster const& source,
                                 proj_transform const& prj_trans,
                                 double offset_x, double offset_y,
@@ -142,19 +266,21 @@ void reproject_and_scale_raster(raster & target, raster const& source,
         filter.calculate(agg::image_filter_blackman(source.get_filter_factor()), true); break;
     }
 
+    if (reproject_separable(target, source, xs, ys, tt, mesh_size,
+                            scaling_method == SCALING_NEAR ? nullptr : &filter))
+    {
+        return;
+    }
+
     // Project mesh cells into target interpolating raster inside each one
     for(unsigned j=0; j<mesh_ny-1; ++j)
     {
         for (unsigned i=0; i<mesh_nx-1; ++i)
         {
-            double polygon[8] = {xs(i,j), ys(i,j),
-                                 xs(i+1,j), ys(i+1,j),
-                                 xs(i+1,j+1), ys(i+1,j+1),
-                                 xs(i,j+1), ys(i,j+1)};
-            tt.forward(polygon+0, polygon+1);
-            tt.forward(polygon+2, polygon+3);
-            tt.forward(polygon+4, polygon+5);
-            tt.forward(polygon+6, polygon+7);
+            double polygon[8];
+            agg::trans_affine tr;
+            bool valid = cell_transform(tr, polygon, xs, ys, tt, i, j, mesh_size,
+                                        source.data_.width(), source.data_.height());
 
             rasterizer.reset();
             rasterizer.move_to_d(std::floor(polygon[0]), std::floor(polygon[1]));
@@ -162,14 +288,7 @@ void reproject_and_scale_raster(raster & target, raster const& source,
             rasterizer.line_to_d(std::floor(polygon[4]), std::floor(polygon[5]));
             rasterizer.line_to_d(std::floor(polygon[6]), std::floor(polygon[7]));
 
-            unsigned x0 = i * mesh_size;
-            unsigned y0 = j * mesh_size;
-            unsigned x1 = (i+1) * mesh_size;
-            unsigned y1 = (j+1) * mesh_size;
-            x1 = std::min(x1, source.data_.width());
-            y1 = std::min(y1, source.data_.height());
-            agg::trans_affine tr(polygon, x0, y0, x1, y1);
-            if (tr.is_valid())
+            if (valid)
             {
                 using interpolator_type = agg::span_interpolator_linear<agg::trans_affine>;
                 interpolator_type interpolator(tr);
@@ -40,6 +40,7 @@ extern "C"
 #include <boost/iostreams/stream.hpp>
 // stl
 #include <fstream>
+#include <algorithm>
 
 namespace mapnik
 {
@@ -111,6 +112,9 @@ private:
     size_t size_;
     unsigned width_;
     unsigned height_;
+    unsigned native_width_;
+    unsigned native_height_;
+    unsigned reduction_;
     bool has_alpha_;
 public:
     explicit webp_reader(char const* data, std::size_t size);
@@ -121,6 +125,7 @@ public:
     inline bool has_alpha() const { return has_alpha_; }
     bool premultiplied_alpha() const { return false; }
     void read(unsigned x,unsigned y,image_data_32& image);
+    unsigned set_reduction(unsigned factor);
 private:
     void init();
 };
@@ -149,6 +154,9 @@ webp_reader<T>::webp_reader(char const* data, std::size_t size)
     : buffer_(new buffer_policy_type(reinterpret_cast<uint8_t const*>(data), size)),
       width_(0),
       height_(0),
+      native_width_(0),
+      native_height_(0),
+      reduction_(1),
       has_alpha_(false)
 {
     init();
@@ -160,6 +168,9 @@ webp_reader<T>::webp_reader(std::string const& filename)
       size_(0),
       width_(0),
       height_(0),
+      native_width_(0),
+      native_height_(0),
+      reduction_(1),
       has_alpha_(false)
 {
     std::ifstream file(filename.c_str(), std::ios::binary);
@@ -202,8 +213,8 @@ void webp_reader<T>::init()
         throw image_reader_exception("WEBP reader: WebPInitDecoderConfig failed");
     }
     if (WebPGetFeatures(buffer_->data(), buffer_->size(), &config.input) == VP8_STATUS_OK) {
-        width_ = config.input.width;
-        height_ = config.input.height;
+        width_ = native_width_ = config.input.width;
+        height_ = native_height_ = config.input.height;
         has_alpha_ = config.input.has_alpha;
     }
     else
@@ -224,6 +235,17 @@ unsigned webp_reader<T>::height() const
     return height_;
 }
 
+template <typename T>
+unsigned webp_reader<T>::set_reduction(unsigned factor)
+{
+    // the cropped area is still decoded at full size, but scaled down
+    // row by row instead of being handed out as a full size image
+    reduction_ = std::max(factor, 1u);
+    width_ = (native_width_ + reduction_ - 1) / reduction_;
+    height_ = (native_height_ + reduction_ - 1) / reduction_;
+    return reduction_;
+}
+
 template <typename T>
 void webp_reader<T>::read(unsigned x0, unsigned y0,image_data_32& image)
 {
@@ -235,10 +257,16 @@ void webp_reader<T>::read(unsigned x0, unsigned y0,image_data_32& image)
     }
 
     config.options.use_cropping = 1;
-    config.options.crop_left = x0;
-    config.options.crop_top = y0;
-    config.options.crop_width = std::min(width_ - x0, image.width());
-    config.options.crop_height = std::min(height_ - y0, image.height());
+    config.options.crop_left = x0 * reduction_;
+    config.options.crop_top = y0 * reduction_;
+    config.options.crop_width = std::min(native_width_ - x0 * reduction_, image.width() * reduction_);
+    config.options.crop_height = std::min(native_height_ - y0 * reduction_, image.height() * reduction_);
+    if (reduction_ > 1)
+    {
+        config.options.use_scaling = 1;
+        config.options.scaled_width = (config.options.crop_width + reduction_ - 1) / reduction_;
+        config.options.scaled_height = (config.options.crop_height + reduction_ - 1) / reduction_;
+    }
 
     if (WebPGetFeatures(buffer_->data(), buffer_->size(), &config.input) != VP8_STATUS_OK)
     {
@@ -29,6 +29,7 @@
 #include <mapnik/color_factory.hpp>
 #include <mapnik/rule.hpp>
 #include <mapnik/feature_type_style.hpp>
+#include <mapnik/map.hpp>
 #include <mapnik/text/text_properties.hpp>
 #include <mapnik/config_error.hpp>
 #include <mapnik/raster_colorizer.hpp>
@@ -427,6 +428,7 @@ compile_get_opt_attr(expression_ptr);
 compile_get_opt_attr(font_feature_settings_ptr);
 compile_get_attr(std::string);
 compile_get_attr(filter_mode_e);
+compile_get_attr(collision_detector_e);
 compile_get_attr(point_placement_e);
 compile_get_attr(debug_symbolizer_mode_e);
 compile_get_attr(marker_placement_e);
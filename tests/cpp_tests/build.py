@@ -41,6 +41,21 @@ else:
             test_env_local = test_env.Clone()
             if 'csv_parse' in cpp_test:
                 source_files += glob.glob('../../plugins/input/csv/' + '*.cpp')
+            if 'gdal_plugin' in cpp_test:
+                if 'gdal' not in env['REQUESTED_PLUGINS'] or 'gdal' in env['SKIPPED_DEPS']:
+                    continue
+                source_files += glob.glob('../../plugins/input/gdal/' + '*.cpp')
+                test_env_local.AppendUnique(LIBS=env['PLUGINS']['gdal']['lib'])
+            if 'shape_dbf' in cpp_test:
+                source_files += ['../../plugins/input/shape/dbfile.cpp']
+                # once more reading through a stream instead of a memory mapping
+                unmapped_env = test_env_local.Clone()
+                unmapped_env['CPPDEFINES'] = [d for d in unmapped_env['CPPDEFINES'] if 'SHAPE_MEMORY_MAPPED_FILE' not in str(d)]
+                unmapped_objects = [unmapped_env.Object(os.path.basename(s).replace('.cpp','-unmapped'), s) for s in source_files]
+                unmapped_program = unmapped_env.Program(name.replace('-bin','-unmapped-bin'), source=unmapped_objects)
+                Depends(unmapped_program, env.subst('../../src/%s' % env['MAPNIK_LIB_NAME']))
+                if 'install' in COMMAND_LINE_TARGETS:
+                    env.Alias('install',unmapped_program)
             test_program = test_env_local.Program(name, source=source_files)
             Depends(test_program, env.subst('../../src/%s' % env['MAPNIK_LIB_NAME']))
         # build locally if installing
@@ -0,0 +1,169 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/load_map.hpp>
+#include <mapnik/save_map.hpp>
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/label_collision_detector.hpp>
+#include <mapnik/feature_style_processor.hpp>
+#include <mapnik/feature_style_processor_impl.hpp>
+#include <mapnik/make_unique.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+// places a point label per feature unless it collides with one placed
+// before, and records the order labels come in
+struct label_recorder : public mapnik::feature_style_processor<label_recorder>
+{
+    using processor_impl_type = label_recorder;
+
+    explicit label_recorder(mapnik::Map const& m)
+        : mapnik::feature_style_processor<label_recorder>(m),
+          detector_(mapnik::box2d<double>(-180, -90, 180, 90)),
+          painted_(false) {}
+
+    void start_map_processing(mapnik::Map const&) {}
+    void end_map_processing(mapnik::Map const&) {}
+    void start_layer_processing(mapnik::layer const& lay, mapnik::box2d<double> const&)
+    {
+        if (lay.clear_label_cache()) detector_.clear();
+    }
+    void end_layer_processing(mapnik::layer const&) {}
+    void start_style_processing(mapnik::feature_type_style const&) {}
+    void end_style_processing(mapnik::feature_type_style const&) {}
+
+    bool process(mapnik::rule::symbolizers const&, mapnik::feature_impl &, mapnik::proj_transform const&)
+    {
+        return false;
+    }
+
+    void process(mapnik::point_symbolizer const&, mapnik::feature_impl & feature, mapnik::proj_transform const&)
+    {
+        order.push_back(feature.id());
+        double x = 0;
+        double y = 0;
+        feature.get_geometry(0).vertex(0, &x, &y);
+        mapnik::box2d<double> box(x - 1, y - 1, x + 1, y + 1);
+        if (detector_.has_placement(box))
+        {
+            detector_.insert(box);
+            placed.push_back(feature.id());
+        }
+    }
+
+    void painted(bool painted) { painted_ = painted; }
+    bool painted() { return painted_; }
+    mapnik::eAttributeCollectionPolicy attribute_collection_policy() const { return mapnik::DEFAULT; }
+    double scale_factor() const { return 1.0; }
+    mapnik::attributes const& variables() const { return vars_; }
+
+    std::vector<mapnik::value_integer> order;
+    std::vector<mapnik::value_integer> placed;
+
+private:
+    mapnik::label_collision_detector4 detector_;
+    mapnik::attributes vars_;
+    bool painted_;
+};
+
+// features with a rank, at x,y
+std::shared_ptr<mapnik::memory_datasource> points(std::vector<std::vector<int> > const& rows)
+{
+    mapnik::parameters params;
+    params["type"] = "memory";
+    auto ds = std::make_shared<mapnik::memory_datasource>(params);
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("rank");
+    for (auto const& row : rows)
+    {
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, row[0]));
+        feature->put("rank", mapnik::value_integer(row[1]));
+        auto pt = std::make_unique<mapnik::geometry_type>(mapnik::geometry_type::types::Point);
+        pt->move_to(row[2], row[3]);
+        feature->add_geometry(pt.release());
+        ds->push(feature);
+    }
+    return ds;
+}
+
+void render(mapnik::Map & m, std::vector<mapnik::value_integer> & order,
+            std::vector<mapnik::value_integer> & placed)
+{
+    // id, rank, x, y
+    m.get_layer(0).set_datasource(points({ { 1, 1, 0, 0 }, { 2, 5, 0, 0 }, { 3, 3, 0, 0 },
+                                           { 4, 5, 5, 5 }, { 5, 2, 0, 0 } }));
+    m.get_layer(1).set_datasource(points({ { 11, 0, 0, 0 }, { 12, 9, 0, 0 } }));
+    m.zoom_to_box(mapnik::box2d<double>(-10, -10, 10, 10));
+    label_recorder recorder(m);
+    recorder.apply();
+    order = recorder.order;
+    placed = recorder.placed;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        std::string xml = "<Map deferred-labels=\"true\">"
+                          "<Style name=\"labels\"><Rule><PointSymbolizer label-priority=\"[rank]\"/></Rule></Style>"
+                          "<Layer name=\"first\"><StyleName>labels</StyleName></Layer>"
+                          "<Layer name=\"second\" clear-label-cache=\"true\"><StyleName>labels</StyleName></Layer>"
+                          "</Map>";
+
+        // the map attribute and the symbolizer property survive a save and reload
+        mapnik::Map loaded(256, 256);
+        mapnik::load_map_string(loaded, xml, true);
+        BOOST_TEST( loaded.deferred_labels() );
+        std::string saved = mapnik::save_map_to_string(loaded);
+        BOOST_TEST( saved.find("deferred-labels=\"true\"") != std::string::npos );
+        BOOST_TEST( saved.find("label-priority=\"[rank]\"") != std::string::npos );
+        mapnik::Map m(256, 256);
+        mapnik::load_map_string(m, saved, true);
+        BOOST_TEST( m.deferred_labels() );
+        BOOST_TEST_EQ( mapnik::save_map_to_string(m), saved );
+        mapnik::Map greedy(m);
+        greedy.set_deferred_labels(false);
+        BOOST_TEST( mapnik::save_map_to_string(greedy).find("deferred-labels") == std::string::npos );
+
+        // labels come by descending priority, equal priorities in feature order,
+        // and the first label at a spot wins it; clear-label-cache flushes the
+        // labels queued before the layer
+        std::vector<mapnik::value_integer> order;
+        std::vector<mapnik::value_integer> placed;
+        render(m, order, placed);
+        BOOST_TEST( order == std::vector<mapnik::value_integer>({ 2, 4, 3, 5, 1, 12, 11 }) );
+        BOOST_TEST( placed == std::vector<mapnik::value_integer>({ 2, 4, 12 }) );
+
+        // without deferred labels, feature order decides
+        render(greedy, order, placed);
+        BOOST_TEST( order == std::vector<mapnik::value_integer>({ 1, 2, 3, 4, 5, 11, 12 }) );
+        BOOST_TEST( placed == std::vector<mapnik::value_integer>({ 1, 4, 11 }) );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ deferred labels: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
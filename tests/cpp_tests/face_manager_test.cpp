@@ -0,0 +1,78 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/text/face.hpp>
+#include <mapnik/util/file_io.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "utils.hpp"
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+        std::string file("./fonts/dejavu-fonts-ttf-2.33/ttf/DejaVuSans.ttf");
+        mapnik::font_library library;
+        mapnik::freetype_engine::font_file_mapping_type mapping;
+        mapping.emplace("Test Face", std::make_pair(0, file));
+        mapnik::freetype_engine::font_memory_cache_type no_memory;
+        mapnik::face_manager_freetype manager(library, mapping, no_memory);
+
+        // faces of fonts outside the map's memory belong to the calling thread:
+        // a renderer moved to another thread gets that thread's face, which its
+        // other renderers share
+        mapnik::face_ptr face = manager.get_face("Test Face");
+        BOOST_TEST( face && manager.get_face("Test Face") == face );
+        mapnik::face_ptr moved;
+        mapnik::face_ptr moved_again;
+        mapnik::face_ptr other;
+        std::thread thread([&]() {
+            mapnik::font_library other_library;
+            mapnik::face_manager_freetype other_manager(other_library, mapping, no_memory);
+            moved = manager.get_face("Test Face");
+            moved_again = manager.get_face("Test Face");
+            other = other_manager.get_face("Test Face");
+        });
+        thread.join();
+        BOOST_TEST( moved && moved != face && moved->get_face() != face->get_face() );
+        BOOST_TEST( moved_again == moved && other == moved );
+        BOOST_TEST( manager.get_face("Test Face") == face );
+        BOOST_TEST( moved->id() == face->id() );
+
+        // faces of the map's font memory belong to the renderer
+        mapnik::util::file font_file(file);
+        BOOST_TEST( font_file.open() );
+        mapnik::freetype_engine::font_memory_cache_type memory;
+        memory.emplace(file, std::make_pair(std::move(font_file.data()), font_file.size()));
+        mapnik::face_manager_freetype map_manager(library, mapping, memory);
+        mapnik::face_ptr map_face = map_manager.get_face("Test Face");
+        BOOST_TEST( map_face && map_face != face );
+        std::thread([&]() { moved = map_manager.get_face("Test Face"); }).join();
+        BOOST_TEST( moved == map_face );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ face manager: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,198 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/load_map.hpp>
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/feature_type_style.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/expression.hpp>
+#include <mapnik/expression_evaluator.hpp>
+#include <mapnik/filter_batch.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/feature_style_processor.hpp>
+#include <mapnik/feature_style_processor_impl.hpp>
+#include <mapnik/make_unique.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+// records which rule (told apart by opacity) symbolized which feature
+struct rule_recorder : public mapnik::feature_style_processor<rule_recorder>
+{
+    using processor_impl_type = rule_recorder;
+
+    explicit rule_recorder(mapnik::Map const& m)
+        : mapnik::feature_style_processor<rule_recorder>(m),
+          painted_(false) {}
+
+    void start_map_processing(mapnik::Map const&) {}
+    void end_map_processing(mapnik::Map const&) {}
+    void start_layer_processing(mapnik::layer const&, mapnik::box2d<double> const&) {}
+    void end_layer_processing(mapnik::layer const&) {}
+    void start_style_processing(mapnik::feature_type_style const&) {}
+    void end_style_processing(mapnik::feature_type_style const&) {}
+
+    bool process(mapnik::rule::symbolizers const&, mapnik::feature_impl &, mapnik::proj_transform const&)
+    {
+        return false;
+    }
+
+    void process(mapnik::point_symbolizer const& sym, mapnik::feature_impl & feature, mapnik::proj_transform const&)
+    {
+        calls.emplace_back(feature.id(), mapnik::get<mapnik::value_double>(sym, mapnik::keys::opacity, 1.0));
+    }
+
+    void painted(bool painted) { painted_ = painted; }
+    bool painted() { return painted_; }
+    mapnik::eAttributeCollectionPolicy attribute_collection_policy() const { return mapnik::DEFAULT; }
+    double scale_factor() const { return 1.0; }
+    mapnik::attributes const& variables() const { return vars_; }
+
+    std::vector<std::pair<mapnik::value_integer, double> > calls;
+
+private:
+    mapnik::attributes vars_;
+    bool painted_;
+};
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // integers, doubles, nulls, utf-16 and utf-8 strings, booleans and
+        // integers beyond the range doubles hold exactly
+        mapnik::transcoder tr("utf-8");
+        mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+        ctx->push("v");
+        ctx->push("s");
+        std::vector<mapnik::value> values = { mapnik::value_integer(1), mapnik::value_integer(3), mapnik::value_double(2.5),
+                                              mapnik::value_double(3.0), mapnik::value_null(), tr.transcode("3"),
+                                              mapnik::value_integer(-4), mapnik::value_double(3.5), mapnik::value_bool(true),
+                                              mapnik::value_integer(9007199254740993LL), tr.transcode_utf8("x"),
+                                              mapnik::value_integer(2) };
+        std::vector<mapnik::feature_ptr> features;
+        mapnik::parameters params;
+        params["type"] = "memory";
+        auto ds = std::make_shared<mapnik::memory_datasource>(params);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, i + 1));
+            if (!values[i].is_null()) feature->put("v", values[i]);
+            if (i % 3) feature->put("s", tr.transcode_utf8("x"));
+            else feature->put("s", tr.transcode("y"));
+            auto pt = std::make_unique<mapnik::geometry_type>(mapnik::geometry_type::types::Point);
+            pt->move_to(0, 0);
+            feature->add_geometry(pt.release());
+            features.push_back(feature);
+            ds->push(feature);
+        }
+
+        // batched filters select what the evaluator selects, for every chunking
+        std::vector<std::string> filters = { "[v] > 2", "[v] >= 3", "[v] < 2.5", "[v] <= 3", "[v] = 3", "[v] != 3",
+                                             "[v] = 3.5", "2 < [v]", "3 = [v]", "-4 >= [v]", "[v] > 9007199254740992",
+                                             "[v] = 9007199254740993", "[v] = 9007199254740992", "[v] = 1",
+                                             "[s] = 'x'", "[v] > 1 and [v] < 4", "not [v] > 2", "[v] + 1 > 3",
+                                             "[v] = null", "[v] = true", "[v] = '3'" };
+        std::vector<mapnik::expression_ptr> exprs;
+        for (std::string const& filter : filters)
+        {
+            exprs.push_back(mapnik::parse_expression(filter));
+        }
+        mapnik::attributes vars;
+        bool same = true;
+        for (std::size_t chunk_size : { 1, 3, 5, 12, 64 })
+        {
+            mapnik::filter_batch batch(vars);
+            mapnik::filter_batch::selection selection;
+            for (std::size_t first = 0; first < features.size(); first += chunk_size)
+            {
+                std::size_t last = std::min(first + chunk_size, features.size());
+                batch.features().assign(features.begin() + first, features.begin() + last);
+                batch.reset();
+                for (std::size_t f = 0; f < exprs.size(); ++f)
+                {
+                    batch.evaluate(exprs[f], selection);
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                        mapnik::value result = mapnik::util::apply_visitor(
+                            mapnik::evaluate<mapnik::feature_impl,mapnik::value,mapnik::attributes>(*features[i], vars), *exprs[f]);
+                        if (selection.size() != last - first || bool(selection[i - first]) != result.to_bool())
+                        {
+                            std::clog << "'" << filters[f] << "' differs on feature " << (i + 1)
+                                      << " in chunks of " << chunk_size << "\n";
+                            same = false;
+                        }
+                    }
+                }
+            }
+        }
+        BOOST_TEST( same );
+
+        // styles symbolize the same features with the same rules, in the same
+        // order, whatever the batch size; 5 does not divide the 12 features
+        std::string xml = "<Map>"
+                          "<Style name=\"all\">"
+                          "<Rule><Filter>[v] &gt; 2</Filter><PointSymbolizer opacity=\"0.1\"/></Rule>"
+                          "<Rule><Filter>[s] = 'x'</Filter><PointSymbolizer opacity=\"0.2\"/></Rule>"
+                          "<Rule><Filter>[v] = 3 or [v] = null</Filter><PointSymbolizer opacity=\"0.3\"/></Rule>"
+                          "<Rule><ElseFilter/><PointSymbolizer opacity=\"0.4\"/></Rule>"
+                          "<Rule><AlsoFilter/><PointSymbolizer opacity=\"0.5\"/></Rule>"
+                          "</Style>"
+                          "<Style name=\"first\" filter-mode=\"first\">"
+                          "<Rule><Filter>[v] &lt;= 2.5</Filter><PointSymbolizer opacity=\"0.6\"/></Rule>"
+                          "<Rule><Filter>[s] != 'y'</Filter><PointSymbolizer opacity=\"0.7\"/></Rule>"
+                          "<Rule><ElseFilter/><PointSymbolizer opacity=\"0.8\"/></Rule>"
+                          "<Rule><AlsoFilter/><PointSymbolizer opacity=\"0.9\"/></Rule>"
+                          "</Style>"
+                          "<Layer name=\"points\"><StyleName>all</StyleName><StyleName>first</StyleName></Layer>"
+                          "</Map>";
+        mapnik::Map m(256, 256);
+        mapnik::load_map_string(m, xml, true);
+        m.get_layer(0).set_datasource(ds);
+        m.zoom_to_box(mapnik::box2d<double>(-10, -10, 10, 10));
+        std::vector<std::pair<mapnik::value_integer, double> > expected;
+        for (unsigned batch_size : { 0, 1, 5, 12, 64 })
+        {
+            m.styles()["all"].set_filter_batch_size(batch_size);
+            m.styles()["first"].set_filter_batch_size(batch_size);
+            rule_recorder recorder(m);
+            recorder.apply();
+            if (batch_size == 0)
+            {
+                expected = recorder.calls;
+                BOOST_TEST( expected.size() > 2 * features.size() );
+            }
+            else if (recorder.calls != expected)
+            {
+                std::clog << "filter-batch-size " << batch_size << " differs\n";
+                BOOST_TEST( false );
+            }
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ filter batch: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
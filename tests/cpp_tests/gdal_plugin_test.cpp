@@ -0,0 +1,117 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/query.hpp>
+#include <mapnik/raster.hpp>
+#include <mapnik/image_reader.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "utils.hpp"
+#include "../../plugins/input/gdal/gdal_datasource.hpp"
+
+mapnik::raster_ptr first_raster(mapnik::featureset_ptr const& fs)
+{
+    mapnik::feature_ptr feature = fs ? fs->next() : mapnik::feature_ptr();
+    return feature ? feature->get_raster() : mapnik::raster_ptr();
+}
+
+bool same_pixels(mapnik::image_data_32 const& a, mapnik::image_data_32 const& b)
+{
+    return a.width() == b.width() && a.height() == b.height() &&
+        std::equal(a.getData(), a.getData() + a.width() * a.height(), b.getData());
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+        GDALAllRegister();
+        std::string file("./tests/data/raster/river_merc.tiff");
+
+        // handles are reused once handed back and at most max_idle stay open
+        {
+            auto pool = std::make_shared<gdal_dataset_pool>(file, false, 2);
+            std::shared_ptr<GDALDataset> a = pool->acquire();
+            std::shared_ptr<GDALDataset> b = pool->acquire();
+            std::shared_ptr<GDALDataset> c = pool->acquire();
+            BOOST_TEST( a && b && c && a != b && b != c && a != c );
+            BOOST_TEST_EQ( pool->idle(), 0u );
+            GDALDataset* kept = c.get();
+            c.reset();
+            BOOST_TEST_EQ( pool->idle(), 1u );
+            BOOST_TEST( pool->acquire().get() == kept );
+            a.reset();
+            b.reset();
+            BOOST_TEST_EQ( pool->idle(), 2u );
+            std::shared_ptr<GDALDataset> d = pool->acquire();
+            std::shared_ptr<GDALDataset> e = pool->acquire();
+            std::shared_ptr<GDALDataset> f = pool->acquire();
+            BOOST_TEST_EQ( pool->idle(), 0u );
+            d.reset();
+            e.reset();
+            f.reset();
+            BOOST_TEST_EQ( pool->idle(), 2u );
+
+            // handles outlive the pool's owner and keep it alive
+            std::weak_ptr<gdal_dataset_pool> weak = pool;
+            std::shared_ptr<GDALDataset> g = pool->acquire();
+            pool.reset();
+            BOOST_TEST( !weak.expired() && g->GetRasterXSize() == 969 );
+            g.reset();
+            BOOST_TEST( weak.expired() );
+        }
+
+        // shared datasets are never kept
+        {
+            auto pool = std::make_shared<gdal_dataset_pool>(file, true, 2);
+            pool->acquire().reset();
+            BOOST_TEST_EQ( pool->idle(), 0u );
+        }
+
+        // the interleaved read gives the file's pixels, on fresh and on reused
+        // handles, and from featuresets alive at the same time
+        std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(file, "tiff"));
+        mapnik::image_data_32 full(reader->width(), reader->height());
+        reader->read(0, 0, full);
+        mapnik::parameters p;
+        p["type"] = "gdal";
+        p["file"] = file;
+        p["max_idle_datasets"] = 1;
+        std::shared_ptr<gdal_datasource> ds = std::make_shared<gdal_datasource>(p);
+        mapnik::box2d<double> extent = ds->envelope();
+        mapnik::query q(extent, mapnik::query::resolution_type(969 / extent.width(), 793 / extent.height()));
+        mapnik::raster_ptr fresh = first_raster(ds->features(q));
+        BOOST_TEST( fresh && same_pixels(fresh->data_, full) );
+        mapnik::featureset_ptr fs1 = ds->features(q);
+        mapnik::featureset_ptr fs2 = ds->features(q);
+        ds.reset();
+        mapnik::raster_ptr r1 = first_raster(fs1);
+        mapnik::raster_ptr r2 = first_raster(fs2);
+        BOOST_TEST( r1 && r2 && same_pixels(r1->data_, full) && same_pixels(r2->data_, full) );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ gdal plugin: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,174 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/load_map.hpp>
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/graphics.hpp>
+#include <mapnik/agg_renderer.hpp>
+#include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/text/glyph_cache.hpp>
+#include <mapnik/make_unique.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "utils.hpp"
+
+// point labels at fractional positions and labels following curved lines,
+// with full and fast halos
+std::string const xml =
+    "<Map srs='+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs' font-directory='fonts/dejavu-fonts-ttf-2.33/ttf/'>"
+    "<Style name='points'><Rule>"
+    "<TextSymbolizer face-name='DejaVu Sans Book' size='11.3' halo-radius='1.5' allow-overlap='true'>[name]</TextSymbolizer>"
+    "</Rule></Style>"
+    "<Style name='lines'><Rule>"
+    "<TextSymbolizer face-name='DejaVu Sans Book' size='12' placement='line' halo-radius='2' halo-rasterizer='fast' allow-overlap='true' max-char-angle-delta='60'>[name]</TextSymbolizer>"
+    "</Rule></Style>"
+    "<Layer name='points' srs='+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs'><StyleName>points</StyleName></Layer>"
+    "<Layer name='lines' srs='+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs'><StyleName>lines</StyleName></Layer>"
+    "</Map>";
+
+std::shared_ptr<mapnik::memory_datasource> features(bool lines)
+{
+    mapnik::parameters params;
+    params["type"] = "memory";
+    auto ds = std::make_shared<mapnik::memory_datasource>(params);
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("name");
+    mapnik::transcoder tr("utf-8");
+    for (int i = 0; i < 6; ++i)
+    {
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, i + 1));
+        feature->put("name", tr.transcode("Quartz jump, vexing fog"));
+        if (lines)
+        {
+            auto line = std::make_unique<mapnik::geometry_type>(mapnik::geometry_type::types::LineString);
+            double y = 20.37 + i * 13.13;
+            line->move_to(4.1, y);
+            for (int x = 1; x <= 40; ++x)
+            {
+                line->line_to(4.1 + x * 4.3, y + 6.0 * std::sin(x * (0.21 + i * 0.05)));
+            }
+            feature->add_geometry(line.release());
+        }
+        else
+        {
+            auto pt = std::make_unique<mapnik::geometry_type>(mapnik::geometry_type::types::Point);
+            pt->move_to(-60.0 + i * 0.19, -75.0 + i * 11.71);
+            feature->add_geometry(pt.release());
+        }
+        ds->push(feature);
+    }
+    return ds;
+}
+
+mapnik::image_32 render(mapnik::Map const& m)
+{
+    mapnik::image_32 im(m.width(), m.height());
+    mapnik::agg_renderer<mapnik::image_32> ren(m, im);
+    ren.apply();
+    return im;
+}
+
+// largest difference of any channel, and the number of differing channels.
+// colours are weighted by alpha, as the colour of a nearly transparent
+// pixel at the edge of a halo does not show
+void compare(mapnik::image_32 const& a, mapnik::image_32 const& b, int & max_diff, std::size_t & count)
+{
+    max_diff = 0;
+    count = 0;
+    unsigned char const* pa = a.raw_data();
+    unsigned char const* pb = b.raw_data();
+    for (std::size_t i = 0; i < std::size_t(a.width()) * a.height() * 4; i += 4)
+    {
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            int va = (c == 3) ? pa[i + 3] : pa[i + c] * pa[i + 3] / 255;
+            int vb = (c == 3) ? pb[i + 3] : pb[i + c] * pb[i + 3] / 255;
+            int diff = std::abs(va - vb);
+            if (diff > 0) ++count;
+            max_diff = std::max(max_diff, diff);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+        mapnik::Map m(256, 256);
+        mapnik::load_map_string(m, xml, true);
+        m.get_layer(0).set_datasource(features(false));
+        m.get_layer(1).set_datasource(features(true));
+        m.zoom_to_box(mapnik::box2d<double>(-90, -90, 180, 180));
+
+        mapnik::glyph_cache & cache = mapnik::glyph_cache::instance();
+        std::size_t max_bytes = cache.max_bytes();
+
+        // max_bytes 0 renders through FreeType glyph by glyph as before
+        cache.set_max_bytes(0);
+        mapnik::image_32 uncached = render(m);
+        BOOST_TEST_EQ( cache.size(), 0u );
+        int max_diff = 0;
+        std::size_t drawn = 0;
+        compare(uncached, mapnik::image_32(m.width(), m.height()), max_diff, drawn);
+        BOOST_TEST( drawn > 1000 );
+
+        // exact keys: cold and warm renders match, and match the uncached
+        // render but for the edges of full halos, which FreeType strokes a
+        // little differently at a subpixel offset than at the final position
+        cache.set_max_bytes(max_bytes);
+        cache.clear();
+        mapnik::image_32 cold = render(m);
+        BOOST_TEST( cache.size() > 0 );
+        mapnik::image_32 warm = render(m);
+        std::size_t count = 0;
+        compare(cold, warm, max_diff, count);
+        BOOST_TEST_EQ( count, 0u );
+        compare(uncached, cold, max_diff, count);
+        if (!quiet) std::clog << "exact glyphs: " << count << " of " << drawn << " channels differ, by at most " << max_diff << "\n";
+        BOOST_TEST( max_diff <= 16 );
+        BOOST_TEST( count < drawn / 100 );
+
+        // snapping to 1/8 pixel and 1/4096 of a turn moves glyphs by at most
+        // 1/16 pixel: most edge pixels change, none by much. a misplaced
+        // glyph would differ by up to 255 over twice its drawn channels
+        cache.clear();
+        cache.set_snapping(8, 4096);
+        mapnik::image_32 snapped = render(m);
+        cache.set_snapping(1, 0);
+        cache.clear();
+        compare(uncached, snapped, max_diff, count);
+        if (!quiet) std::clog << "snapped glyphs: " << count << " of " << drawn << " channels differ, by at most " << max_diff << "\n";
+        BOOST_TEST( max_diff <= 48 );
+        BOOST_TEST( count < drawn );
+    }
+    catch (std::exception const & ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST(false);
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ glyph cache rendering: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,109 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/text/face.hpp>
+#include <mapnik/text/glyph_cache.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "utils.hpp"
+
+mapnik::glyph_cache_key key(unsigned face_id, mapnik::glyph_index_t glyph, std::int32_t halo_radius = -1)
+{
+    return mapnik::glyph_cache_key { face_id, glyph, 12 << 6, 0x10000, 0, 0, 0, halo_radius };
+}
+
+mapnik::glyph_bitmap_ptr bitmap(unsigned size)
+{
+    return std::make_shared<mapnik::glyph_bitmap>(
+        mapnik::glyph_bitmap { 0, 0, size, size, std::vector<std::uint8_t>(size * size, 0xff) });
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+        mapnik::glyph_cache & cache = mapnik::glyph_cache::instance();
+        cache.clear();
+
+        // hits only for the exact key, plain glyphs and halos apart
+        BOOST_TEST( !cache.find(key(1, 36)) );
+        cache.insert(key(1, 36), bitmap(10));
+        cache.insert(key(1, 36, 2 << 6), bitmap(14));
+        mapnik::glyph_bitmap_ptr found = cache.find(key(1, 36));
+        BOOST_TEST( found && found->width == 10 );
+        found = cache.find(key(1, 36, 2 << 6));
+        BOOST_TEST( found && found->width == 14 );
+        BOOST_TEST( !cache.find(key(2, 36)) );
+        BOOST_TEST( !cache.find(key(1, 37)) );
+        BOOST_TEST( !cache.find(key(1, 36, 1 << 6)) );
+        mapnik::glyph_cache_key other = key(1, 36);
+        other.size = 13 << 6;
+        BOOST_TEST( !cache.find(other) );
+        other = key(1, 36);
+        other.rotation_sin = 1;
+        BOOST_TEST( !cache.find(other) );
+        other = key(1, 36);
+        other.subpixel_x = 1;
+        BOOST_TEST( !cache.find(other) );
+        BOOST_TEST_EQ( cache.size(), 2u );
+
+        // least recently used bitmaps go first
+        std::size_t bytes = cache.bytes();
+        cache.set_max_bytes(bytes);
+        BOOST_TEST( cache.find(key(1, 36)) );
+        cache.insert(key(1, 38), bitmap(10));
+        BOOST_TEST( cache.find(key(1, 36)) );
+        BOOST_TEST( cache.find(key(1, 38)) );
+        BOOST_TEST( !cache.find(key(1, 36, 2 << 6)) );
+        BOOST_TEST( cache.bytes() <= bytes );
+        cache.clear();
+        BOOST_TEST_EQ( cache.size(), 0u );
+        cache.set_max_bytes(32 * 1024 * 1024);
+
+        // faces are told apart by their font file and face index, not by their
+        // names: two versions of a family must not share glyphs
+        std::string name("DejaVu Sans Mono Bold Oblique");
+        mapnik::font_library library;
+        mapnik::freetype_engine::font_file_mapping_type bundled;
+        mapnik::freetype_engine::font_file_mapping_type local;
+        mapnik::freetype_engine::font_file_mapping_type global;
+        mapnik::freetype_engine::font_memory_cache_type memory;
+        mapnik::freetype_engine::font_memory_cache_type global_memory;
+        bundled.emplace(name, std::make_pair(0, std::string("./fonts/dejavu-fonts-ttf-2.33/ttf/DejaVuSansMono-BoldOblique.ttf")));
+        local.emplace(name, std::make_pair(0, std::string("./tests/data/fonts/DejaVuSansMono-BoldOblique.ttf")));
+        mapnik::face_ptr a = mapnik::freetype_engine::create_face(name, library, bundled, memory, global, global_memory);
+        mapnik::face_ptr b = mapnik::freetype_engine::create_face(name, library, local, memory, global, global_memory);
+        mapnik::face_ptr c = mapnik::freetype_engine::create_face(name, library, bundled, memory, global, global_memory);
+        BOOST_TEST( a && b && c );
+        if (a && b && c)
+        {
+            BOOST_TEST( a->family_name() == b->family_name() && a->style_name() == b->style_name() );
+            BOOST_TEST( a->id() != b->id() );
+            BOOST_TEST_EQ( a->id(), c->id() );
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ glyph cache: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,135 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/image_reader.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+bool is_png(std::string const& data, int color_type, int bit_depth)
+{
+    return data.size() > 25 && data.compare(1, 3, "PNG") == 0 &&
+        data[24] == bit_depth && data[25] == color_type;
+}
+
+bool is_jpeg(std::string const& data)
+{
+    return data.size() > 2 && data[0] == '\xff' && data[1] == '\xd8';
+}
+
+bool decodes_to(std::string const& data, mapnik::image_data_32 const& im)
+{
+    std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(data.data(), data.size()));
+    if (!reader || reader->width() != im.width() || reader->height() != im.height()) return false;
+    mapnik::image_data_32 out(im.width(), im.height());
+    reader->read(0, 0, out);
+    return std::equal(im.getData(), im.getData() + im.width() * im.height(), out.getData());
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // up to 256 colors, translucent ones included, give a lossless png8
+        mapnik::image_data_32 im(300, 200);
+        for (unsigned y = 0; y < im.height(); ++y)
+        {
+            for (unsigned x = 0; x < im.width(); ++x)
+            {
+                unsigned i = (x / 7 + y / 5) % 256;
+                im(x, y) = i < 40 ? (i << 24) | (i << 8) : 0xff000000 | (i * 0x010203);
+            }
+        }
+        std::string out = mapnik::save_to_string(im, "auto");
+        BOOST_TEST( is_png(out, 3, 8) );
+        BOOST_TEST( decodes_to(out, im) );
+        BOOST_TEST( out.size() < mapnik::save_to_string(im, "png32").size() );
+
+        // a few colors give 4 bit, a single one 1 bit
+        for (unsigned y = 0; y < im.height(); ++y)
+        {
+            for (unsigned x = 0; x < im.width(); ++x)
+            {
+                im(x, y) = (x + y) % 3 ? 0x80102030 : 0xff00ff00;
+            }
+        }
+        out = mapnik::save_to_string(im, "auto:z=1");
+        BOOST_TEST( is_png(out, 3, 4) );
+        BOOST_TEST( decodes_to(out, im) );
+        im.set(0);
+        out = mapnik::save_to_string(im, "auto");
+        BOOST_TEST( is_png(out, 3, 1) );
+        BOOST_TEST( decodes_to(out, im) );
+
+        // more colors keep all of them, opaque ones without alpha channel
+        for (unsigned y = 0; y < im.height(); ++y)
+        {
+            for (unsigned x = 0; x < im.width(); ++x)
+            {
+                im(x, y) = 0xff000000 | ((y * 3) << 8) | (x / 4);
+            }
+        }
+        out = mapnik::save_to_string(im, "auto");
+        BOOST_TEST( is_png(out, 2, 8) );
+        BOOST_TEST( decodes_to(out, im) );
+        im(0, 0) = 0x80000000;
+        out = mapnik::save_to_string(im, "auto");
+        BOOST_TEST( is_png(out, 6, 8) );
+        BOOST_TEST( decodes_to(out, im) );
+
+        // noise goes to jpeg, unless restricted to png
+        unsigned seed = 5;
+        for (unsigned y = 0; y < im.height(); ++y)
+        {
+            for (unsigned x = 0; x < im.width(); ++x)
+            {
+                seed = seed * 1103515245 + 12345;
+                im(x, y) = 0xff000000 | (seed >> 8);
+            }
+        }
+        out = mapnik::save_to_string(im, "auto:q=70");
+#if defined(HAVE_JPEG)
+        BOOST_TEST( is_jpeg(out) );
+#else
+        BOOST_TEST( is_png(out, 2, 8) );
+#endif
+        out = mapnik::save_to_string(im, "auto:png");
+        BOOST_TEST( is_png(out, 2, 8) );
+        BOOST_TEST( decodes_to(out, im) );
+
+        try
+        {
+            mapnik::save_to_string(im, "auto:q=101");
+            BOOST_TEST( false );
+        }
+        catch (std::exception const&) {}
+        try
+        {
+            mapnik::save_to_string(im, "auto:x=1");
+            BOOST_TEST( false );
+        }
+        catch (std::exception const&) {}
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ auto image format: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,144 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_compositing.hpp>
+#include <mapnik/simd.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "agg_rendering_buffer.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_renderer_base.h"
+
+// random bytes, premultiplied or not: agg blenders are also fed
+// non-premultiplied data and the vector kernels must agree there too
+void fill(mapnik::image_data_32 & im, unsigned seed)
+{
+    unsigned char * bytes = im.getBytes();
+    std::size_t size = im.width() * im.height() * 4;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned v = (seed >> 16) & 0xff;
+        // make fully transparent and fully opaque pixels common
+        if ((i & 3) == 3 && (v & 0xc0) == 0xc0) v = (v & 1) ? 255 : 0;
+        bytes[i] = static_cast<unsigned char>(v);
+    }
+}
+
+void reference(mapnik::image_data_32 & dst, mapnik::image_data_32 & src,
+               mapnik::composite_mode_e mode, float opacity, int dx, int dy)
+{
+    using blender_type = agg::comp_op_adaptor_rgba_pre<agg::rgba8, agg::order_rgba>;
+    using pixfmt_type = agg::pixfmt_custom_blend_rgba<blender_type, agg::rendering_buffer>;
+    agg::rendering_buffer dst_buffer(dst.getBytes(),dst.width(),dst.height(),dst.width() * 4);
+    agg::rendering_buffer src_buffer(src.getBytes(),src.width(),src.height(),src.width() * 4);
+    pixfmt_type pixf(dst_buffer);
+    pixf.comp_op(static_cast<agg::comp_op_e>(mode));
+    agg::pixfmt_rgba32 pixf_mask(src_buffer);
+    agg::renderer_base<pixfmt_type> ren(pixf);
+    ren.blend_from(pixf_mask,0,dx,dy,unsigned(255*opacity));
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    mapnik::composite_mode_e modes[] = { mapnik::src_over, mapnik::dst_in, mapnik::dst_out,
+                                         mapnik::multiply, mapnik::screen, mapnik::overlay,
+                                         mapnik::darken };
+    float opacities[] = { 1.0f, 0.5f, 0.73f, 0.0f };
+    int offsets[][2] = { { 0, 0 }, { 3, -2 }, { -5, 7 } };
+
+    mapnik::image_data_32 src(37, 29);
+    fill(src, 1);
+    mapnik::image_data_32 background(41, 23);
+    fill(background, 2);
+    std::size_t bytes = background.width() * background.height() * 4;
+
+    for (int level = mapnik::simd::SCALAR; level <= detected; ++level)
+    {
+        BOOST_TEST_EQ( mapnik::simd::set_level(static_cast<mapnik::simd::level_e>(level)), level );
+        for (mapnik::composite_mode_e mode : modes)
+        {
+            for (float opacity : opacities)
+            {
+                for (auto const& offset : offsets)
+                {
+                    mapnik::image_data_32 expected(background.width(), background.height());
+                    std::memcpy(expected.getBytes(), background.getBytes(), bytes);
+                    mapnik::image_data_32 actual(background.width(), background.height());
+                    std::memcpy(actual.getBytes(), background.getBytes(), bytes);
+                    reference(expected, src, mode, opacity, offset[0], offset[1]);
+                    mapnik::composite(actual, src, mode, opacity, offset[0], offset[1], false);
+                    bool same = std::memcmp(expected.getBytes(), actual.getBytes(), bytes) == 0;
+                    BOOST_TEST( same );
+                    if (!same && !quiet)
+                    {
+                        std::clog << "level " << level << " mode " << *mapnik::comp_op_to_string(mode)
+                                  << " opacity " << opacity << " offset " << offset[0] << "," << offset[1] << "\n";
+                    }
+                }
+            }
+        }
+    }
+    mapnik::simd::set_level(detected);
+
+    // modes claimed to ignore transparent source pixels really do
+    using blender_type = agg::comp_op_adaptor_rgba_pre<agg::rgba8, agg::order_rgba>;
+    for (int m = mapnik::clear; m <= mapnik::divide; ++m)
+    {
+        mapnik::composite_mode_e mode = static_cast<mapnik::composite_mode_e>(m);
+        if (!mapnik::composite_transparent_noop(mode)) continue;
+        bool noop = true;
+        for (unsigned cover : { 255u, 128u, 0u })
+        {
+            for (unsigned a = 0; a < 256; ++a)
+            {
+                for (unsigned c = 0; c <= a; ++c)
+                {
+                    std::uint8_t p[4] = { std::uint8_t(c), std::uint8_t(a - c), std::uint8_t(c / 2), std::uint8_t(a) };
+                    std::uint8_t q[4] = { p[0], p[1], p[2], p[3] };
+                    blender_type::blend_pix(m, q, 0, 0, 0, 0, cover);
+                    if (std::memcmp(p, q, 4) != 0) noop = false;
+                }
+            }
+        }
+        BOOST_TEST( noop );
+        if (!noop && !quiet) std::clog << "mode " << *mapnik::comp_op_to_string(mode) << " changes the destination\n";
+    }
+
+    // compositing the painted box only, transparent elsewhere
+    mapnik::image_data_32 sparse(src.width(), src.height());
+    mapnik::box2d<int> box(9, 4, 30, 20);
+    for (int y = box.miny(); y < box.maxy(); ++y)
+    {
+        std::memcpy(sparse.getRow(y) + box.minx(), src.getRow(y) + box.minx(), box.width() * 4);
+    }
+    for (auto const& offset : offsets)
+    {
+        mapnik::image_data_32 expected(background.width(), background.height());
+        std::memcpy(expected.getBytes(), background.getBytes(), bytes);
+        mapnik::image_data_32 actual(background.width(), background.height());
+        std::memcpy(actual.getBytes(), background.getBytes(), bytes);
+        mapnik::composite(expected, sparse, mapnik::multiply, 0.5f, offset[0], offset[1], false);
+        mapnik::composite(actual, sparse, box, mapnik::multiply, 0.5f, offset[0], offset[1]);
+        BOOST_TEST( std::memcmp(expected.getBytes(), actual.getBytes(), bytes) == 0 );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ image compositing: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,431 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/graphics.hpp>
+#include <mapnik/image_filter.hpp>
+#include <mapnik/image_filter_types.hpp>
+#include <mapnik/simd.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// premultiplied pixels with plenty of transparent and opaque ones
+void fill(mapnik::image_32 & im, unsigned seed)
+{
+    unsigned char * bytes = im.raw_data();
+    for (std::size_t i = 0; i < std::size_t(im.width()) * im.height(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned a = (seed >> 16) & 0xff;
+        if (a < 40) a = 0;
+        else if (a > 200) a = 255;
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            seed = seed * 1103515245 + 12345;
+            bytes[i * 4 + c] = static_cast<unsigned char>(((seed >> 16) & 0xff) * a / 255);
+        }
+        bytes[i * 4 + 3] = static_cast<unsigned char>(a);
+    }
+}
+
+bool same(mapnik::image_32 const& a, mapnik::image_32 const& b)
+{
+    return std::memcmp(a.raw_data(), b.raw_data(), std::size_t(a.width()) * a.height() * 4) == 0;
+}
+
+void reset(mapnik::image_32 & im, mapnik::image_32 const& src)
+{
+    std::memcpy(im.raw_data(), src.raw_data(), std::size_t(src.width()) * src.height() * 4);
+}
+
+// the scalar code the filters used before they were vectorized
+template <typename Src, typename Dst, typename Filter>
+void convolution_3x3(Src const& src_view, Dst & dst_view, Filter const& filter)
+{
+    using boost::gil::bits32f;
+    using boost::gil::point2;
+
+    // p0 p1 p2
+    // p3 p4 p5
+    // p6 p7 p8
+
+    typename Src::xy_locator src_loc = src_view.xy_at(0,0);
+    typename Src::xy_locator::cached_location_t loc00 = src_loc.cache_location(-1,-1);
+    typename Src::xy_locator::cached_location_t loc10 = src_loc.cache_location( 0,-1);
+    typename Src::xy_locator::cached_location_t loc20 = src_loc.cache_location( 1,-1);
+    typename Src::xy_locator::cached_location_t loc01 = src_loc.cache_location(-1, 0);
+    typename Src::xy_locator::cached_location_t loc11 = src_loc.cache_location( 0, 0);
+    typename Src::xy_locator::cached_location_t loc21 = src_loc.cache_location( 1, 0);
+    typename Src::xy_locator::cached_location_t loc02 = src_loc.cache_location(-1, 1);
+    typename Src::xy_locator::cached_location_t loc12 = src_loc.cache_location( 0, 1);
+    typename Src::xy_locator::cached_location_t loc22 = src_loc.cache_location( 1, 1);
+
+    typename Src::x_iterator dst_it = dst_view.row_begin(0);
+
+    // top row
+    for (int x = 0 ; x < src_view.width(); ++x)
+    {
+        (*dst_it)[3] = src_loc[loc11][3]; // Dst.a = Src.a
+        for (int i = 0; i < 3; ++i)
+        {
+            bits32f p[9];
+
+            p[4] = src_loc[loc11][i];
+            p[7] = src_loc[loc12][i];
+
+            if (x == 0)
+            {
+                p[3] = p[4];
+                p[6] = p[7];
+            }
+            else
+            {
+                p[3] = src_loc[loc01][i];
+                p[6] = src_loc[loc02][i];
+            }
+
+            if ( x == src_view.width()-1)
+            {
+                p[5] = p[4];
+                p[8] = p[7];
+            }
+            else
+            {
+                p[5] = src_loc[loc21][i];
+                p[8] = src_loc[loc22][i];
+            }
+
+            p[0] = p[6];
+            p[1] = p[7];
+            p[2] = p[8];
+
+            process_channel(p, (*dst_it)[i], filter);
+        }
+        ++src_loc.x();
+        ++dst_it;
+    }
+    // carrige-return
+    src_loc += point2<std::ptrdiff_t>(-src_view.width(),1);
+
+    // 1... height-1 rows
+    for (int y = 1; y<src_view.height()-1; ++y)
+    {
+        for (int x = 0; x < src_view.width(); ++x)
+        {
+            (*dst_it)[3] = src_loc[loc11][3]; // Dst.a = Src.a
+            for (int i = 0; i < 3; ++i)
+            {
+                bits32f p[9];
+
+                p[1] = src_loc[loc10][i];
+                p[4] = src_loc[loc11][i];
+                p[7] = src_loc[loc12][i];
+
+                if (x == 0)
+                {
+                    p[0] = p[1];
+                    p[3] = p[4];
+                    p[6] = p[7];
+                }
+                else
+                {
+                    p[0] = src_loc[loc00][i];
+                    p[3] = src_loc[loc01][i];
+                    p[6] = src_loc[loc02][i];
+                }
+
+                if ( x == src_view.width() - 1)
+                {
+                    p[2] = p[1];
+                    p[5] = p[4];
+                    p[8] = p[7];
+                }
+                else
+                {
+                    p[2] = src_loc[loc20][i];
+                    p[5] = src_loc[loc21][i];
+                    p[8] = src_loc[loc22][i];
+                }
+                process_channel(p, (*dst_it)[i], filter);
+            }
+            ++dst_it;
+            ++src_loc.x();
+        }
+        // carrige-return
+        src_loc += point2<std::ptrdiff_t>(-src_view.width(),1);
+    }
+
+    // bottom row
+    //src_loc = src_view.xy_at(0,src_view.height()-1);
+    for (int x = 0 ; x < src_view.width(); ++x)
+    {
+        (*dst_it)[3] = src_loc[loc11][3]; // Dst.a = Src.a
+        for (int i = 0; i < 3; ++i)
+        {
+            bits32f p[9];
+
+            p[1] = src_loc[loc10][i];
+            p[4] = src_loc[loc11][i];
+
+            if (x == 0)
+            {
+                p[0] = p[1];
+                p[3] = p[4];
+            }
+            else
+            {
+                p[0] = src_loc[loc00][i];
+                p[3] = src_loc[loc01][i];
+            }
+
+            if ( x == src_view.width()-1)
+            {
+                p[2] = p[1];
+                p[5] = p[4];
+
+            }
+            else
+            {
+                p[2] = src_loc[loc20][i];
+                p[5] = src_loc[loc21][i];
+            }
+
+            p[6] = p[0];
+            p[7] = p[1];
+            p[8] = p[2];
+            process_channel(p, (*dst_it)[i], filter);
+        }
+        ++src_loc.x();
+        ++dst_it;
+    }
+}
+
+template <typename Filter>
+void reference_3x3(mapnik::image_32 & im, Filter const& filter)
+{
+    {
+        im.demultiply();
+        mapnik::filter::double_buffer<mapnik::image_32> tb(im);
+        convolution_3x3(tb.src_view, tb.dst_view, filter);
+    }
+    im.premultiply();
+}
+
+void reference_stack_blur(mapnik::image_32 & im, unsigned rx, unsigned ry)
+{
+    agg::rendering_buffer buf(im.raw_data(), im.width(), im.height(), im.width() * 4);
+    agg::pixfmt_rgba32_pre pixf(buf);
+    agg::stack_blur_rgba32(pixf, rx, ry);
+}
+
+void reference_gray_invert(mapnik::image_32 & im, bool invert)
+{
+    unsigned char * p = im.raw_data();
+    for (std::size_t i = 0; i < std::size_t(im.width()) * im.height() * 4; i += 4)
+    {
+        if (invert)
+        {
+            p[i] = p[i + 3] - p[i];
+            p[i + 1] = p[i + 3] - p[i + 1];
+            p[i + 2] = p[i + 3] - p[i + 2];
+        }
+        else
+        {
+            p[i] = p[i + 1] = p[i + 2] = uint8_t((4915 * p[i] + 9667 * p[i + 1] + 1802 * p[i + 2] + 8192) >> 14);
+        }
+    }
+}
+
+void reference_colorize(mapnik::image_32 & im, mapnik::color const& c)
+{
+    unsigned char * p = im.raw_data();
+    for (std::size_t i = 0; i < std::size_t(im.width()) * im.height() * 4; i += 4)
+    {
+        unsigned a = p[i + 3];
+        if (a > 0)
+        {
+            p[i] = (c.red() * a + 255) >> 8;
+            p[i + 1] = (c.green() * a + 255) >> 8;
+            p[i + 2] = (c.blue() * a + 255) >> 8;
+        }
+    }
+}
+
+template <typename Filter>
+void run(mapnik::image_32 & im, Filter const& filter)
+{
+    mapnik::filter::filter_type tag(filter);
+    mapnik::filter::filter_visitor<mapnik::image_32> visitor(im);
+    mapnik::util::apply_visitor(visitor, tag);
+}
+
+// applies filters to the box filter_extent_visitor grows around the painted
+// pixels only, as agg_renderer does with style buffers
+void run_in_extent(mapnik::image_32 & im, std::vector<mapnik::filter::filter_type> const& filters)
+{
+    mapnik::box2d<int> image(0, 0, im.width(), im.height());
+    mapnik::box2d<int> extent = im.bounding_box();
+    mapnik::filter::filter_extent_visitor extent_visitor(extent, image);
+    for (auto const& tag : filters) mapnik::util::apply_visitor(extent_visitor, tag);
+    mapnik::image_32 region(extent.width(), extent.height());
+    for (int y = 0; y < extent.height(); ++y)
+    {
+        std::memcpy(region.data().getRow(y), im.data().getRow(extent.miny() + y) + extent.minx(), extent.width() * 4);
+    }
+    mapnik::filter::filter_visitor<mapnik::image_32> visitor(region);
+    for (auto const& tag : filters) mapnik::util::apply_visitor(visitor, tag);
+    im.clear();
+    for (int y = 0; y < extent.height(); ++y)
+    {
+        std::memcpy(im.data().getRow(extent.miny() + y) + extent.minx(), region.data().getRow(y), extent.width() * 4);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    std::size_t threshold = mapnik::filter::parallel_threshold();
+    std::vector<std::pair<int, int> > sizes = { {1, 1}, {1, 9}, {7, 1}, {2, 2}, {67, 45}, {300, 211} };
+
+    mapnik::filter::colorize_alpha single_stop;
+    single_stop.emplace_back(mapnik::color(255, 0, 128), 0.0);
+    mapnik::filter::colorize_alpha stops;
+    stops.emplace_back(mapnik::color(0, 0, 255), 0.0);
+    stops.emplace_back(mapnik::color(0, 255, 0), 0.5);
+    stops.emplace_back(mapnik::color(255, 0, 0, 128), 1.0);
+
+    for (std::size_t parallel : { std::size_t(0), std::size_t(1) })
+    {
+        mapnik::filter::set_parallel_threshold(parallel);
+        for (int level = mapnik::simd::SCALAR; level <= detected; ++level)
+        {
+            mapnik::simd::set_level(static_cast<mapnik::simd::level_e>(level));
+            for (auto const& size : sizes)
+            {
+                mapnik::image_32 src(size.first, size.second);
+                fill(src, size.first * 31 + size.second);
+
+                for (unsigned r : { 1u, 2u, 10u, 300u })
+                {
+                    for (auto const& radius : { std::make_pair(r, r), std::make_pair(r, 0u), std::make_pair(0u, r) })
+                    {
+                        mapnik::image_32 expected(src);
+                        mapnik::image_32 actual(src);
+                        reference_stack_blur(expected, radius.first, radius.second);
+                        run(actual, mapnik::filter::agg_stack_blur(radius.first, radius.second));
+                        BOOST_TEST( same(expected, actual) );
+                    }
+                }
+
+                // 3x3 filters of height 1 read outside of the image in the reference
+                if (size.second > 1)
+                {
+                    mapnik::image_32 expected(src);
+                    mapnik::image_32 actual(src);
+                    reference_3x3(expected, mapnik::filter::blur());
+                    run(actual, mapnik::filter::blur());
+                    BOOST_TEST( same(expected, actual) );
+
+                    reset(expected, src); reset(actual, src);
+                    reference_3x3(expected, mapnik::filter::emboss());
+                    run(actual, mapnik::filter::emboss());
+                    BOOST_TEST( same(expected, actual) );
+
+                    reset(expected, src); reset(actual, src);
+                    reference_3x3(expected, mapnik::filter::sharpen());
+                    run(actual, mapnik::filter::sharpen());
+                    BOOST_TEST( same(expected, actual) );
+
+                    reset(expected, src); reset(actual, src);
+                    reference_3x3(expected, mapnik::filter::edge_detect());
+                    run(actual, mapnik::filter::edge_detect());
+                    BOOST_TEST( same(expected, actual) );
+
+                    reset(expected, src); reset(actual, src);
+                    reference_3x3(expected, mapnik::filter::sobel());
+                    run(actual, mapnik::filter::sobel());
+                    BOOST_TEST( same(expected, actual) );
+                }
+
+                {
+                    mapnik::image_32 expected(src);
+                    mapnik::image_32 actual(src);
+                    reference_gray_invert(expected, false);
+                    run(actual, mapnik::filter::gray());
+                    BOOST_TEST( same(expected, actual) );
+
+                    reset(expected, src); reset(actual, src);
+                    reference_gray_invert(expected, true);
+                    run(actual, mapnik::filter::invert());
+                    BOOST_TEST( same(expected, actual) );
+
+                    reset(expected, src); reset(actual, src);
+                    reference_colorize(expected, single_stop[0].color);
+                    run(actual, single_stop);
+                    BOOST_TEST( same(expected, actual) );
+                }
+            }
+        }
+    }
+
+    // filters without a reference here must not depend on how rows are split
+    mapnik::simd::set_level(detected);
+    mapnik::image_32 src(300, 211);
+    fill(src, 7);
+    mapnik::filter::scale_hsla hsla(0.1, 0.9, 0.2, 0.8, 0.1, 0.9, 0.1, 0.9);
+    mapnik::filter::color_to_alpha to_alpha(mapnik::color(40, 80, 120));
+    mapnik::image_32 serial(src);
+    mapnik::image_32 parallel(src);
+    mapnik::filter::set_parallel_threshold(0);
+    run(serial, hsla);
+    run(serial, to_alpha);
+    run(serial, stops);
+    mapnik::filter::set_parallel_threshold(1);
+    run(parallel, hsla);
+    run(parallel, to_alpha);
+    run(parallel, stops);
+    BOOST_TEST( same(serial, parallel) );
+    BOOST_TEST( !same(serial, src) );
+    mapnik::filter::set_parallel_threshold(threshold);
+
+    // filtering only around the painted pixels gives the same image
+    std::vector<std::vector<mapnik::filter::filter_type> > chains = {
+        { mapnik::filter::agg_stack_blur(6, 3) },
+        { mapnik::filter::blur(), mapnik::filter::emboss() },
+        { mapnik::filter::sobel(), mapnik::filter::agg_stack_blur(2, 9) },
+        { mapnik::filter::gray(), mapnik::filter::invert(), mapnik::filter::sharpen() },
+        { hsla, mapnik::filter::edge_detect(), stops },
+        { mapnik::filter::agg_stack_blur(1, 1), mapnik::filter::x_gradient() } };
+    std::vector<mapnik::box2d<int> > painted = { { 100, 60, 140, 95 }, { 0, 150, 30, 211 }, { 290, 0, 300, 5 } };
+    for (auto const& chain : chains)
+    {
+        for (auto const& box : painted)
+        {
+            mapnik::image_32 expected(300, 211);
+            for (int y = box.miny(); y < box.maxy(); ++y)
+            {
+                std::memcpy(expected.data().getRow(y) + box.minx(), src.data().getRow(y) + box.minx(), box.width() * 4);
+            }
+            mapnik::image_32 actual(expected);
+            mapnik::filter::filter_visitor<mapnik::image_32> visitor(expected);
+            for (auto const& tag : chain) mapnik::util::apply_visitor(visitor, tag);
+            run_in_extent(actual, chain);
+            BOOST_TEST( same(expected, actual) );
+        }
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ image filters: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -5,9 +5,41 @@
 #include <mapnik/util/fs.hpp>
 #include <vector>
 #include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <cstdlib>
+#include <string>
 
 #include "utils.hpp"
 
+// windows must read exactly what a full read has at their position
+bool windows_match(mapnik::image_reader & reader)
+{
+    unsigned width = reader.width();
+    unsigned height = reader.height();
+    mapnik::image_data_32 full(width, height);
+    reader.read(0, 0, full);
+    unsigned windows[][4] = { { 0, 0, width / 2, height / 2 },
+                              { width / 3, height / 3, width / 2, height / 2 },
+                              { width / 2, height / 2, width - width / 2, height - height / 2 },
+                              { 1, height - 1, width - 1, 1 },
+                              { width / 5, height / 7, width / 3 + 1, height - height / 7 } };
+    for (auto const& w : windows)
+    {
+        mapnik::image_data_32 window(w[2], w[3]);
+        reader.read(w[0], w[1], window);
+        for (unsigned y = 0; y < w[3]; ++y)
+        {
+            for (unsigned x = 0; x < w[2]; ++x)
+            {
+                if (window(x, y) != full(x + w[0], y + w[1])) return false;
+            }
+        }
+    }
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     std::vector<std::string> args;
@@ -44,6 +76,51 @@ int main(int argc, char** argv)
         {
             BOOST_TEST( true );
         }
+
+        // reduced decoding gives about the box filtered full size image
+        mapnik::image_data_32 gradient(203, 117);
+        for (unsigned y = 0; y < gradient.height(); ++y)
+        {
+            for (unsigned x = 0; x < gradient.width(); ++x)
+            {
+                gradient(x, y) = 0xff000000 | ((x + y) / 2 << 16) | (y * 2 << 8) | x;
+            }
+        }
+        std::string jpeg = mapnik::save_to_string(gradient, "jpeg95");
+        std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(jpeg.data(), jpeg.size()));
+        BOOST_TEST( reader && reader->width() == 203 && reader->height() == 117 );
+        if (reader)
+        {
+            mapnik::image_data_32 full(203, 117);
+            reader->read(0, 0, full);
+            BOOST_TEST_EQ( reader->set_reduction(3), 2u );
+            BOOST_TEST( reader->width() == 102 && reader->height() == 59 );
+            BOOST_TEST( windows_match(*reader) );
+            mapnik::image_data_32 half(102, 59);
+            reader->read(0, 0, half);
+            bool close = true;
+            for (unsigned y = 0; y < 58; ++y)
+            {
+                for (unsigned x = 0; x < 101; ++x)
+                {
+                    for (unsigned shift = 0; shift < 24; shift += 8)
+                    {
+                        int sum = 0;
+                        for (unsigned k = 0; k < 4; ++k)
+                        {
+                            sum += (full(x * 2 + k % 2, y * 2 + k / 2) >> shift) & 0xff;
+                        }
+                        close = close && std::abs(int((half(x, y) >> shift) & 0xff) - sum / 4) <= 8;
+                    }
+                }
+            }
+            BOOST_TEST( close );
+            BOOST_TEST_EQ( reader->set_reduction(100), 8u );
+            BOOST_TEST( reader->width() == 26 && reader->height() == 15 );
+            BOOST_TEST( windows_match(*reader) );
+            BOOST_TEST_EQ( reader->set_reduction(1), 1u );
+            BOOST_TEST( reader->width() == 203 && reader->height() == 117 );
+        }
 #endif
 
 #if defined(HAVE_PNG)
@@ -90,6 +167,17 @@ int main(int argc, char** argv)
         {
             BOOST_TEST( true );
         }
+
+        // stripped with a short last strip, and tiled
+        for (std::string const& name : { "./tests/data/raster/river.tiff", "./tests/data/raster/dataraster.tif" })
+        {
+            std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(name, "tiff"));
+            BOOST_TEST( reader && windows_match(*reader) );
+            std::ifstream file(name.c_str(), std::ios::binary);
+            std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            reader.reset(mapnik::get_image_reader(data.data(), data.size()));
+            BOOST_TEST( reader && windows_match(*reader) );
+        }
 #endif
 
 #if defined(HAVE_WEBP)
@@ -0,0 +1,98 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/graphics.hpp>
+#include <mapnik/box2d.hpp>
+#include <mapnik/simd.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "agg_rendering_buffer.h"
+#include "agg_pixfmt_rgba.h"
+
+// every combination of color and alpha, including colors above alpha that
+// demultiply has to clamp; an odd width leaves a tail for the scalar code
+void fill(mapnik::image_32 & im)
+{
+    unsigned char * p = im.raw_data();
+    std::size_t size = std::size_t(im.width()) * im.height();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        unsigned c = i & 0xff;
+        unsigned a = (i >> 8) & 0xff;
+        p[i * 4] = static_cast<unsigned char>(c);
+        p[i * 4 + 1] = static_cast<unsigned char>(255 - c);
+        p[i * 4 + 2] = static_cast<unsigned char>(c / 2);
+        p[i * 4 + 3] = static_cast<unsigned char>(a);
+    }
+}
+
+bool same(mapnik::image_32 const& a, mapnik::image_32 const& b)
+{
+    return std::memcmp(a.raw_data(), b.raw_data(), std::size_t(a.width()) * a.height() * 4) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    for (int level = mapnik::simd::SCALAR; level <= detected; ++level)
+    {
+        BOOST_TEST_EQ( mapnik::simd::set_level(static_cast<mapnik::simd::level_e>(level)), level );
+
+        mapnik::image_32 expected(259, 254);
+        fill(expected);
+        mapnik::image_32 actual(259, 254);
+        fill(actual);
+        agg::rendering_buffer buf(expected.raw_data(), expected.width(), expected.height(), expected.width() * 4);
+        agg::pixfmt_rgba32(buf).premultiply();
+        actual.premultiply();
+        BOOST_TEST( actual.premultiplied() );
+        if (!same(expected, actual) && !quiet) std::clog << "premultiply differs at level " << level << "\n";
+        BOOST_TEST( same(expected, actual) );
+
+        fill(expected);
+        fill(actual);
+        agg::pixfmt_rgba32_pre(buf).demultiply();
+        actual.demultiply();
+        BOOST_TEST( !actual.premultiplied() );
+        if (!same(expected, actual) && !quiet) std::clog << "demultiply differs at level " << level << "\n";
+        BOOST_TEST( same(expected, actual) );
+    }
+    mapnik::simd::set_level(detected);
+
+    // bounding box of the pixels that are not all zero
+    mapnik::image_32 im(100, 70);
+    BOOST_TEST( !im.bounding_box().valid() );
+    im.setPixel(40, 30, 0x01000000);
+    BOOST_TEST( im.bounding_box() == mapnik::box2d<int>(40, 30, 41, 31) );
+    // any byte counts, not only alpha
+    im.setPixel(12, 61, 0x00000100);
+    BOOST_TEST( im.bounding_box() == mapnik::box2d<int>(12, 30, 41, 62) );
+    im.setPixel(99, 45, 0xffffffff);
+    im.setPixel(70, 0, 0xffffffff);
+    BOOST_TEST( im.bounding_box() == mapnik::box2d<int>(12, 0, 100, 62) );
+    im.setPixel(0, 69, 0xffffffff);
+    BOOST_TEST( im.bounding_box() == mapnik::box2d<int>(0, 0, 100, 70) );
+
+    // clearing a box, clipped to the image
+    im.clear(mapnik::box2d<int>(-10, -10, 50, 80));
+    BOOST_TEST( im.bounding_box() == mapnik::box2d<int>(70, 0, 100, 46) );
+    im.clear(mapnik::box2d<int>(70, 0, 100, 46));
+    BOOST_TEST( !im.bounding_box().valid() );
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ image premultiply: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
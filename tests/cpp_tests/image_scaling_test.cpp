@@ -0,0 +1,153 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_scaling.hpp>
+#include <mapnik/simd.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "agg_image_accessors.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_rasterizer_scanline_aa.h"
+#include "agg_renderer_scanline.h"
+#include "agg_rendering_buffer.h"
+#include "agg_scanline_u.h"
+#include "agg_span_allocator.h"
+#include "agg_span_image_filter_rgba.h"
+#include "agg_span_interpolator_linear.h"
+#include "agg_trans_affine.h"
+#include "agg_image_filters.h"
+
+// smooth premultiplied gradients with some noise and transparent patches
+void fill(mapnik::image_data_32 & im, unsigned seed)
+{
+    unsigned char * p = im.getBytes();
+    for (unsigned y = 0; y < im.height(); ++y)
+    {
+        for (unsigned x = 0; x < im.width(); ++x, p += 4)
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned noise = (seed >> 16) & 0x1f;
+            unsigned a = ((x / 7 + y / 5) % 4 == 0) ? 0 : std::min(255u, 120 + x * 3 + noise);
+            p[0] = static_cast<unsigned char>((((x * 11 + noise) & 0xff) * a) / 255);
+            p[1] = static_cast<unsigned char>((((y * 13) & 0xff) * a) / 255);
+            p[2] = static_cast<unsigned char>((((x * y + noise) & 0xff) * a) / 255);
+            p[3] = static_cast<unsigned char>(a);
+        }
+    }
+}
+
+// the agg span generators scale_image_agg used for every method before,
+// with pixels copied rather than blended onto the empty target, which
+// rounded translucent alpha up by one
+void reference(mapnik::image_data_32 & target, mapnik::image_data_32 const& source,
+               mapnik::scaling_method_e method, double ratio_x, double ratio_y)
+{
+    using pixfmt_pre = agg::pixfmt_rgba32_pre;
+    using img_src_type = agg::image_accessor_clone<pixfmt_pre>;
+    using interpolator_type = agg::span_interpolator_linear<>;
+    agg::rasterizer_scanline_aa<> ras;
+    agg::scanline_u8 sl;
+    agg::span_allocator<agg::rgba8> sa;
+    agg::rendering_buffer rbuf_src((unsigned char*)source.getBytes(), source.width(), source.height(), source.width() * 4);
+    pixfmt_pre pixf_src(rbuf_src);
+    img_src_type img_src(pixf_src);
+    agg::rendering_buffer rbuf_dst(target.getBytes(), target.width(), target.height(), target.width() * 4);
+    using blender_type = agg::comp_op_adaptor_rgba_pre<agg::rgba8, agg::order_rgba>;
+    using pixfmt_type = agg::pixfmt_custom_blend_rgba<blender_type, agg::rendering_buffer>;
+    pixfmt_type pixf_dst(rbuf_dst, agg::comp_op_src);
+    agg::renderer_base<pixfmt_type> rb(pixf_dst);
+    agg::trans_affine img_mtx;
+    img_mtx /= agg::trans_affine_scaling(ratio_x, ratio_y);
+    interpolator_type interpolator(img_mtx);
+    ras.move_to_d(0, 0);
+    ras.line_to_d(target.width(), 0);
+    ras.line_to_d(target.width(), target.height());
+    ras.line_to_d(0, target.height());
+    if (method == mapnik::SCALING_NEAR)
+    {
+        agg::span_image_filter_rgba_nn<img_src_type, interpolator_type> sg(img_src, interpolator);
+        agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+        return;
+    }
+    agg::image_filter_lut filter;
+    switch (method)
+    {
+    case mapnik::SCALING_BILINEAR: filter.calculate(agg::image_filter_bilinear(), true); break;
+    case mapnik::SCALING_BICUBIC: filter.calculate(agg::image_filter_bicubic(), true); break;
+    case mapnik::SCALING_SPLINE36: filter.calculate(agg::image_filter_spline36(), true); break;
+    case mapnik::SCALING_GAUSSIAN: filter.calculate(agg::image_filter_gaussian(), true); break;
+    case mapnik::SCALING_LANCZOS: filter.calculate(agg::image_filter_lanczos(2.0), true); break;
+    default: break;
+    }
+    agg::span_image_resample_rgba_affine<img_src_type> sg(img_src, interpolator, filter);
+    agg::render_scanlines_aa(ras, sl, rb, sa, sg);
+}
+
+int max_difference(mapnik::image_data_32 const& a, mapnik::image_data_32 const& b)
+{
+    unsigned char const* pa = a.getBytes();
+    unsigned char const* pb = b.getBytes();
+    int diff = 0;
+    for (std::size_t i = 0; i < std::size_t(a.width()) * a.height() * 4; ++i)
+    {
+        diff = std::max(diff, std::abs(int(pa[i]) - int(pb[i])));
+    }
+    return diff;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    mapnik::simd::level_e detected = mapnik::simd::detected_level();
+    mapnik::scaling_method_e methods[] = { mapnik::SCALING_NEAR, mapnik::SCALING_BILINEAR, mapnik::SCALING_BICUBIC,
+                                           mapnik::SCALING_SPLINE36, mapnik::SCALING_GAUSSIAN, mapnik::SCALING_LANCZOS };
+    // source size and target size
+    int sizes[][4] = { { 64, 48, 160, 120 }, { 97, 61, 31, 20 }, { 50, 50, 50, 173 }, { 300, 7, 29, 70 },
+                       { 1, 1, 9, 4 }, { 256, 256, 255, 257 } };
+
+    for (int level = mapnik::simd::SCALAR; level <= detected; ++level)
+    {
+        mapnik::simd::set_level(static_cast<mapnik::simd::level_e>(level));
+        for (auto const& size : sizes)
+        {
+            mapnik::image_data_32 src(size[0], size[1]);
+            fill(src, size[0] + size[2]);
+            double ratio_x = double(size[2]) / size[0];
+            double ratio_y = double(size[3]) / size[1];
+            for (mapnik::scaling_method_e method : methods)
+            {
+                mapnik::image_data_32 expected(size[2], size[3]);
+                mapnik::image_data_32 actual(size[2], size[3]);
+                reference(expected, src, method, ratio_x, ratio_y);
+                mapnik::scale_image_agg(actual, src, method, ratio_x, ratio_y, 0.0, 0.0, 2.0);
+                // only the rounding of the separable passes differs
+                int diff = max_difference(expected, actual);
+                bool close = method == mapnik::SCALING_NEAR ? diff == 0 : diff <= 1;
+                BOOST_TEST( close );
+                if (!close && !quiet)
+                {
+                    std::clog << "level " << level << " " << size[0] << "x" << size[1] << " -> " << size[2] << "x" << size[3]
+                              << " " << *mapnik::scaling_method_to_string(method) << ": " << diff << "\n";
+                }
+            }
+        }
+    }
+    mapnik::simd::set_level(detected);
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ image scaling: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,119 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_view.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/encoded_image_cache.hpp>
+#include <vector>
+#include <algorithm>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // a single differing pixel anywhere, in full blocks and in row tails
+        mapnik::image_data_32 im(77, 31);
+        im.set(0x80402010);
+        BOOST_TEST( mapnik::is_solid(im) );
+        bool all_found = true;
+        for (unsigned y = 0; y < im.height(); y += 5)
+        {
+            for (unsigned x = 0; x < im.width(); ++x)
+            {
+                im(x, y) = 0x80402011;
+                all_found = all_found && !mapnik::is_solid(im);
+                im(x, y) = 0x80402010;
+            }
+        }
+        BOOST_TEST( all_found );
+        BOOST_TEST( mapnik::is_solid(mapnik::image_data_32(0, 0)) );
+
+        // views only look at their own pixels
+        im(3, 4) = 0;
+        BOOST_TEST( mapnik::is_solid(mapnik::image_view<mapnik::image_data_32>(4, 5, 60, 20, im)) );
+        BOOST_TEST( !mapnik::is_solid(mapnik::image_view<mapnik::image_data_32>(3, 4, 60, 20, im)) );
+
+        // a view hashes like its pixels copied out, any change shows
+        for (unsigned y = 0; y < im.height(); ++y)
+        {
+            for (unsigned x = 0; x < im.width(); ++x)
+            {
+                im(x, y) = (x * 2654435761u) ^ (y * 40503u);
+            }
+        }
+        mapnik::image_view<mapnik::image_data_32> view(5, 2, 33, 17, im);
+        mapnik::image_data_32 copy(33, 17);
+        for (unsigned y = 0; y < copy.height(); ++y)
+        {
+            for (unsigned x = 0; x < copy.width(); ++x)
+            {
+                copy(x, y) = im(x + 5, y + 2);
+            }
+        }
+        BOOST_TEST_EQ( mapnik::image_hash(view), mapnik::image_hash(copy) );
+        std::uint64_t hash = mapnik::image_hash(copy);
+        copy(32, 16) ^= 1;
+        BOOST_TEST( mapnik::image_hash(copy) != hash );
+        BOOST_TEST( mapnik::image_hash(mapnik::image_data_32(16, 8)) != mapnik::image_hash(mapnik::image_data_32(8, 16)) );
+
+        // cached encodings of solid images are byte for byte the uncached ones
+        mapnik::encoded_image_cache & cache = mapnik::encoded_image_cache::instance();
+        std::size_t max_size = cache.max_size();
+        mapnik::image_data_32 solid(256, 256);
+        std::vector<std::uint32_t> colors = { 0x00000000u, 0xff336699u, 0x80402010u };
+        std::vector<std::string> formats = { "png", "png8:m=h", "png8:m=o:z=1", "PNG32:t=0" };
+        std::vector<std::string> expected;
+        cache.set_max_size(0);
+        for (std::uint32_t color : colors)
+        {
+            solid.set(color);
+            for (std::string const& format : formats)
+            {
+                expected.push_back(mapnik::save_to_string(solid, format));
+            }
+        }
+        BOOST_TEST_EQ( cache.size(), 0u );
+        cache.set_max_size(max_size);
+        for (unsigned pass = 0; pass < 2; ++pass)
+        {
+            std::size_t i = 0;
+            for (std::uint32_t color : colors)
+            {
+                solid.set(color);
+                for (std::string const& format : formats)
+                {
+                    BOOST_TEST( mapnik::save_to_string(solid, format) == expected[i++] );
+                }
+            }
+            BOOST_TEST_EQ( cache.size(), expected.size() );
+        }
+        // other sizes get their own entry, busy images none
+        BOOST_TEST( mapnik::save_to_string(mapnik::image_data_32(255, 256), "png") !=
+                    mapnik::save_to_string(mapnik::image_data_32(256, 256), "png") );
+        BOOST_TEST( mapnik::save_to_string(im, "png") != mapnik::save_to_string(solid, "png") );
+        BOOST_TEST_EQ( cache.size(), expected.size() + 1 );
+        cache.clear();
+        BOOST_TEST_EQ( cache.size(), 0u );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ solid images: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,82 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/label_collision_detector.hpp>
+#include <mapnik/unicode.hpp>
+#include <vector>
+#include <algorithm>
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    mapnik::box2d<double> extent(-10, -10, 266, 266);
+    mapnik::transcoder tr("utf-8");
+    mapnik::value_unicode_string a = tr.transcode("a");
+    mapnik::value_unicode_string b = tr.transcode("b");
+
+    for (double cell_size : { 0.0, 16.0, mapnik::label_collision_detector4::default_cell_size(extent) })
+    {
+        mapnik::label_collision_detector4 detector(extent, cell_size);
+        BOOST_TEST( detector.cell_size() == cell_size );
+        BOOST_TEST( detector.extent() == extent );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(0, 0, 10, 10)) );
+        detector.insert(mapnik::box2d<double>(0, 0, 10, 10), a);
+        BOOST_TEST( !detector.has_placement(mapnik::box2d<double>(5, 5, 15, 15)) );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(11, 0, 20, 10)) );
+
+        // margin
+        BOOST_TEST( !detector.has_placement(mapnik::box2d<double>(11, 0, 20, 10), 2.0) );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(13, 0, 20, 10), 2.0) );
+
+        // repeat distance only applies to labels with the same text
+        BOOST_TEST( !detector.has_placement(mapnik::box2d<double>(40, 0, 50, 10), 2.0, a, 50.0) );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(40, 0, 50, 10), 2.0, b, 50.0) );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(70, 0, 80, 10), 2.0, a, 50.0) );
+
+        // boxes partly or entirely outside of the extent
+        detector.insert(mapnik::box2d<double>(-40, 200, -20, 400));
+        BOOST_TEST( !detector.has_placement(mapnik::box2d<double>(-30, 250, -5, 500)) );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(-15, 300, 0, 500)) );
+        detector.insert(mapnik::box2d<double>(250, 250, 300, 300));
+        BOOST_TEST( !detector.has_placement(mapnik::box2d<double>(260, 260, 262, 262)) );
+
+        BOOST_TEST_EQ( std::distance(detector.begin(), detector.end()), 3 );
+        detector.clear();
+        BOOST_TEST( detector.begin() == detector.end() );
+        BOOST_TEST( detector.has_placement(mapnik::box2d<double>(5, 5, 15, 15)) );
+    }
+
+    // grid and quad tree agree on a dense sequence of placements
+    mapnik::label_collision_detector4 quad_tree(extent);
+    mapnik::label_collision_detector4 grid(extent, 16.0);
+    std::size_t placed = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        double x = (i * 37) % 290 - 20;
+        double y = (i * 53) % 290 - 20;
+        mapnik::box2d<double> box(x, y, x + 5 + i % 40, y + 8);
+        mapnik::value_unicode_string const& text = (i % 3) ? a : b;
+        bool expected = quad_tree.has_placement(box, 1.0, text, 30.0);
+        BOOST_TEST_EQ( grid.has_placement(box, 1.0, text, 30.0), expected );
+        if (expected)
+        {
+            quad_tree.insert(box, text);
+            grid.insert(box, text);
+            ++placed;
+        }
+    }
+    BOOST_TEST( placed > 0 );
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ label collision detector: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,99 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/lru_cache.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+using string_ptr = std::shared_ptr<std::string const>;
+
+struct string_length
+{
+    std::size_t operator()(int, string_ptr const& value) const
+    {
+        return value->size();
+    }
+};
+
+string_ptr make(std::string const& value)
+{
+    return std::make_shared<std::string const>(value);
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // bounded by the number of entries, least recently used out first
+        mapnik::lru_cache<int, string_ptr> cache(2);
+        cache.insert(1, make("a"));
+        cache.insert(2, make("b"));
+        BOOST_TEST( cache.find(1) && *cache.find(1) == "a" );
+        cache.insert(3, make("c"));
+        BOOST_TEST( cache.find(1) );
+        BOOST_TEST( !cache.find(2) );
+        BOOST_TEST( cache.find(3) );
+        BOOST_TEST_EQ( cache.entries(), 2u );
+        BOOST_TEST_EQ( cache.size(), 2u );
+        mapnik::lru_cache_stats stats = cache.stats();
+        BOOST_TEST_EQ( stats.hits, 4u );
+        BOOST_TEST_EQ( stats.misses, 1u );
+        BOOST_TEST_EQ( stats.evictions, 1u );
+
+        // empty values are not stored, a second insert replaces the first
+        cache.insert(4, string_ptr());
+        BOOST_TEST( !cache.find(4) );
+        cache.insert(3, make("d"));
+        BOOST_TEST_EQ( *cache.find(3), std::string("d") );
+        BOOST_TEST_EQ( cache.entries(), 2u );
+
+        // shrinking evicts, 0 disables
+        cache.set_max_size(1);
+        BOOST_TEST_EQ( cache.entries(), 1u );
+        BOOST_TEST( cache.find(3) );
+        cache.set_max_size(0);
+        BOOST_TEST_EQ( cache.entries(), 0u );
+        cache.insert(5, make("e"));
+        BOOST_TEST( !cache.find(5) );
+        cache.clear();
+        stats = cache.stats();
+        BOOST_TEST_EQ( stats.hits + stats.misses + stats.evictions, 0u );
+
+        // bounded by the sum of entry sizes
+        mapnik::lru_cache<int, string_ptr, std::hash<int>, string_length> sized(10);
+        sized.insert(1, make("aaaa"));
+        sized.insert(2, make("bbbb"));
+        BOOST_TEST_EQ( sized.size(), 8u );
+        sized.insert(3, make("cccc"));
+        BOOST_TEST_EQ( sized.size(), 8u );
+        BOOST_TEST( !sized.find(1) );
+        // replacing an entry accounts for the old size
+        sized.insert(3, make("cc"));
+        BOOST_TEST_EQ( sized.size(), 6u );
+        // an entry larger than the whole cache is not stored and flushes nothing
+        sized.insert(4, make("dddddddddddd"));
+        BOOST_TEST( !sized.find(4) );
+        BOOST_TEST_EQ( sized.entries(), 2u );
+    }
+    catch (std::exception const & ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST(false);
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ lru cache: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
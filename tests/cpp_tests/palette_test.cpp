@@ -0,0 +1,131 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/palette.hpp>
+#include <mapnik/hextree.hpp>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <thread>
+
+// brute force nearest color, ties resolved in the order of the sorted
+// palette search and exact colors mapping to their last duplicate
+unsigned reference(std::vector<mapnik::rgba> const& sorted, unsigned val)
+{
+    mapnik::rgba c(val);
+    auto dist = [&](unsigned i) {
+        int dr = sorted[i].r - c.r;
+        int dg = sorted[i].g - c.g;
+        int db = sorted[i].b - c.b;
+        int da = sorted[i].a - c.a;
+        return dr*dr + dg*dg + db*db + da*da;
+    };
+    unsigned poz = std::lower_bound(sorted.begin(), sorted.end(), c, mapnik::rgba::mean_sort_cmp()) - sorted.begin();
+    if (poz == sorted.size()) --poz;
+    unsigned best = poz;
+    for (int i = poz; i >= 0; --i)
+    {
+        if (dist(i) < dist(best)) best = i;
+    }
+    for (unsigned i = poz + 1; i < sorted.size(); ++i)
+    {
+        if (dist(i) < dist(best)) best = i;
+    }
+    if (dist(best) == 0)
+    {
+        while (best + 1 < sorted.size() && sorted[best + 1] == c) ++best;
+    }
+    return best;
+}
+
+bool check(mapnik::rgba_palette const& pal, std::vector<mapnik::rgba> const& sorted,
+           unsigned seed, unsigned count)
+{
+    bool ok = true;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        // few distinct colors, so that the lookup table is hit as well
+        unsigned val = (seed & 0xc7c7c7c7) | ((seed >> 7) & 0x01010101);
+        ok = ok && pal.quantize(val) == (val == 0 ? 0 : reference(sorted, val));
+    }
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // random palette with duplicates and translucent entries
+        std::string str;
+        std::vector<mapnik::rgba> sorted;
+        unsigned seed = 3;
+        for (unsigned i = 0; i < 200; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            mapnik::rgba c((seed >> 8) & 0xc7, (seed >> 16) & 0xc7, (seed >> 24) & 0xc7,
+                           i % 4 ? 0xff : (seed & 0xc7));
+            for (unsigned k = 0; k < (i % 50 ? 1u : 3u); ++k)
+            {
+                str += std::string() + char(c.r) + char(c.g) + char(c.b) + char(c.a);
+                sorted.push_back(c);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(), mapnik::rgba::mean_sort_cmp());
+        mapnik::rgba_palette pal(str);
+
+        for (mapnik::rgba const& c : sorted)
+        {
+            unsigned val = c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
+            BOOST_TEST_EQ( unsigned(pal.quantize(val)), val == 0 ? 0 : reference(sorted, val) );
+        }
+        BOOST_TEST( check(pal, sorted, 1, 200000) );
+
+        // the lookup table is shared between threads
+        std::vector<std::thread> threads;
+        bool results[4];
+        for (unsigned t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t]() { results[t] = check(pal, sorted, 1 + t % 2, 100000); });
+        }
+        for (auto & thread : threads) thread.join();
+        BOOST_TEST( std::all_of(results, results + 4, [](bool r) { return r; }) );
+
+        // counted inserts build the same palette as single pixel ones
+        mapnik::hextree<mapnik::rgba> single(64);
+        mapnik::hextree<mapnik::rgba> counted(64);
+        for (unsigned i = 0; i < 3000; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            mapnik::rgba c((seed >> 8) & 0xe3, (seed >> 16) & 0xe3, (seed >> 24) & 0xe3, seed & 0x83);
+            unsigned repeat = 1 + (seed >> 29);
+            for (unsigned k = 0; k < repeat; ++k) single.insert(c);
+            counted.insert(c, repeat);
+        }
+        std::vector<mapnik::rgba> single_pal;
+        std::vector<mapnik::rgba> counted_pal;
+        single.create_palette(single_pal);
+        counted.create_palette(counted_pal);
+        BOOST_TEST( single_pal == counted_pal );
+        BOOST_TEST( single_pal.size() > 16 );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ palette quantization: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
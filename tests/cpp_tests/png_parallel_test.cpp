@@ -0,0 +1,113 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/image_data.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/image_reader.hpp>
+#include <mapnik/parallel_png.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+// smooth gradients with some noise, so chunks neither compress to nothing
+// nor stay uncompressed
+void fill(mapnik::image_data_32 & im, bool opaque)
+{
+    unsigned seed = 17;
+    for (unsigned y = 0; y < im.height(); ++y)
+    {
+        for (unsigned x = 0; x < im.width(); ++x)
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned noise = (seed >> 16) & 0x7;
+            unsigned a = opaque ? 255 : ((x + y) & 0xff);
+            unsigned r = std::min(a, (x + noise) & 0xff);
+            unsigned g = std::min(a, (y * 2) & 0xff);
+            unsigned b = std::min(a, ((x ^ y) + noise) & 0xff);
+            im(x, y) = (a << 24) | (b << 16) | (g << 8) | r;
+        }
+    }
+}
+
+bool decode(std::string const& data, mapnik::image_data_32 & out)
+{
+    std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(data.data(), data.size()));
+    if (!reader || reader->width() != out.width() || reader->height() != out.height()) return false;
+    reader->read(0, 0, out);
+    return true;
+}
+
+// the parallel encoder must decode to exactly what libpng's encoding decodes to
+bool same_decoded(mapnik::image_data_32 const& im, std::string const& format, std::string const& options)
+{
+    mapnik::image_data_32 expected(im.width(), im.height());
+    mapnik::image_data_32 actual(im.width(), im.height());
+    if (!decode(mapnik::save_to_string(im, format), expected)) return false;
+    if (!decode(mapnik::save_to_string(im, format + options), actual)) return false;
+    return std::equal(expected.getData(), expected.getData() + im.width() * im.height(), actual.getData());
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // from a single chunk to a dozen, with a last chunk of a few rows
+        for (unsigned height : { 1u, 3u, 130u, 517u })
+        {
+            for (bool opaque : { true, false })
+            {
+                mapnik::image_data_32 im(601, height);
+                fill(im, opaque);
+                for (std::string const& options : { ":p=0", ":p=2", ":p=5:z=1", ":p=3:z=9", ":p=4:z=0", ":p=2:s=rle" })
+                {
+                    BOOST_TEST( same_decoded(im, "png32", options) );
+                    BOOST_TEST( same_decoded(im, "png32:t=0", options) );
+                    BOOST_TEST( same_decoded(im, "png8:m=h", options) );
+                    BOOST_TEST( same_decoded(im, "png8:m=o:c=16", options) );
+                }
+            }
+        }
+
+        // the compression level is honoured, and chunking costs little
+        mapnik::image_data_32 im(601, 517);
+        fill(im, false);
+        std::size_t serial = mapnik::save_to_string(im, "png32:z=6").size();
+        std::size_t fast = mapnik::save_to_string(im, "png32:p=4:z=1").size();
+        std::size_t parallel = mapnik::save_to_string(im, "png32:p=4:z=6").size();
+        BOOST_TEST( parallel < fast );
+        BOOST_TEST( parallel < serial + serial / 50 );
+
+        try
+        {
+            mapnik::save_to_string(im, "png32:p=2:e=miniz");
+            BOOST_TEST( false );
+        }
+        catch (std::exception const&) {}
+        try
+        {
+            mapnik::save_to_string(im, "png32:p=-1");
+            BOOST_TEST( false );
+        }
+        catch (std::exception const&) {}
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ parallel png: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
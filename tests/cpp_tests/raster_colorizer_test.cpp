@@ -0,0 +1,100 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/raster.hpp>
+#include <mapnik/raster_colorizer.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+std::shared_ptr<mapnik::raster> make_raster(std::vector<float> const& values)
+{
+    auto r = std::make_shared<mapnik::raster>(mapnik::box2d<double>(0, 0, 1, 1), values.size(), 1, 1.0);
+    std::memcpy(r->data_.getData(), values.data(), values.size() * sizeof(float));
+    return r;
+}
+
+// colorize must give exactly what get_color gives pixel by pixel
+bool check(mapnik::raster_colorizer const& colorizer, std::vector<float> const& values,
+           boost::optional<double> const& nodata, mapnik::feature_impl const& f)
+{
+    auto r = make_raster(values);
+    if (nodata) r->set_nodata(*nodata);
+    colorizer.colorize(r, f);
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        unsigned expected = (nodata && std::fabs(values[i] - *nodata) < colorizer.get_epsilon())
+            ? 0 : colorizer.get_color(values[i]);
+        if (r->data_(i, 0) != expected) return false;
+    }
+    return true;
+}
+
+std::vector<float> range(int first, int last, float step = 1.0f)
+{
+    std::vector<float> values;
+    for (float v = first; v <= last; v += step) values.push_back(v);
+    return values;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx,1));
+
+    mapnik::raster_colorizer colorizer(mapnik::COLORIZER_LINEAR, mapnik::color(10,20,30,40));
+    colorizer.add_stop(mapnik::colorizer_stop(-1000, mapnik::COLORIZER_DISCRETE, mapnik::color(255,0,0,255)));
+    colorizer.add_stop(mapnik::colorizer_stop(3, mapnik::COLORIZER_EXACT, mapnik::color(0,255,0,255)));
+    colorizer.add_stop(mapnik::colorizer_stop(7, mapnik::COLORIZER_INHERIT, mapnik::color(0,0,255,128)));
+    colorizer.add_stop(mapnik::colorizer_stop(200, mapnik::COLORIZER_LINEAR, mapnik::color(255,255,255,255)));
+    colorizer.add_stop(mapnik::colorizer_stop(30000, mapnik::COLORIZER_LINEAR, mapnik::color(0,0,0,0)));
+
+    boost::optional<double> none;
+    std::vector<std::vector<float> > inputs = {
+        range(0, 255),          // 8 bit
+        range(0, 65535),        // unsigned 16 bit
+        range(-32768, 32767),   // signed 16 bit
+        range(-2000, 2000, 0.25f), // float
+        { -0.0f, 1e9f, std::numeric_limits<float>::quiet_NaN(), 5.0f }
+    };
+    for (auto const& values : inputs)
+    {
+        BOOST_TEST( check(colorizer, values, none, *feature) );
+        BOOST_TEST( check(colorizer, values, boost::optional<double>(7), *feature) );
+        BOOST_TEST( check(colorizer, values, boost::optional<double>(-9999.5), *feature) );
+    }
+
+    // nodata outside the integer range keeps the table path for the rest
+    std::vector<float> dem = range(0, 300);
+    dem.push_back(-3.4e38f);
+    BOOST_TEST( check(colorizer, dem, boost::optional<double>(-3.4e38f), *feature) );
+
+    // tables are rebuilt when the colorizer changes, also through get_stops
+    std::vector<float> byte = range(0, 255);
+    BOOST_TEST( check(colorizer, byte, none, *feature) );
+    const_cast<mapnik::colorizer_stops &>(colorizer.get_stops())[1].set_color(mapnik::color(1,2,3,4));
+    BOOST_TEST( check(colorizer, byte, none, *feature) );
+    colorizer.set_default_color(mapnik::color(50,60,70,80));
+    BOOST_TEST( check(colorizer, byte, none, *feature) );
+    colorizer.set_epsilon(1.5f);
+    BOOST_TEST( check(colorizer, byte, boost::optional<double>(100), *feature) );
+    colorizer.set_default_mode(mapnik::COLORIZER_DISCRETE);
+    BOOST_TEST( check(colorizer, byte, boost::optional<double>(100), *feature) );
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ raster colorizer: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
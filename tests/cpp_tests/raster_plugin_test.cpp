@@ -0,0 +1,184 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/datasource.hpp>
+#include <mapnik/datasource_cache.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/query.hpp>
+#include <mapnik/raster.hpp>
+#include <mapnik/raster_tile_cache.hpp>
+#include <mapnik/image_reader.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/image_view.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "utils.hpp"
+
+// the pixels of a raster feature are those of the file at x,y
+bool same_pixels(mapnik::image_data_32 const& full, mapnik::raster const& r, unsigned x, unsigned y)
+{
+    if (x + r.data_.width() > full.width() || y + r.data_.height() > full.height()) return false;
+    for (unsigned j = 0; j < r.data_.height(); ++j)
+    {
+        for (unsigned i = 0; i < r.data_.width(); ++i)
+        {
+            if (r.data_(i, j) != full(x + i, y + j)) return false;
+        }
+    }
+    return true;
+}
+
+struct decoded_raster
+{
+    mapnik::box2d<double> extent;
+    mapnik::image_data_32 data;
+};
+
+// every raster of a query, in the order the featureset hands them out
+std::vector<decoded_raster> rasters(mapnik::datasource_ptr const& ds, mapnik::query const& q)
+{
+    mapnik::raster_tile_cache::instance().clear();
+    std::vector<decoded_raster> result;
+    mapnik::featureset_ptr fs = ds->features(q);
+    mapnik::feature_ptr feature;
+    while (fs && (feature = fs->next()))
+    {
+        mapnik::raster_ptr r = feature->get_raster();
+        if (r) result.push_back({ r->ext_, r->data_ });
+    }
+    return result;
+}
+
+bool same_rasters(std::vector<decoded_raster> const& a, std::vector<decoded_raster> const& b)
+{
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        if (!(a[i].extent == b[i].extent) ||
+            a[i].data.width() != b[i].data.width() ||
+            a[i].data.height() != b[i].data.height() ||
+            !std::equal(a[i].data.getData(), a[i].data.getData() + a[i].data.width() * a[i].data.height(),
+                        b[i].data.getData()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+#if defined(HAVE_TIFF)
+        std::string file("./tests/data/raster/river_merc.tiff");
+        mapnik::datasource_cache::instance().register_datasources("plugins/input/");
+        mapnik::raster_tile_cache & cache = mapnik::raster_tile_cache::instance();
+        cache.clear();
+
+        std::unique_ptr<mapnik::image_reader> reader(mapnik::get_image_reader(file, "tiff"));
+        mapnik::image_data_32 full(reader->width(), reader->height());
+        reader->read(0, 0, full);
+        BOOST_TEST( full.width() == 969 && full.height() == 793 );
+
+        mapnik::parameters p;
+        p["type"] = "raster";
+        p["file"] = file;
+        p["format"] = "tiff";
+        p["extent"] = "0,0,969,793";
+        mapnik::datasource_ptr ds = mapnik::datasource_cache::instance().create(p);
+
+        // a small window of a single file is read on its own, not as part of a
+        // cached tile as large as the whole image
+        mapnik::query q(mapnik::box2d<double>(100, 100, 300, 250), mapnik::query::resolution_type(1.0, 1.0));
+        mapnik::featureset_ptr fs = ds->features(q);
+        mapnik::feature_ptr feature = fs ? fs->next() : mapnik::feature_ptr();
+        mapnik::raster_ptr r = feature ? feature->get_raster() : mapnik::raster_ptr();
+        BOOST_TEST( r && r->data_.width() == 200 && r->data_.height() == 150 );
+        BOOST_TEST( r && same_pixels(full, *r, 100, 793 - 250) );
+        mapnik::raster_tile_cache_stats stats = cache.stats();
+        BOOST_TEST( stats.tiles == 0 && stats.misses == 0 && stats.bytes == 0 );
+
+        // windows of the tiles of larger queries go through the cache
+        mapnik::query all(ds->envelope(), mapnik::query::resolution_type(1.0, 1.0));
+        unsigned features = 0;
+        for (unsigned pass = 0; pass < 2; ++pass)
+        {
+            fs = ds->features(all);
+            while ((feature = fs->next()))
+            {
+                if (feature->get_raster()) ++features;
+            }
+        }
+        stats = cache.stats();
+        BOOST_TEST( features > 2 && stats.tiles > 0 );
+        BOOST_TEST_EQ( stats.misses, stats.tiles );
+        BOOST_TEST_EQ( stats.hits, stats.misses );
+        cache.clear();
+
+        // a multi-file pyramid of 3x3 tiles cut from the same file decodes the
+        // same with one and with several threads
+        boost::filesystem::path root = boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path("mapnik-raster-%%%%-%%%%");
+        for (unsigned x = 0; x < 3; ++x)
+        {
+            for (unsigned y = 0; y < 3; ++y)
+            {
+                boost::filesystem::path dir = root / "000" / "000" / ("00" + std::to_string(x)) / "000" / "000";
+                boost::filesystem::create_directories(dir);
+                mapnik::image_view<mapnik::image_data_32> tile(x * 256, y * 256, 256, 256, full);
+                mapnik::save_to_file(tile, (dir / ("00" + std::to_string(y) + ".tif")).string(), "tiff");
+            }
+        }
+        p["file"] = (root / "${x}" / "${y}.tif").string();
+        p["multi"] = true;
+        p["tile_size"] = 256;
+        p["x_width"] = 3;
+        p["y_width"] = 3;
+        p["extent"] = "0,0,768,768";
+        std::vector<mapnik::query> queries = {
+            mapnik::query(mapnik::box2d<double>(0, 0, 768, 768), mapnik::query::resolution_type(1.0, 1.0)),
+            mapnik::query(mapnik::box2d<double>(100, 50, 700, 600), mapnik::query::resolution_type(1.0, 1.0)),
+            mapnik::query(mapnik::box2d<double>(0, 0, 768, 768), mapnik::query::resolution_type(0.25, 0.25)) };
+        p["decode_threads"] = 1;
+        mapnik::datasource_ptr sequential = mapnik::datasource_cache::instance().create(p);
+        for (mapnik::value_integer threads : { 2, 4, 16 })
+        {
+            p["decode_threads"] = threads;
+            mapnik::datasource_ptr concurrent = mapnik::datasource_cache::instance().create(p);
+            for (mapnik::query const& query : queries)
+            {
+                std::vector<decoded_raster> expected = rasters(sequential, query);
+                BOOST_TEST( expected.size() == 9 || (expected.size() > 1 && &query == &queries[1]) );
+                BOOST_TEST( same_rasters(rasters(concurrent, query), expected) );
+            }
+        }
+        boost::filesystem::remove_all(root);
+        cache.clear();
+#endif
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ raster plugin: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,109 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/raster_tile_cache.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+
+mapnik::raster_tile_key key(unsigned x, unsigned y, unsigned reduction = 1)
+{
+    return mapnik::raster_tile_key { "tiles/a.jpg", x, y, reduction };
+}
+
+mapnik::raster_tile_ptr tile(unsigned size)
+{
+    return std::make_shared<mapnik::raster_tile>(size, size, false);
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        mapnik::raster_tile_cache & cache = mapnik::raster_tile_cache::instance();
+        std::size_t max_bytes = cache.max_bytes();
+        cache.clear();
+
+        // bounded by pixel bytes, least recently used tiles go first
+        cache.set_max_bytes(3 * 64 * 64 * 4);
+        cache.insert(key(0, 0), tile(64));
+        cache.insert(key(64, 0), tile(64));
+        cache.insert(key(0, 64), tile(64));
+        BOOST_TEST( cache.find(key(0, 0)) );
+        cache.insert(key(64, 64), tile(64));
+        BOOST_TEST( cache.find(key(0, 0)) );
+        BOOST_TEST( !cache.find(key(64, 0)) );
+        BOOST_TEST( cache.find(key(0, 64)) );
+        BOOST_TEST( cache.find(key(64, 64)) );
+        BOOST_TEST( !cache.find(key(0, 0, 2)) );
+        mapnik::raster_tile_cache_stats stats = cache.stats();
+        BOOST_TEST_EQ( stats.tiles, 3u );
+        BOOST_TEST_EQ( stats.bytes, 3u * 64 * 64 * 4 );
+        BOOST_TEST_EQ( stats.hits, 4u );
+        BOOST_TEST_EQ( stats.misses, 2u );
+        BOOST_TEST_EQ( stats.evictions, 1u );
+
+        // replacing a tile keeps the byte count, larger ones make room
+        cache.insert(key(0, 64), tile(64));
+        BOOST_TEST_EQ( cache.stats().bytes, 3u * 64 * 64 * 4 );
+        cache.insert(key(0, 128), tile(90));
+        stats = cache.stats();
+        BOOST_TEST_EQ( stats.tiles, 2u );
+        BOOST_TEST( stats.bytes <= cache.max_bytes() );
+
+        // tiles larger than the whole cache are not kept
+        cache.insert(key(0, 256), tile(128));
+        BOOST_TEST( !cache.find(key(0, 256)) );
+        BOOST_TEST_EQ( cache.stats().tiles, 2u );
+        cache.set_max_bytes(0);
+        BOOST_TEST_EQ( cache.stats().tiles, 0u );
+        BOOST_TEST_EQ( cache.stats().bytes, 0u );
+
+        // shared between threads
+        cache.clear();
+        cache.set_max_bytes(50 * 16 * 16 * 4);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&cache, t]() {
+                for (unsigned i = 0; i < 2000; ++i)
+                {
+                    mapnik::raster_tile_key k = key((i * 7 + t) % 100, 0);
+                    mapnik::raster_tile_ptr found = cache.find(k);
+                    if (!found) cache.insert(k, tile(16));
+                }
+            });
+        }
+        for (auto & thread : threads) thread.join();
+        stats = cache.stats();
+        BOOST_TEST_EQ( stats.hits + stats.misses, 8000u );
+        BOOST_TEST_EQ( stats.tiles, 50u );
+        BOOST_TEST_EQ( stats.bytes, 50u * 16 * 16 * 4 );
+
+        cache.clear();
+        stats = cache.stats();
+        BOOST_TEST( stats.tiles == 0 && stats.bytes == 0 && stats.hits == 0 && stats.misses == 0 );
+        cache.set_max_bytes(max_bytes);
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ raster tile cache: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
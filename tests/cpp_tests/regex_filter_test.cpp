@@ -0,0 +1,99 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/expression_node.hpp>
+#include <mapnik/value.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/attribute.hpp>
+#if defined(BOOST_REGEX_HAS_ICU)
+#include <boost/regex/icu.hpp>
+#else
+#include <boost/regex.hpp>
+#endif
+#include <vector>
+#include <algorithm>
+#include <string>
+
+// the prefiltered nodes against the regex engine on its own
+bool same_results(mapnik::transcoder const& tr, std::string const& pattern,
+                  std::vector<std::string> const& inputs)
+{
+#if defined(BOOST_REGEX_HAS_ICU)
+    boost::u32regex re;
+    try { re = boost::make_u32regex(tr.transcode(pattern.c_str())); }
+#else
+    boost::regex re;
+    try { re = boost::regex(pattern); }
+#endif
+    catch (std::exception const&) { return true; } // not a pattern this engine takes
+    mapnik::regex_match_node match(tr, mapnik::attribute("name"), pattern);
+    mapnik::regex_replace_node replace(tr, mapnik::attribute("name"), pattern, "<$&>");
+    bool ok = true;
+    for (std::string const& input : inputs)
+    {
+        mapnik::value val = tr.transcode(input.c_str());
+#if defined(BOOST_REGEX_HAS_ICU)
+        bool expected = boost::u32regex_match(val.to_unicode(), re);
+        std::string expected_replaced;
+        mapnik::to_utf8(boost::u32regex_replace(val.to_unicode(), re, tr.transcode("<$&>")), expected_replaced);
+#else
+        bool expected = boost::regex_match(input, re);
+        std::string expected_replaced = boost::regex_replace(input, re, std::string("<$&>"));
+#endif
+        if (match.apply(val).to_bool() != expected || replace.apply(val).to_string() != expected_replaced)
+        {
+            std::clog << "'" << pattern << "' on '" << input << "' differs\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        mapnik::transcoder tr("utf-8");
+        std::vector<std::string> inputs = { "", "Abc", "41bc", "101bc", "Axyz", "\x01xyz", "cAxyz",
+                                            "xyz", "Lbc", "pLbc", "a.b", "a.bb", "Qa.bEb", "a12b",
+                                            "ab", "foo.png", "foo_png", "11x", "12x", "x41", "A A",
+                                            "abcabc", "abc\n", "a\tb", "uAbc", "u0041bc", "foo",
+                                            "foo bar", "xfoo", "<foo>", "`foo'" };
+        // escapes taking arguments or standing for assertions, mixed with
+        // literals on either side
+        std::vector<std::string> patterns = { "\\x41bc", "\\x{41}bc", "ab\\x41", "\\0101bc", "\\101bc",
+                                              "\\cAxyz", "x\\cA", "\\pLbc", "\\p{Lu}bc", "\\PLbc",
+                                              "\\N{A}bc", "\\Qa.b\\Eb", "(\\Qa)\\E)b", "a\\Q.b",
+                                              "\\u0041bc", "\\UAbc", "(\\d)\\1x", "(A) \\1", "\\k<1>x",
+                                              "a\\d+b", "a\\db", "\\w+\\.png", "foo\\.png", "a\\.b",
+                                              "\\Aabc", "abc\\z", "abc\\Z", "abc\\b", "a\\tb",
+                                              "[\\x41]bc", "[\\]x]41", "abc", "^abc$", "(abc)+",
+                                              "\\<foo\\>", "foo\\>", "\\`foo\\'", "\\<foo", "\\<foo\\> bar",
+                                              "x\\<foo", "\\<\\w+\\>", "\\<foo\\>.*" };
+        bool all_same = true;
+        for (std::string const& pattern : patterns)
+        {
+            all_same = same_results(tr, pattern, inputs) && all_same;
+        }
+        BOOST_TEST( all_same );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ regex filters: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
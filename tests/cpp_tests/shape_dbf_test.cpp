@@ -0,0 +1,131 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/feature.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/value.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "../../plugins/input/shape/dbfile.hpp"
+
+struct dbf_field
+{
+    std::string name;
+    char type;
+    unsigned length;
+    unsigned dec;
+};
+
+// a dbase III file, records given as the raw bytes of their fields
+void write_dbf(std::string const& file, std::vector<dbf_field> const& fields,
+               std::vector<std::string> const& records)
+{
+    unsigned record_length = 0;
+    for (auto const& field : fields) record_length += field.length;
+    unsigned header_length = 33 + 32 * fields.size();
+    std::string header(32, '\0');
+    header[0] = '\3';
+    header[4] = static_cast<char>(records.size());
+    header[8] = static_cast<char>(header_length & 0xff);
+    header[9] = static_cast<char>(header_length >> 8);
+    header[10] = static_cast<char>((record_length + 1) & 0xff);
+    header[11] = static_cast<char>((record_length + 1) >> 8);
+    std::ofstream out(file.c_str(), std::ios::out | std::ios::binary);
+    out << header;
+    for (auto const& field : fields)
+    {
+        std::string descriptor(32, '\0');
+        descriptor.replace(0, field.name.size(), field.name);
+        descriptor[11] = field.type;
+        descriptor[16] = static_cast<char>(field.length);
+        descriptor[17] = static_cast<char>(field.dec);
+        out << descriptor;
+    }
+    out << '\r';
+    for (auto const& record : records)
+    {
+        out << ' ' << record;
+    }
+    out << '\x1a';
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        // built as configured and, as *-unmapped-bin, reading through a
+        // stream instead of a memory mapping: both decode the same values
+        std::vector<dbf_field> fields = { { "NAME", 'C', 12, 0 }, { "CODE", 'C', 6, 0 },
+                                          { "POP", 'N', 8, 0 }, { "AREA", 'N', 10, 2 },
+                                          { "OK", 'L', 1, 0 }, { "DAY", 'D', 8, 0 } };
+        std::vector<std::string> records = {
+            std::string("  Berlin    " "DE\0xyz" " 3500000" "    891.25" "T" "20141019", 45),
+            std::string("K\xc3\xb6ln\0\0\0\0\0\0\0" "\0\0\0\0\0\0" "********" "     -1.50" "?" "        ", 45),
+            std::string("Main\0Street " "  ab  " "      -7" "      0.00" "n" "2014\0   ", 45),
+            std::string("            " "\0  cd " "       0" "         1" "Y" "\t2014\t\t\t", 45) };
+        std::string file = (boost::filesystem::temp_directory_path() /
+                            boost::filesystem::unique_path("mapnik-dbf-%%%%-%%%%.dbf")).string();
+        write_dbf(file, fields, records);
+
+        mapnik::transcoder tr("utf-8");
+        std::vector<std::vector<mapnik::value> > expected = {
+            { tr.transcode_utf8("Berlin"), tr.transcode_utf8("DE"), mapnik::value_integer(3500000), 891.25, true, tr.transcode_utf8("20141019") },
+            { tr.transcode_utf8("Köln"), tr.transcode_utf8(""), mapnik::value_null(), -1.5, false, tr.transcode_utf8("") },
+            { tr.transcode_utf8("Main"), tr.transcode_utf8("ab"), mapnik::value_integer(-7), 0.0, false, tr.transcode_utf8("2014") },
+            { tr.transcode_utf8(""), tr.transcode_utf8(""), mapnik::value_integer(0), 1.0, true, tr.transcode_utf8("2014") } };
+        {
+            dbf_file dbf(file);
+            BOOST_TEST( dbf.is_open() );
+            BOOST_TEST_EQ( dbf.num_records(), 4 );
+            BOOST_TEST_EQ( dbf.num_fields(), 6 );
+            mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+            for (auto const& field : fields) ctx->push(field.name);
+            bool same = true;
+            // out of order, as an index walks the records
+            for (int id : { 3, 1, 4, 2, 1 })
+            {
+                dbf.move_to(id);
+                mapnik::feature_impl feature(ctx, id);
+                for (int col = 0; col < dbf.num_fields(); ++col)
+                {
+                    dbf.add_attribute(col, tr, feature);
+                    mapnik::value const& value = expected[id - 1][col];
+                    mapnik::value const& decoded = feature.get(fields[col].name);
+                    bool ok = decoded.get_type_index() == value.get_type_index() && (value.is_null() || decoded == value);
+                    if (!ok)
+                    {
+                        std::clog << fields[col].name << " of record " << id << " is '" << decoded << "'\n";
+                        same = false;
+                    }
+                }
+            }
+            BOOST_TEST( same );
+            BOOST_TEST_EQ( dbf.string_value(1), std::string("DE\0xyz", 6) );
+        }
+        boost::filesystem::remove(file);
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ shape dbf: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
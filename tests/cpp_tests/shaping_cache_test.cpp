@@ -0,0 +1,130 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/text/itemizer.hpp>
+#include <mapnik/text/harfbuzz_shaper.hpp>
+#include <mapnik/text/shaping_cache.hpp>
+#include <mapnik/text/text_properties.hpp>
+#include <mapnik/unicode.hpp>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "utils.hpp"
+
+struct glyph_run
+{
+    mapnik::glyph_index_t glyph_index;
+    unsigned char_index;
+    unsigned face_id;
+    double advance;
+    double offset_x;
+    double offset_y;
+
+    bool operator==(glyph_run const& rhs) const
+    {
+        return glyph_index == rhs.glyph_index && char_index == rhs.char_index &&
+            face_id == rhs.face_id && advance == rhs.advance &&
+            offset_x == rhs.offset_x && offset_y == rhs.offset_y;
+    }
+};
+
+// shapes each part in its own format, all with the same face name
+std::vector<glyph_run> shape(mapnik::face_manager_freetype & font_manager,
+                             std::vector<std::string> const& parts)
+{
+    mapnik::transcoder tr("utf-8");
+    mapnik::text_itemizer itemizer;
+    double size = 10.0;
+    for (auto const& part : parts)
+    {
+        auto format = std::make_shared<mapnik::detail::evaluated_format_properties>();
+        format->face_name = "Test Face";
+        format->text_size = size;
+        size += 2.0;
+        itemizer.add_text(tr.transcode(part.c_str()), format);
+    }
+    mapnik::text_line line(0, itemizer.text().length());
+    std::map<unsigned, double> width_map;
+    mapnik::harfbuzz_shaper::shape_text(line, itemizer, width_map, font_manager, 1.5);
+    std::vector<glyph_run> runs;
+    for (auto const& glyph : line)
+    {
+        runs.push_back({ glyph.glyph_index, glyph.char_index, glyph.face->id(), glyph.advance(),
+                         glyph.offset.x, glyph.offset.y });
+    }
+    return runs;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+        mapnik::shaping_cache & cache = mapnik::shaping_cache::instance();
+        cache.clear();
+
+        // two maps registering different fonts under the same name
+        mapnik::font_library library;
+        mapnik::freetype_engine::font_file_mapping_type sans;
+        mapnik::freetype_engine::font_file_mapping_type mono;
+        mapnik::freetype_engine::font_memory_cache_type memory;
+        sans.emplace("Test Face", std::make_pair(0, std::string("./fonts/dejavu-fonts-ttf-2.33/ttf/DejaVuSans.ttf")));
+        mono.emplace("Test Face", std::make_pair(0, std::string("./tests/data/fonts/DejaVuSansMono-BoldOblique.ttf")));
+        mapnik::face_manager_freetype sans_manager(library, sans, memory);
+        mapnik::face_manager_freetype mono_manager(library, mono, memory);
+
+        std::vector<std::vector<std::string> > texts = { { "Main Street" }, { "Rue de l'Église" },
+                                                         { "Москва" }, { "(", "שלום", ")" },
+                                                         { "東京 Tokyo" }, { "123 ", "Main", " Street" },
+                                                         { "" } };
+        cache.set_max_size(0);
+        std::vector<std::vector<glyph_run> > sans_expected;
+        std::vector<std::vector<glyph_run> > mono_expected;
+        for (auto const& text : texts)
+        {
+            sans_expected.push_back(shape(sans_manager, text));
+            mono_expected.push_back(shape(mono_manager, text));
+        }
+        BOOST_TEST_EQ( cache.size(), 0u );
+        BOOST_TEST( sans_expected[0].size() == 11 && sans_expected[0] != mono_expected[0] );
+
+        // cached runs are the uncached ones, also after the other map shaped the
+        // same text with its own font of that name
+        cache.set_max_size(16384);
+        bool same = true;
+        for (unsigned pass = 0; pass < 2; ++pass)
+        {
+            for (std::size_t i = 0; i < texts.size(); ++i)
+            {
+                same = same && shape(sans_manager, texts[i]) == sans_expected[i];
+                same = same && shape(mono_manager, texts[i]) == mono_expected[i];
+            }
+        }
+        BOOST_TEST( same );
+        BOOST_TEST_EQ( cache.size(), 2 * (texts.size() - 1) );
+        cache.clear();
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ shaping cache: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
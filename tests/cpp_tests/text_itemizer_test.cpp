@@ -0,0 +1,147 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/text/itemizer.hpp>
+#include <mapnik/text/scrptrun.hpp>
+#include <mapnik/text/text_properties.hpp>
+#include <mapnik/unicode.hpp>
+#include <vector>
+#include <algorithm>
+
+// unicode
+#include <unicode/ubidi.h>
+
+namespace {
+
+// itemization as done with ICU BiDi and ScriptRun, for text
+// without mixed directions
+std::vector<mapnik::text_item> reference(mapnik::text_itemizer const& itemizer,
+                                         std::vector<std::pair<unsigned, mapnik::evaluated_format_properties_ptr> > const& formats,
+                                         unsigned start, unsigned end)
+{
+    mapnik::value_unicode_string const& text = itemizer.text();
+    // itemize() treats an end of 0 as the end of the text
+    if (end == 0) end = text.length();
+    UErrorCode error = U_ZERO_ERROR;
+    UBiDi *bidi = ubidi_openSized(end - start, 0, &error);
+    ubidi_setPara(bidi, text.getBuffer() + start, end - start, UBIDI_DEFAULT_LTR, 0, &error);
+    UBiDiDirection direction = ubidi_getDirection(bidi);
+    ubidi_close(bidi);
+    BOOST_TEST( direction != UBIDI_MIXED );
+
+    std::vector<unsigned> breaks;
+    std::vector<UScriptCode> scripts;
+    ScriptRun runs(text.getBuffer(), text.length());
+    while (runs.next())
+    {
+        breaks.push_back(runs.getScriptEnd());
+        scripts.push_back(runs.getScriptCode());
+    }
+    std::vector<mapnik::text_item> items;
+    unsigned position = start;
+    while (position < end)
+    {
+        mapnik::text_item item;
+        item.start = position;
+        std::size_t script = std::upper_bound(breaks.begin(), breaks.end(), position) - breaks.begin();
+        std::size_t format = 0;
+        while (format + 1 < formats.size() && formats[format + 1].first <= position) ++format;
+        position = std::min(end, breaks[script]);
+        if (format + 1 < formats.size()) position = std::min(position, formats[format + 1].first);
+        item.end = position;
+        item.script = scripts[script];
+        item.rtl = direction;
+        item.format = formats[format].second;
+        if (direction == UBIDI_LTR) items.push_back(item);
+        else items.insert(items.begin(), item);
+    }
+    return items;
+}
+
+bool same_items(std::list<mapnik::text_item> const& lhs, std::vector<mapnik::text_item> const& rhs)
+{
+    if (lhs.size() != rhs.size()) return false;
+    auto itr = rhs.begin();
+    for (auto const& item : lhs)
+    {
+        if (item.start != itr->start || item.end != itr->end ||
+            item.script != itr->script || item.rtl != itr->rtl ||
+            item.format != itr->format) return false;
+        ++itr;
+    }
+    return true;
+}
+
+bool check(std::vector<std::string> const& parts)
+{
+    mapnik::transcoder tr("utf-8");
+    mapnik::text_itemizer itemizer;
+    std::vector<std::pair<unsigned, mapnik::evaluated_format_properties_ptr> > formats;
+    for (auto const& part : parts)
+    {
+        mapnik::value_unicode_string str = tr.transcode(part.c_str());
+        auto format = std::make_shared<mapnik::detail::evaluated_format_properties>();
+        formats.emplace_back(itemizer.text().length(), format);
+        itemizer.add_text(str, format);
+    }
+    bool ok = true;
+    for (unsigned i = 0; i < itemizer.num_lines(); ++i)
+    {
+        auto line = itemizer.line(i);
+        std::list<mapnik::text_item> const& items = itemizer.itemize(line.first, line.second);
+        if (!same_items(items, reference(itemizer, formats, line.first, line.second)))
+        {
+            std::clog << "itemization differs for '" << parts[0] << "' line " << i << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    // latin and common characters only
+    BOOST_TEST( check({"Main Street"}) );
+    BOOST_TEST( check({"123"}) );
+    BOOST_TEST( check({"(42) - [17]"}) );
+    BOOST_TEST( check({""}) );
+    BOOST_TEST( check({"Rue de l'Église"}) );
+    BOOST_TEST( check({"Straße\nNord"}) );
+    BOOST_TEST( check({"\n\n1 km\n"}) );
+    BOOST_TEST( check({"µ ª º × ÷ ©"}) );
+    BOOST_TEST( check({"Đồng", "ſ ǅ ɏ"}) );
+    BOOST_TEST( check({"123 ", "Main", " Street"}) );
+    BOOST_TEST( check({"1\n", "Main\nStreet", ""}) );
+    // anything else goes through BiDi and script detection
+    BOOST_TEST( check({"Москва"}) );
+    BOOST_TEST( check({"Main ", "Москва"}) );
+    BOOST_TEST( check({"שלום"}) );
+    BOOST_TEST( check({"(", "שלום", ")"}) );
+    BOOST_TEST( check({"東京 Tokyo"}) );
+
+    mapnik::text_itemizer itemizer;
+    auto format = std::make_shared<mapnik::detail::evaluated_format_properties>();
+    mapnik::transcoder tr("utf-8");
+    itemizer.add_text(tr.transcode("שלום"), format);
+    BOOST_TEST( itemizer.itemize().front().rtl == UBIDI_RTL );
+    itemizer.clear();
+    itemizer.add_text(tr.transcode("Main"), format);
+    BOOST_TEST( itemizer.itemize().front().rtl == UBIDI_LTR );
+    BOOST_TEST( itemizer.itemize().front().script == USCRIPT_LATIN );
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ text itemizer: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
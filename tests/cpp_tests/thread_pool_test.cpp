@@ -0,0 +1,86 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/thread_pool.hpp>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        mapnik::thread_pool & pool = mapnik::thread_pool::instance();
+        unsigned hardware = std::thread::hardware_concurrency();
+        BOOST_TEST_EQ( pool.size(), hardware > 1 ? hardware - 1 : 0 );
+
+        // every index exactly once, for sizes around the number of threads
+        for (std::size_t count : { 0u, 1u, 2u, 3u, 7u, 64u, 1000u })
+        {
+            std::vector<std::atomic<int> > calls(count);
+            for (auto & c : calls) c = 0;
+            pool.parallel_for(count, 0, [&](std::size_t i) { ++calls[i]; });
+            for (auto const& c : calls) BOOST_TEST_EQ( c.load(), 1 );
+        }
+
+        // max_workers bounds the threads taking part, the caller included
+        for (unsigned max_workers : { 1u, 2u })
+        {
+            std::set<std::thread::id> ids;
+            std::mutex ids_mutex;
+            pool.parallel_for(256, max_workers, [&](std::size_t) {
+                std::lock_guard<std::mutex> lock(ids_mutex);
+                ids.insert(std::this_thread::get_id());
+            });
+            BOOST_TEST( ids.size() <= max_workers );
+            if (max_workers == 1) BOOST_TEST( ids.count(std::this_thread::get_id()) == 1 );
+        }
+
+        // nested loops finish even when every worker is busy with the outer one
+        std::atomic<int> inner(0);
+        pool.parallel_for(16, 0, [&](std::size_t) {
+            pool.parallel_for(16, 0, [&](std::size_t) { ++inner; });
+        });
+        BOOST_TEST_EQ( inner.load(), 16 * 16 );
+
+        // the first exception reaches the caller and the pool stays usable
+        bool thrown = false;
+        try
+        {
+            pool.parallel_for(100, 0, [](std::size_t i) {
+                if (i == 42) throw std::runtime_error("42");
+            });
+        }
+        catch (std::runtime_error const& ex)
+        {
+            thrown = std::string(ex.what()) == "42";
+        }
+        BOOST_TEST( thrown );
+        std::atomic<int> after(0);
+        pool.parallel_for(100, 0, [&](std::size_t) { ++after; });
+        BOOST_TEST_EQ( after.load(), 100 );
+    }
+    catch (std::exception const & ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST(false);
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ thread pool: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,124 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/unicode.hpp>
+#include <mapnik/value.hpp>
+#include <unicode/unistr.h>
+#include <vector>
+#include <algorithm>
+#include <string>
+
+// the transcoder against the plain ICU converter of its encoding
+bool same_as_converter(std::string const& encoding, std::string const& input)
+{
+    mapnik::transcoder tr(encoding);
+    mapnik::value_unicode_string expected(input.data(), static_cast<std::int32_t>(input.size()),
+                                          encoding.c_str());
+    if (tr.transcode(input.data(), static_cast<std::int32_t>(input.size())) != expected ||
+        tr.transcode(input.c_str()) != mapnik::value_unicode_string(input.c_str(), encoding.c_str()))
+    {
+        std::clog << encoding << " input of " << input.size() << " bytes differs\n";
+        return false;
+    }
+    // utf-8 straight from the source bytes as after a round trip through utf-16
+    std::string expected_utf8;
+    mapnik::to_utf8(expected, expected_utf8);
+    if (tr.transcode_utf8(input.data(), static_cast<std::int32_t>(input.size())) != expected_utf8)
+    {
+        std::clog << encoding << " input of " << input.size() << " bytes differs as utf-8\n";
+        return false;
+    }
+    return true;
+}
+
+// utf-8 back from a value, as ICU writes it
+bool same_utf8(mapnik::value_unicode_string const& ustr)
+{
+    std::string result;
+    mapnik::to_utf8(ustr, result);
+    std::string expected;
+    ustr.toUTF8String(expected);
+    return result == expected;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        std::vector<std::string> ascii = { "", "a", "Main Street", "123", std::string("a\0b", 3),
+                                           "\x01\x7f", std::string(300, 'x') };
+        std::vector<std::string> utf8 = { "caf\xc3\xa9", "\xd0\x9c\xd0\xbe\xd1\x81\xd0\xba\xd0\xb2\xd0\xb0",
+                                          "\xe6\x9d\xb1\xe4\xba\xac Tokyo", "\xf0\x9f\x97\xba",
+                                          "\xef\xbb\xbf" "bom", "\xef\xbf\xbe", std::string(300, 'x') + "\xc3\xa9" };
+        std::vector<std::string> invalid = { "caf\xe9", "\xc3", "ab\xc3", "\x80", "\xc0\xaf", "\xe0\x80\xaf",
+                                             "\xed\xa0\x80", "\xed\xa0\xbd\xed\xb7\xba", "\xf4\x90\x80\x80",
+                                             "\xf8\x88\x80\x80\x80", "\xfe\xff", "\xe6\x9d", "a\xe6\x9d" "b",
+                                             "\xf0\x9f\x97", "\xc3\xa9\xff\xc3\xa9" };
+
+        // ascii and valid utf-8 decode as the converter does and write back unchanged
+        mapnik::transcoder tr("utf-8");
+        for (std::string const& input : ascii)
+        {
+            BOOST_TEST( same_as_converter("utf-8", input) );
+            BOOST_TEST( same_as_converter("us-ascii", input) );
+            BOOST_TEST( same_as_converter("latin1", input) );
+            std::string result;
+            mapnik::to_utf8(tr.transcode(input.data(), static_cast<std::int32_t>(input.size())), result);
+            BOOST_TEST( result == input );
+        }
+        for (std::string const& input : utf8)
+        {
+            BOOST_TEST( same_as_converter("utf-8", input) );
+            std::string result;
+            mapnik::to_utf8(tr.transcode(input.data(), static_cast<std::int32_t>(input.size())), result);
+            BOOST_TEST( result == input );
+        }
+
+        // malformed utf-8 is substituted exactly as the converter does it
+        for (std::string const& input : invalid)
+        {
+            BOOST_TEST( same_as_converter("utf-8", input) );
+            BOOST_TEST( same_utf8(tr.transcode(input.data(), static_cast<std::int32_t>(input.size()))) );
+        }
+
+        // other encodings, ascii compatible or not
+        BOOST_TEST( same_as_converter("latin1", "caf\xe9") );
+        BOOST_TEST( same_as_converter("iso-8859-5", "\xbc\xde\xe1\xda\xd2\xd0") );
+        BOOST_TEST( same_as_converter("windows-1252", "\x80 caf\xe9") );
+        BOOST_TEST( same_as_converter("shift_jis", "\x93\x8c\x8b\x9e Tokyo") );
+        BOOST_TEST( same_as_converter("utf-16le", std::string("a\0b\0", 4)) );
+        BOOST_TEST( same_as_converter("utf-16be", std::string("\0a\0b", 4)) );
+        BOOST_TEST( same_as_converter("gb18030", "\x81\x30\x81\x30 \x95\x32\x82\x36") );
+        // ascii bytes that are not ascii text in these encodings
+        for (std::string const& encoding : { "utf-7", "iso-2022-jp", "ibm-37", "utf-16le", "hz-gb-2312" })
+        {
+            BOOST_TEST( same_as_converter(encoding, "a+b-c~{d~}\x1b$Be") );
+        }
+        mapnik::transcoder latin1("latin1");
+        std::string result;
+        mapnik::to_utf8(latin1.transcode("caf\xe9"), result);
+        BOOST_TEST( result == "caf\xc3\xa9" );
+        mapnik::transcoder sjis("shift_jis");
+        mapnik::to_utf8(sjis.transcode("\x93\x8c\x8b\x9e"), result);
+        BOOST_TEST( result == "\xe6\x9d\xb1\xe4\xba\xac" );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ unicode: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
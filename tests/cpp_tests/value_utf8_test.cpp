@@ -0,0 +1,124 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/value.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/expression.hpp>
+#include <mapnik/expression_evaluator.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+using operation = bool (*)(mapnik::value const&, mapnik::value const&);
+
+bool eq(mapnik::value const& a, mapnik::value const& b) { return a == b; }
+bool ne(mapnik::value const& a, mapnik::value const& b) { return a != b; }
+bool lt(mapnik::value const& a, mapnik::value const& b) { return a < b; }
+bool le(mapnik::value const& a, mapnik::value const& b) { return a <= b; }
+bool gt(mapnik::value const& a, mapnik::value const& b) { return a > b; }
+bool ge(mapnik::value const& a, mapnik::value const& b) { return a >= b; }
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        mapnik::transcoder tr("utf-8");
+        // ascii, latin, cjk, U+E000-U+FFFF and supplementary characters, whose
+        // utf-8 byte order differs from the utf-16 order of UnicodeString
+        std::vector<std::string> const texts = { "", "a", "ab", "b", "K\xc3\xb6ln", "Koln", "\xe6\x9d\xb1\xe4\xba\xac",
+                                                 "\xee\x80\x80", "\xef\xbf\xbd", "\xef\xbc\xa1", "\xf0\x9f\x97\xba",
+                                                 "\xf0\x9f\x97\xbaz", "\xf4\x8f\xbf\xbf", "a\xf0\x9f\x97\xba", "a\xee\x80\x80" };
+
+        // every representation compares like the utf-16 strings do
+        std::vector<operation> const operations = { eq, ne, lt, le, gt, ge };
+        bool same = true;
+        for (std::string const& lhs : texts)
+        {
+            for (std::string const& rhs : texts)
+            {
+                mapnik::value const ulhs(tr.transcode(lhs.c_str()));
+                mapnik::value const urhs(tr.transcode(rhs.c_str()));
+                mapnik::value const slhs(lhs);
+                mapnik::value const srhs(rhs);
+                for (operation op : operations)
+                {
+                    bool expected = op(ulhs, urhs);
+                    if (op(slhs, srhs) != expected || op(slhs, urhs) != expected || op(ulhs, srhs) != expected)
+                    {
+                        std::clog << "'" << lhs << "' against '" << rhs << "' differs\n";
+                        same = false;
+                    }
+                }
+            }
+        }
+        BOOST_TEST( same );
+
+        mapnik::value const name(std::string("K\xc3\xb6ln"));
+        BOOST_TEST( name.is<mapnik::value_utf8_string>() );
+        BOOST_TEST_EQ( name.to_string(), std::string("K\xc3\xb6ln") );
+        BOOST_TEST( name.to_unicode() == tr.transcode("K\xc3\xb6ln") );
+        BOOST_TEST_EQ( name.to_expression_string(), std::string("'K\xc3\xb6ln'") );
+        BOOST_TEST_EQ( mapnik::value(std::string("\xc3")).to_unicode().charAt(0), 0xfffd );
+        BOOST_TEST( mapnik::value(std::string("\xc3")) == mapnik::value(tr.transcode("\xc3")) );
+
+        // equal text hashes alike in either representation
+        BOOST_TEST_EQ( hash_value(name), hash_value(mapnik::value(tr.transcode("K\xc3\xb6ln"))) );
+
+        // conversions read the utf-8 directly
+        BOOST_TEST( mapnik::value(std::string("x")).to_bool() );
+        BOOST_TEST( !mapnik::value(std::string()).to_bool() );
+        BOOST_TEST_EQ( mapnik::value(std::string("12.5")).to_double(), 12.5 );
+        BOOST_TEST_EQ( mapnik::value(std::string("42")).to_int(), 42 );
+
+        // arithmetic keeps utf-8 unless it meets a utf-16 string
+        mapnik::value sum = name + mapnik::value(std::string(" 1"));
+        BOOST_TEST( sum.is<mapnik::value_utf8_string>() && sum.to_string() == "K\xc3\xb6ln 1" );
+        sum = name + mapnik::value(mapnik::value_integer(1));
+        BOOST_TEST( sum.is<mapnik::value_utf8_string>() && sum.to_string() == "K\xc3\xb6ln1" );
+        sum = name + mapnik::value(tr.transcode(" 1"));
+        BOOST_TEST( sum.is<mapnik::value_unicode_string>() && sum.to_string() == "K\xc3\xb6ln 1" );
+        BOOST_TEST( (name - name).is_null() );
+        BOOST_TEST( (-name).is_null() );
+        BOOST_TEST( mapnik::value() != mapnik::value(std::string("a")) );
+        BOOST_TEST( !(mapnik::value() != mapnik::value(std::string())) );
+
+        // filters match utf-8 attributes against utf-16 literals
+        mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+        ctx->push("name");
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+        feature->put("name", tr.transcode_utf8("K\xc3\xb6ln"));
+        BOOST_TEST( feature->get("name").is<mapnik::value_utf8_string>() );
+        mapnik::attributes vars;
+        for (std::string const& filter : { "[name] = 'K\xc3\xb6ln'", "[name] != 'Koln'", "[name] > 'Koln'",
+                                           "[name].match('K.+ln')", "[name] + '!' = 'K\xc3\xb6ln!'" })
+        {
+            mapnik::expression_ptr expr = mapnik::parse_expression(filter);
+            mapnik::value result = mapnik::util::apply_visitor(
+                mapnik::evaluate<mapnik::feature_impl,mapnik::value,mapnik::attributes>(*feature, vars), *expr);
+            if (!result.to_bool()) std::clog << filter << " does not match\n";
+            BOOST_TEST( result.to_bool() );
+        }
+    }
+    catch (std::exception const & ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST(false);
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ utf-8 values: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
@@ -0,0 +1,166 @@
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <mapnik/map.hpp>
+#include <mapnik/load_map.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/feature_type_style.hpp>
+#include <mapnik/rule.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/projection.hpp>
+#include <mapnik/well_known_srs.hpp>
+#include <mapnik/proj_transform.hpp>
+#include <mapnik/view_transform.hpp>
+#include <mapnik/label_collision_detector.hpp>
+#include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/text/symbolizer_helpers.hpp>
+#include <mapnik/text/vertex_cache_store.hpp>
+#include <mapnik/make_unique.hpp>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "utils.hpp"
+
+mapnik::geometry_type * line(mapnik::feature_impl & feature, double y)
+{
+    auto geom = std::make_unique<mapnik::geometry_type>(mapnik::geometry_type::types::LineString);
+    geom->move_to(10, y);
+    geom->line_to(120, y + 10);
+    geom->line_to(240, y);
+    mapnik::geometry_type * result = geom.get();
+    feature.add_geometry(geom.release());
+    return result;
+}
+
+// places a text symbolizer the way the renderers do and returns the
+// positions of all its glyphs
+std::vector<double> place(mapnik::text_symbolizer const& sym, mapnik::feature_impl const& feature,
+                          mapnik::face_manager_freetype & font_manager,
+                          mapnik::vertex_cache_store * store)
+{
+    mapnik::attributes vars;
+    mapnik::projection proj(mapnik::MAPNIK_LONGLAT_PROJ);
+    mapnik::proj_transform prj_trans(proj, proj);
+    mapnik::box2d<double> extent(0, 0, 256, 256);
+    mapnik::view_transform t(256, 256, extent);
+    mapnik::label_collision_detector4 detector(extent);
+    agg::trans_affine tr;
+    auto transform = mapnik::get_optional<mapnik::transform_type>(sym, mapnik::keys::geometry_transform);
+    if (transform) mapnik::evaluate_transform(tr, feature, vars, *transform);
+    mapnik::text_symbolizer_helper helper(sym, feature, vars, prj_trans, 256, 256, 1.0, t,
+                                          font_manager, detector, extent, tr, store);
+    std::vector<double> positions;
+    for (auto const& glyphs : helper.get())
+    {
+        for (auto const& glyph : *glyphs)
+        {
+            positions.push_back(glyph.pos.x);
+            positions.push_back(glyph.pos.y);
+        }
+    }
+    return positions;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> args;
+    for (int i=1;i<argc;++i)
+    {
+        args.push_back(argv[i]);
+    }
+    bool quiet = std::find(args.begin(), args.end(), "-q")!=args.end();
+
+    try
+    {
+        BOOST_TEST(set_working_dir(args));
+        mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+        ctx->push("name");
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+        mapnik::geometry_type * a = line(*feature, 100);
+        mapnik::geometry_type * b = line(*feature, 160);
+
+        // entries are found only for the geometry and parameters they were
+        // measured with
+        mapnik::vertex_cache_store store;
+        mapnik::vertex_cache_store::params_type params = {{ 0 }};
+        store.set_feature(*feature);
+        BOOST_TEST( !store.find(*a, params) );
+        mapnik::vertex_cache * path = store.insert(*a, params, std::make_unique<mapnik::vertex_cache>(*a));
+        BOOST_TEST( path && store.find(*a, params) == path );
+        BOOST_TEST( !store.find(*b, params) );
+        mapnik::vertex_cache_store::params_type translated = params;
+        translated[9] = 5.0;
+        BOOST_TEST( !store.find(*a, translated) );
+        BOOST_TEST( store.insert(*a, translated, std::make_unique<mapnik::vertex_cache>(*a)) != path );
+        BOOST_TEST( store.find(*a, params) == path );
+        BOOST_TEST_EQ( store.size(), 2u );
+        store.set_feature(*feature);
+        BOOST_TEST_EQ( store.size(), 2u );
+
+        // another feature, even at the same address, starts afresh
+        feature->set_id(2);
+        store.set_feature(*feature);
+        BOOST_TEST_EQ( store.size(), 0u );
+        BOOST_TEST( !store.find(*a, params) );
+
+        // symbolizers differing only in what they draw share the path of each
+        // geometry; transforms and converter settings get their own
+        std::string font("./fonts/dejavu-fonts-ttf-2.33/ttf/DejaVuSans.ttf");
+        BOOST_TEST( mapnik::freetype_engine::register_font(font) );
+        feature->put("name", mapnik::value_unicode_string("Main Street"));
+        std::string xml = "<Map>"
+                          "<Style name=\"labels\"><Rule>"
+                          "<TextSymbolizer face-name=\"DejaVu Sans Book\" size=\"10\" placement=\"line\" largest-bbox-only=\"false\">[name]</TextSymbolizer>"
+                          "<TextSymbolizer face-name=\"DejaVu Sans Book\" size=\"14\" placement=\"line\" largest-bbox-only=\"false\" fill=\"red\">'Main'</TextSymbolizer>"
+                          "<TextSymbolizer face-name=\"DejaVu Sans Book\" size=\"10\" placement=\"line\" largest-bbox-only=\"false\" geometry-transform=\"translate(0,5)\">[name]</TextSymbolizer>"
+                          "<TextSymbolizer face-name=\"DejaVu Sans Book\" size=\"10\" placement=\"line\" largest-bbox-only=\"false\" smooth=\"0.5\">[name]</TextSymbolizer>"
+                          "<TextSymbolizer face-name=\"DejaVu Sans Book\" size=\"10\" placement=\"line\" largest-bbox-only=\"false\" clip=\"true\">[name]</TextSymbolizer>"
+                          "</Rule></Style>"
+                          "</Map>";
+        mapnik::Map m(256, 256);
+        mapnik::load_map_string(m, xml, true);
+        std::vector<mapnik::text_symbolizer> syms;
+        for (auto const& sym : m.find_style("labels")->get_rules()[0])
+        {
+            syms.push_back(mapnik::util::get<mapnik::text_symbolizer>(sym));
+        }
+        BOOST_TEST_EQ( syms.size(), 5u );
+        mapnik::font_library library;
+        mapnik::face_manager_freetype font_manager(library, mapnik::freetype_engine::get_mapping(),
+                                                   mapnik::freetype_engine::get_cache());
+        std::size_t sizes[] = { 2, 2, 4, 6, 8 };
+        bool same = true;
+        for (std::size_t i = 0; i < syms.size(); ++i)
+        {
+            std::vector<double> cached = place(syms[i], *feature, font_manager, &store);
+            same = same && !cached.empty() && cached == place(syms[i], *feature, font_manager, nullptr);
+            BOOST_TEST_EQ( store.size(), sizes[i] );
+        }
+        BOOST_TEST( same );
+
+        // repeated placements reuse the paths from the start
+        same = true;
+        for (auto const& sym : syms)
+        {
+            same = same && place(sym, *feature, font_manager, &store) == place(sym, *feature, font_manager, nullptr);
+        }
+        BOOST_TEST( same );
+        BOOST_TEST_EQ( store.size(), 8u );
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        BOOST_TEST( false );
+    }
+
+    if (!::boost::detail::test_errors()) {
+        if (quiet) std::clog << "\x1b[1;32m.\x1b[0m";
+        else std::clog << "C++ vertex cache store: \x1b[1;32m✓ \x1b[0m\n";
+        ::boost::detail::report_errors_remind().called_report_errors_function = true;
+    } else {
+        return ::boost::report_errors();
+    }
+}
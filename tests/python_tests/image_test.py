@@ -21,6 +21,17 @@ def test_image_premultiply():
     im.demultiply()
     eq_(im.premultiplied(),False)
 
+def test_image_content_hash():
+    im = mapnik.Image(256,256)
+    im2 = mapnik.Image(256,256)
+    eq_(im.content_hash(),im2.content_hash())
+    im.set_pixel(10,20,mapnik.Color('red'))
+    assert im.content_hash() != im2.content_hash()
+    im2.set_pixel(10,20,mapnik.Color('red'))
+    eq_(im.content_hash(),im2.content_hash())
+    # same pixels, different shape
+    assert mapnik.Image(128,512).content_hash() != mapnik.Image(256,256).content_hash()
+
 # Disabled for now since this breaks hard if run against
 # a mapnik version that does not have the fix
 #@raises(RuntimeError)